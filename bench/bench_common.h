@@ -0,0 +1,95 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+// Shared helpers for the benchmark executables: result output, timing and
+// synthetic FDM-DUO IQ
+//
+// Every result is one JSON object per line on stdout, e.g.
+//   {"version":"1.0.0","bench":"fft","fft_size":4096,...,"ns_per_sample":9.12}
+// so runs can be collected with `meson test --benchmark` and compared
+// between builds with jq or a spreadsheet.
+
+#include <stdio.h>
+#include <time.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "app_state.h"
+
+#define COUNT(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+// ---- Synthetic IQ in the FDM-DUO USB format ----
+
+#define SAMPLE_RATE 192000.0
+#define BENCH_SECONDS 5.0  // Signal time processed per configuration
+
+static inline void put_sample(uint8_t *p, double value) {
+    int32_t v = (int32_t)(value * 2147483647.0);
+    p[0] = v & 0xFF;
+    p[1] = (v >> 8) & 0xFF;
+    p[2] = (v >> 16) & 0xFF;
+    p[3] = (v >> 24) & 0xFF;
+}
+
+// Fill one USB buffer with a tone at freq_hz (continuing at sample n)
+static inline void fill_buffer(uint8_t *buf, double freq_hz, long n) {
+    for (int i = 0; i < USB_BUFFER_SIZE / 8; i++) {
+        double phase = 2.0 * M_PI * freq_hz * (double)(n + i) / SAMPLE_RATE;
+        put_sample(buf + i * 8, 0.1 * cos(phase));
+        put_sample(buf + i * 8 + 4, 0.1 * sin(phase));
+    }
+}
+
+// A second of a 12345 Hz tone as *blocks USB buffers, pre-generated so
+// generation stays out of the timing
+// Returns NULL if out of memory
+static inline uint8_t *tone_signal_new(int *blocks) {
+    *blocks = (int)(SAMPLE_RATE / (USB_BUFFER_SIZE / 8));
+    uint8_t *signal = malloc((size_t)*blocks * USB_BUFFER_SIZE);
+    if (!signal) return NULL;
+    for (int b = 0; b < *blocks; b++) {
+        fill_buffer(signal + (size_t)b * USB_BUFFER_SIZE, 12345.0, (long)b * (USB_BUFFER_SIZE / 8));
+    }
+    return signal;
+}
+
+// Unit-variance Gaussian noise (Box-Muller)
+static inline double gaussian(void) {
+    double u1 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    double u2 = (rand() + 1.0) / (RAND_MAX + 2.0);
+    return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
+#ifndef ELAD_VERSION
+#define ELAD_VERSION "unknown"
+#endif
+
+static inline double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Start a result line; add fields with bench_field_*, finish with bench_end
+static inline void bench_begin(const char *bench) {
+    printf("{\"version\":\"%s\",\"bench\":\"%s\"", ELAD_VERSION, bench);
+}
+
+static inline void bench_field_int(const char *key, long value) {
+    printf(",\"%s\":%ld", key, value);
+}
+
+static inline void bench_field_double(const char *key, double value) {
+    printf(",\"%s\":%.6g", key, value);
+}
+
+static inline void bench_field_str(const char *key, const char *value) {
+    printf(",\"%s\":\"%s\"", key, value);
+}
+
+static inline void bench_end(void) {
+    printf("}\n");
+    fflush(stdout);
+}
+
+#endif // BENCH_COMMON_H
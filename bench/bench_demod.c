@@ -0,0 +1,169 @@
+#define _DEFAULT_SOURCE
+// Demodulation benchmark: audio demodulator, channelizer and CW decoders
+//
+// The "demod" results time the audio demodulator per mode with its
+// default filter, as the share of one core it needs at 192 kS/s.
+//
+// The "channelizer" results time the polyphase FFT channelizer from 16
+// to 4096 channels with none and 16 channels subscribed: the cost per
+// input sample should grow with log2(channels) only.
+//
+// The "cw" results time the --cw-decode path on one thread: a 512-channel
+// channelizer with CW_DECODERS channels subscribed and one CW decoder on
+// each, split into the channelizer and the decoders' share of one core.
+//
+// Run with: meson test -C build --benchmark  (or ./build/bench-demod)
+
+#include "bench_common.h"
+#include "demodulator.h"
+#include "channelizer.h"
+#include "cw_decoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static void run_demod(const uint8_t *signal, int blocks, demod_mode_t mode) {
+    demodulator_t *demod = demodulator_new((int)SAMPLE_RATE);
+    if (!demod || demodulator_set_mode(demod, mode, 0, 0) != 0) {
+        demodulator_free(demod);
+        return;
+    }
+    int samples = USB_BUFFER_SIZE / 8;
+    int max_audio = demodulator_max_output(demod, samples);
+    float *audio = malloc(sizeof(float) * max_audio);
+
+    // Warm up, then time BENCH_SECONDS of signal
+    for (int b = 0; b < blocks; b++) {
+        demodulator_process_s32(demod, signal + (size_t)b * USB_BUFFER_SIZE, samples, audio,
+                                max_audio);
+    }
+    int rounds = (int)BENCH_SECONDS;
+    long audio_samples = 0;
+    double start = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        for (int b = 0; b < blocks; b++) {
+            audio_samples += demodulator_process_s32(demod, signal + (size_t)b * USB_BUFFER_SIZE,
+                                                     samples, audio, max_audio);
+        }
+    }
+    double elapsed = now_ns() - start;
+    double ns_per_sample = elapsed / ((double)rounds * blocks * samples);
+
+    bench_begin("demod");
+    bench_field_str("mode", demodulator_mode_name(mode));
+    bench_field_int("channel_rate", demodulator_get_channel_rate(demod));
+    bench_field_double("ns_per_sample", ns_per_sample);
+    bench_field_double("core_pct", ns_per_sample * SAMPLE_RATE * 1e-7);
+    // Audio samples per second of input, should be DEMOD_AUDIO_RATE
+    bench_field_double("audio_rate", audio_samples * SAMPLE_RATE / ((double)rounds * blocks * samples));
+    bench_end();
+
+    free(audio);
+    demodulator_free(demod);
+}
+
+#define CHANNELIZER_SUBSCRIBED 16
+
+static void run_channelizer(const uint8_t *signal, int blocks, int channels, int subscribed) {
+    channelizer_t *ch = channelizer_new((int)SAMPLE_RATE, channels);
+    if (!ch) return;
+    for (int k = 0; k < subscribed; k++) {
+        channelizer_subscribe(ch, k * (channels / subscribed));
+    }
+    float *out = malloc(sizeof(float) * 2 * (size_t)SAMPLE_RATE);
+    int samples = USB_BUFFER_SIZE / 8;
+
+    // Consumers drain every buffer, as they would from their own threads
+    int rounds = (int)BENCH_SECONDS;
+    double start = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        for (int b = 0; b < blocks; b++) {
+            channelizer_process_s32(ch, signal + (size_t)b * USB_BUFFER_SIZE, samples);
+            for (int k = 0; k < subscribed; k++) {
+                channelizer_read(ch, k * (channels / subscribed), out, (int)SAMPLE_RATE);
+            }
+        }
+    }
+    double ns_per_sample = (now_ns() - start) / ((double)rounds * blocks * samples);
+
+    bench_begin("channelizer");
+    bench_field_int("channels", channels);
+    bench_field_int("subscribed", subscribed);
+    bench_field_double("spacing_hz", channelizer_get_spacing(ch));
+    bench_field_double("ns_per_sample", ns_per_sample);
+    bench_field_double("core_pct", ns_per_sample * SAMPLE_RATE * 1e-7);
+    bench_end();
+
+    free(out);
+    channelizer_free(ch);
+}
+
+// --cw-decode: default channelizer size, and up to this many decoders
+#define CW_CHANNELS 512
+#define CW_DECODERS 128
+
+static void run_cw(const uint8_t *signal, int blocks, int decoders) {
+    int channels = CW_CHANNELS;
+    channelizer_t *ch = channelizer_new((int)SAMPLE_RATE, channels);
+    if (!ch) return;
+    cw_decoder_t **dec = calloc(decoders, sizeof(cw_decoder_t *));
+    for (int k = 0; k < decoders; k++) {
+        channelizer_subscribe(ch, k * (channels / decoders));
+        dec[k] = cw_decoder_new(channelizer_get_output_rate(ch));
+        cw_decoder_set_offset(dec[k], 100.0);
+    }
+    float *out = malloc(sizeof(float) * 2 * (size_t)SAMPLE_RATE);
+    int samples = USB_BUFFER_SIZE / 8;
+
+    int rounds = (int)BENCH_SECONDS;
+    double decode_ns = 0.0;
+    double start = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        for (int b = 0; b < blocks; b++) {
+            channelizer_process_s32(ch, signal + (size_t)b * USB_BUFFER_SIZE, samples);
+            double decode_start = now_ns();
+            for (int k = 0; k < decoders; k++) {
+                int n = channelizer_read(ch, k * (channels / decoders), out, (int)SAMPLE_RATE);
+                cw_decoder_process(dec[k], out, n);
+            }
+            decode_ns += now_ns() - decode_start;
+        }
+    }
+    double input_samples = (double)rounds * blocks * samples;
+    double ns_per_sample = (now_ns() - start) / input_samples;
+
+    bench_begin("cw");
+    bench_field_int("channels", channels);
+    bench_field_int("decoders", decoders);
+    bench_field_double("channel_rate", channelizer_get_output_rate(ch));
+    bench_field_double("ns_per_sample", ns_per_sample);
+    bench_field_double("core_pct", ns_per_sample * SAMPLE_RATE * 1e-7);
+    bench_field_double("decoder_core_pct", decode_ns / input_samples * SAMPLE_RATE * 1e-7);
+    bench_end();
+
+    for (int k = 0; k < decoders; k++) cw_decoder_free(dec[k]);
+    free(dec);
+    free(out);
+    channelizer_free(ch);
+}
+
+int main(void) {
+    int blocks;
+    uint8_t *signal = tone_signal_new(&blocks);
+    if (!signal) return 1;
+
+    for (int m = DEMOD_AM; m <= DEMOD_FM; m++) {
+        run_demod(signal, blocks, (demod_mode_t)m);
+    }
+
+    for (int channels = 16; channels <= 4096; channels *= 4) {
+        run_channelizer(signal, blocks, channels, 0);
+        run_channelizer(signal, blocks, channels, CHANNELIZER_SUBSCRIBED);
+    }
+
+    for (int decoders = 32; decoders <= CW_DECODERS; decoders *= 2) {
+        run_cw(signal, blocks, decoders);
+    }
+
+    free(signal);
+    return 0;
+}
@@ -0,0 +1,262 @@
+#define _DEFAULT_SOURCE
+// DSP benchmark: fft_processor_process at each FFT size, averaging depth
+// and estimator front end
+//
+// Feeds a synthetic tone through fft_processor and reports the processing
+// cost per input sample and the spectrum rate, plus the leakage three bins
+// away from a tone halfway between bins (the worst case for scalloping,
+// and what the extra WOLA taps buy).
+//
+// The "fftsend" result compares elad-server's former hand-rolled FFT loop
+// (kept below as a reference) with fft_processor_process_float on the same
+// float I/Q buffers.
+//
+// Run with: meson test -C build --benchmark  (or ./build/bench-dsp)
+
+#include "bench_common.h"
+#include "fft_processor.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+static const int fft_sizes[] = { 1024, 2048, 4096, 8192, 16384 };
+static const int averaging[] = { 1, 3, 8 };
+
+static const struct {
+    const char *name;
+    fft_window_t type;
+} windows[] = {
+    { "blackman-harris", FFT_WINDOW_BLACKMAN_HARRIS },
+    { "wola", FFT_WINDOW_WOLA },
+};
+
+static fft_processor_t *create(int fft_size, fft_window_t type, int frames) {
+    fft_processor_t *fft = fft_processor_new(fft_size);
+    if (!fft || fft_processor_set_window(fft, type) != 0 ||
+        fft_processor_set_averaging(fft, frames) != 0) {
+        fprintf(stderr, "bench: failed to create processor\n");
+        exit(1);
+    }
+    return fft;
+}
+
+// Leakage three bins from the peak (dBc) for a tone halfway between bins
+static float measure_leakage(int fft_size, fft_window_t type, float *peak_db) {
+    fft_processor_t *fft = create(fft_size, type, 1);
+
+    double tone_hz = 100.5 * SAMPLE_RATE / fft_size;
+    uint8_t *buf = malloc(USB_BUFFER_SIZE);
+    long n = 0;
+    while (1) {
+        fill_buffer(buf, tone_hz, n);
+        n += USB_BUFFER_SIZE / 8;
+        if (fft_processor_process(fft, buf, USB_BUFFER_SIZE)) break;
+    }
+
+    float *spectrum = malloc(sizeof(float) * fft_size);
+    fft_processor_get_spectrum_db(fft, spectrum);
+    int peak = 0;
+    for (int i = 1; i < fft_size; i++) {
+        if (spectrum[i] > spectrum[peak]) peak = i;
+    }
+    *peak_db = spectrum[peak];
+    float leakage = spectrum[peak + 3] - spectrum[peak];
+
+    free(spectrum);
+    free(buf);
+    fft_processor_free(fft);
+    return leakage;
+}
+
+static void run(const uint8_t *signal, int blocks, int fft_size, int w, int frames) {
+    fft_processor_t *fft = create(fft_size, windows[w].type, frames);
+
+    int total_blocks = (int)(BENCH_SECONDS * blocks);
+    int spectra = 0;
+    double start = now_ns();
+    for (int b = 0; b < total_blocks; b++) {
+        if (fft_processor_process(fft, signal + (size_t)(b % blocks) * USB_BUFFER_SIZE, USB_BUFFER_SIZE)) {
+            spectra++;
+        }
+    }
+    double elapsed = now_ns() - start;
+    double samples = (double)total_blocks * (USB_BUFFER_SIZE / 8);
+    fft_processor_free(fft);
+
+    float peak_db;
+    float leakage = measure_leakage(fft_size, windows[w].type, &peak_db);
+
+    bench_begin("fft");
+    bench_field_int("fft_size", fft_size);
+    bench_field_int("averaging", frames);
+    bench_field_str("window", windows[w].name);
+    bench_field_double("ns_per_sample", elapsed / samples);
+    bench_field_double("realtime_factor", (samples / SAMPLE_RATE) / (elapsed / 1e9));
+    bench_field_double("spectra_per_s", spectra / (elapsed / 1e9));
+    bench_field_double("peak_db", peak_db);
+    bench_field_double("leakage_dbc", leakage);
+    bench_end();
+}
+
+// elad-server's FFTSend loop before it moved to fft_processor: windowed
+// radix-2 DIF FFT in double, bit reversal per output bin, log10 per bin
+typedef struct {
+    int n, p;
+    double *co, *si, *coeff, *re, *im;
+    uint8_t *out;
+} legacy_fft_t;
+
+static legacy_fft_t *legacy_new(int p) {
+    legacy_fft_t *l = calloc(1, sizeof(legacy_fft_t));
+    l->p = p;
+    l->n = 1 << p;
+    int n = l->n;
+    int m = n / 2;
+    l->co = calloc(m, sizeof(double));
+    l->si = calloc(m, sizeof(double));
+    l->coeff = calloc(n, sizeof(double));
+    l->re = calloc(n, sizeof(double));
+    l->im = calloc(n, sizeof(double));
+    l->out = calloc(n, 1);
+    for (int j = 1; j < n; j++) {
+        l->coeff[j] = 0.35875 - 0.48829 * cos(2 * M_PI * j / (n - 1)) +
+                      0.14128 * cos(4 * M_PI * j / (n - 1)) - 0.01168 * cos(6 * M_PI * j / (n - 1));
+    }
+    double co1 = cos(M_PI / m);
+    double si1 = -sin(M_PI / m);
+    l->co[0] = 1;
+    l->si[0] = 0;
+    for (int j = 1; j < m; j++) {
+        l->co[j] = co1 * l->co[j - 1] - si1 * l->si[j - 1];
+        l->si[j] = si1 * l->co[j - 1] + co1 * l->si[j - 1];
+    }
+    return l;
+}
+
+static void legacy_free(legacy_fft_t *l) {
+    free(l->co);
+    free(l->si);
+    free(l->coeff);
+    free(l->re);
+    free(l->im);
+    free(l->out);
+    free(l);
+}
+
+static void legacy_frame(legacy_fft_t *l, const float *iq) {
+    int n = l->n;
+    int m = n / 2;
+    double *re = l->re;
+    double *im = l->im;
+    for (int j = 0; j < n; j++) {
+        re[j] = iq[2 * j] * l->coeff[j];
+        im[j] = iq[2 * j + 1] * l->coeff[j];
+    }
+    for (int j = 0, ng = 1, md = m; j < l->p; j++) {
+        for (int ind = 0, ig = 0; ig < ng; ig++) {
+            for (int i = 0, k = 0; i < md; i++) {
+                int i1 = ind + i;
+                int i2 = i1 + md;
+                double dr = re[i1] - re[i2];
+                double di = im[i1] - im[i2];
+                re[i1] += re[i2];
+                im[i1] += im[i2];
+                re[i2] = dr * l->co[k] - di * l->si[k];
+                im[i2] = dr * l->si[k] + di * l->co[k];
+                k += ng;
+            }
+            ind += md * 2;
+        }
+        md >>= 1;
+        ng <<= 1;
+    }
+    for (int j = 0; j < n; j++) {
+        int jd = j, k = 0, kp = m;
+        for (int i = 1; i <= l->p; i++) {
+            k += (jd - (jd / 2) * 2) * kp;
+            jd >>= 1;
+            kp >>= 1;
+        }
+        if (k > j) {
+            double t = re[j];
+            re[j] = re[k];
+            re[k] = t;
+            t = im[j];
+            im[j] = im[k];
+            im[k] = t;
+        }
+    }
+    for (int j = 0; j < n; j++) {
+        double mag = sqrt(re[j] * re[j] + im[j] * im[j]) / m;
+        l->out[j] = 150 + (char)(20 * log10(mag));
+    }
+}
+
+// One spectrum per received UDP buffer (1536 float I/Q samples), old loop
+// against the shared engine
+static void run_fftsend(int p) {
+    int n = 1 << p;
+    int samples = USB_BUFFER_SIZE / 8;
+    int frames = 20000;
+    float *iq = malloc(sizeof(float) * 2 * samples);
+    for (int i = 0; i < samples; i++) {
+        double phase = 2.0 * M_PI * 12345.0 * i / SAMPLE_RATE;
+        iq[2 * i] = (float)(0.1 * cos(phase));
+        iq[2 * i + 1] = (float)(0.1 * sin(phase));
+    }
+
+    legacy_fft_t *l = legacy_new(p);
+    double start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        legacy_frame(l, iq);
+    }
+    double legacy_ns = (now_ns() - start) / frames;
+    legacy_free(l);
+
+    fft_processor_t *fft = create(n, FFT_WINDOW_BLACKMAN_HARRIS, 1);
+    float *spectrum = malloc(sizeof(float) * n);
+    int spectra = 0;
+    start = now_ns();
+    for (int f = 0; f < frames; f++) {
+        if (fft_processor_process_float(fft, iq, samples)) {
+            fft_processor_get_spectrum_db(fft, spectrum);
+            spectra++;
+        }
+    }
+    double engine_ns = (now_ns() - start) / frames;
+    fft_processor_free(fft);
+
+    bench_begin("fftsend");
+    bench_field_int("fft_size", n);
+    bench_field_double("legacy_ns_per_frame", legacy_ns);
+    bench_field_double("engine_ns_per_frame", engine_ns);
+    bench_field_double("engine_spectra_per_frame", (double)spectra / frames);
+    bench_field_double("speedup", legacy_ns / engine_ns);
+    // The old loop transformed only the first n samples of each buffer;
+    // the engine transforms all of them
+    bench_field_double("speedup_per_fft", legacy_ns / engine_ns * samples / n);
+    bench_end();
+
+    free(spectrum);
+    free(iq);
+}
+
+int main(void) {
+    int blocks;
+    uint8_t *signal = tone_signal_new(&blocks);
+    if (!signal) return 1;
+
+    for (int s = 0; s < COUNT(fft_sizes); s++) {
+        for (int a = 0; a < COUNT(averaging); a++) {
+            for (int w = 0; w < COUNT(windows); w++) {
+                run(signal, blocks, fft_sizes[s], w, averaging[a]);
+            }
+        }
+    }
+
+    run_fftsend(10);
+
+    free(signal);
+    return 0;
+}
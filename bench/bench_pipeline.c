@@ -0,0 +1,102 @@
+#define _DEFAULT_SOURCE
+// Multi-radio pipeline benchmark: aggregate throughput of 1 to
+// PIPELINE_MAX_RADIOS radio_pipelines running side by side
+//
+// Each pipeline plays the same recorded tone at maximum speed (its source
+// thread waits for ring space, so it runs as fast as its DSP thread), the
+// way several radios run in one process: own source and DSP threads, own
+// FFT, no shared locks. The "pipelines" result reports the total samples/s
+// for each radio count and the scaling against one radio (1.0 = linear),
+// with the number of online cores; scaling can only stay linear while
+// there is a free core for every busy thread.
+//
+// Run with: meson test -C build --benchmark  (or ./build/bench-pipeline)
+
+#include "bench_common.h"
+#include "radio_pipeline.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define PIPELINE_MAX_RADIOS 4
+#define PIPELINE_RUN_US 3000000  // Wall time per radio count
+
+// Write a second of tone as a raw IQ file
+// Returns 0 on success, -1 on error
+static int write_signal(const char *path) {
+    int blocks;
+    uint8_t *signal = tone_signal_new(&blocks);
+    if (!signal) return -1;
+    FILE *f = fopen(path, "wb");
+    size_t size = (size_t)blocks * USB_BUFFER_SIZE;
+    int ok = f && fwrite(signal, 1, size, f) == size;
+    if (f && fclose(f) != 0) ok = 0;
+    free(signal);
+    return ok ? 0 : -1;
+}
+
+// Run radios pipelines for PIPELINE_RUN_US
+// Returns total mega-samples/s, or a negative value on error
+static double run_pipelines(const char *path, int radios) {
+    radio_pipeline_t *pipes[PIPELINE_MAX_RADIOS] = { 0 };
+    iq_playback_t *playbacks[PIPELINE_MAX_RADIOS] = { 0 };
+    double total_msps = -1.0;
+
+    for (int i = 0; i < radios; i++) {
+        playbacks[i] = iq_playback_open(path, (int)SAMPLE_RATE);
+        if (!playbacks[i]) goto done;
+        iq_playback_set_speed(playbacks[i], IQ_PLAYBACK_SPEED_MAX);
+        iq_playback_set_loop(playbacks[i], true);
+        // Takes ownership of the playback
+        pipes[i] = radio_pipeline_new_playback(playbacks[i]);
+        if (!pipes[i]) goto done;
+    }
+    for (int i = 0; i < radios; i++) {
+        if (radio_pipeline_start(pipes[i]) != 0) goto done;
+    }
+
+    usleep(PIPELINE_RUN_US);
+    total_msps = 0.0;
+    for (int i = 0; i < radios; i++) {
+        total_msps += iq_playback_get_throughput_msps(playbacks[i]);
+    }
+
+done:
+    for (int i = 0; i < radios; i++) {
+        radio_pipeline_free(pipes[i]);
+    }
+    return total_msps;
+}
+
+int main(void) {
+    char path[] = "/tmp/bench-pipeline-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0 || close(fd) != 0 || write_signal(path) != 0) {
+        fprintf(stderr, "bench-pipeline: Cannot write %s\n", path);
+        return 1;
+    }
+
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    double single_msps = 0.0;
+    for (int radios = 1; radios <= PIPELINE_MAX_RADIOS; radios++) {
+        double total_msps = run_pipelines(path, radios);
+        if (total_msps < 0.0) {
+            fprintf(stderr, "bench-pipeline: Cannot run %d pipelines\n", radios);
+            unlink(path);
+            return 1;
+        }
+        if (radios == 1) single_msps = total_msps;
+
+        bench_begin("pipelines");
+        bench_field_int("radios", radios);
+        bench_field_int("cores", cores);
+        bench_field_double("msps_total", total_msps);
+        bench_field_double("msps_per_radio", total_msps / radios);
+        bench_field_double("scaling", single_msps > 0.0 ? total_msps / (radios * single_msps) : 0.0);
+        bench_field_double("realtime_radios", total_msps * 1e6 / SAMPLE_RATE);
+        bench_end();
+    }
+
+    unlink(path);
+    return 0;
+}
@@ -0,0 +1,167 @@
+#define _DEFAULT_SOURCE
+// Render benchmark: the per-frame drawing paths, on offscreen surfaces
+//
+//   waterfall  waterfall_render_line (scroll + colourise) into an RGB24
+//              surface, as WaterfallWidget does for every spectrum
+//   spectrum   spectrum_render with band overlay and signal markers, as
+//              SpectrumWidget draws every frame
+//   bandplan   bandplan_find_visible for a sweep of visible spans
+//
+// Run with: meson test -C build --benchmark  (or ./build/bench-render [bands.json])
+
+#include "bench_common.h"
+#include "spectrum_render.h"
+#include "waterfall_render.h"
+#include "bandplan.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define WATERFALL_HEIGHT 400
+#define BENCH_LINES 5000
+#define SPECTRUM_FRAMES 300
+#define BANDPLAN_CALLS 1000000
+
+static const int waterfall_widths[] = { 800, 1920 };
+
+static const struct {
+    int width;
+    int height;
+} spectrum_sizes[] = {
+    { 800, 240 },
+    { 1920, 540 },
+};
+
+// Noise around -110 dB with a few carriers, shifted per frame
+static void fill_spectrum(float *spectrum, int size, int frame) {
+    unsigned int seed = 12345u + frame;
+    for (int i = 0; i < size; i++) {
+        seed = seed * 1103515245u + 12345u;
+        spectrum[i] = -110.0f + (float)((seed >> 16) & 0x7FFF) / 32768.0f * 10.0f;
+    }
+    for (int c = 1; c <= 8; c++) {
+        int bin = (c * size / 9 + frame) % size;
+        spectrum[bin] = -50.0f - c;
+    }
+}
+
+// Fallback plan covering the default 14.2 MHz span if the JSON is missing
+static void fill_bandplan(bandplan_t *plan) {
+    memset(plan, 0, sizeof(*plan));
+    for (int i = 0; i < BANDPLAN_MAX_BANDS; i++) {
+        band_entry_t *band = &plan->bands[i];
+        snprintf(band->name, sizeof(band->name), "band %d", i);
+        band->lower_bound = 1800000 + (int64_t)i * 450000;
+        band->upper_bound = band->lower_bound + 200000;
+        band->tag = (band_tag_t)(1 + i % 4);
+    }
+    plan->count = BANDPLAN_MAX_BANDS;
+}
+
+static void bench_waterfall(const float *spectrum, int size, int width) {
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, WATERFALL_HEIGHT);
+
+    double start = now_ns();
+    for (int i = 0; i < BENCH_LINES; i++) {
+        waterfall_render_line(surface, spectrum, 0, size, -120.0f, -40.0f);
+    }
+    double elapsed = now_ns() - start;
+
+    bench_begin("waterfall");
+    bench_field_int("width", width);
+    bench_field_int("height", WATERFALL_HEIGHT);
+    bench_field_int("bins", size);
+    bench_field_double("ns_per_line", elapsed / BENCH_LINES);
+    bench_field_double("lines_per_s", BENCH_LINES / (elapsed / 1e9));
+    bench_end();
+
+    cairo_surface_destroy(surface);
+}
+
+static void bench_spectrum(float *spectrum, int size, int width, int height,
+                           const bandplan_t *plan) {
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, height);
+    cairo_t *cr = cairo_create(surface);
+
+    spectrum_view_t view;
+    spectrum_view_init(&view);
+    view.min_db = -120.0f;
+    view.max_db = -40.0f;
+    view.bandplan = plan;
+    snprintf(view.overlay_freq, sizeof(view.overlay_freq), "14.200.000");
+    snprintf(view.overlay_mode, sizeof(view.overlay_mode), "USB");
+    snprintf(view.info_text, sizeof(view.info_text), "USB: 15.6 spectra/s\nDSP: 0.4 ms");
+    view.marker_count = 16;
+    for (int m = 0; m < view.marker_count; m++) {
+        view.markers[m].center_bin = (m + 0.5f) * size / view.marker_count;
+        view.markers[m].width_bins = 12.0f;
+        view.markers[m].snr_db = 20.0f + m;
+    }
+
+    double start = now_ns();
+    for (int i = 0; i < SPECTRUM_FRAMES; i++) {
+        spectrum[i % size] = -60.0f;  // Keep the data changing between frames
+        spectrum_render(cr, width, height, &view, spectrum, size);
+    }
+    cairo_surface_flush(surface);
+    double elapsed = now_ns() - start;
+
+    bench_begin("spectrum");
+    bench_field_int("width", width);
+    bench_field_int("height", height);
+    bench_field_int("bins", size);
+    bench_field_int("markers", view.marker_count);
+    bench_field_int("bands", plan->count);
+    bench_field_double("ms_per_frame", elapsed / SPECTRUM_FRAMES / 1e6);
+    bench_field_double("frames_per_s", SPECTRUM_FRAMES / (elapsed / 1e9));
+    bench_end();
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+static void bench_bandplan(const bandplan_t *plan) {
+    int indices[BANDPLAN_MAX_BANDS];
+    long found = 0;
+
+    // Sweep a 192 kHz span across HF so hits and misses both occur
+    double start = now_ns();
+    for (int i = 0; i < BANDPLAN_CALLS; i++) {
+        int64_t freq_start = 1000000 + (int64_t)(i % 29000) * 1000;
+        found += bandplan_find_visible(plan, freq_start, freq_start + DEFAULT_SAMPLE_RATE,
+                                       indices, BANDPLAN_MAX_BANDS);
+    }
+    double elapsed = now_ns() - start;
+
+    bench_begin("bandplan");
+    bench_field_int("bands", plan->count);
+    bench_field_double("ns_per_call", elapsed / BANDPLAN_CALLS);
+    bench_field_double("hits_per_call", (double)found / BANDPLAN_CALLS);
+    bench_end();
+}
+
+int main(int argc, char **argv) {
+    float *spectrum = malloc(sizeof(float) * FFT_SIZE);
+    bandplan_t *plan = malloc(sizeof(bandplan_t));
+    if (!spectrum || !plan) return 1;
+
+    fill_spectrum(spectrum, FFT_SIZE, 0);
+    if (argc < 2 || bandplan_load(plan, argv[1]) != 0) {
+        fprintf(stderr, "bench: using synthetic band plan\n");
+        fill_bandplan(plan);
+    }
+
+    for (int i = 0; i < COUNT(waterfall_widths); i++) {
+        bench_waterfall(spectrum, FFT_SIZE, waterfall_widths[i]);
+    }
+    for (int i = 0; i < COUNT(spectrum_sizes); i++) {
+        bench_spectrum(spectrum, FFT_SIZE, spectrum_sizes[i].width, spectrum_sizes[i].height, plan);
+    }
+    bench_bandplan(plan);
+
+    bandplan_free(plan);
+    free(plan);
+    free(spectrum);
+    return 0;
+}
@@ -0,0 +1,226 @@
+#define _DEFAULT_SOURCE
+// Storage benchmark: occupancy store and spectrum archive
+//
+// The "occupancy" result times adding one 4096-bin spectrum to the
+// occupancy store (per frame and as a share of one core at the display
+// spectrum rate), then fills every hour of the OCCUPANCY_DAYS of the two
+// tile files the span covers and times a full 24 x 1024 heatmap query
+// over them.
+//
+// The "archive" result writes ARC_LINES 4096-bin lines of a busy band
+// (noise averaged over 3 frames, steady and fading carriers, keyed ones)
+// through the spectrum archive and reports the cost per line, the bytes
+// per line and per day at the display rate, and the time to seek to and
+// decode a screenful of lines in the middle.
+//
+// Run with: meson test -C build --benchmark  (or ./build/bench-storage)
+
+#include "bench_common.h"
+#include "occupancy.h"
+#include "spectrum_archive.h"
+#include "mono_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Store geometry: the display spectrum, 15.625 spectra/s at 192 kS/s
+#define OCC_BINS 4096
+#define OCC_RATE (SAMPLE_RATE / OCC_BINS / 3)
+#define OCC_FRAMES 20000
+#define OCC_COLUMNS 1024
+#define OCC_CENTER_HZ 7100000LL
+
+static void run_occupancy(void) {
+    char dir[] = "/tmp/bench-occupancy-XXXXXX";
+    if (!mkdtemp(dir)) return;
+    occupancy_t *occ = occupancy_new(dir, OCC_BINS, OCCUPANCY_DEFAULT_THRESHOLD_DB);
+    if (!occ) return;
+
+    float *spectrum = malloc(sizeof(float) * OCC_BINS);
+    for (int i = 0; i < OCC_BINS; i++) spectrum[i] = -120.0f + 40.0f * (float)gaussian();
+
+    // Frames 64 ms apart from now on; the worker maps the two tiles the
+    // span covers while the first ones are skipped
+    uint64_t t0 = monotonic_ns();
+    while (occupancy_get_frames(occ) == 0) {
+        occupancy_add(occ, spectrum, -120.0f, OCC_CENTER_HZ, (uint32_t)SAMPLE_RATE, t0);
+        usleep(1000);
+    }
+    double start = now_ns();
+    for (int f = 1; f <= OCC_FRAMES; f++) {
+        occupancy_add(occ, spectrum, -120.0f, OCC_CENTER_HZ, (uint32_t)SAMPLE_RATE,
+                      t0 + (uint64_t)f * 64000000ULL);
+    }
+    double ns_per_frame = (now_ns() - start) / OCC_FRAMES;
+
+    // Every hour of each tile's ring written, as after running for
+    // OCCUPANCY_DAYS
+    double file_mb = 0.0, query_ms = 0.0;
+    DIR *files = opendir(dir);
+    struct dirent *entry;
+    while (files && (entry = readdir(files))) {
+        if (entry->d_name[0] == '.') continue;
+        char path[600];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        int fd = open(path, O_RDWR);
+        struct stat st;
+        if (fd < 0) continue;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            continue;
+        }
+        uint8_t *map = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (map == MAP_FAILED) continue;
+        occupancy_header_t *header = (occupancy_header_t *)map;
+        occupancy_bucket_t *table = (occupancy_bucket_t *)(map + header->header_size);
+        occupancy_cell_t *cells = (occupancy_cell_t *)(map + header->cells_offset);
+        int64_t hour_s = (int64_t)time(NULL) / 3600 * 3600;
+        for (uint32_t b = 0; b < header->bucket_count; b++) {
+            int64_t start_s = hour_s - (int64_t)b * 3600;
+            occupancy_bucket_t *bucket = &table[start_s / 3600 % header->bucket_count];
+            bucket->start_s = start_s;
+            bucket->frames = 56250;
+        }
+        for (size_t i = 0; i < (size_t)header->bucket_count * OCC_BINS; i++) {
+            cells[i].frames = 56250;
+            cells[i].busy = (uint32_t)(i * 7919 % 56250);
+            cells[i].sum_db = -110.0f * 56250;
+            cells[i].max_db = -60.0f;
+        }
+        msync(map, (size_t)st.st_size, MS_SYNC);
+        munmap(map, (size_t)st.st_size);
+        file_mb += st.st_size / 1e6;
+    }
+    if (files) closedir(files);
+
+    // Best of a few: the files are in the page cache, as they would be
+    if (file_mb > 0.0) {
+        float *out = malloc(sizeof(float) * 24 * OCC_COLUMNS);
+        query_ms = 1e9;
+        for (int r = 0; r < 5; r++) {
+            double q = now_ns();
+            occupancy_heatmap(occ, OCC_CENTER_HZ, (uint32_t)SAMPLE_RATE, 0, OCCUPANCY_BUSY, out,
+                              OCC_COLUMNS);
+            q = (now_ns() - q) / 1e6;
+            if (q < query_ms) query_ms = q;
+        }
+        free(out);
+    }
+
+    bench_begin("occupancy");
+    bench_field_int("bins", OCC_BINS);
+    bench_field_int("buckets", OCCUPANCY_DAYS * 24);
+    bench_field_double("ns_per_frame", ns_per_frame);
+    bench_field_double("core_pct", ns_per_frame * OCC_RATE * 1e-7);
+    bench_field_double("file_mb", file_mb);
+    bench_field_double("query_ms", query_ms);
+    bench_end();
+
+    occupancy_free(occ);
+    free(spectrum);
+    files = opendir(dir);
+    while (files && (entry = readdir(files))) {
+        if (entry->d_name[0] == '.') continue;
+        char path[600];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        unlink(path);
+    }
+    if (files) closedir(files);
+    rmdir(dir);
+}
+
+#define ARC_BINS 4096
+#define ARC_RATE (SAMPLE_RATE / ARC_BINS / 3)
+#define ARC_LINES 20000
+#define ARC_SCENE_LINES 256  // Distinct lines, repeated
+#define ARC_SCREEN_LINES 600
+
+static void run_archive(void) {
+    char dir[] = "/tmp/bench-archive-XXXXXX";
+    if (!mkdtemp(dir)) return;
+    spectrum_archive_t *arc = spectrum_archive_new(dir, ARC_BINS, NULL);
+    if (!arc || spectrum_archive_start(arc) != 0) {
+        spectrum_archive_free(arc);
+        rmdir(dir);
+        return;
+    }
+
+    // Noise floor at -120 dB: the mean of 3 exponential powers, in dB
+    float *scene = malloc(sizeof(float) * ARC_BINS * ARC_SCENE_LINES);
+    for (int l = 0; l < ARC_SCENE_LINES; l++) {
+        for (int i = 0; i < ARC_BINS; i++) {
+            double p = 0.0;
+            for (int k = 0; k < 3; k++) p -= log(1.0 - rand() / (RAND_MAX + 1.0));
+            p = p / 3 * 1e-12;
+            if (i % 97 == 0) p += 1e-10 * (1 + 0.3 * sin(l * 0.05 + i));  // Carriers
+            if (i % 331 == 0 && (l / 3) % 2) p += 1e-9;                     // Keyed
+            scene[(size_t)l * ARC_BINS + i] = (float)(10.0 * log10(p));
+        }
+    }
+
+    // Whole path: queue, encode, write (stop waits for the last batch)
+    int64_t t0 = (int64_t)time(NULL) / 3600 * 3600 * 1000000000LL;
+    int64_t line_ns = (int64_t)(1e9 / ARC_RATE);
+    double start = now_ns();
+    for (int l = 0; l < ARC_LINES; l++) {
+        const float *line = scene + (size_t)(l % ARC_SCENE_LINES) * ARC_BINS;
+        while (spectrum_archive_add_line(arc, line, -120.0f, t0 + l * line_ns, OCC_CENTER_HZ,
+                                         (uint32_t)SAMPLE_RATE) != 0) {
+            usleep(100);
+        }
+    }
+    spectrum_archive_stop(arc);
+    double ns_per_line = (now_ns() - start) / ARC_LINES;
+    double bytes_per_line = (double)spectrum_archive_get_bytes(arc) / ARC_LINES;
+    spectrum_archive_free(arc);
+
+    // Best of a few: the chunk is in the page cache
+    double seek_ms = 1e9;
+    spectrum_archive_reader_t *reader = spectrum_archive_reader_open(dir);
+    float *lines = malloc(sizeof(float) * ARC_BINS * ARC_SCREEN_LINES);
+    int read = 0;
+    for (int r = 0; r < 5 && reader; r++) {
+        double q = now_ns();
+        read = spectrum_archive_read(reader, t0 + (ARC_LINES / 2 + r * 97) * line_ns,
+                                     ARC_SCREEN_LINES, lines, ARC_BINS, NULL);
+        q = (now_ns() - q) / 1e6;
+        if (q < seek_ms) seek_ms = q;
+    }
+    spectrum_archive_reader_close(reader);
+
+    bench_begin("archive");
+    bench_field_int("bins", ARC_BINS);
+    bench_field_double("ns_per_line", ns_per_line);
+    bench_field_double("core_pct", ns_per_line * ARC_RATE * 1e-7);
+    bench_field_double("bytes_per_line", bytes_per_line);
+    bench_field_double("mb_per_day", bytes_per_line * ARC_RATE * 86400 / 1e6);
+    bench_field_int("screen_lines", read);
+    bench_field_double("seek_ms", seek_ms);
+    bench_end();
+
+    DIR *d = opendir(dir);
+    struct dirent *entry;
+    while (d && (entry = readdir(d)) != NULL) {
+        char path[600];
+        if (entry->d_name[0] == '.') continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        unlink(path);
+    }
+    if (d) closedir(d);
+    rmdir(dir);
+    free(lines);
+    free(scene);
+}
+
+int main(void) {
+    run_occupancy();
+    run_archive();
+    return 0;
+}
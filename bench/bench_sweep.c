@@ -0,0 +1,142 @@
+#define _DEFAULT_SOURCE
+// Band sweep benchmark: the sweep against a simulated radio
+//
+// Chunks are paced in real time like USB transfers, carrying tones at
+// fixed frequencies as seen through the tuned centre, and a retune takes
+// SWEEP_RETUNE_US (the FPGA and CAT control transfers). The "sweep" result
+// reports the time per step over a full sweep of
+// SWEEP_START_HZ..SWEEP_STOP_HZ, the resulting time for the default
+// 3-30 MHz sweep, the DSP time per step, and how many of the tones show up
+// within a column of where they are.
+//
+// Run with: meson test -C build --benchmark  (or ./build/bench-sweep)
+
+#include "bench_common.h"
+#include "band_sweep.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#define SWEEP_START_HZ 7000000LL
+#define SWEEP_STOP_HZ 8000000LL
+#define SWEEP_RETUNE_US 2000
+#define SWEEP_SAMPLES (USB_BUFFER_SIZE / 8)
+
+static const double sweep_tones_hz[] = { 7003000.0, 7074000.0, 7200000.0, 7475500.0, 7990000.0 };
+
+typedef struct {
+    band_sweep_t *sweep;
+    atomic_long tuned_hz;
+    atomic_int running;
+} sweep_radio_t;
+
+// Source thread of the simulated radio: retunes between event rounds
+static void *sweep_source(void *arg) {
+    sweep_radio_t *radio = (sweep_radio_t *)arg;
+    while (atomic_load(&radio->running)) {
+        long freq;
+        if (band_sweep_get_request(radio->sweep, &freq)) {
+            usleep(SWEEP_RETUNE_US);
+            atomic_store(&radio->tuned_hz, freq);
+            band_sweep_tuned(radio->sweep, true);
+        } else {
+            usleep(500);
+        }
+    }
+    return NULL;
+}
+
+static void run_sweep(void) {
+    band_sweep_config_t config = BAND_SWEEP_CONFIG_DEFAULT;
+    band_sweep_t *hf = band_sweep_new(&config, (int)SAMPLE_RATE);
+    config.start_hz = SWEEP_START_HZ;
+    config.stop_hz = SWEEP_STOP_HZ;
+    sweep_radio_t radio = { .sweep = band_sweep_new(&config, (int)SAMPLE_RATE) };
+    if (!hf || !radio.sweep) {
+        band_sweep_free(hf);
+        band_sweep_free(radio.sweep);
+        return;
+    }
+    band_sweep_stats_t hf_stats;
+    band_sweep_get_stats(hf, &hf_stats);
+    band_sweep_free(hf);
+
+    atomic_init(&radio.tuned_hz, 0);
+    atomic_init(&radio.running, 1);
+    pthread_t source;
+    if (pthread_create(&source, NULL, sweep_source, &radio) != 0) {
+        band_sweep_free(radio.sweep);
+        return;
+    }
+
+    // Deliver chunks in real time until two sweeps are complete (the
+    // second is timed whole)
+    uint8_t *chunk = malloc(USB_BUFFER_SIZE);
+    double chunk_ns = SWEEP_SAMPLES * 1e9 / SAMPLE_RATE;
+    double due = now_ns(), dsp_ns = 0.0;
+    long n = 0, segments = 0;
+    band_sweep_stats_t stats = { 0 };
+    while (stats.sweeps < 2) {
+        long tuned = atomic_load(&radio.tuned_hz);
+        for (int i = 0; i < SWEEP_SAMPLES; i++, n++) {
+            double t = n / SAMPLE_RATE, re = 1e-6 * gaussian(), im = 1e-6 * gaussian();
+            for (int k = 0; k < COUNT(sweep_tones_hz); k++) {
+                double phase = 2.0 * M_PI * (sweep_tones_hz[k] - tuned) * t;
+                re += 1e-3 * cos(phase);
+                im += 1e-3 * sin(phase);
+            }
+            put_sample(chunk + i * 8, re);
+            put_sample(chunk + i * 8 + 4, im);
+        }
+        due += chunk_ns;
+        double wait = due - now_ns();
+        if (wait > 0) usleep((useconds_t)(wait / 1e3));
+
+        double start = now_ns();
+        if (band_sweep_process(radio.sweep, chunk, USB_BUFFER_SIZE, (uint64_t)now_ns())) segments++;
+        dsp_ns += now_ns() - start;
+        band_sweep_get_stats(radio.sweep, &stats);
+    }
+    atomic_store(&radio.running, 0);
+    pthread_join(source, NULL);
+
+    // Each tone should peak in its own column (or the next)
+    float columns[FFT_SIZE];
+    int64_t center_hz;
+    uint32_t span_hz;
+    band_sweep_get_spectrum(radio.sweep, columns);
+    band_sweep_get_span(radio.sweep, &center_hz, &span_hz);
+    double start_hz = center_hz - span_hz / 2.0, column_hz = (double)span_hz / FFT_SIZE;
+    int found = 0;
+    for (int k = 0; k < COUNT(sweep_tones_hz); k++) {
+        int expected = (int)((sweep_tones_hz[k] - start_hz) / column_hz);
+        int peak = expected - 3 < 0 ? 0 : expected - 3;
+        for (int c = peak; c <= expected + 3 && c < FFT_SIZE; c++) {
+            if (columns[c] > columns[peak]) peak = c;
+        }
+        if (abs(peak - expected) <= 1 && columns[peak] > -100.0f) found++;
+    }
+
+    double step_ms = stats.sweep_s * 1e3 / stats.steps;
+    bench_begin("sweep");
+    bench_field_int("steps", stats.steps);
+    bench_field_double("step_ms", step_ms);
+    bench_field_double("retune_ms", stats.retune_ms);
+    bench_field_int("hf_steps", hf_stats.steps);
+    bench_field_double("hf_sweep_s", step_ms * hf_stats.steps / 1e3);
+    bench_field_double("dsp_us_per_step", dsp_ns / 1e3 / segments);
+    bench_field_int("tones_found", found);
+    bench_field_int("tones", COUNT(sweep_tones_hz));
+    bench_end();
+
+    free(chunk);
+    band_sweep_free(radio.sweep);
+}
+
+int main(void) {
+    run_sweep();
+    return 0;
+}
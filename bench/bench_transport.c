@@ -0,0 +1,79 @@
+#define _DEFAULT_SOURCE
+// Network IQ benchmark: the block floating point codec (iq_bfp)
+//
+// The "bfp" results time encode and decode and compare the quantization
+// error with the noise in the signal: noise only ("quiet") and noise under
+// a -12 dBFS carrier ("strong", the worst case, since the carrier sets
+// every block exponent).
+//
+// Run with: meson test -C build --benchmark  (or ./build/bench-transport)
+
+#include "bench_common.h"
+#include "iq_bfp.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+// Signal noise: Gaussian, -80 dBFS per I/Q component (about the level the
+// synthetic source uses for the radio's noise floor)
+#define BFP_NOISE_DBFS -80.0
+#define BFP_TONE_DBFS -12.0
+#define BFP_SAMPLES (IQ_BFP_BLOCK_SAMPLES * 4096)
+
+static void run_bfp(int bits, const char *scene, double tone_dbfs) {
+    int32_t *iq = malloc(sizeof(int32_t) * 2 * BFP_SAMPLES);
+    int32_t *out = malloc(sizeof(int32_t) * 2 * BFP_SAMPLES);
+    uint8_t *enc = malloc((size_t)BFP_SAMPLES * 8);
+    double noise = pow(10.0, BFP_NOISE_DBFS / 20.0);
+    double tone = tone_dbfs > -200.0 ? pow(10.0, tone_dbfs / 20.0) : 0.0;
+    srand(1);
+    for (int i = 0; i < BFP_SAMPLES; i++) {
+        double phase = 2.0 * M_PI * 12345.0 * i / SAMPLE_RATE;
+        iq[2 * i] = (int32_t)lrint((tone * cos(phase) + noise * gaussian()) * 2147483647.0);
+        iq[2 * i + 1] = (int32_t)lrint((tone * sin(phase) + noise * gaussian()) * 2147483647.0);
+    }
+
+    int rounds = 200;
+    int bytes = 0;
+    double start = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        bytes = iq_bfp_encode((const uint8_t *)iq, BFP_SAMPLES, bits, enc);
+    }
+    double encode_ns = (now_ns() - start) / ((double)rounds * BFP_SAMPLES);
+    start = now_ns();
+    for (int r = 0; r < rounds; r++) {
+        iq_bfp_decode_s32(enc, bytes, bits, (uint8_t *)out);
+    }
+    double decode_ns = (now_ns() - start) / ((double)rounds * BFP_SAMPLES);
+
+    // Quantization error power per component, relative to full scale
+    double err = 0.0;
+    for (int i = 0; i < 2 * BFP_SAMPLES; i++) {
+        double e = ((double)out[i] - iq[i]) / 2147483647.0;
+        err += e * e;
+    }
+    double error_dbfs = 10.0 * log10(err / (2.0 * BFP_SAMPLES) + 1e-30);
+
+    bench_begin("bfp");
+    bench_field_int("bits", bits);
+    bench_field_str("signal", scene);
+    bench_field_double("compression", (double)BFP_SAMPLES * 8 / bytes);
+    bench_field_double("encode_ns_per_sample", encode_ns);
+    bench_field_double("decode_ns_per_sample", decode_ns);
+    bench_field_double("error_dbfs", error_dbfs);
+    bench_field_double("noise_dbfs", BFP_NOISE_DBFS);
+    bench_field_double("margin_db", BFP_NOISE_DBFS - error_dbfs);
+    bench_end();
+
+    free(enc);
+    free(out);
+    free(iq);
+}
+
+int main(void) {
+    for (int bits = 8; bits <= 16; bits += 4) {
+        run_bfp(bits, "quiet", -300.0);
+        run_bfp(bits, "strong", BFP_TONE_DBFS);
+    }
+    return 0;
+}
@@ -1,3 +1,4 @@
+#define _GNU_SOURCE  // F_SETPIPE_SZ, vmsplice
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,6 +17,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <stdint.h>
+#include <sys/uio.h>
+#include <sys/time.h>
 
 #define S_RATE 122880000
 #define S_RATE_S1 61440000
@@ -58,14 +62,12 @@ enabled=true\n";
 typedef struct _cbdata_t {
 	int obj;
 	struct libusb_transfer *transfer;
-	float *outbuf;
 	long *freq;
 	int *atten;
 	int *filter;
 	int *sampling;
 	int *bytes_per_sample;
 	int rescale;
-	int fifo;
 } cbdata_t, *cbdata_p;
 
 libusb_device_handle *dev_handle=NULL; 
@@ -75,14 +77,247 @@ static int isS2 = 0;
 static float globalOffset, lpOffset, attOffset;
 static float recalc, rescale;
 
+//--------------------------------------------------------
+// Output to gqrx: cb_in converts each transfer into a buffer taken from
+// the pool and queues it; fifoWriter drains the queue into the FIFO, so
+// a slow reader never delays the USB resubmit. When the pool runs dry
+// the transfer is dropped and counted instead of blocking.
+
+#define POOL_BUFFERS 512
+#define POOL_BUFFER_BYTES (512*24*sizeof(float)/sizeof(short))	// 16-bit samples double in size
+#define PIPE_SIZE (1024*1024)
+
+typedef struct _pool_t {
+	float *buf[POOL_BUFFERS];
+	int len[POOL_BUFFERS];		// bytes to write
+	int freeList[POOL_BUFFERS];
+	int nfree;
+	int ready[POOL_BUFFERS];	// queue of converted buffers
+	int rhead, nready;
+	pthread_mutex_t mut;
+	pthread_cond_t con;
+	int fifo;
+	int pipeSize;
+	long dropped;			// transfers dropped, pool empty
+	long droppedBytes;
+} pool_t;
+
+static pool_t pool;
+
+static int pool_init( int fifo ) {
+	int j;
+	memset( &pool, 0, sizeof( pool ) );
+	pthread_mutex_init( &pool.mut, NULL );
+	pthread_cond_init( &pool.con, NULL );
+	pool.fifo = fifo;
+	pool.pipeSize = 65536;
+#ifdef F_SETPIPE_SZ
+	// a larger FIFO absorbs gqrx scheduling hiccups (capped by
+	// /proc/sys/fs/pipe-max-size for non root users)
+	if( fcntl( fifo, F_SETPIPE_SZ, PIPE_SIZE ) == -1 ) {
+		if( debug ) fprintf( stderr, "F_SETPIPE_SZ failed (%d)\n", errno );
+	}
+	j = fcntl( fifo, F_GETPIPE_SZ );
+	if( j > 0 ) {
+		pool.pipeSize = j;
+	}
+#endif
+	if( debug ) fprintf( stderr, "FIFO size %d bytes\n", pool.pipeSize );
+	// page aligned, so vmsplice can map whole pages into the pipe
+	for( j=0; j<POOL_BUFFERS; j++ ) {
+		if( posix_memalign( (void **)&pool.buf[j], 4096, POOL_BUFFER_BYTES ) ) {
+			return -1;
+		}
+		pool.freeList[pool.nfree++] = j;
+	}
+	return 0;
+}
+
+// Take a free buffer, -1 when none is left
+static int pool_get( void ) {
+	int idx = -1;
+	pthread_mutex_lock( &pool.mut );
+	if( pool.nfree > 0 ) {
+		idx = pool.freeList[--pool.nfree];
+	}
+	pthread_mutex_unlock( &pool.mut );
+	return idx;
+}
+
+static void pool_put( int idx ) {
+	pthread_mutex_lock( &pool.mut );
+	pool.freeList[pool.nfree++] = idx;
+	pthread_mutex_unlock( &pool.mut );
+}
+
+static void pool_queue( int idx, int bytes ) {
+	pool.len[idx] = bytes;
+	pthread_mutex_lock( &pool.mut );
+	pool.ready[(pool.rhead + pool.nready) % POOL_BUFFERS] = idx;
+	pool.nready++;
+	pthread_cond_signal( &pool.con );
+	pthread_mutex_unlock( &pool.mut );
+}
+
+static void pool_drop( int bytes ) {
+	pthread_mutex_lock( &pool.mut );
+	pool.dropped++;
+	pool.droppedBytes += bytes;
+	pthread_mutex_unlock( &pool.mut );
+}
+
+// Write all of a buffer, returns -1 on error
+static int write_all( int fd, const char *p, int n ) {
+	int rc;
+	while( n > 0 ) {
+		rc = write( fd, p, n );
+		if( rc == -1 ) {
+			if( errno == EINTR ) continue;
+			return -1;
+		}
+		p += rc;
+		n -= rc;
+	}
+	return 0;
+}
+
+#ifdef SPLICE_F_GIFT
+// Map a buffer into the pipe without copying, returns bytes spliced
+// (less than n if vmsplice is not supported on this fd)
+static int splice_all( int fd, char *p, int n ) {
+	struct iovec iov;
+	int done = 0;
+	int rc;
+	while( done < n ) {
+		iov.iov_base = p + done;
+		iov.iov_len = n - done;
+		rc = vmsplice( fd, &iov, 1, 0 );
+		if( rc == -1 ) {
+			if( errno == EINTR ) continue;
+			break;
+		}
+		done += rc;
+	}
+	return done;
+}
+#endif
+
+void *fifoWriter( void *a ) {
+	// Spliced buffers stay referenced by the pipe until gqrx reads them:
+	// a buffer is reused only after a full pipe of later data was written
+	int inPipe[POOL_BUFFERS];
+	long inPipeEnd[POOL_BUFFERS];
+	int ih=0, n=0;
+	long total=0;
+	int useSplice=1;
+	long dropped, reported=0;
+	int droppedKB;
+	struct timeval now, last;
+	int idx, bytes, done;
+	(void)a;
+
+	gettimeofday( &last, NULL );
+	for( ;; ) {
+		pthread_mutex_lock( &pool.mut );
+		while( pool.nready == 0 ) {
+			pthread_cond_wait( &pool.con, &pool.mut );
+		}
+		idx = pool.ready[pool.rhead];
+		pool.rhead = (pool.rhead + 1) % POOL_BUFFERS;
+		pool.nready--;
+		dropped = pool.dropped;
+		droppedKB = (int)(pool.droppedBytes / 1024);
+		pthread_mutex_unlock( &pool.mut );
+
+		bytes = pool.len[idx];
+		done = 0;
+#ifdef SPLICE_F_GIFT
+		if( useSplice ) {
+			done = splice_all( pool.fifo, (char *)pool.buf[idx], bytes );
+			if( done < bytes ) {
+				if( debug ) fprintf( stderr, "vmsplice failed (%d), using write\n", errno );
+				useSplice = 0;
+			}
+		}
+#endif
+		if( done < bytes && write_all( pool.fifo, (char *)pool.buf[idx] + done, bytes - done ) == -1 ) {
+			if( debug ) fprintf( stderr, "FIFO write failed (%d)\n", errno );
+			exit( 0 );
+		}
+		total += bytes;
+
+		if( done > 0 ) {
+			inPipe[(ih + n) % POOL_BUFFERS] = idx;
+			inPipeEnd[(ih + n) % POOL_BUFFERS] = total;
+			n++;
+		} else {
+			pool_put( idx );
+		}
+		while( n > 0 && total - inPipeEnd[ih] >= pool.pipeSize ) {
+			pool_put( inPipe[ih] );
+			ih = (ih + 1) % POOL_BUFFERS;
+			n--;
+		}
+
+		// Drop report, always shown, at most once per second
+		if( dropped != reported ) {
+			gettimeofday( &now, NULL );
+			if( (now.tv_sec - last.tv_sec) * 1000000L + (now.tv_usec - last.tv_usec) >= 1000000L ) {
+				fprintf( stderr, "FIFO overrun: %ld transfers (%d kB) dropped\n", dropped, droppedKB );
+				reported = dropped;
+				last = now;
+			}
+		}
+	}
+	return NULL;
+}
+
+//--------------------------------------------------------
+// Sample conversion, 8 samples per step with GCC/clang vector extensions
+// (one SIMD register with AVX, two with SSE2/NEON); the tail is scalar
+
+typedef int32_t v8si __attribute__(( vector_size( 32 ) ));
+typedef int16_t v8hi __attribute__(( vector_size( 16 ) ));
+typedef float v8sf __attribute__(( vector_size( 32 ) ));
+
+static int convert16( const uint8_t *in, int bytes, float *out, float c ) {
+	int n = bytes / sizeof( short );
+	int j;
+	v8hi v;
+	v8sf f;
+	for( j=0; j+8<=n; j+=8 ) {
+		memcpy( &v, in + j*sizeof( short ), sizeof( v ) );
+		f = __builtin_convertvector( v, v8sf ) * c;
+		memcpy( out + j, &f, sizeof( f ) );
+	}
+	for( ; j<n; j++ ) {
+		out[j] = ((const int16_t *)in)[j] * c;
+	}
+	return n;
+}
+
+static int convert32( const uint8_t *in, int bytes, float *out, float c ) {
+	int n = bytes / sizeof( int );
+	int j;
+	v8si v;
+	v8sf f;
+	for( j=0; j+8<=n; j+=8 ) {
+		memcpy( &v, in + j*sizeof( int ), sizeof( v ) );
+		f = __builtin_convertvector( v, v8sf ) * c;
+		memcpy( out + j, &f, sizeof( f ) );
+	}
+	for( ; j<n; j++ ) {
+		out[j] = ((const int32_t *)in)[j] * c;
+	}
+	return n;
+}
+
 void cb_in( struct libusb_transfer * transfer ) {
 	static int isFirst=1;
 	cbdata_p cbd;
 	int res;
 	int j;
-	float c;
-	short rs;
-	int ri;
+	int idx;
 	static struct timeval start;
 	static struct timeval stop;
 	struct libusb_transfer * transfer_in;
@@ -97,21 +332,18 @@ void cb_in( struct libusb_transfer * transfer ) {
 	}
 	switch(transfer->status) {
 		case LIBUSB_TRANSFER_COMPLETED:
-                        if(*(cbd->bytes_per_sample)==2) {
-                                c=recalc/32.0/1024.0;
-                                for( j=0; j<transfer->actual_length/sizeof(short); j++ ) {
-                                      rs=(short)((uint16_t *)(transfer->buffer))[j];
-                                        cbd->outbuf[j]=rs*c;
-                                }
-                        } else {
-                                c=recalc/2.0/1024.0/1024.0/1024.0;
-                                for( j=0; j<transfer->actual_length/sizeof(int); j++ ) {
-                                        ri=(int)((uint32_t *)(transfer->buffer))[j];
-                                        cbd->outbuf[j]=ri*c;
-                                }
-                        }
-			//write to fifo
-			write( cbd->fifo, cbd->outbuf, j*sizeof(float) );
+			idx = pool_get();
+			if( idx < 0 ) {
+				pool_drop( transfer->actual_length );
+				break;
+			}
+			if(*(cbd->bytes_per_sample)==2) {
+				j=convert16( transfer->buffer, transfer->actual_length, pool.buf[idx], recalc/32.0/1024.0 );
+			} else {
+				j=convert32( transfer->buffer, transfer->actual_length, pool.buf[idx], recalc/2.0/1024.0/1024.0/1024.0 );
+			}
+			//queue for the fifo writer
+			pool_queue( idx, j*sizeof(float) );
 			break;
 		case LIBUSB_TRANSFER_CANCELLED:
 			if( debug ) fprintf( stderr, "CB result: Cancelled %d\n", cbd->obj );
@@ -407,10 +639,6 @@ int main( int ac, char *av[], char **ev ) {
 	struct libusb_transfer *transfer_in2;
 	struct libusb_transfer *transfer_in3;
 	struct libusb_transfer *transfer_in4;
-	float pBuffer1a[512*12];
-	float pBuffer2a[512*12];
-	float pBuffer3a[512*12];
-	float pBuffer4a[512*12];
 
 	cbdata_t cbdata1;
 	cbdata_t cbdata2;
@@ -428,6 +656,7 @@ int main( int ac, char *av[], char **ev ) {
 	static char file[200];
 	static int fifo;
         pthread_t pthread;
+        pthread_t writer;
         pthread_attr_t attr;
 	static int conf;
 	static struct stat statbuf;	
@@ -600,6 +829,11 @@ int main( int ac, char *av[], char **ev ) {
 	if( debug ) fprintf( stderr, "%s has returned %d\n", cmd, res );
 	fifo=open( "/tmp/elad", O_WRONLY );
 	if( debug ) fprintf( stderr, "open fifo returned %d\n", fifo );
+	if( pool_init( fifo ) ) {
+		if( debug ) fprintf( stderr, "buffer pool allocation failed\n" );
+		return 2;
+	}
+	(void)pthread_create( &writer, NULL, fifoWriter, NULL );
 	// Initialize libusb-1.0
 	res = libusb_init(&ctx);
 	if( res < 0 ){
@@ -805,44 +1039,36 @@ int main( int ac, char *av[], char **ev ) {
 
 	cbdata1.obj=0;
 	cbdata1.transfer=transfer_in1;
-	cbdata1.outbuf=pBuffer1a;
 	cbdata1.freq = &LOfreq;
 	cbdata1.sampling = &sampling;
 	cbdata1.atten = &atten;
 	cbdata1.filter = &filter;
 	cbdata1.bytes_per_sample = &bytes_per_sample;
 	cbdata1.rescale = rescale;
-	cbdata1.fifo = fifo;
 	cbdata2.obj=1;
 	cbdata2.transfer=transfer_in2;
-	cbdata2.outbuf=pBuffer2a;
 	cbdata2.freq = &LOfreq;
 	cbdata2.sampling = &sampling;
 	cbdata2.atten = &atten;
 	cbdata2.filter = &filter;
 	cbdata2.bytes_per_sample = &bytes_per_sample;
 	cbdata2.rescale = rescale;
-	cbdata2.fifo = fifo;
 	cbdata3.obj=2;
 	cbdata3.transfer=transfer_in3;
-	cbdata3.outbuf=pBuffer3a;
 	cbdata3.freq = &LOfreq;
 	cbdata3.sampling = &sampling;
 	cbdata3.atten = &atten;
 	cbdata3.filter = &filter;
 	cbdata3.bytes_per_sample = &bytes_per_sample;
 	cbdata3.rescale = rescale;
-	cbdata3.fifo = fifo;
 	cbdata4.obj=3;
 	cbdata4.transfer=transfer_in4;
-	cbdata4.outbuf=pBuffer4a;
 	cbdata4.freq = &LOfreq;
 	cbdata4.sampling = &sampling;
 	cbdata4.atten = &atten;
 	cbdata4.filter = &filter;
 	cbdata4.bytes_per_sample = &bytes_per_sample;
 	cbdata4.rescale = rescale;
-	cbdata4.fifo = fifo;
 
 	libusb_fill_bulk_transfer( transfer_in1, dev_handle, 0x86, pBuffer1, 512*24, cb_in, &cbdata1, 2000);
 	libusb_fill_bulk_transfer( transfer_in2, dev_handle, 0x86, pBuffer2, 512*24, cb_in, &cbdata2, 2000);
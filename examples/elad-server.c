@@ -1,4 +1,4 @@
-#define _GNU_SOURCE
+#define _DEFAULT_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +20,9 @@
 #include <sys/shm.h>
 #include <math.h>
 
+#include "fft_processor.h"
+#include "udp_iq.h"
+
 typedef struct _payload {
 	int fifor;
 	int fifow;
@@ -40,9 +43,12 @@ typedef struct _payload {
 	int *fwd;
 } payload, *payloadp;
 
-static int sockfd;
-static socklen_t salen;
-static struct sockaddr *sa;
+// UDP out (udpSend): destination port (0 = the receive port on host),
+// the sample rate announced in the stream header and the block floating
+// point mantissa bits (0 = uncompressed)
+static int sendPort = 0;
+static int sendRate = 192000;
+static int sendBfp = 0;
 
 void *tcpManage( void *pay ) {
 	int sfd;
@@ -168,108 +174,64 @@ void *tcpManage( void *pay ) {
 			}
 		}
 	}
-	close( sockfd );
+	close( sfd );
 
 	return NULL;
 }
 
+// Called by the UDP IQ receiver thread with each full buffer: fills the
+// a/b buffers alternately and wakes the matching consumer
+static void udpBlock( const uint8_t *data, int length, uint64_t timestamp_ns, void *pay ) {
+	static int a = 0;
+	payloadp payl=(payloadp)pay;
+	(void)timestamp_ns;
+
+	a=1-a;
+	if( a==1 ) {
+		memcpy( payl->buf_a, data, length );
+		*(payl->lung_a)=length;
+		pthread_cond_signal( payl->con_a );
+	} else {
+		memcpy( payl->buf_b, data, length );
+		*(payl->lung_b)=length;
+		pthread_cond_signal( payl->con_b );
+	}
+}
+
 void *udpReceive( void *pay ) {
 
-	int sfd; 
-	int res;
-	int isFirst;
 	int fw;
-	unsigned int clilen;
-	struct sockaddr_in saddr;
-	struct sockaddr_in cliaddr;
 	char buf[2048];
-	int a = 0;
-	int j;
-	pthread_cond_t *con;
-	char *buff;
-	int *lung;
-	int bufflen;
-	static char recvBuffer[1024+32];
-	static long counter=0;
-	static long tempCounter=0;
-	static long oldTempCounter=0;
-	struct timeval start, stop;
+	udp_iq_receiver_t *rx;
 	payloadp payl=(payloadp)pay;
 	int port = payl->port;
 	fprintf( stderr, "Parameters for UDP received\n" );
 
-	// socket: create the socket
-	sfd = socket( AF_INET, SOCK_DGRAM, 0 );
-	if( sfd == -1 ) {
-		fprintf( stderr, "socket error\n" );
-		exit( 10 );
-	}
-	fprintf( stderr, "Socket for udp created\n" );
-
-	// reuse socket
-	int opt = 1;
-	setsockopt( sfd, SOL_SOCKET, SO_REUSEADDR, (const void *)&opt, sizeof( int ) );
-
-	// set server address
-	memset( (char *)&saddr, 0, sizeof( saddr ) );
-	saddr.sin_family = AF_INET;
-	saddr.sin_addr.s_addr = htonl(INADDR_ANY);
-	saddr.sin_port = htons( (unsigned short)port );
-
-	// associate socket to a port
-	if( bind( sfd, (struct sockaddr *)&saddr, sizeof( saddr ) ) == -1 ) {
+	// Batched receive (recvmmsg); accepts both the old 1028-byte datagrams
+	// and the 64-bit sequenced stream, zero-filling lost datagrams
+	rx = udp_iq_receiver_new( port, UDP_IQ_FORMAT_F32, payl->buflen );
+	if( rx == NULL ) {
 		fprintf( stderr, "binding Error\n" );
 		exit( 11 );
 	}
 	fprintf( stderr, "Socket for udp binded\n" );
 
-	gettimeofday( &start, NULL );
-	for( isFirst=0;; ) {
-		if( isFirst==0 ) {
-			sprintf( buf, "/tmp/fifo%d", payl->fifow );
-			fprintf( stderr, "Opening FIFO %s\n", buf );
-			fw = open( buf, O_WRONLY );
-			if( fw == -1 ) {
-				fprintf( stderr, "Error opening %s\n", buf );
-				exit( 4 );
-			}
-			*(payl->fwd)=fw;
-			fprintf( stderr, "FIFO %s opened\n", buf );
-			isFirst++;
-		}
-		// receive UDP datagrams
-		a=1-a;
-		if( a==1 ) {
-			con=payl->con_a;
-			buff=payl->buf_a;
-			lung=payl->lung_a;
-			bufflen=payl->buflen;
-		} else {
-			con=payl->con_b;
-			buff=payl->buf_b;
-			lung=payl->lung_b;
-			bufflen=payl->buflen;
-		}
-		memset( buff, 0, bufflen );
-		for( j=0, *lung=0; j<bufflen; j+=res-4 ) {
-			res = recvfrom( sfd, recvBuffer, 1028, 0, (struct sockaddr *) &cliaddr, &clilen);
-			memcpy( buff+j, recvBuffer+4, res-4 );
-			tempCounter = ntohl ( *(long *)recvBuffer );
-			counter++;
-			if( counter!=tempCounter ) {
-				gettimeofday( &stop, NULL );
-				fprintf( stderr, "Counter (%ld) differs from received counter (%ld) diff %ld %%=%f time=%f\n", counter, tempCounter, tempCounter-counter, (tempCounter-counter)*100.0/(tempCounter-oldTempCounter), (stop.tv_sec-start.tv_sec)+0.000001*(stop.tv_usec-start.tv_usec) );
-				counter=tempCounter;
-				oldTempCounter=tempCounter;
-				gettimeofday( &start, NULL );
-			}
-			*lung += res-4;
-			if ( res == -1 ) {
-				fprintf( stderr,"Recvfrom Error\n" );
-				exit( 12 );
-			}
-		}
-		pthread_cond_signal( con );
+	sprintf( buf, "/tmp/fifo%d", payl->fifow );
+	fprintf( stderr, "Opening FIFO %s\n", buf );
+	fw = open( buf, O_WRONLY );
+	if( fw == -1 ) {
+		fprintf( stderr, "Error opening %s\n", buf );
+		exit( 4 );
+	}
+	*(payl->fwd)=fw;
+	fprintf( stderr, "FIFO %s opened\n", buf );
+
+	if( udp_iq_receiver_start( rx, udpBlock, payl ) != 0 ) {
+		fprintf( stderr, "Recvfrom Error\n" );
+		exit( 12 );
+	}
+	for( ;; ) {
+		sleep( 1 );
 	}
 	return NULL;
 }
@@ -296,155 +258,84 @@ void *fifoSend( void *pay ) {
 	return NULL;
 }
 
+// FFT size and averaging for FFTSend (arguments 4 and 5)
+static int fftSize = 1024;
+static int fftAveraging = 1;
+#define FFT_SIZE_MIN 64
+#define FFT_SIZE_MAX 65536
+
+// Shared memory for FFTSend: a 4-byte ready flag then N bytes. Readers
+// of the original 1024-point layout attach 1028 bytes at FFT_SHM_KEY;
+// other sizes get their own key so they never meet a segment of the
+// wrong size
+#define FFT_SHM_KEY 6166529
+#define FFT_SHM_LEGACY_SIZE 1024
+
+// fft_processor dB is relative to a full-scale tone seen through the window
+// gain over N; the old loop divided by N/2, i.e. 6.02 dB higher
+#define FFT_OUT_OFFSET_DB (150.0f + 6.02f)
+
 void *FFTSend( void *pay ) {
 
-	double *co = NULL;
-	double *si = NULL;
-	double *fftr = NULL;
-	double *ffti = NULL;
-	double *coeff = NULL;
+	fft_processor_t *fft;
+	float *spectrum = NULL;
 	unsigned char *fftout = NULL;
-	int N;
-	double co1, si1;
-	double pi=3.141592653589793238462643383279502884197169399375105820974944592;
-	double fftdr, fftdi;
-	int j, k; 
-	int m, p, md, ng, ig, i, ind, i1, i2, jd, kp;
-
-	struct timeval start, stop;
+	int N = fftSize;
+	int samples;
+	int j;
 	payloadp payl=(payloadp)pay;
-	
-	key_t shm_key = 6166529;
-	const int shm_size = 1028;
+
+	key_t shm_key = N == FFT_SHM_LEGACY_SIZE ? FFT_SHM_KEY : FFT_SHM_KEY + N;
+	const int shm_size = N + 4;
 	int shm_id;
 	char* shmaddr;
 
 	// Allocate and attach a shared memory segment
 	shm_id = shmget (shm_key, shm_size, IPC_CREAT | S_IRUSR | S_IWUSR | 0666 );
+	if( shm_id == -1 ) {
+		fprintf( stderr, "shmget key %d, %d bytes failed: %s\n", (int)shm_key, shm_size, strerror( errno ) );
+		exit( 6 );
+	}
 	shmaddr = (char*) shmat (shm_id, 0, 0);
-	fprintf( stderr, "Shared memory attached at address %p\n", shmaddr);
-
-	p=10;
-	N=1<<p;
+	if( shmaddr == (char *)-1 ) {
+		fprintf( stderr, "shmat key %d failed: %s\n", (int)shm_key, strerror( errno ) );
+		exit( 6 );
+	}
+	fprintf( stderr, "Shared memory key %d (%d bytes) attached at address %p\n", (int)shm_key, shm_size, shmaddr);
 
-	fftr = calloc( N, sizeof( double ) );
-	if( fftr == NULL ) {
-		fprintf( stderr, "error allocating fftr buffer" );
+	// Same FFT engine as elad-spectrum: FFTW plan, Blackman-Harris window,
+	// FFT shift and dB averaging
+	fft = fft_processor_new( N );
+	if( fft == NULL || fft_processor_set_averaging( fft, fftAveraging ) != 0 ) {
+		fprintf( stderr, "error creating %d-point FFT with averaging %d\n", N, fftAveraging );
 		exit( 5 );
 	}
-	ffti = calloc( N, sizeof( double ) );
-	if( ffti == NULL ) {
-		fprintf( stderr, "error allocating ffti buffer" );
-		exit( 6 );
-	}
+	spectrum = calloc( N, sizeof( float ) );
 	fftout = calloc( N, sizeof( char ) );
-	if( fftout == NULL ) {
+	if( spectrum == NULL || fftout == NULL ) {
 		fprintf( stderr, "error allocating fftout buffer" );
 		exit( 7 );
 	}
-	co = calloc( N/2, sizeof( double ) );
-	if( co == NULL ) {
-		fprintf( stderr, "error allocating co buffer" );
-		exit( 8 );
-	}
-	si = calloc( N/2, sizeof( double ) );
-	if( si == NULL ) {
-		fprintf( stderr, "error allocating si buffer" );
-		exit( 9 );
-	}
-	coeff = calloc( N, sizeof( double ) );
-	if( coeff == NULL ) {
-		fprintf( stderr, "error allocating coeff buffer" );
-		exit( 9 );
-	}
-
-	// coeff table initialization
-	for( j=1; j<N; j++ ) {
-		coeff[j]=0.35875-0.48829*cos(2*pi*j/(N-1))+0.14128*cos(4*pi*j/(N-1))-0.01168*cos(6*pi*j/(N-1));
-	}
-
-	// sin table initialization
-	m = N/2;
-	p = 10;
-	co1 = cos( pi/m );
-	si1 = -sin( pi/m );
-	co[0] = 1;
-	si[0] = 0;
-	for( j=1; j<m; j++ ) {
-		co[j] = co1 * co[j-1] - si1 * si[j-1];
-		si[j] = si1 * co[j-1] + co1 * si[j-1];
-	}
+	fprintf( stderr, "FFT size %d, averaging %d\n", N, fftAveraging );
 
 	for( ;; ) {
 		pthread_cond_wait(payl->con, payl->mut);
 
-		// Time measurement
-		gettimeofday( &start, NULL );
-		
-		// Read input data 
-		for( j=0; j<N; j++ ) {
-			fftr[j]=((float *)payl->buf)[2*j]*coeff[j];
-			ffti[j]=((float *)payl->buf)[2*j+1]*coeff[j];
-		}
-
-		m = N/2;
-		p = 10;
-			
-		// FFT Compute
-		for( j=0,ng=1,md=m; j<p; j++ ) {
-			for( ind=0, ig=0; ig<ng; ig++ ) {
-				for( i=0, k=0; i<md; i++ ) {
-					i1=ind+i;
-					i2=i1+md;
-					fftdr = fftr[i1] - fftr[i2];
-					fftdi = ffti[i1] - ffti[i2];
-					fftr[i1] = fftr[i1] + fftr[i2];
-					ffti[i1] = ffti[i1] + ffti[i2];
-					fftr[i2] = fftdr * co[k] - fftdi * si[k];
-					ffti[i2] = fftdr * si[k] + fftdi * co[k];
-					k += ng;
-				}
-				ind += md*2;
-			}
-			md >>= 1;
-			ng <<= 1;
-		}
-
-		// Coefficients reordering
-		for( j=0; j<N; j++ ) {
-			jd=j;
-			k=0;
-			kp=m;
-			for( i=1; i<=p; i++ ) {
-				k = k + (jd-(jd/2)*2)*kp;
-				jd >>= 1;
-				kp >>= 1;
-			}
-			if( k>j ) {
-				fftdr = fftr[j];
-				fftdi = ffti[j];
-				fftr[j] = fftr[k];
-				ffti[j] = ffti[k];
-				fftr[k] = fftdr;
-				ffti[k] = fftdi;
-			}
+		// Input is interleaved float I/Q
+		samples = *(payl->lung) / (2 * sizeof( float ));
+		if( !fft_processor_process_float( fft, (const float *)payl->buf, samples ) ) {
+			continue;
 		}
+		fft_processor_get_spectrum_db( fft, spectrum );
 
-		// Absolute value
+		// Same byte scale as before: 150 + dB, already centred on DC
 		for( j=0; j<N; j++ ) {
-			fftr[j] = fftr[j]/m;
-			ffti[j] = ffti[j]/m;
-			fftr[j] = sqrt( fftr[j] * fftr[j] + ffti[j] * ffti[j] );
-			fftout[j]=150+(char)( 20*log10(fftr[j]) );
+			float v = spectrum[j] + FFT_OUT_OFFSET_DB;
+			fftout[j] = v <= 0.0f ? 0 : v >= 255.0f ? 255 : (unsigned char)v;
 		}
 
-		// time measurement
-		gettimeofday( &stop, NULL );
-		// fprintf( stderr, "FFT time= %f mSec\n", (stop.tv_sec-start.tv_sec)*1000+0.001*(stop.tv_usec-start.tv_usec) );
-
 		// FFT write out
-		memcpy( shmaddr+4, fftout+512, 512 );
-		memcpy( shmaddr+516, fftout, 512 );
+		memcpy( shmaddr+4, fftout, N );
 		memset( shmaddr, 0x0001, 4 );
 		usleep( 5000 );
 		memset( shmaddr, 0, 4 );
@@ -453,49 +344,81 @@ void *FFTSend( void *pay ) {
 	return NULL;
 }
 
+// Reads FDM-DUO 32-bit I/Q from its FIFO and streams it to host with the
+// same UDP transport udpReceive takes in (sequenced datagrams sized from
+// the path MTU), so two elad-servers can feed each other
 void *udpSend( void *pay ) {
 
-	struct addrinfo hints, *rlist, *rlistsave;
+	static uint8_t data[512*24];
+	char buf[100];
+	udp_iq_sender_t *tx;
 	payloadp payl=(payloadp)pay;
-	char *host = payl->hostname;
-	int res;
-
-	// initialize addrinfo structure
-	memset( &hints, 0, sizeof(struct addrinfo) );
-	hints.ai_family=AF_UNSPEC;
-	hints.ai_socktype=SOCK_DGRAM;
-	hints.ai_protocol=IPPROTO_UDP;
+	int fr, n, len;
 
-	res = getaddrinfo( host, payl->portc, &hints, &rlist );
-	if( res == -1 ){
-		fprintf( stderr, "udp error for %s, %s: %s", host, payl->portc, gai_strerror( res ) );
+	tx = udp_iq_sender_new( payl->hostname, payl->port, UDP_IQ_FORMAT_S32, sendRate );
+	if( tx == NULL ) {
+		fprintf( stderr, "udp error for %s, %d\n", payl->hostname, payl->port );
 		exit( 1 );
 	}
-	rlistsave = rlist;
-	for( ;; rlist=rlist->ai_next ) {
-		sockfd=socket( rlist->ai_family, rlist->ai_socktype, rlist->ai_protocol );
-		if( sockfd>= 0 ){
-			break; 
-		}
+	if( udp_iq_sender_set_compression( tx, sendBfp ) != 0 ) {
+		fprintf( stderr, "udp error: %d-bit BFP not supported\n", sendBfp );
+		exit( 1 );
 	}
+	fprintf( stderr, "UDP out prepared: %s port %d, %d-byte datagrams, BFP %d bits\n", payl->hostname, payl->port, udp_iq_sender_get_payload_bytes( tx ), sendBfp );
+
+	sprintf( buf, "/tmp/fifo%d", payl->fifor );
+	for( ;; ) {
+		fr = open( buf, O_RDONLY );
+		if( fr == -1 ) {
+			fprintf( stderr, "Error opening %s\n", buf );
+			exit( 4 );
+		}
+		fprintf( stderr, "FIFO %s opened for UDP out\n", buf );
 
-	sa=malloc( rlist->ai_addrlen );
-	memcpy(sa, rlist->ai_addr, rlist->ai_addrlen );
-	salen=rlist->ai_addrlen;
-	freeaddrinfo( rlistsave );
-	fprintf( stderr, "UDP out prepared\n" );
-/*
-	for( k=0; k<y; k+=1472 ) {
-		res = sendto( sockfd, ((char *)(cbd->outbuf))+k, y-k<1472?y-k:1472, 0, sa, salen );
-		if( res < 0 ) {
-			fprintf( stderr, "CB UDP error (%d)\n", res  );
+		// Whole USB transfers (1536 samples); at EOF send what is left
+		// in whole 32-sample blocks and wait for the next writer
+		for( len=0;; ) {
+			n = read( fr, data+len, sizeof( data )-len );
+			if( n == -1 && errno == EINTR ) {
+				continue;
+			}
+			if( n > 0 ) {
+				len += n;
+			}
+			if( len == sizeof( data ) || ( n <= 0 && len >= 256 ) ) {
+				if( udp_iq_sender_send( tx, data, len - len % 256 ) != 0 ) {
+					fprintf( stderr, "UDP send Error\n" );
+				}
+				len = 0;
+			}
+			if( n <= 0 ) {
+				break;
+			}
 		}
+		close( fr );
 	}
-*/
 	return NULL;
 }
 
-int main( int ac, char *av[], char **ev ) {
+// Whole-string decimal argument; returns 0 if it is one, -1 otherwise
+static int parseInt( const char *arg, int *value ) {
+	char *end;
+	long v;
+
+	errno = 0;
+	v = strtol( arg, &end, 10 );
+	if( end == arg || *end != '\0' || errno != 0 || v < -2147483647L || v > 2147483647L ) {
+		return -1;
+	}
+	*value = (int)v;
+	return 0;
+}
+
+static void usage( void ) {
+	fprintf( stderr, "usage: elad-server [--send-port PORT] [--rate HZ] [--bfp 8|12|16] [host [port [fifo [fftSize [averaging]]]]]\n" );
+}
+
+int main( int ac, char *av[] ) {
 
         int j;
 	int res;
@@ -542,6 +465,36 @@ int main( int ac, char *av[], char **ev ) {
 
         fprintf( stderr, "Operations init elad-server version 1.0\n" );
 
+	// Options come before the positional arguments
+	while( ac>1 && strncmp( av[1], "--", 2 )==0 ) {
+		if( ac<3 ) {
+			usage();
+			return 1;
+		}
+		if( strcmp( av[1], "--send-port" )==0 ) {
+			if( parseInt( av[2], &sendPort ) != 0 || sendPort < 1 || sendPort > 65535 ) {
+				fprintf( stderr, "Invalid --send-port '%s'\n", av[2] );
+				return 1;
+			}
+		} else if( strcmp( av[1], "--rate" )==0 ) {
+			if( parseInt( av[2], &sendRate ) != 0 || sendRate < 1 ) {
+				fprintf( stderr, "Invalid --rate '%s'\n", av[2] );
+				return 1;
+			}
+		} else if( strcmp( av[1], "--bfp" )==0 ) {
+			if( parseInt( av[2], &sendBfp ) != 0 || ( sendBfp != 8 && sendBfp != 12 && sendBfp != 16 ) ) {
+				fprintf( stderr, "Invalid --bfp '%s' (8, 12 or 16)\n", av[2] );
+				return 1;
+			}
+		} else {
+			usage();
+			return 1;
+		}
+		av[2] = av[0];
+		av += 2;
+		ac -= 2;
+	}
+
 	// Read host from Argument, if not localhost
 	if( ac<2 ) {
 		host = "localhost";
@@ -568,6 +521,21 @@ int main( int ac, char *av[], char **ev ) {
 	portn=atoi( port );
 	fprintf( stderr, " fifo base number: %d\n", fifo );
 
+	// Read FFT size and averaging from Arguments, if not 1024 and 1
+	if( ac>=5 ) {
+		if( parseInt( av[4], &fftSize ) != 0 || fftSize < FFT_SIZE_MIN || fftSize > FFT_SIZE_MAX ||
+		    ( fftSize & ( fftSize-1 ) ) != 0 ) {
+			fprintf( stderr, "Invalid FFT size '%s' (power of two, %d-%d)\n", av[4], FFT_SIZE_MIN, FFT_SIZE_MAX );
+			return 1;
+		}
+	}
+	if( ac>=6 ) {
+		if( parseInt( av[5], &fftAveraging ) != 0 || fftAveraging < 1 || fftAveraging > FFT_MAX_AVERAGING ) {
+			fprintf( stderr, "Invalid FFT averaging '%s' (1-%d)\n", av[5], FFT_MAX_AVERAGING );
+			return 1;
+		}
+	}
+
 	// open fifo to send/receive commands from radio and for receive/send udp data from radio
 	for( j=0; j<4; j++ ) {
 		sprintf( fifoname, "/tmp/fifo%d", fifo+j );
@@ -630,7 +598,7 @@ int main( int ac, char *av[], char **ev ) {
 	memset( &payl2, 0, sizeof( payl2 ) );
 	payl2.fifow=fifo+3;
 	payl2.fifor=fifo+3;
-	payl2.port=portn;
+	payl2.port=sendPort ? sendPort : portn;
 	payl2.portc=port;
 	payl2.hostname=host;
 	res=pthread_attr_init( &attr2 );
@@ -0,0 +1,336 @@
+#define _DEFAULT_SOURCE
+#include "audio_output.h"
+#include "app_state.h"
+#include "iq_ring.h"
+#include "rt_sched.h"
+#include "perf_trace.h"
+#include "mono_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#ifdef HAVE_PULSE
+#include <pulse/simple.h>
+#include <pulse/error.h>
+#endif
+
+// Chunks buffered ahead of the demodulator (~250 ms at 192 kS/s)
+#define AUDIO_RING_SLOTS 32
+
+// How long the audio thread waits for data before re-checking for shutdown
+#define AUDIO_WAIT_MS 100
+
+// PulseAudio target latency
+#define PULSE_LATENCY_MS 100
+
+#define WAV_HEADER_SIZE 44
+
+typedef enum {
+    SINK_WAV,
+    SINK_STDOUT,
+    SINK_PULSE,
+} sink_type_t;
+
+struct audio_output {
+    int input_rate;
+    demodulator_t *demod;  // Audio thread only (after start)
+    iq_ring_t *ring;
+
+    // Sink
+    sink_type_t type;
+    FILE *file;            // WAV file or stdout
+    uint32_t data_bytes;   // WAV payload written
+    bool failed;           // Write error, output muted
+#ifdef HAVE_PULSE
+    pa_simple *pulse;
+#endif
+
+    // Mode request, applied on the audio thread
+    atomic_int mode_request;
+    atomic_int bandwidth_request;
+    atomic_int offset_request;
+    atomic_int mode_generation;
+    int applied_generation;
+
+    // Audio thread buffers
+    float *audio;
+    int16_t *pcm;
+    int audio_size;
+
+    // Counters
+    atomic_llong cpu_ns;
+    atomic_llong audio_samples;
+
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+};
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+// 16-bit mono PCM WAV header for data_bytes of samples
+static void wav_header(uint8_t *h, uint32_t data_bytes) {
+    memcpy(h, "RIFF", 4);
+    put_le32(h + 4, 36 + data_bytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put_le32(h + 16, 16);
+    put_le16(h + 20, 1);  // PCM
+    put_le16(h + 22, 1);  // Mono
+    put_le32(h + 24, DEMOD_AUDIO_RATE);
+    put_le32(h + 28, DEMOD_AUDIO_RATE * 2);
+    put_le16(h + 32, 2);
+    put_le16(h + 34, 16);
+    memcpy(h + 36, "data", 4);
+    put_le32(h + 40, data_bytes);
+}
+
+static int open_sink(audio_output_t *out, const char *sink) {
+    if (strcmp(sink, "-") == 0) {
+        // A closed pipe must fail the write, not kill the application
+        signal(SIGPIPE, SIG_IGN);
+        out->type = SINK_STDOUT;
+        out->file = stdout;
+        return 0;
+    }
+
+    if (strcmp(sink, "pulse") == 0) {
+#ifdef HAVE_PULSE
+        pa_sample_spec spec = { .format = PA_SAMPLE_S16LE, .rate = DEMOD_AUDIO_RATE, .channels = 1 };
+        pa_buffer_attr attr = {
+            .maxlength = (uint32_t)-1,
+            .tlength = DEMOD_AUDIO_RATE * 2 * PULSE_LATENCY_MS / 1000,
+            .prebuf = (uint32_t)-1,
+            .minreq = (uint32_t)-1,
+            .fragsize = (uint32_t)-1,
+        };
+        int err = 0;
+        out->pulse = pa_simple_new(NULL, "elad-spectrum", PA_STREAM_PLAYBACK, NULL, "Demodulator",
+                                   &spec, NULL, &attr, &err);
+        if (!out->pulse) {
+            fprintf(stderr, "Audio: Cannot connect to PulseAudio: %s\n", pa_strerror(err));
+            return -1;
+        }
+        out->type = SINK_PULSE;
+        return 0;
+#else
+        fprintf(stderr, "Audio: Built without PulseAudio (libpulse-simple), use a .wav file or -\n");
+        return -1;
+#endif
+    }
+
+    out->file = fopen(sink, "wb");
+    if (!out->file) {
+        fprintf(stderr, "Audio: Cannot create %s: %s\n", sink, strerror(errno));
+        return -1;
+    }
+    uint8_t header[WAV_HEADER_SIZE];
+    wav_header(header, 0);
+    fwrite(header, 1, sizeof(header), out->file);
+    out->type = SINK_WAV;
+    return 0;
+}
+
+static void close_sink(audio_output_t *out) {
+    switch (out->type) {
+        case SINK_WAV:
+            if (!out->file) break;
+            // Sizes are only known now
+            {
+                uint8_t header[WAV_HEADER_SIZE];
+                wav_header(header, out->data_bytes);
+                if (fseek(out->file, 0, SEEK_SET) == 0) {
+                    fwrite(header, 1, sizeof(header), out->file);
+                }
+            }
+            fclose(out->file);
+            break;
+        case SINK_STDOUT:
+            fflush(stdout);
+            break;
+        case SINK_PULSE:
+#ifdef HAVE_PULSE
+            if (out->pulse) pa_simple_free(out->pulse);
+#endif
+            break;
+    }
+    out->file = NULL;
+}
+
+static void write_sink(audio_output_t *out, const int16_t *pcm, int samples) {
+    if (out->failed || samples <= 0) return;
+
+    size_t bytes = (size_t)samples * sizeof(int16_t);
+    int ok;
+#ifdef HAVE_PULSE
+    if (out->type == SINK_PULSE) {
+        int err = 0;
+        ok = pa_simple_write(out->pulse, pcm, bytes, &err) == 0;
+        if (!ok) fprintf(stderr, "Audio: PulseAudio write failed: %s\n", pa_strerror(err));
+    } else
+#endif
+    {
+        ok = fwrite(pcm, 1, bytes, out->file) == bytes;
+        if (ok && out->type == SINK_STDOUT) ok = fflush(out->file) == 0;
+        if (!ok) fprintf(stderr, "Audio: Write failed: %s, audio muted\n", strerror(errno));
+    }
+    if (!ok) {
+        out->failed = true;
+        return;
+    }
+    out->data_bytes += (uint32_t)bytes;
+}
+
+static void *audio_thread_func(void *user_data) {
+    audio_output_t *out = (audio_output_t *)user_data;
+    rt_sched_apply("audio", NULL);
+
+    while (atomic_load(&out->running)) {
+        int generation = atomic_load(&out->mode_generation);
+        if (generation != out->applied_generation) {
+            out->applied_generation = generation;
+            demod_mode_t mode = (demod_mode_t)atomic_load(&out->mode_request);
+            int bandwidth = atomic_load(&out->bandwidth_request);
+            if (demodulator_set_mode(out->demod, mode, bandwidth,
+                                     atomic_load(&out->offset_request)) == 0) {
+                fprintf(stderr, "Audio: %s, filter %d Hz, channel rate %d Hz\n",
+                        demodulator_mode_name(mode), bandwidth,
+                        demodulator_get_channel_rate(out->demod));
+            }
+        }
+
+        int length = 0;
+        const uint8_t *data = iq_ring_read_begin(out->ring, &length, NULL, AUDIO_WAIT_MS);
+        if (!data) continue;
+
+        uint64_t cpu_start = thread_cpu_ns();
+        PERF_SPAN_BEGIN(demod_start);
+        int samples = demodulator_process_s32(out->demod, data, length / 8, out->audio,
+                                              out->audio_size);
+        iq_ring_read_commit(out->ring);
+        for (int i = 0; i < samples; i++) {
+            float v = out->audio[i] * 32767.0f;
+            if (v > 32767.0f) v = 32767.0f;
+            if (v < -32768.0f) v = -32768.0f;
+            out->pcm[i] = (int16_t)v;
+        }
+        PERF_SPAN_END(demod_start, PERF_STAGE_DEMOD);
+        atomic_fetch_add_explicit(&out->cpu_ns, (long long)(thread_cpu_ns() - cpu_start),
+                                  memory_order_relaxed);
+        atomic_fetch_add_explicit(&out->audio_samples, samples, memory_order_relaxed);
+
+        // Blocks for PulseAudio, which paces the thread to the sound card
+        write_sink(out, out->pcm, samples);
+    }
+    return NULL;
+}
+
+audio_output_t *audio_output_new(const char *sink, int input_rate) {
+    if (!sink || input_rate <= 0) return NULL;
+
+    audio_output_t *out = calloc(1, sizeof(audio_output_t));
+    if (!out) return NULL;
+
+    out->input_rate = input_rate;
+    out->demod = demodulator_new(input_rate);
+    out->ring = iq_ring_new(AUDIO_RING_SLOTS, USB_BUFFER_SIZE);
+    out->audio_size = out->demod ? demodulator_max_output(out->demod, USB_BUFFER_SIZE / 8) : 0;
+    out->audio = malloc(sizeof(float) * out->audio_size);
+    out->pcm = malloc(sizeof(int16_t) * out->audio_size);
+    atomic_init(&out->mode_request, DEMOD_USB);
+    atomic_init(&out->bandwidth_request, 0);
+    atomic_init(&out->offset_request, 0);
+    atomic_init(&out->mode_generation, 0);
+    atomic_init(&out->cpu_ns, 0);
+    atomic_init(&out->audio_samples, 0);
+    atomic_init(&out->running, 0);
+    out->type = SINK_WAV;
+
+    if (!out->demod || !out->ring || !out->audio || !out->pcm || open_sink(out, sink) != 0) {
+        audio_output_free(out);
+        return NULL;
+    }
+
+    fprintf(stderr, "Audio: Demodulating %d Hz IQ to %s\n", input_rate,
+            strcmp(sink, "-") == 0 ? "stdout" : sink);
+    return out;
+}
+
+void audio_output_free(audio_output_t *out) {
+    if (!out) return;
+
+    audio_output_stop(out);
+    close_sink(out);
+    demodulator_free(out->demod);
+    iq_ring_free(out->ring);
+    free(out->audio);
+    free(out->pcm);
+    free(out);
+}
+
+int audio_output_start(audio_output_t *out) {
+    if (!out) return -1;
+    if (atomic_load(&out->running)) return 0;
+
+    atomic_store(&out->running, 1);
+    if (pthread_create(&out->thread, NULL, audio_thread_func, out) != 0) {
+        fprintf(stderr, "Audio: Failed to create thread\n");
+        atomic_store(&out->running, 0);
+        return -1;
+    }
+    out->thread_started = 1;
+    return 0;
+}
+
+void audio_output_stop(audio_output_t *out) {
+    if (!out || !out->thread_started) return;
+
+    atomic_store(&out->running, 0);
+    pthread_join(out->thread, NULL);
+    out->thread_started = 0;
+
+    audio_output_stats_t stats;
+    audio_output_get_stats(out, &stats);
+    fprintf(stderr, "Audio: %.1f s demodulated, %.2f%% of one core, %ld chunks dropped\n",
+            stats.seconds, stats.cpu_load * 100.0, stats.dropped);
+}
+
+void audio_output_set_mode(audio_output_t *out, demod_mode_t mode, int bandwidth_hz,
+                           int offset_hz) {
+    if (!out) return;
+    atomic_store(&out->mode_request, mode);
+    atomic_store(&out->bandwidth_request, bandwidth_hz);
+    atomic_store(&out->offset_request, offset_hz);
+    atomic_fetch_add(&out->mode_generation, 1);
+}
+
+void audio_output_push(audio_output_t *out, const uint8_t *iq, int length) {
+    if (!out || !atomic_load(&out->running)) return;
+    iq_ring_push(out->ring, iq, length, 0, false, 0);
+}
+
+void audio_output_get_stats(audio_output_t *out, audio_output_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!out) return;
+
+    long long samples = atomic_load_explicit(&out->audio_samples, memory_order_relaxed);
+    stats->seconds = (double)samples / DEMOD_AUDIO_RATE;
+    if (stats->seconds > 0.0) {
+        stats->cpu_load = atomic_load_explicit(&out->cpu_ns, memory_order_relaxed) / 1e9 /
+                          stats->seconds;
+    }
+    stats->dropped = iq_ring_get_dropped(out->ring);
+}
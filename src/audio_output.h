@@ -0,0 +1,50 @@
+#ifndef AUDIO_OUTPUT_H
+#define AUDIO_OUTPUT_H
+
+#include <stdint.h>
+#include "demodulator.h"
+
+// Demodulated audio of one radio on its own thread.
+//
+// The pipeline's DSP thread hands every IQ chunk to audio_output_push(),
+// which copies it into a ring and returns (chunks are dropped, not
+// waited for, when the audio thread is behind). The audio thread runs
+// the demodulator and writes 16-bit mono 48 kHz audio to the sink:
+//   "file.wav"  WAV file (header completed when the output is freed)
+//   "-"         raw signed 16-bit little-endian samples on stdout
+//   "pulse"     default PulseAudio/PipeWire sink (built with libpulse-simple)
+
+typedef struct audio_output audio_output_t;
+
+typedef struct {
+    double cpu_load;  // Thread CPU time / audio time (1.0 = one full core)
+    double seconds;   // Audio produced
+    long dropped;     // IQ chunks dropped because the audio thread was behind
+} audio_output_stats_t;
+
+// Open the sink for IQ at input_rate (demodulator in USB mode until set)
+// Returns NULL on error
+audio_output_t *audio_output_new(const char *sink, int input_rate);
+
+// Stop the thread, close the sink and free the output
+void audio_output_free(audio_output_t *out);
+
+// Start the audio thread
+// Returns 0 on success, -1 on error
+int audio_output_start(audio_output_t *out);
+
+// Stop the audio thread (blocks until it exits)
+void audio_output_stop(audio_output_t *out);
+
+// Change mode and filter (any thread; applied before the next chunk)
+// See demodulator_set_mode() for bandwidth_hz and offset_hz
+void audio_output_set_mode(audio_output_t *out, demod_mode_t mode, int bandwidth_hz,
+                           int offset_hz);
+
+// Queue a chunk of 32-bit LE I/Q (never blocks)
+void audio_output_push(audio_output_t *out, const uint8_t *iq, int length);
+
+// Copy the counters
+void audio_output_get_stats(audio_output_t *out, audio_output_stats_t *stats);
+
+#endif // AUDIO_OUTPUT_H
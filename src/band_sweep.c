@@ -0,0 +1,294 @@
+#define _DEFAULT_SOURCE
+#include "band_sweep.h"
+#include "fft_processor.h"
+#include "mono_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <stdatomic.h>
+
+#define USABLE_BINS (FFT_SIZE - 2 * BAND_SWEEP_EDGE_BINS)
+
+struct band_sweep {
+    band_sweep_config_t config;
+    int sample_rate;
+    double bin_hz;
+    int steps;
+    int total_bins;            // Stitched bins (steps overlapping)
+
+    // Request from the DSP thread (step, -1 = none) and when it was made
+    atomic_int request_step;
+    atomic_uint_fast64_t request_ns;
+
+    // Retune result from the source thread: step now tuned and when the
+    // retune completed, published by bumping tune_generation
+    int pending_step;          // Source thread only
+    atomic_int tuned_step;
+    atomic_uint_fast64_t tuned_ns;
+    atomic_int tune_generation;
+    atomic_uint_fast64_t retune_sum_ns;
+    atomic_int retune_count;
+
+    // Capture (DSP thread only)
+    fft_processor_t *fft;
+    int needed_samples;        // Samples for one averaged spectrum
+    int generation;            // tune_generation being captured
+    int step;
+    uint64_t valid_from_ns;    // Chunks must start after this
+    int settle_left;           // Samples still to discard
+    int collected;             // Samples fed to the FFT
+    bool requested;            // Next step already requested
+    uint64_t wrap_ns;          // When the last sweep completed (or began)
+
+    // Segments and stitched spectrum (DSP thread only)
+    float *segments;           // steps * FFT_SIZE dB
+    bool *have;
+    float *stitched;           // total_bins
+    float columns[FFT_SIZE];
+
+    // Statistics
+    atomic_long sweeps;
+    atomic_uint_fast64_t sweep_ns;
+    atomic_uint_fast64_t retune_ns;
+    atomic_long discarded;
+};
+
+// Centre frequency of a step: its bin FFT_SIZE / 2 (DC) is stitched bin
+// step * BAND_SWEEP_STEP_BINS + FFT_SIZE / 2 - BAND_SWEEP_EDGE_BINS
+static long step_freq(band_sweep_t *sweep, int step) {
+    double bin = (double)step * BAND_SWEEP_STEP_BINS + FFT_SIZE / 2 - BAND_SWEEP_EDGE_BINS;
+    return lround((double)sweep->config.start_hz + bin * sweep->bin_hz);
+}
+
+band_sweep_t *band_sweep_new(const band_sweep_config_t *config, int sample_rate) {
+    band_sweep_config_t defaults = BAND_SWEEP_CONFIG_DEFAULT;
+    if (!config) config = &defaults;
+    if (sample_rate <= 0 || config->start_hz < 0 || config->stop_hz <= config->start_hz ||
+        config->stop_hz > BAND_SWEEP_MAX_HZ || config->frames < 1 ||
+        config->frames > FFT_MAX_AVERAGING || config->settle_frames < 0) {
+        fprintf(stderr, "Sweep: Invalid range (0-%lld MHz) or frame counts\n",
+                BAND_SWEEP_MAX_HZ / 1000000);
+        return NULL;
+    }
+
+    band_sweep_t *sweep = calloc(1, sizeof(band_sweep_t));
+    if (!sweep) return NULL;
+
+    sweep->config = *config;
+    sweep->sample_rate = sample_rate;
+    sweep->bin_hz = (double)sample_rate / FFT_SIZE;
+
+    // Enough steps to cover start..stop with the usable bins
+    double range_bins = (double)(config->stop_hz - config->start_hz) / sweep->bin_hz;
+    sweep->steps = 1;
+    if (range_bins > USABLE_BINS) {
+        sweep->steps += (int)ceil((range_bins - USABLE_BINS) / BAND_SWEEP_STEP_BINS);
+    }
+    sweep->total_bins = (sweep->steps - 1) * BAND_SWEEP_STEP_BINS + USABLE_BINS;
+
+    // The whole steps overshoot stop: past the radio's range, end the
+    // sweep there instead (the last step is then tuned below it)
+    double span_hz = sweep->total_bins * sweep->bin_hz;
+    if (sweep->config.start_hz + span_hz > BAND_SWEEP_MAX_HZ) {
+        sweep->config.start_hz = BAND_SWEEP_MAX_HZ - (int64_t)ceil(span_hz);
+        if (sweep->config.start_hz < 0) sweep->config.start_hz = 0;
+    }
+
+    sweep->fft = fft_processor_new(FFT_SIZE);
+    sweep->segments = malloc(sizeof(float) * FFT_SIZE * (size_t)sweep->steps);
+    sweep->have = calloc((size_t)sweep->steps, sizeof(bool));
+    sweep->stitched = malloc(sizeof(float) * (size_t)sweep->total_bins);
+    if (!sweep->fft || !sweep->segments || !sweep->have || !sweep->stitched ||
+        fft_processor_set_averaging(sweep->fft, config->frames) != 0) {
+        fprintf(stderr, "Sweep: Failed to allocate %d steps\n", sweep->steps);
+        band_sweep_free(sweep);
+        return NULL;
+    }
+    for (int i = 0; i < sweep->total_bins; i++) sweep->stitched[i] = BAND_SWEEP_EMPTY_DB;
+    for (int i = 0; i < FFT_SIZE; i++) sweep->columns[i] = BAND_SWEEP_EMPTY_DB;
+
+    // The first history fills taps frames, each further frame one hop
+    int taps = fft_processor_get_window(sweep->fft) == FFT_WINDOW_WOLA ? FFT_WOLA_TAPS : 1;
+    sweep->needed_samples = FFT_SIZE * (taps + config->frames - 1);
+
+    atomic_init(&sweep->request_step, 0);
+    atomic_init(&sweep->request_ns, monotonic_ns());
+    atomic_init(&sweep->tuned_step, 0);
+    atomic_init(&sweep->tuned_ns, 0);
+    atomic_init(&sweep->tune_generation, 0);
+    atomic_init(&sweep->retune_sum_ns, 0);
+    atomic_init(&sweep->retune_count, 0);
+    atomic_init(&sweep->sweeps, 0);
+    atomic_init(&sweep->sweep_ns, 0);
+    atomic_init(&sweep->retune_ns, 0);
+    atomic_init(&sweep->discarded, 0);
+    sweep->pending_step = -1;
+    sweep->requested = true;  // Nothing to capture before the first retune
+
+    fprintf(stderr, "Sweep: %.3f-%.3f MHz in %d steps of %.0f kHz\n",
+            sweep->config.start_hz / 1e6, (sweep->config.start_hz + span_hz) / 1e6,
+            sweep->steps, BAND_SWEEP_STEP_BINS * sweep->bin_hz / 1e3);
+    return sweep;
+}
+
+void band_sweep_free(band_sweep_t *sweep) {
+    if (!sweep) return;
+    fft_processor_free(sweep->fft);
+    free(sweep->segments);
+    free(sweep->have);
+    free(sweep->stitched);
+    free(sweep);
+}
+
+void band_sweep_get_span(band_sweep_t *sweep, int64_t *center_hz, uint32_t *span_hz) {
+    if (!sweep) return;
+    double span = sweep->total_bins * sweep->bin_hz;
+    if (center_hz) *center_hz = sweep->config.start_hz + (int64_t)llround(span / 2);
+    if (span_hz) *span_hz = (uint32_t)llround(span);
+}
+
+bool band_sweep_get_request(band_sweep_t *sweep, long *freq_hz) {
+    if (!sweep) return false;
+    int step = atomic_exchange(&sweep->request_step, -1);
+    if (step < 0) return false;
+    sweep->pending_step = step;
+    if (freq_hz) *freq_hz = step_freq(sweep, step);
+    return true;
+}
+
+void band_sweep_tuned(band_sweep_t *sweep, bool ok) {
+    if (!sweep || sweep->pending_step < 0) return;
+
+    if (!ok) {
+        // Retried on the next round (or after the radio reconnects)
+        atomic_store(&sweep->request_step, sweep->pending_step);
+        sweep->pending_step = -1;
+        return;
+    }
+
+    uint64_t now = monotonic_ns();
+    atomic_fetch_add(&sweep->retune_sum_ns, now - atomic_load(&sweep->request_ns));
+    atomic_fetch_add(&sweep->retune_count, 1);
+
+    // Step and time before the generation that publishes them
+    atomic_store(&sweep->tuned_step, sweep->pending_step);
+    atomic_store(&sweep->tuned_ns, now);
+    atomic_fetch_add(&sweep->tune_generation, 1);
+    sweep->pending_step = -1;
+}
+
+void band_sweep_restart(band_sweep_t *sweep) {
+    if (!sweep || sweep->pending_step >= 0) return;
+    int expected = -1;
+    atomic_store(&sweep->request_ns, monotonic_ns());
+    atomic_compare_exchange_strong(&sweep->request_step, &expected,
+                                   atomic_load(&sweep->tuned_step));
+}
+
+// Recompute stitched bins [from, to) from the segments covering them, then
+// the display columns over them
+static void stitch(band_sweep_t *sweep, int from, int to) {
+    for (int j = from; j < to; j++) {
+        int last = j / BAND_SWEEP_STEP_BINS;
+        if (last >= sweep->steps) last = sweep->steps - 1;
+        double sum = 0.0, weight = 0.0;
+        for (int k = last; k >= 0 && k >= last - 1; k--) {
+            int p = j - k * BAND_SWEEP_STEP_BINS;
+            if (p < 0 || p >= USABLE_BINS || !sweep->have[k]) continue;
+            // Ramps across the overlaps, so neighbours' weights sum to one
+            double w = fmin(1.0, fmin((p + 0.5) / BAND_SWEEP_OVERLAP_BINS,
+                                      (USABLE_BINS - p - 0.5) / BAND_SWEEP_OVERLAP_BINS));
+            sum += w * sweep->segments[(size_t)k * FFT_SIZE + BAND_SWEEP_EDGE_BINS + p];
+            weight += w;
+        }
+        if (weight > 0.0) sweep->stitched[j] = (float)(sum / weight);
+    }
+
+    int first_col = (int)((int64_t)from * FFT_SIZE / sweep->total_bins);
+    int last_col = (int)((int64_t)(to - 1) * FFT_SIZE / sweep->total_bins);
+    for (int c = first_col; c <= last_col && c < FFT_SIZE; c++) {
+        int a = (int)((int64_t)c * sweep->total_bins / FFT_SIZE);
+        int b = (int)((int64_t)(c + 1) * sweep->total_bins / FFT_SIZE);
+        if (b <= a) b = a + 1;
+        float peak = sweep->stitched[a];
+        for (int j = a + 1; j < b; j++) {
+            if (sweep->stitched[j] > peak) peak = sweep->stitched[j];
+        }
+        sweep->columns[c] = peak;
+    }
+}
+
+static void add_segment(band_sweep_t *sweep) {
+    int step = sweep->step;
+    fft_processor_get_spectrum_db(sweep->fft, sweep->segments + (size_t)step * FFT_SIZE);
+    sweep->have[step] = true;
+
+    int from = step * BAND_SWEEP_STEP_BINS;
+    stitch(sweep, from, from + USABLE_BINS);
+
+    if (step == sweep->steps - 1) {
+        uint64_t now = monotonic_ns();
+        atomic_store(&sweep->sweep_ns, now - sweep->wrap_ns);
+        int count = atomic_exchange(&sweep->retune_count, 0);
+        uint64_t sum = atomic_exchange(&sweep->retune_sum_ns, 0);
+        atomic_store(&sweep->retune_ns, count > 0 ? sum / (uint64_t)count : 0);
+        atomic_fetch_add(&sweep->sweeps, 1);
+        sweep->wrap_ns = now;
+    }
+}
+
+bool band_sweep_process(band_sweep_t *sweep, const uint8_t *usb_data, int length,
+                        uint64_t timestamp_ns) {
+    if (!sweep || !usb_data) return false;
+
+    // A new step tuned: start capturing it
+    int generation = atomic_load(&sweep->tune_generation);
+    if (generation != sweep->generation) {
+        sweep->generation = generation;
+        sweep->step = atomic_load(&sweep->tuned_step);
+        sweep->valid_from_ns = atomic_load(&sweep->tuned_ns);
+        sweep->settle_left = sweep->config.settle_frames * FFT_SIZE;
+        sweep->collected = 0;
+        sweep->requested = false;
+        if (sweep->wrap_ns == 0) sweep->wrap_ns = atomic_load(&sweep->request_ns);
+        fft_processor_reset(sweep->fft);
+    }
+    if (sweep->requested) return false;
+
+    // Chunks partly captured before the retune completed, then settling
+    int samples = length / 8;
+    uint64_t duration_ns = (uint64_t)samples * 1000000000ULL / (uint64_t)sweep->sample_rate;
+    if (timestamp_ns < sweep->valid_from_ns + duration_ns || sweep->settle_left > 0) {
+        if (timestamp_ns >= sweep->valid_from_ns + duration_ns) sweep->settle_left -= samples;
+        atomic_fetch_add_explicit(&sweep->discarded, 1, memory_order_relaxed);
+        return false;
+    }
+
+    // The chunk completing the average: retune while it is processed
+    sweep->collected += samples;
+    if (sweep->collected >= sweep->needed_samples) {
+        atomic_store(&sweep->request_ns, monotonic_ns());
+        atomic_store(&sweep->request_step, (sweep->step + 1) % sweep->steps);
+        sweep->requested = true;
+    }
+
+    if (!fft_processor_process(sweep->fft, usb_data, length)) return false;
+    add_segment(sweep);
+    return true;
+}
+
+void band_sweep_get_spectrum(band_sweep_t *sweep, float *output) {
+    if (!sweep || !output) return;
+    memcpy(output, sweep->columns, sizeof(sweep->columns));
+}
+
+void band_sweep_get_stats(band_sweep_t *sweep, band_sweep_stats_t *stats) {
+    if (!sweep || !stats) return;
+    stats->sweeps = atomic_load(&sweep->sweeps);
+    stats->steps = sweep->steps;
+    stats->sweep_s = atomic_load(&sweep->sweep_ns) / 1e9;
+    stats->retune_ms = atomic_load(&sweep->retune_ns) / 1e6;
+    stats->discarded = atomic_load_explicit(&sweep->discarded, memory_order_relaxed);
+}
@@ -0,0 +1,96 @@
+#ifndef BAND_SWEEP_H
+#define BAND_SWEEP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "app_state.h"
+
+// Panoramic sweep: the radio is stepped across a wide range (all of HF by
+// default) and the averaged 192 kHz segments are stitched into one
+// spectrum, published by the pipeline like any other.
+//
+// Segments are FFT_SIZE bins; the outer BAND_SWEEP_EDGE_BINS on each side
+// (decimation filter roll-off) are dropped and steps are
+// BAND_SWEEP_STEP_BINS apart, so neighbours overlap by
+// BAND_SWEEP_OVERLAP_BINS, blended with linear weights. The stitched
+// spectrum is shown as FFT_SIZE columns, each the peak of the bins it
+// covers, so narrow carriers survive the reduction.
+//
+// Retune and processing are pipelined across two threads:
+//   DSP thread     discards chunks captured before the retune completed
+//                  plus settle_frames FFT frames, feeds the rest to its
+//                  own fft_processor and, as soon as the chunk completing
+//                  the average arrives, requests the next step, then
+//                  computes and stitches the segment
+//   source thread  picks the request up between USB event rounds and
+//                  retunes (usb_device_set_frequency), so the USB control
+//                  transfers and settling of step k+1 overlap the FFT and
+//                  stitching of step k, and the RT DSP thread never waits
+//                  on the radio
+// The hand-over is a request atomic one way and a generation counter the
+// other, like the pipeline's zoom requests.
+
+#define BAND_SWEEP_EDGE_BINS (FFT_SIZE / 16)            // 12 kHz each side
+#define BAND_SWEEP_STEP_BINS (FFT_SIZE * 3 / 4)         // 144 kHz
+#define BAND_SWEEP_OVERLAP_BINS (FFT_SIZE - 2 * BAND_SWEEP_EDGE_BINS - BAND_SWEEP_STEP_BINS)
+#define BAND_SWEEP_EMPTY_DB -160.0f
+
+// FDM-DUO receive range: stop frequencies above it are rejected, and the
+// steps are moved down so the last one is tuned inside it
+#define BAND_SWEEP_MAX_HZ 54000000LL
+
+typedef struct {
+    int64_t start_hz;
+    int64_t stop_hz;
+    int frames;            // FFT frames averaged per step
+    int settle_frames;     // FFT frames discarded after each retune
+} band_sweep_config_t;
+
+#define BAND_SWEEP_CONFIG_DEFAULT { \
+    .start_hz = 3000000, .stop_hz = 30000000, .frames = 3, .settle_frames = 1 }
+
+typedef struct {
+    long sweeps;           // Complete sweeps so far
+    int steps;             // Steps per sweep
+    double sweep_s;        // Duration of the last complete sweep (0 = none yet)
+    double retune_ms;      // Mean time from request to retuned over that sweep
+    long discarded;        // Chunks discarded (captured before/while settling)
+} band_sweep_stats_t;
+
+typedef struct band_sweep band_sweep_t;
+
+// Create a sweep over config (NULL = defaults) for a radio at sample_rate
+// Returns NULL on error, including a stop frequency above BAND_SWEEP_MAX_HZ
+band_sweep_t *band_sweep_new(const band_sweep_config_t *config, int sample_rate);
+
+void band_sweep_free(band_sweep_t *sweep);
+
+// Centre and width of the stitched spectrum (covers start..stop, rounded
+// up to whole steps)
+void band_sweep_get_span(band_sweep_t *sweep, int64_t *center_hz, uint32_t *span_hz);
+
+// Source thread: the frequency to tune next, if a retune is pending
+bool band_sweep_get_request(band_sweep_t *sweep, long *freq_hz);
+
+// Source thread: report the retune of the last request (ok false keeps it
+// pending, to be retried)
+void band_sweep_tuned(band_sweep_t *sweep, bool ok);
+
+// Source thread: request the current step again, e.g. after the radio
+// reconnected (its frequency is then unknown)
+void band_sweep_restart(band_sweep_t *sweep);
+
+// DSP thread: one chunk of raw USB data (timestamp_ns: capture time of its
+// last sample, CLOCK_MONOTONIC)
+// Returns true when a segment was stitched in
+bool band_sweep_process(band_sweep_t *sweep, const uint8_t *usb_data, int length,
+                        uint64_t timestamp_ns);
+
+// DSP thread: the stitched spectrum as FFT_SIZE columns (dB); parts not
+// captured yet are at BAND_SWEEP_EMPTY_DB
+void band_sweep_get_spectrum(band_sweep_t *sweep, float *output);
+
+// Any thread
+void band_sweep_get_stats(band_sweep_t *sweep, band_sweep_stats_t *stats);
+
+#endif // BAND_SWEEP_H
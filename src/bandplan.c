@@ -3,6 +3,24 @@
 #include <stdio.h>
 #include <string.h>
 
+// Append one "frequencies" entry (a number or an array of numbers)
+static void add_frequencies(bandplan_t *plan, const char *mode, JsonNode *node, int band) {
+    JsonArray *list = JSON_NODE_HOLDS_ARRAY(node) ? json_node_get_array(node) : NULL;
+    guint count = list ? json_array_get_length(list) : 1;
+
+    for (guint i = 0; i < count && plan->frequency_count < BANDPLAN_MAX_FREQUENCIES; i++) {
+        JsonNode *value = list ? json_array_get_element(list, i) : node;
+        if (!JSON_NODE_HOLDS_VALUE(value)) continue;
+
+        band_frequency_t *freq = &plan->frequencies[plan->frequency_count];
+        strncpy(freq->mode, mode, sizeof(freq->mode) - 1);
+        freq->mode[sizeof(freq->mode) - 1] = '\0';
+        freq->freq_hz = json_node_get_int(value);
+        freq->band = band;
+        plan->frequency_count++;
+    }
+}
+
 int bandplan_load(bandplan_t *plan, const char *filepath) {
     if (!plan || !filepath) return -1;
 
@@ -80,17 +98,30 @@ int bandplan_load(bandplan_t *plan, const char *filepath) {
         band->lower_bound = lower;
         band->upper_bound = upper;
         band->tag = tag;
+
+        // Activity frequencies ("ft8": 14074000, "wspr": [...])
+        if (json_object_has_member(obj, "frequencies")) {
+            JsonObject *freqs = json_object_get_object_member(obj, "frequencies");
+            GList *modes = freqs ? json_object_get_members(freqs) : NULL;
+            for (GList *m = modes; m; m = m->next) {
+                const char *mode = m->data;
+                add_frequencies(plan, mode, json_object_get_member(freqs, mode), plan->count);
+            }
+            g_list_free(modes);
+        }
         plan->count++;
     }
 
     g_object_unref(parser);
-    fprintf(stderr, "Bandplan: Loaded %d bands from %s\n", plan->count, filepath);
+    fprintf(stderr, "Bandplan: Loaded %d bands, %d activity frequencies from %s\n",
+            plan->count, plan->frequency_count, filepath);
     return 0;
 }
 
 void bandplan_free(bandplan_t *plan) {
     if (plan) {
         plan->count = 0;
+        plan->frequency_count = 0;
     }
 }
 
@@ -112,3 +143,19 @@ int bandplan_find_visible(const bandplan_t *plan,
 
     return found;
 }
+
+int bandplan_find_frequencies(const bandplan_t *plan,
+                              int64_t freq_start, int64_t freq_end,
+                              int *indices, int max_results) {
+    if (!plan || !indices || max_results <= 0) return 0;
+
+    int found = 0;
+    for (int i = 0; i < plan->frequency_count && found < max_results; i++) {
+        int64_t freq = plan->frequencies[i].freq_hz;
+        if (freq >= freq_start && freq < freq_end) {
+            indices[found++] = i;
+        }
+    }
+
+    return found;
+}
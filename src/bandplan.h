@@ -4,6 +4,7 @@
 #include <stdint.h>
 
 #define BANDPLAN_MAX_BANDS 64
+#define BANDPLAN_MAX_FREQUENCIES 256
 
 typedef enum {
     BAND_TAG_UNKNOWN = 0,
@@ -20,9 +21,19 @@ typedef struct {
     band_tag_t tag;
 } band_entry_t;
 
+// Activity frequency from a band's "frequencies" object (dial frequency
+// of a digital mode, skimmer segment, ...)
+typedef struct {
+    char mode[16];    // Key in the band plan ("ft8", "wspr", ...)
+    int64_t freq_hz;
+    int band;         // Index into bands
+} band_frequency_t;
+
 typedef struct {
     band_entry_t bands[BANDPLAN_MAX_BANDS];
     int count;
+    band_frequency_t frequencies[BANDPLAN_MAX_FREQUENCIES];
+    int frequency_count;
 } bandplan_t;
 
 // Load bandplan from JSON file
@@ -39,4 +50,10 @@ int bandplan_find_visible(const bandplan_t *plan,
                           int64_t freq_start, int64_t freq_end,
                           int *indices, int max_results);
 
+// Find activity frequencies in [freq_start, freq_end)
+// Returns number found, fills indices with indices into plan->frequencies
+int bandplan_find_frequencies(const bandplan_t *plan,
+                              int64_t freq_start, int64_t freq_end,
+                              int *indices, int max_results);
+
 #endif // BANDPLAN_H
@@ -1,5 +1,6 @@
 #define _DEFAULT_SOURCE
 #include "cat_control.h"
+#include "mono_clock.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -7,10 +8,18 @@
 #include <fcntl.h>
 #include <termios.h>
 #include <errno.h>
+#include <time.h>
+#include <stdatomic.h>
 
 struct cat_control {
     int fd;
     char device[256];
+
+    // Command statistics, read by other threads
+    atomic_uint_fast64_t stat_commands;
+    atomic_uint_fast64_t stat_failures;
+    atomic_uint_fast64_t stat_rtt_sum_us;
+    atomic_uint_fast64_t rtt_hist[CAT_STATS_HIST_BUCKETS];
 };
 
 cat_control_t *cat_control_new(void) {
@@ -101,10 +110,22 @@ bool cat_control_is_open(cat_control_t *cat) {
     return cat && cat->fd >= 0;
 }
 
-// Send command and read response
-static int cat_command(cat_control_t *cat, const char *cmd, char *response, int response_size) {
-    if (!cat || cat->fd < 0) return -1;
+// Count a finished command; only replies ending in ';' count as answered
+static void record_command(cat_control_t *cat, uint64_t start_us, int result, const char *response) {
+    atomic_fetch_add_explicit(&cat->stat_commands, 1, memory_order_relaxed);
+    if (result <= 0 || response[result - 1] != ';') {
+        atomic_fetch_add_explicit(&cat->stat_failures, 1, memory_order_relaxed);
+        return;
+    }
 
+    uint64_t rtt_us = monotonic_us() - start_us;
+    atomic_fetch_add_explicit(&cat->stat_rtt_sum_us, rtt_us, memory_order_relaxed);
+    int bucket = duration_hist_bucket(rtt_us, CAT_STATS_HIST_BUCKETS);
+    atomic_fetch_add_explicit(&cat->rtt_hist[bucket], 1, memory_order_relaxed);
+}
+
+// Send command and read response
+static int cat_command_io(cat_control_t *cat, const char *cmd, char *response, int response_size) {
     // Flush input buffer
     tcflush(cat->fd, TCIFLUSH);
 
@@ -141,6 +162,29 @@ static int cat_command(cat_control_t *cat, const char *cmd, char *response, int
     return total;
 }
 
+static int cat_command(cat_control_t *cat, const char *cmd, char *response, int response_size) {
+    if (!cat || cat->fd < 0) return -1;
+
+    uint64_t start_us = monotonic_us();
+    response[0] = '\0';
+    int result = cat_command_io(cat, cmd, response, response_size);
+    record_command(cat, start_us, result, response);
+    return result;
+}
+
+void cat_control_get_stats(cat_control_t *cat, cat_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!cat) return;
+
+    stats->commands = atomic_load_explicit(&cat->stat_commands, memory_order_relaxed);
+    stats->failures = atomic_load_explicit(&cat->stat_failures, memory_order_relaxed);
+    stats->rtt_sum_us = atomic_load_explicit(&cat->stat_rtt_sum_us, memory_order_relaxed);
+    for (int i = 0; i < CAT_STATS_HIST_BUCKETS; i++) {
+        stats->rtt_hist[i] = atomic_load_explicit(&cat->rtt_hist[i], memory_order_relaxed);
+    }
+}
+
 // Filter bandwidth lookup tables from RF CAT command (per ELAD FDM-DUO manual)
 // LSB/USB filters (P1=1,2): index 0-21
 static const char *filter_lsb_usb[] = {
@@ -2,10 +2,23 @@
 #define CAT_CONTROL_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "usb_device.h"  // For elad_mode_t
 
 typedef struct cat_control cat_control_t;
 
+// Round-trip histogram: bucket 0 counts < 1 us, bucket i counts
+// [2^(i-1), 2^i) us, the last bucket everything above (like usb_stats_t)
+#define CAT_STATS_HIST_BUCKETS 24
+
+// Command statistics snapshot (see cat_control_get_stats)
+typedef struct {
+    uint64_t commands;      // Commands sent
+    uint64_t failures;      // Write errors, read errors or no ';' terminated reply
+    uint64_t rtt_sum_us;    // Sum of round-trip times
+    uint64_t rtt_hist[CAT_STATS_HIST_BUCKETS];  // Command write to reply
+} cat_stats_t;
+
 // Create CAT control handler
 cat_control_t *cat_control_new(void);
 
@@ -33,4 +46,7 @@ int cat_control_get_freq_mode(cat_control_t *cat, long *freq_hz, elad_mode_t *mo
 // Returns 0 on success, -1 on error
 int cat_control_get_filter_bw(cat_control_t *cat, elad_mode_t mode, char *filter_str, int filter_str_size);
 
+// Copy command statistics (safe from any thread)
+void cat_control_get_stats(cat_control_t *cat, cat_stats_t *stats);
+
 #endif // CAT_CONTROL_H
@@ -0,0 +1,383 @@
+#define _DEFAULT_SOURCE
+#include "channelizer.h"
+#include <fftw3.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdatomic.h>
+
+typedef float v8sf __attribute__((vector_size(32)));
+
+// Kaiser design attenuation of the prototype (the 12-tap length leaves
+// the transition narrower than the 0.5 spacing it needs)
+#define PROTOTYPE_ATTEN_DB 90.0
+
+// FFT outputs kept per channel before the rings are published
+#define OUTPUT_BATCH 64
+
+// Lock-free SPSC ring of complex samples; positions only grow
+typedef struct {
+    float *data;            // 2 * capacity floats, I/Q interleaved
+    size_t capacity;        // Power of two
+    atomic_size_t write_pos;  // Producer
+    atomic_size_t read_pos;   // Consumer
+    atomic_long dropped;
+} channel_ring_t;
+
+typedef struct {
+    _Atomic(channel_ring_t *) ring;  // Allocated on first subscribe, kept until free
+    atomic_int subscribed;
+} channel_t;
+
+struct channelizer {
+    int input_rate;
+    int channels;           // N (FFT size)
+    int decimation;         // N / 2
+    int length;             // Prototype taps, N * CHANNELIZER_TAPS
+
+    float *coef;            // Prototype, time reversed (oldest sample first)
+    float *hist_re;         // Doubled history: a window never wraps
+    float *hist_im;
+    int pos;
+    int phase;              // Input samples since the last output
+    uint64_t outputs;       // Output index, for the channel phase correction
+
+    float *fold_re;         // N folded samples
+    float *fold_im;
+    fftw_complex *fft_in;
+    fftw_complex *fft_out;
+    fftw_plan plan;
+
+    channel_t *chan;
+
+    // Producer scratch: subscribed channels this call and their outputs
+    int *active;
+    channel_ring_t **active_ring;
+    size_t *active_write;
+    size_t *active_read;
+    float *batch;           // OUTPUT_BATCH * channels * 2
+    int batch_count;
+};
+
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+// Kaiser-windowed sinc, cutoff one spacing (1 / N cycles per sample),
+// unity DC gain, stored time reversed
+static void design_prototype(float *coef, int length, int channels) {
+    double beta = 0.1102 * (PROTOTYPE_ATTEN_DB - 8.7);
+    double fc = 1.0 / channels;
+    double mid = (length - 1) / 2.0;
+    double *h = malloc(sizeof(double) * length);
+    double sum = 0.0;
+    for (int i = 0; i < length; i++) {
+        double x = i - mid;
+        double sinc = x == 0.0 ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        double r = x / (mid + 0.5);
+        h[i] = sinc * bessel_i0(beta * sqrt(1.0 - r * r)) / bessel_i0(beta);
+        sum += h[i];
+    }
+    for (int i = 0; i < length; i++) {
+        coef[length - 1 - i] = (float)(h[i] / sum);
+    }
+    free(h);
+}
+
+channelizer_t *channelizer_new(int input_rate, int channels) {
+    if (input_rate <= 0 || channels < 8 || channels > 4096 || (channels & (channels - 1))) {
+        fprintf(stderr, "Channelizer: channels must be a power of two from 8 to 4096\n");
+        return NULL;
+    }
+
+    channelizer_t *ch = calloc(1, sizeof(channelizer_t));
+    if (!ch) return NULL;
+
+    ch->input_rate = input_rate;
+    ch->channels = channels;
+    ch->decimation = channels / 2;
+    ch->length = channels * CHANNELIZER_TAPS;
+
+    ch->coef = malloc(sizeof(float) * ch->length);
+    ch->hist_re = calloc((size_t)ch->length * 2, sizeof(float));
+    ch->hist_im = calloc((size_t)ch->length * 2, sizeof(float));
+    ch->fold_re = malloc(sizeof(float) * channels);
+    ch->fold_im = malloc(sizeof(float) * channels);
+    ch->fft_in = fftw_malloc(sizeof(fftw_complex) * channels);
+    ch->fft_out = fftw_malloc(sizeof(fftw_complex) * channels);
+    ch->chan = calloc(channels, sizeof(channel_t));
+    ch->active = malloc(sizeof(int) * channels);
+    ch->active_ring = malloc(sizeof(channel_ring_t *) * channels);
+    ch->active_write = malloc(sizeof(size_t) * channels);
+    ch->active_read = malloc(sizeof(size_t) * channels);
+    ch->batch = malloc(sizeof(float) * 2 * OUTPUT_BATCH * channels);
+    if (!ch->coef || !ch->hist_re || !ch->hist_im || !ch->fold_re || !ch->fold_im ||
+        !ch->fft_in || !ch->fft_out || !ch->chan || !ch->active || !ch->active_ring ||
+        !ch->active_write || !ch->active_read || !ch->batch) {
+        fprintf(stderr, "Channelizer: Out of memory\n");
+        channelizer_free(ch);
+        return NULL;
+    }
+
+    // Inverse transform: channel k picks up exp(+j 2 pi k m / N) of the fold
+    ch->plan = fftw_plan_dft_1d(channels, ch->fft_in, ch->fft_out, FFTW_BACKWARD, FFTW_MEASURE);
+    if (!ch->plan) {
+        fprintf(stderr, "Channelizer: Failed to create FFT plan\n");
+        channelizer_free(ch);
+        return NULL;
+    }
+
+    design_prototype(ch->coef, ch->length, channels);
+    for (int k = 0; k < channels; k++) {
+        atomic_init(&ch->chan[k].ring, NULL);
+        atomic_init(&ch->chan[k].subscribed, 0);
+    }
+
+    fprintf(stderr, "Channelizer: %d channels, %.0f Hz apart, %.0f Hz output\n",
+            channels, channelizer_get_spacing(ch), channelizer_get_output_rate(ch));
+    return ch;
+}
+
+void channelizer_free(channelizer_t *ch) {
+    if (!ch) return;
+
+    if (ch->plan) fftw_destroy_plan(ch->plan);
+    if (ch->chan) {
+        for (int k = 0; k < ch->channels; k++) {
+            channel_ring_t *ring = atomic_load(&ch->chan[k].ring);
+            if (ring) {
+                free(ring->data);
+                free(ring);
+            }
+        }
+    }
+    fftw_free(ch->fft_in);
+    fftw_free(ch->fft_out);
+    free(ch->coef);
+    free(ch->hist_re);
+    free(ch->hist_im);
+    free(ch->fold_re);
+    free(ch->fold_im);
+    free(ch->chan);
+    free(ch->active);
+    free(ch->active_ring);
+    free(ch->active_write);
+    free(ch->active_read);
+    free(ch->batch);
+    free(ch);
+}
+
+int channelizer_get_channels(channelizer_t *ch) {
+    return ch ? ch->channels : 0;
+}
+
+double channelizer_get_spacing(channelizer_t *ch) {
+    return ch ? (double)ch->input_rate / ch->channels : 0.0;
+}
+
+double channelizer_get_output_rate(channelizer_t *ch) {
+    return ch ? (double)ch->input_rate / ch->decimation : 0.0;
+}
+
+double channelizer_channel_offset(channelizer_t *ch, int channel) {
+    if (!ch || channel < 0 || channel >= ch->channels) return 0.0;
+    int k = channel < ch->channels / 2 ? channel : channel - ch->channels;
+    return k * channelizer_get_spacing(ch);
+}
+
+int channelizer_find_channel(channelizer_t *ch, double offset_hz, double *residual_hz) {
+    if (!ch || fabs(offset_hz) > ch->input_rate / 2.0) return -1;
+
+    double spacing = channelizer_get_spacing(ch);
+    int k = (int)lround(offset_hz / spacing);
+    if (residual_hz) *residual_hz = offset_hz - k * spacing;
+    return k < 0 ? k + ch->channels : k % ch->channels;
+}
+
+// Copy the batched outputs of the subscribed channels into their rings
+static void flush_batch(channelizer_t *ch, int active_count) {
+    int channels = ch->channels;
+    for (int a = 0; a < active_count; a++) {
+        channel_ring_t *ring = ch->active_ring[a];
+        size_t write = ch->active_write[a];
+        size_t mask = ring->capacity - 1;
+        int k = ch->active[a];
+        long dropped = 0;
+        for (int b = 0; b < ch->batch_count; b++) {
+            if (write - ch->active_read[a] >= ring->capacity) {
+                dropped++;
+                continue;
+            }
+            const float *y = ch->batch + ((size_t)b * channels + k) * 2;
+            size_t slot = (write & mask) * 2;
+            ring->data[slot] = y[0];
+            ring->data[slot + 1] = y[1];
+            write++;
+        }
+        ch->active_write[a] = write;
+        if (dropped) atomic_fetch_add_explicit(&ring->dropped, dropped, memory_order_relaxed);
+    }
+    ch->batch_count = 0;
+}
+
+// One output of every channel from the newest length samples
+// (batched only when some channel is subscribed)
+static void run_block(channelizer_t *ch, int active_count) {
+    int n = ch->channels;
+    const float *window_re = ch->hist_re + ch->pos;
+    const float *window_im = ch->hist_im + ch->pos;
+
+    // Weight by the prototype and fold the taps onto N points
+    for (int q = 0; q < n; q += 8) {
+        v8sf acc_re = { 0 }, acc_im = { 0 };
+        for (int t = 0; t < CHANNELIZER_TAPS; t++) {
+            size_t i = (size_t)t * n + q;
+            v8sf c, re, im;
+            memcpy(&c, ch->coef + i, sizeof(c));
+            memcpy(&re, window_re + i, sizeof(re));
+            memcpy(&im, window_im + i, sizeof(im));
+            acc_re += c * re;
+            acc_im += c * im;
+        }
+        memcpy(ch->fold_re + q, &acc_re, sizeof(acc_re));
+        memcpy(ch->fold_im + q, &acc_im, sizeof(acc_im));
+    }
+
+    // The window is oldest first: delay m sits at fold[N - 1 - m]
+    for (int m = 0; m < n; m++) {
+        ch->fft_in[m][0] = ch->fold_re[n - 1 - m];
+        ch->fft_in[m][1] = ch->fold_im[n - 1 - m];
+    }
+    fftw_execute(ch->plan);
+    if (active_count == 0) {
+        ch->outputs++;
+        return;
+    }
+
+    // Mixing channel k down advances its phase by pi * k per output
+    // (decimation N/2): odd channels flip sign on odd outputs
+    float *y = ch->batch + (size_t)ch->batch_count * n * 2;
+    int odd = (int)(ch->outputs & 1);
+    for (int k = 0; k < n; k++) {
+        float sign = (odd && (k & 1)) ? -1.0f : 1.0f;
+        y[2 * k] = (float)ch->fft_out[k][0] * sign;
+        y[2 * k + 1] = (float)ch->fft_out[k][1] * sign;
+    }
+    ch->outputs++;
+    ch->batch_count++;
+}
+
+void channelizer_process_s32(channelizer_t *ch, const uint8_t *iq, int samples) {
+    if (!ch || !iq || samples <= 0) return;
+
+    // Snapshot the subscribed channels for this call
+    int active_count = 0;
+    for (int k = 0; k < ch->channels; k++) {
+        if (!atomic_load_explicit(&ch->chan[k].subscribed, memory_order_acquire)) continue;
+        channel_ring_t *ring = atomic_load_explicit(&ch->chan[k].ring, memory_order_acquire);
+        ch->active[active_count] = k;
+        ch->active_ring[active_count] = ring;
+        ch->active_write[active_count] = atomic_load_explicit(&ring->write_pos,
+                                                              memory_order_relaxed);
+        ch->active_read[active_count] = atomic_load_explicit(&ring->read_pos,
+                                                             memory_order_acquire);
+        active_count++;
+    }
+
+    int length = ch->length;
+    for (int i = 0; i < samples; i++) {
+        const uint8_t *p = iq + (size_t)i * 8;
+        int32_t re, im;
+        memcpy(&re, p, 4);
+        memcpy(&im, p + 4, 4);
+        float fre = re / 2147483648.0f;
+        float fim = im / 2147483648.0f;
+        ch->hist_re[ch->pos] = ch->hist_re[ch->pos + length] = fre;
+        ch->hist_im[ch->pos] = ch->hist_im[ch->pos + length] = fim;
+        if (++ch->pos == length) ch->pos = 0;
+
+        if (++ch->phase == ch->decimation) {
+            ch->phase = 0;
+            run_block(ch, active_count);
+            if (ch->batch_count == OUTPUT_BATCH) flush_batch(ch, active_count);
+        }
+    }
+    flush_batch(ch, active_count);
+
+    for (int a = 0; a < active_count; a++) {
+        atomic_store_explicit(&ch->active_ring[a]->write_pos, ch->active_write[a],
+                              memory_order_release);
+    }
+}
+
+int channelizer_subscribe(channelizer_t *ch, int channel) {
+    if (!ch || channel < 0 || channel >= ch->channels) return -1;
+
+    channel_t *c = &ch->chan[channel];
+    channel_ring_t *ring = atomic_load(&c->ring);
+    if (!ring) {
+        ring = calloc(1, sizeof(channel_ring_t));
+        if (!ring) return -1;
+        size_t capacity = 1;
+        while (capacity < channelizer_get_output_rate(ch) * CHANNELIZER_RING_SECONDS) {
+            capacity <<= 1;
+        }
+        ring->capacity = capacity;
+        ring->data = malloc(sizeof(float) * 2 * capacity);
+        if (!ring->data) {
+            free(ring);
+            return -1;
+        }
+        atomic_init(&ring->write_pos, 0);
+        atomic_init(&ring->read_pos, 0);
+        atomic_init(&ring->dropped, 0);
+        atomic_store_explicit(&c->ring, ring, memory_order_release);
+    }
+
+    // Skip whatever was written before (consumer owns read_pos)
+    atomic_store_explicit(&ring->read_pos,
+                          atomic_load_explicit(&ring->write_pos, memory_order_acquire),
+                          memory_order_release);
+    atomic_store_explicit(&c->subscribed, 1, memory_order_release);
+    return 0;
+}
+
+void channelizer_unsubscribe(channelizer_t *ch, int channel) {
+    if (!ch || channel < 0 || channel >= ch->channels) return;
+    atomic_store_explicit(&ch->chan[channel].subscribed, 0, memory_order_release);
+}
+
+int channelizer_read(channelizer_t *ch, int channel, float *iq, int max_samples) {
+    if (!ch || !iq || max_samples <= 0 || channel < 0 || channel >= ch->channels) return 0;
+
+    channel_ring_t *ring = atomic_load_explicit(&ch->chan[channel].ring, memory_order_acquire);
+    if (!ring) return 0;
+
+    size_t read = atomic_load_explicit(&ring->read_pos, memory_order_relaxed);
+    size_t write = atomic_load_explicit(&ring->write_pos, memory_order_acquire);
+    size_t count = write - read;
+    if (count > (size_t)max_samples) count = (size_t)max_samples;
+
+    size_t mask = ring->capacity - 1;
+    size_t start = read & mask;
+    size_t first = ring->capacity - start;
+    if (first > count) first = count;
+    memcpy(iq, ring->data + start * 2, sizeof(float) * 2 * first);
+    memcpy(iq + first * 2, ring->data, sizeof(float) * 2 * (count - first));
+
+    atomic_store_explicit(&ring->read_pos, read + count, memory_order_release);
+    return (int)count;
+}
+
+long channelizer_get_dropped(channelizer_t *ch, int channel) {
+    if (!ch || channel < 0 || channel >= ch->channels) return 0;
+    channel_ring_t *ring = atomic_load_explicit(&ch->chan[channel].ring, memory_order_acquire);
+    return ring ? atomic_load_explicit(&ring->dropped, memory_order_relaxed) : 0;
+}
@@ -0,0 +1,72 @@
+#ifndef CHANNELIZER_H
+#define CHANNELIZER_H
+
+#include <stdint.h>
+
+// Polyphase FFT channelizer: splits wideband IQ into uniformly spaced
+// narrow channels in one pass.
+//
+// Channel k of N is centred k * spacing from the input centre (FFT order:
+// channels above N/2 are below the centre), spacing = input_rate / N.
+// Channels come out at twice the spacing (2x oversampled, decimation
+// N/2), flat to +-0.75 spacing and 80 dB down beyond +-1.25 spacing, so
+// every frequency is within half a spacing of a channel centre and a
+// signal up to spacing/2 wide passes undistorted.
+//
+// Cost per input sample: a 2 * CHANNELIZER_TAPS tap polyphase fold plus
+// one N-point FFT every N/2 samples, O(log N) however many channels are
+// subscribed; only subscribed channels are copied out.
+//
+// Threads: channelizer_process_s32() runs on one producer thread (the
+// radio's DSP thread). Each channel has its own lock-free single-producer
+// single-consumer ring; subscribe, read and unsubscribe a channel from
+// one consumer thread at a time.
+
+#define CHANNELIZER_TAPS 12          // Prototype filter taps per channel
+#define CHANNELIZER_RING_SECONDS 1.0 // Output buffered per subscribed channel
+
+typedef struct channelizer channelizer_t;
+
+// Create a channelizer for IQ at input_rate with channels channels
+// (a power of two, 8..4096)
+// Returns NULL on error
+channelizer_t *channelizer_new(int input_rate, int channels);
+
+// Free the channelizer and all channel rings
+void channelizer_free(channelizer_t *ch);
+
+int channelizer_get_channels(channelizer_t *ch);
+
+// Channel spacing (Hz)
+double channelizer_get_spacing(channelizer_t *ch);
+
+// Output sample rate of every channel (Hz, twice the spacing)
+double channelizer_get_output_rate(channelizer_t *ch);
+
+// Centre of a channel relative to the input centre (Hz)
+double channelizer_channel_offset(channelizer_t *ch, int channel);
+
+// Channel nearest to offset_hz from the input centre
+// residual_hz (may be NULL) receives where offset_hz lands in the channel
+// Returns the channel, or -1 if offset_hz is outside the input band
+int channelizer_find_channel(channelizer_t *ch, double offset_hz, double *residual_hz);
+
+// Channelize 32-bit LE I/Q (the FDM-DUO USB format)
+void channelizer_process_s32(channelizer_t *ch, const uint8_t *iq, int samples);
+
+// Start copying a channel into its ring (discarding anything older)
+// Returns 0 on success, -1 on invalid channel or allocation failure
+int channelizer_subscribe(channelizer_t *ch, int channel);
+
+// Stop copying a channel (its ring is kept for a later subscribe)
+void channelizer_unsubscribe(channelizer_t *ch, int channel);
+
+// Read up to max_samples complex samples (I/Q interleaved floats, full
+// scale 1.0) from a subscribed channel; never blocks
+// Returns the number of samples read
+int channelizer_read(channelizer_t *ch, int channel, float *iq, int max_samples);
+
+// Samples dropped on a channel because its consumer fell behind
+long channelizer_get_dropped(channelizer_t *ch, int channel);
+
+#endif // CHANNELIZER_H
@@ -0,0 +1,520 @@
+#define _DEFAULT_SOURCE
+#include "cw_bank.h"
+#include "rt_sched.h"
+#include "mono_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Carriers this close (Hz) are the same signal from one frame to the next
+#define CW_BANK_MATCH_HZ 30.0
+
+// Channel samples read per decoder pass
+#define CW_BANK_CHUNK 256
+
+// A decoder slot: one carrier
+typedef struct {
+    cw_decoder_t *dec;     // Kept across reuse of the slot
+    bool active;
+    double offset_hz;
+    int channel;
+    uint64_t last_seen_ms;
+} cw_slot_t;
+
+// All decoders on one channel: slots order[first .. first + count - 1]
+typedef struct {
+    int channel;
+    int first;
+    int count;
+} cw_job_t;
+
+typedef struct {
+    struct cw_bank *bank;
+    int index;
+
+    // Job deque: owner pops the tail, thieves take the head
+    pthread_mutex_t mutex;
+    int jobs[CW_BANK_MAX_DECODERS];
+    int head;
+    int tail;
+
+    float buffer[2 * CW_BANK_CHUNK];
+    atomic_llong cpu_ns;
+    pthread_t thread;
+    int thread_started;
+} cw_worker_t;
+
+struct cw_bank {
+    channelizer_t *ch;
+    double channel_rate;
+    int channels;
+
+    // Carrier list from cw_bank_update()
+    pthread_mutex_t carrier_mutex;
+    cw_carrier_t carriers[CW_BANK_MAX_DECODERS];
+    int carrier_count;
+    int carrier_generation;
+    bool clear_request;
+
+    // Scheduler thread only (workers touch only the slots of their jobs)
+    cw_carrier_t applied[CW_BANK_MAX_DECODERS];
+    int applied_generation;
+    cw_slot_t slots[CW_BANK_MAX_DECODERS];
+    int *channel_refs;  // Decoders per channel
+    int order[CW_BANK_MAX_DECODERS];
+    cw_job_t jobs[CW_BANK_MAX_DECODERS];
+    int job_count;
+
+    // Tick hand-off to the workers
+    cw_worker_t *workers;
+    int worker_count;
+    pthread_mutex_t work_mutex;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    int tick;      // Bumped when a tick's jobs are dealt
+    int pending;   // Jobs of the current tick not finished
+
+    // Published text
+    pthread_mutex_t publish_mutex;
+    cw_decoded_t decoded[CW_BANK_MAX_DECODERS];
+    int decoded_count;
+    int decoder_count;
+    int channel_count;
+
+    atomic_long steals;
+    uint64_t start_ms;
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+};
+
+// Next job for a worker: its own newest, else the oldest of another
+static int take_job(cw_worker_t *worker) {
+    int job = -1;
+    pthread_mutex_lock(&worker->mutex);
+    if (worker->tail > worker->head) job = worker->jobs[--worker->tail];
+    pthread_mutex_unlock(&worker->mutex);
+    if (job >= 0) return job;
+
+    cw_bank_t *bank = worker->bank;
+    for (int i = 1; i < bank->worker_count && job < 0; i++) {
+        cw_worker_t *victim = &bank->workers[(worker->index + i) % bank->worker_count];
+        pthread_mutex_lock(&victim->mutex);
+        if (victim->tail > victim->head) job = victim->jobs[victim->head++];
+        pthread_mutex_unlock(&victim->mutex);
+    }
+    if (job >= 0) atomic_fetch_add_explicit(&bank->steals, 1, memory_order_relaxed);
+    return job;
+}
+
+// Read everything buffered on the job's channel through its decoders
+static void run_job(cw_worker_t *worker, const cw_job_t *job) {
+    cw_bank_t *bank = worker->bank;
+    int samples;
+    while ((samples = channelizer_read(bank->ch, job->channel, worker->buffer, CW_BANK_CHUNK)) > 0) {
+        for (int i = 0; i < job->count; i++) {
+            cw_decoder_process(bank->slots[bank->order[job->first + i]].dec, worker->buffer, samples);
+        }
+    }
+}
+
+static void *worker_thread_func(void *user_data) {
+    cw_worker_t *worker = (cw_worker_t *)user_data;
+    cw_bank_t *bank = worker->bank;
+    char name[16];
+    snprintf(name, sizeof(name), "cw-%d", worker->index);
+    rt_sched_apply(name, NULL);
+
+    int seen = 0;
+    pthread_mutex_lock(&bank->work_mutex);
+    while (atomic_load(&bank->running)) {
+        if (bank->tick == seen) {
+            pthread_cond_wait(&bank->work_cond, &bank->work_mutex);
+            continue;
+        }
+        seen = bank->tick;
+        pthread_mutex_unlock(&bank->work_mutex);
+
+        uint64_t cpu_start = thread_cpu_ns();
+        int job;
+        int done = 0;
+        while ((job = take_job(worker)) >= 0) {
+            run_job(worker, &bank->jobs[job]);
+            done++;
+        }
+        atomic_fetch_add_explicit(&worker->cpu_ns, (long long)(thread_cpu_ns() - cpu_start),
+                                  memory_order_relaxed);
+
+        pthread_mutex_lock(&bank->work_mutex);
+        bank->pending -= done;
+        if (done > 0 && bank->pending == 0) pthread_cond_signal(&bank->done_cond);
+    }
+    pthread_mutex_unlock(&bank->work_mutex);
+    return NULL;
+}
+
+static void stop_slot(cw_bank_t *bank, cw_slot_t *slot) {
+    if (!slot->active) return;
+    slot->active = false;
+    if (--bank->channel_refs[slot->channel] == 0) {
+        channelizer_unsubscribe(bank->ch, slot->channel);
+    }
+}
+
+static void start_slot(cw_bank_t *bank, cw_slot_t *slot, double offset_hz, uint64_t now_ms) {
+    double residual_hz = 0.0;
+    int channel = channelizer_find_channel(bank->ch, offset_hz, &residual_hz);
+    if (channel < 0) return;
+
+    if (!slot->dec) {
+        slot->dec = cw_decoder_new(bank->channel_rate);
+        if (!slot->dec) return;
+    } else {
+        cw_decoder_reset(slot->dec);
+    }
+    if (bank->channel_refs[channel] == 0 && channelizer_subscribe(bank->ch, channel) != 0) return;
+    bank->channel_refs[channel]++;
+
+    cw_decoder_set_offset(slot->dec, residual_hz);
+    slot->active = true;
+    slot->offset_hz = offset_hz;
+    slot->channel = channel;
+    slot->last_seen_ms = now_ms;
+}
+
+// Match the carrier list against running decoders, start and retire
+static void apply_carriers(cw_bank_t *bank, uint64_t now_ms) {
+    pthread_mutex_lock(&bank->carrier_mutex);
+    bool clear = bank->clear_request;
+    bank->clear_request = false;
+    int count = 0;
+    if (bank->carrier_generation != bank->applied_generation) {
+        bank->applied_generation = bank->carrier_generation;
+        count = bank->carrier_count;
+        memcpy(bank->applied, bank->carriers, sizeof(cw_carrier_t) * count);
+    }
+    pthread_mutex_unlock(&bank->carrier_mutex);
+
+    if (clear) {
+        for (int i = 0; i < CW_BANK_MAX_DECODERS; i++) stop_slot(bank, &bank->slots[i]);
+    }
+
+    for (int c = 0; c < count; c++) {
+        double offset_hz = bank->applied[c].offset_hz;
+        cw_slot_t *match = NULL;
+        cw_slot_t *free_slot = NULL;
+        double best = CW_BANK_MATCH_HZ;
+        for (int i = 0; i < CW_BANK_MAX_DECODERS; i++) {
+            cw_slot_t *slot = &bank->slots[i];
+            if (!slot->active) {
+                if (!free_slot) free_slot = slot;
+                continue;
+            }
+            double distance = fabs(slot->offset_hz - offset_hz);
+            if (distance < best) {
+                best = distance;
+                match = slot;
+            }
+        }
+        if (match) {
+            match->last_seen_ms = now_ms;
+        } else if (free_slot) {
+            start_slot(bank, free_slot, offset_hz, now_ms);
+        }
+    }
+
+    for (int i = 0; i < CW_BANK_MAX_DECODERS; i++) {
+        cw_slot_t *slot = &bank->slots[i];
+        if (slot->active && now_ms - slot->last_seen_ms > CW_BANK_HOLD_MS) stop_slot(bank, slot);
+    }
+}
+
+// Group running decoders by channel, one job per channel
+static void build_jobs(cw_bank_t *bank) {
+    int count = 0;
+    for (int i = 0; i < CW_BANK_MAX_DECODERS; i++) {
+        if (bank->slots[i].active) bank->order[count++] = i;
+    }
+
+    // Insertion sort by channel (a few hundred at most, mostly sorted)
+    for (int i = 1; i < count; i++) {
+        int slot = bank->order[i];
+        int j = i;
+        while (j > 0 && bank->slots[bank->order[j - 1]].channel > bank->slots[slot].channel) {
+            bank->order[j] = bank->order[j - 1];
+            j--;
+        }
+        bank->order[j] = slot;
+    }
+
+    bank->job_count = 0;
+    for (int i = 0; i < count; i++) {
+        int channel = bank->slots[bank->order[i]].channel;
+        if (bank->job_count > 0 && bank->jobs[bank->job_count - 1].channel == channel) {
+            bank->jobs[bank->job_count - 1].count++;
+        } else {
+            bank->jobs[bank->job_count++] = (cw_job_t){ .channel = channel, .first = i, .count = 1 };
+        }
+    }
+}
+
+// Deal the jobs, wake the workers and wait for all jobs to finish
+static void run_tick(cw_bank_t *bank) {
+    if (bank->job_count == 0) return;
+
+    // Dealt under work_mutex, so a worker still looking for work from the
+    // last tick cannot finish a new job before pending is set
+    pthread_mutex_lock(&bank->work_mutex);
+    bank->pending = bank->job_count;
+    for (int w = 0; w < bank->worker_count; w++) {
+        cw_worker_t *worker = &bank->workers[w];
+        pthread_mutex_lock(&worker->mutex);
+        worker->head = 0;
+        worker->tail = 0;
+        for (int j = w; j < bank->job_count; j += bank->worker_count) {
+            worker->jobs[worker->tail++] = j;
+        }
+        pthread_mutex_unlock(&worker->mutex);
+    }
+
+    bank->tick++;
+    pthread_cond_broadcast(&bank->work_cond);
+    while (bank->pending > 0 && atomic_load(&bank->running)) {
+        pthread_cond_wait(&bank->done_cond, &bank->work_mutex);
+    }
+    pthread_mutex_unlock(&bank->work_mutex);
+}
+
+static void publish(cw_bank_t *bank) {
+    pthread_mutex_lock(&bank->publish_mutex);
+    int count = 0;
+    int decoders = 0;
+    for (int i = 0; i < CW_BANK_MAX_DECODERS; i++) {
+        cw_slot_t *slot = &bank->slots[i];
+        if (!slot->active) continue;
+        decoders++;
+
+        cw_decoded_t *out = &bank->decoded[count];
+        if (cw_decoder_get_text(slot->dec, out->text, sizeof(out->text)) == 0) continue;
+        out->offset_hz = slot->offset_hz;
+        out->wpm = cw_decoder_get_wpm(slot->dec);
+
+        // Keep ordered by offset
+        int j = count++;
+        while (j > 0 && bank->decoded[j - 1].offset_hz > bank->decoded[j].offset_hz) {
+            cw_decoded_t tmp = bank->decoded[j - 1];
+            bank->decoded[j - 1] = bank->decoded[j];
+            bank->decoded[j] = tmp;
+            j--;
+        }
+    }
+    bank->decoded_count = count;
+    bank->decoder_count = decoders;
+    bank->channel_count = bank->job_count;
+    pthread_mutex_unlock(&bank->publish_mutex);
+}
+
+static void *scheduler_thread_func(void *user_data) {
+    cw_bank_t *bank = (cw_bank_t *)user_data;
+    rt_sched_apply("cw-bank", NULL);
+
+    struct timespec due;
+    clock_gettime(CLOCK_MONOTONIC, &due);
+    while (atomic_load(&bank->running)) {
+        due.tv_nsec += CW_BANK_TICK_MS * 1000000L;
+        if (due.tv_nsec >= 1000000000L) {
+            due.tv_sec++;
+            due.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+
+        apply_carriers(bank, monotonic_ms());
+        build_jobs(bank);
+        run_tick(bank);
+        publish(bank);
+    }
+    return NULL;
+}
+
+cw_bank_t *cw_bank_new(channelizer_t *ch, int threads) {
+    if (!ch || threads < 0) return NULL;
+
+    if (threads == 0) {
+        // Leave a core for the DSP thread
+        threads = (int)sysconf(_SC_NPROCESSORS_ONLN) - 1;
+        if (threads < 1) threads = 1;
+    }
+    if (threads > CW_BANK_MAX_THREADS) threads = CW_BANK_MAX_THREADS;
+
+    cw_bank_t *bank = calloc(1, sizeof(cw_bank_t));
+    if (!bank) return NULL;
+
+    bank->ch = ch;
+    bank->channel_rate = channelizer_get_output_rate(ch);
+    bank->channels = channelizer_get_channels(ch);
+    bank->channel_refs = calloc(bank->channels, sizeof(int));
+    bank->workers = calloc(threads, sizeof(cw_worker_t));
+    if (!bank->channel_refs || !bank->workers) {
+        free(bank->channel_refs);
+        free(bank->workers);
+        free(bank);
+        return NULL;
+    }
+    bank->worker_count = threads;
+    for (int w = 0; w < threads; w++) {
+        bank->workers[w].bank = bank;
+        bank->workers[w].index = w;
+        pthread_mutex_init(&bank->workers[w].mutex, NULL);
+        atomic_init(&bank->workers[w].cpu_ns, 0);
+    }
+
+    pthread_mutex_init(&bank->carrier_mutex, NULL);
+    pthread_mutex_init(&bank->work_mutex, NULL);
+    pthread_cond_init(&bank->work_cond, NULL);
+    pthread_cond_init(&bank->done_cond, NULL);
+    pthread_mutex_init(&bank->publish_mutex, NULL);
+    atomic_init(&bank->steals, 0);
+    atomic_init(&bank->running, 0);
+
+    fprintf(stderr, "CW: Decoder bank on %d channels at %.0f Hz, %d worker threads\n",
+            bank->channels, bank->channel_rate, threads);
+    return bank;
+}
+
+void cw_bank_free(cw_bank_t *bank) {
+    if (!bank) return;
+
+    cw_bank_stop(bank);
+    for (int i = 0; i < CW_BANK_MAX_DECODERS; i++) {
+        stop_slot(bank, &bank->slots[i]);
+        cw_decoder_free(bank->slots[i].dec);
+    }
+    for (int w = 0; w < bank->worker_count; w++) {
+        pthread_mutex_destroy(&bank->workers[w].mutex);
+    }
+    pthread_mutex_destroy(&bank->carrier_mutex);
+    pthread_mutex_destroy(&bank->work_mutex);
+    pthread_cond_destroy(&bank->work_cond);
+    pthread_cond_destroy(&bank->done_cond);
+    pthread_mutex_destroy(&bank->publish_mutex);
+    free(bank->channel_refs);
+    free(bank->workers);
+    free(bank);
+}
+
+int cw_bank_start(cw_bank_t *bank) {
+    if (!bank) return -1;
+    if (atomic_load(&bank->running)) return 0;
+
+    atomic_store(&bank->running, 1);
+    bank->start_ms = monotonic_ms();
+    for (int w = 0; w < bank->worker_count; w++) {
+        cw_worker_t *worker = &bank->workers[w];
+        if (pthread_create(&worker->thread, NULL, worker_thread_func, worker) != 0) {
+            fprintf(stderr, "CW: Failed to create worker thread\n");
+            cw_bank_stop(bank);
+            return -1;
+        }
+        worker->thread_started = 1;
+    }
+    if (pthread_create(&bank->thread, NULL, scheduler_thread_func, bank) != 0) {
+        fprintf(stderr, "CW: Failed to create scheduler thread\n");
+        cw_bank_stop(bank);
+        return -1;
+    }
+    bank->thread_started = 1;
+    return 0;
+}
+
+void cw_bank_stop(cw_bank_t *bank) {
+    if (!bank) return;
+
+    // Wake everyone: idle workers and a scheduler waiting for a tick
+    pthread_mutex_lock(&bank->work_mutex);
+    atomic_store(&bank->running, 0);
+    pthread_cond_broadcast(&bank->work_cond);
+    pthread_cond_broadcast(&bank->done_cond);
+    pthread_mutex_unlock(&bank->work_mutex);
+
+    if (bank->thread_started) {
+        pthread_join(bank->thread, NULL);
+        bank->thread_started = 0;
+    }
+    bool joined = false;
+    for (int w = 0; w < bank->worker_count; w++) {
+        if (!bank->workers[w].thread_started) continue;
+        pthread_join(bank->workers[w].thread, NULL);
+        bank->workers[w].thread_started = 0;
+        joined = true;
+    }
+
+    if (joined) {
+        cw_bank_stats_t stats;
+        cw_bank_get_stats(bank, &stats);
+        fprintf(stderr, "CW: %d decoders, %.2f%% of one core, %ld jobs stolen\n",
+                stats.decoders, stats.cpu_load * 100.0, stats.steals);
+    }
+}
+
+void cw_bank_update(cw_bank_t *bank, const cw_carrier_t *carriers, int count) {
+    if (!bank || (!carriers && count > 0)) return;
+    if (count > CW_BANK_MAX_DECODERS) count = CW_BANK_MAX_DECODERS;
+    if (count < 0) count = 0;
+
+    pthread_mutex_lock(&bank->carrier_mutex);
+    if (count > 0) memcpy(bank->carriers, carriers, sizeof(cw_carrier_t) * count);
+    bank->carrier_count = count;
+    bank->carrier_generation++;
+    pthread_mutex_unlock(&bank->carrier_mutex);
+}
+
+void cw_bank_clear(cw_bank_t *bank) {
+    if (!bank) return;
+
+    pthread_mutex_lock(&bank->carrier_mutex);
+    bank->clear_request = true;
+    bank->carrier_count = 0;
+    bank->carrier_generation++;
+    pthread_mutex_unlock(&bank->carrier_mutex);
+
+    // Stale text must not outlive the retune until the next tick
+    pthread_mutex_lock(&bank->publish_mutex);
+    bank->decoded_count = 0;
+    pthread_mutex_unlock(&bank->publish_mutex);
+}
+
+int cw_bank_get_decoded(cw_bank_t *bank, cw_decoded_t *out, int max) {
+    if (!bank || !out || max <= 0) return 0;
+
+    pthread_mutex_lock(&bank->publish_mutex);
+    int count = bank->decoded_count < max ? bank->decoded_count : max;
+    memcpy(out, bank->decoded, sizeof(cw_decoded_t) * count);
+    pthread_mutex_unlock(&bank->publish_mutex);
+    return count;
+}
+
+void cw_bank_get_stats(cw_bank_t *bank, cw_bank_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!bank) return;
+
+    pthread_mutex_lock(&bank->publish_mutex);
+    stats->decoders = bank->decoder_count;
+    stats->channels = bank->channel_count;
+    pthread_mutex_unlock(&bank->publish_mutex);
+    stats->steals = atomic_load_explicit(&bank->steals, memory_order_relaxed);
+
+    long long cpu_ns = 0;
+    for (int w = 0; w < bank->worker_count; w++) {
+        cpu_ns += atomic_load_explicit(&bank->workers[w].cpu_ns, memory_order_relaxed);
+    }
+    uint64_t elapsed_ms = monotonic_ms() - bank->start_ms;
+    if (bank->start_ms > 0 && elapsed_ms > 0) stats->cpu_load = cpu_ns / 1e6 / (double)elapsed_ms;
+}
@@ -0,0 +1,74 @@
+#ifndef CW_BANK_H
+#define CW_BANK_H
+
+#include "channelizer.h"
+#include "cw_decoder.h"
+
+// Bank of CW decoders, one per carrier, fed by a channelizer.
+//
+// The carrier list (from the signal detector) arrives from any thread;
+// a scheduler thread matches it against running decoders every
+// CW_BANK_TICK_MS, starting a decoder (and subscribing its channel) for
+// each new carrier and retiring decoders whose carrier has been gone for
+// CW_BANK_HOLD_MS. Decoders sharing a channel form one job, since the
+// channel is read once for all of them. Each tick the jobs are dealt
+// round-robin onto per-worker deques; a worker pops its own deque from
+// the tail and, once empty, steals from the head of the others, so a
+// worker stuck with a crowded channel does not hold up the tick.
+//
+// Decoded text is published after every tick for the GTK thread.
+
+#define CW_BANK_MAX_DECODERS 256
+#define CW_BANK_MAX_THREADS 8
+#define CW_BANK_TICK_MS 20
+#define CW_BANK_HOLD_MS 5000
+
+typedef struct cw_bank cw_bank_t;
+
+// A carrier to decode
+typedef struct {
+    double offset_hz;  // From the channelizer input centre
+} cw_carrier_t;
+
+// Latest text of one decoder
+typedef struct {
+    double offset_hz;
+    float wpm;
+    char text[CW_DECODER_TEXT_LEN + 1];
+} cw_decoded_t;
+
+typedef struct {
+    int decoders;      // Running
+    int channels;      // Subscribed
+    long steals;       // Jobs run by a worker other than the one dealt
+    double cpu_load;   // Worker CPU time over wall time (1.0 = one core)
+} cw_bank_stats_t;
+
+// Create a bank reading from ch (not owned, must outlive the bank) with
+// threads workers (0 = one per core but one, at most CW_BANK_MAX_THREADS)
+// Returns NULL on error
+cw_bank_t *cw_bank_new(channelizer_t *ch, int threads);
+
+// Stop the threads, unsubscribe all channels and free the bank
+void cw_bank_free(cw_bank_t *bank);
+
+// Start scheduler and worker threads
+// Returns 0 on success, -1 on error
+int cw_bank_start(cw_bank_t *bank);
+
+// Stop all threads (blocks until they exit)
+void cw_bank_stop(cw_bank_t *bank);
+
+// Replace the carrier list (any thread, carriers copied)
+void cw_bank_update(cw_bank_t *bank, const cw_carrier_t *carriers, int count);
+
+// Drop all decoders (after a retune: offsets no longer mean the same)
+void cw_bank_clear(cw_bank_t *bank);
+
+// Copy up to max decoders with text, ordered by offset
+// Returns the number copied
+int cw_bank_get_decoded(cw_bank_t *bank, cw_decoded_t *out, int max);
+
+void cw_bank_get_stats(cw_bank_t *bank, cw_bank_stats_t *stats);
+
+#endif // CW_BANK_H
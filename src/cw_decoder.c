@@ -0,0 +1,314 @@
+#define _DEFAULT_SOURCE
+#include "cw_decoder.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+
+// Lowpass: four one-pole sections at this corner (about 35 Hz each side
+// overall, 40 dB down 300 Hz away)
+#define FILTER_SECTIONS 4
+#define FILTER_CORNER_HZ 80.0
+
+// Envelope rate (key timing resolution)
+#define ENVELOPE_RATE_HZ 500.0
+
+// Key down above THRESHOLD * peak * HYSTERESIS, up below
+// THRESHOLD * peak / HYSTERESIS: half the peak amplitude, where a keyed
+// carrier is well clear of both its own fading and the noise
+#define THRESHOLD 0.25f
+#define HYSTERESIS 1.4f
+#define PEAK_DECAY_S 2.0
+
+// Squelch: mean power while key down over mean power while key up (after
+// SPACE_GUARD_DOTS, clear of the filter's decay) must reach 10 dB, or the
+// "marks" are just noise peaks and nothing is printed
+#define LEVEL_S 0.5
+#define SPACE_GUARD_DOTS 1.5f
+#define SQUELCH_RATIO 10.0f
+
+// A new key state must last this share of a dot (or 6 ms) to count
+#define DEBOUNCE_DOTS 0.2f
+#define DEBOUNCE_MIN_MS 6.0f
+
+// Dot length limits (60 and 5 WPM) and start value (20 WPM)
+#define DOT_MIN_MS 20.0f
+#define DOT_MAX_MS 240.0f
+#define DOT_START_MS 60.0f
+
+// Marks shorter than this share of a dot (or 8 ms) are noise
+#define GLITCH_DOTS 0.3f
+#define GLITCH_MIN_MS 8.0f
+
+// Longest character in elements
+#define MAX_ELEMENTS 7
+
+static const struct {
+    const char *code;
+    char c;
+} morse_table[] = {
+    { ".-", 'A' },     { "-...", 'B' },   { "-.-.", 'C' },   { "-..", 'D' },
+    { ".", 'E' },      { "..-.", 'F' },   { "--.", 'G' },    { "....", 'H' },
+    { "..", 'I' },     { ".---", 'J' },   { "-.-", 'K' },    { ".-..", 'L' },
+    { "--", 'M' },     { "-.", 'N' },     { "---", 'O' },    { ".--.", 'P' },
+    { "--.-", 'Q' },   { ".-.", 'R' },    { "...", 'S' },    { "-", 'T' },
+    { "..-", 'U' },    { "...-", 'V' },   { ".--", 'W' },    { "-..-", 'X' },
+    { "-.--", 'Y' },   { "--..", 'Z' },
+    { "-----", '0' },  { ".----", '1' },  { "..---", '2' },  { "...--", '3' },
+    { "....-", '4' },  { ".....", '5' },  { "-....", '6' },  { "--...", '7' },
+    { "---..", '8' },  { "----.", '9' },
+    { ".-.-.-", '.' }, { "--..--", ',' }, { "..--..", '?' }, { "-..-.", '/' },
+    { "-...-", '=' },  { ".-.-.", '+' },  { "-....-", '-' }, { ".--.-.", '@' },
+    { "---...", ':' }, { "-.--.", '(' },  { "-.--.-", ')' }, { ".----.", '\'' },
+};
+
+struct cw_decoder {
+    double sample_rate;
+
+    // NCO (unit phasor, renormalized every call)
+    float nco_re, nco_im;
+    float step_re, step_im;
+
+    // Lowpass state and coefficient
+    float lp_re[FILTER_SECTIONS];
+    float lp_im[FILTER_SECTIONS];
+    float lp_alpha;
+
+    // Envelope
+    int env_decim;        // Channel samples per envelope sample
+    int env_count;
+    float env_ms;         // Duration of one envelope sample
+    float peak;
+    float peak_decay;     // Per envelope sample
+    float mark_level;     // Mean power key down
+    float space_level;    // Mean power key up
+    float level_alpha;
+
+    // Keying
+    bool key_down;
+    float state_ms;       // Time in the current key state
+    float pending_ms;     // Time the envelope has disagreed with it
+    float dot_ms;
+    char elements[MAX_ELEMENTS + 1];
+    int element_count;
+    bool word_ended;      // Space already emitted for this gap
+
+    char text[CW_DECODER_TEXT_LEN + 1];
+    int text_len;
+};
+
+cw_decoder_t *cw_decoder_new(double sample_rate) {
+    if (sample_rate <= 0.0) return NULL;
+
+    cw_decoder_t *dec = calloc(1, sizeof(cw_decoder_t));
+    if (!dec) return NULL;
+
+    dec->sample_rate = sample_rate;
+    dec->lp_alpha = (float)(1.0 - exp(-2.0 * M_PI * FILTER_CORNER_HZ / sample_rate));
+    dec->env_decim = (int)(sample_rate / ENVELOPE_RATE_HZ);
+    if (dec->env_decim < 1) dec->env_decim = 1;
+    double env_rate = sample_rate / dec->env_decim;
+    dec->env_ms = (float)(1000.0 / env_rate);
+    dec->peak_decay = (float)exp(-1.0 / (PEAK_DECAY_S * env_rate));
+    dec->level_alpha = (float)(1.0 - exp(-1.0 / (LEVEL_S * env_rate)));
+
+    cw_decoder_set_offset(dec, 0.0);
+    cw_decoder_reset(dec);
+    return dec;
+}
+
+void cw_decoder_free(cw_decoder_t *dec) {
+    free(dec);
+}
+
+void cw_decoder_reset(cw_decoder_t *dec) {
+    if (!dec) return;
+
+    dec->nco_re = 1.0f;
+    dec->nco_im = 0.0f;
+    memset(dec->lp_re, 0, sizeof(dec->lp_re));
+    memset(dec->lp_im, 0, sizeof(dec->lp_im));
+    dec->env_count = 0;
+    dec->peak = 0.0f;
+    dec->mark_level = 0.0f;
+    dec->space_level = 0.0f;
+    dec->key_down = false;
+    dec->state_ms = 0.0f;
+    dec->pending_ms = 0.0f;
+    dec->dot_ms = DOT_START_MS;
+    dec->element_count = 0;
+    dec->word_ended = true;
+    dec->text_len = 0;
+    dec->text[0] = '\0';
+}
+
+void cw_decoder_set_offset(cw_decoder_t *dec, double offset_hz) {
+    if (!dec) return;
+    double step = -2.0 * M_PI * offset_hz / dec->sample_rate;
+    dec->step_re = (float)cos(step);
+    dec->step_im = (float)sin(step);
+}
+
+static void append_char(cw_decoder_t *dec, char c) {
+    if (dec->text_len == CW_DECODER_TEXT_LEN) {
+        memmove(dec->text, dec->text + 1, CW_DECODER_TEXT_LEN - 1);
+        dec->text_len--;
+    }
+    dec->text[dec->text_len++] = c;
+    dec->text[dec->text_len] = '\0';
+}
+
+// Marks not clearly above the gaps between them: noise
+static bool squelched(const cw_decoder_t *dec) {
+    return dec->space_level == 0.0f || dec->mark_level < dec->space_level * SQUELCH_RATIO;
+}
+
+// Character gap: look up the elements collected so far
+static void end_character(cw_decoder_t *dec) {
+    if (dec->element_count == 0) return;
+
+    if (squelched(dec)) {
+        dec->element_count = 0;
+        return;
+    }
+
+    dec->elements[dec->element_count] = '\0';
+    char c = '*';  // Not a known character
+    for (size_t i = 0; i < sizeof(morse_table) / sizeof(morse_table[0]); i++) {
+        if (strcmp(morse_table[i].code, dec->elements) == 0) {
+            c = morse_table[i].c;
+            break;
+        }
+    }
+    append_char(dec, c);
+    dec->element_count = 0;
+    dec->word_ended = false;
+}
+
+// A mark ended: dot or dash, and adapt the dot length
+static void end_mark(cw_decoder_t *dec, float mark_ms) {
+    float glitch_ms = fmaxf(GLITCH_MIN_MS, GLITCH_DOTS * dec->dot_ms);
+    if (mark_ms < glitch_ms) return;
+
+    bool dash = mark_ms > 2.0f * dec->dot_ms;
+    float estimate = dash ? mark_ms / 3.0f : mark_ms;
+    dec->dot_ms += 0.25f * (estimate - dec->dot_ms);
+    if (dec->dot_ms < DOT_MIN_MS) dec->dot_ms = DOT_MIN_MS;
+    if (dec->dot_ms > DOT_MAX_MS) dec->dot_ms = DOT_MAX_MS;
+
+    if (dec->element_count < MAX_ELEMENTS) {
+        dec->elements[dec->element_count++] = dash ? '-' : '.';
+    } else {
+        // Too long for any character: flush what we have as unknown
+        dec->element_count = 0;
+        if (!squelched(dec)) append_char(dec, '*');
+    }
+}
+
+// One envelope sample (power)
+static void envelope_sample(cw_decoder_t *dec, float power) {
+    // Peak: instant attack, slow decay
+    if (power > dec->peak) {
+        dec->peak = power;
+    } else {
+        dec->peak *= dec->peak_decay;
+    }
+
+    float threshold = THRESHOLD * dec->peak;
+    bool down = dec->key_down;
+    if (dec->key_down && power < threshold / HYSTERESIS) down = false;
+    if (!dec->key_down && power > threshold * HYSTERESIS) down = true;
+
+    // Levels only from samples settled in the current state
+    if (down == dec->key_down) {
+        float *level = NULL;
+        if (down) {
+            level = &dec->mark_level;
+        } else if (dec->state_ms > SPACE_GUARD_DOTS * dec->dot_ms) {
+            level = &dec->space_level;
+        }
+        if (level && *level == 0.0f) {
+            *level = power;
+        } else if (level) {
+            *level += (power - *level) * dec->level_alpha;
+        }
+    }
+
+    // Debounce: the new state takes over once it has lasted long enough,
+    // and keeps the time it took to get there
+    dec->state_ms += dec->env_ms;
+    if (down != dec->key_down) {
+        dec->pending_ms += dec->env_ms;
+        if (dec->pending_ms >= fmaxf(DEBOUNCE_MIN_MS, DEBOUNCE_DOTS * dec->dot_ms)) {
+            if (dec->key_down) end_mark(dec, dec->state_ms - dec->pending_ms);
+            dec->key_down = down;
+            dec->state_ms = dec->pending_ms;
+            dec->pending_ms = 0.0f;
+        }
+    } else {
+        dec->pending_ms = 0.0f;
+    }
+
+    // Gaps end characters and words without waiting for the next mark
+    if (!dec->key_down) {
+        if (dec->element_count > 0 && dec->state_ms > 2.0f * dec->dot_ms) {
+            end_character(dec);
+        }
+        if (!dec->word_ended && dec->state_ms > 5.0f * dec->dot_ms) {
+            append_char(dec, ' ');
+            dec->word_ended = true;
+        }
+    }
+}
+
+void cw_decoder_process(cw_decoder_t *dec, const float *iq, int samples) {
+    if (!dec || !iq) return;
+
+    float alpha = dec->lp_alpha;
+    for (int i = 0; i < samples; i++) {
+        float in_re = iq[2 * i];
+        float in_im = iq[2 * i + 1];
+
+        // Mix the carrier to 0 Hz
+        float re = in_re * dec->nco_re - in_im * dec->nco_im;
+        float im = in_re * dec->nco_im + in_im * dec->nco_re;
+        float nre = dec->nco_re * dec->step_re - dec->nco_im * dec->step_im;
+        dec->nco_im = dec->nco_re * dec->step_im + dec->nco_im * dec->step_re;
+        dec->nco_re = nre;
+
+        for (int s = 0; s < FILTER_SECTIONS; s++) {
+            dec->lp_re[s] += (re - dec->lp_re[s]) * alpha;
+            dec->lp_im[s] += (im - dec->lp_im[s]) * alpha;
+            re = dec->lp_re[s];
+            im = dec->lp_im[s];
+        }
+
+        if (++dec->env_count == dec->env_decim) {
+            dec->env_count = 0;
+            envelope_sample(dec, re * re + im * im);
+        }
+    }
+
+    // Keep the phasor on the unit circle
+    float mag = sqrtf(dec->nco_re * dec->nco_re + dec->nco_im * dec->nco_im);
+    if (mag > 0.0f) {
+        dec->nco_re /= mag;
+        dec->nco_im /= mag;
+    }
+}
+
+int cw_decoder_get_text(cw_decoder_t *dec, char *text, int size) {
+    if (!text || size <= 0) return 0;
+    text[0] = '\0';
+    if (!dec) return 0;
+
+    int len = dec->text_len < size - 1 ? dec->text_len : size - 1;
+    memcpy(text, dec->text + dec->text_len - len, len);
+    text[len] = '\0';
+    return len;
+}
+
+float cw_decoder_get_wpm(cw_decoder_t *dec) {
+    return dec ? 1200.0f / dec->dot_ms : 0.0f;
+}
@@ -0,0 +1,47 @@
+#ifndef CW_DECODER_H
+#define CW_DECODER_H
+
+// Morse decoder for one carrier in a channelizer channel.
+//
+//   mix    NCO moves the carrier from its offset in the channel to 0 Hz
+//   filter four cascaded one-pole lowpass sections (I/Q), ~40 Hz wide
+//   detect power envelope at ~500 Hz, key up/down at half the amplitude
+//          of a fast-attack slow-decay peak, with hysteresis and
+//          debouncing; squelched unless marks are 10 dB above the gaps
+//   timing marks classified against the tracked dot length (dot < 2 dots
+//          < dash), gaps of 2 / 5 dots end a character / word
+//   table  dot/dash string -> character
+//
+// A few dozen operations per channel sample, so a bank of decoders costs
+// little next to the channelizer feeding it. Not thread-safe: one thread
+// at a time processes and reads a decoder.
+
+#define CW_DECODER_TEXT_LEN 40  // Most recent characters kept
+
+typedef struct cw_decoder cw_decoder_t;
+
+// Create a decoder for complex samples at sample_rate (Hz)
+// Returns NULL on error
+cw_decoder_t *cw_decoder_new(double sample_rate);
+
+// Free the decoder
+void cw_decoder_free(cw_decoder_t *dec);
+
+// Forget levels, timing and text (new carrier)
+void cw_decoder_reset(cw_decoder_t *dec);
+
+// Carrier frequency relative to the centre of the input (Hz)
+void cw_decoder_set_offset(cw_decoder_t *dec, double offset_hz);
+
+// Decode samples complex samples (I/Q interleaved floats)
+void cw_decoder_process(cw_decoder_t *dec, const float *iq, int samples);
+
+// Copy the decoded text (oldest first, NUL-terminated, at most
+// CW_DECODER_TEXT_LEN characters)
+// Returns the length copied
+int cw_decoder_get_text(cw_decoder_t *dec, char *text, int size);
+
+// Current speed estimate in words per minute (PARIS timing)
+float cw_decoder_get_wpm(cw_decoder_t *dec);
+
+#endif // CW_DECODER_H
@@ -0,0 +1,244 @@
+#define _DEFAULT_SOURCE
+#include "ddc.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+
+#define CIC_ORDER 5
+#define FIR_TAPS 95  // Odd, symmetric
+
+// Fixed-point scale for CIC input: integrators wrap modulo 2^64, which
+// is exact for a CIC as long as the output fits (24 + 5*log2(8) bits)
+#define CIC_SCALE 8388608.0  // 2^23
+
+// FIR band edges relative to the FIR output Nyquist frequency
+#define FIR_PASS_EDGE DDC_PASS_FRACTION
+#define FIR_STOP_EDGE 1.0
+
+// Renormalize NCO phasor this often (keeps |phasor| = 1)
+#define NCO_RENORM_INTERVAL 1024
+
+struct ddc {
+    int decimation;      // Total decimation (1 = bypass)
+    int cic_decimation;  // CIC stage (decimation / 2)
+
+    // NCO
+    double nco_re, nco_im;
+    double step_re, step_im;
+    int nco_count;
+
+    // CIC state per channel (I, Q); unsigned for defined wraparound
+    uint64_t integ[2][CIC_ORDER];
+    uint64_t comb[2][CIC_ORDER];
+    int cic_phase;
+    double cic_norm;  // 1 / (CIC_SCALE * R^order)
+
+    // Decimate-by-2 FIR (history duplicated so taps read contiguously)
+    float taps[FIR_TAPS];
+    float fir_hist[2][FIR_TAPS * 2];
+    int fir_pos;
+    int fir_phase;
+};
+
+ddc_t *ddc_new(void) {
+    ddc_t *ddc = calloc(1, sizeof(ddc_t));
+    if (!ddc) return NULL;
+    ddc->decimation = 1;
+    ddc->cic_decimation = 1;
+    ddc->nco_re = 1.0;
+    ddc->step_re = 1.0;
+    return ddc;
+}
+
+void ddc_free(ddc_t *ddc) {
+    free(ddc);
+}
+
+// CIC magnitude response at frequency f (cycles per CIC input sample)
+static double cic_response(double f, int r) {
+    if (r <= 1 || f == 0.0) return 1.0;
+    double num = sin(M_PI * f * r);
+    double den = r * sin(M_PI * f);
+    return pow(fabs(num / den), CIC_ORDER);
+}
+
+// Frequency-sampling design of the compensating low-pass FIR
+// Desired response: 1/CIC droop in the passband, cosine taper to zero
+// at the stopband edge; Blackman window on the result
+static void design_fir(float *taps, int r) {
+    const double pass = FIR_PASS_EDGE * 0.25;  // Cycles per FIR input sample
+    const double stop = FIR_STOP_EDGE * 0.25;
+    const int grid = 2048;
+    const double center = (FIR_TAPS - 1) / 2.0;
+    double sum = 0.0;
+    double h[FIR_TAPS];
+
+    for (int n = 0; n < FIR_TAPS; n++) {
+        double acc = 0.0;
+        for (int k = 0; k < grid; k++) {
+            double f = (k + 0.5) * 0.5 / grid;
+            double a;
+            if (f <= pass) {
+                a = 1.0 / cic_response(f / r, r);
+            } else if (f < stop) {
+                double t = (f - pass) / (stop - pass);
+                a = 0.5 * (1.0 + cos(M_PI * t)) / cic_response(f / r, r);
+            } else {
+                break;
+            }
+            acc += a * cos(2.0 * M_PI * f * (n - center));
+        }
+        acc *= 2.0 * 0.5 / grid;
+
+        double x = (double)n / (FIR_TAPS - 1);
+        double w = 0.42 - 0.5 * cos(2.0 * M_PI * x) + 0.08 * cos(4.0 * M_PI * x);
+        h[n] = acc * w;
+        sum += h[n];
+    }
+
+    // Unity gain at DC (after CIC normalization)
+    for (int n = 0; n < FIR_TAPS; n++) {
+        taps[n] = (float)(h[n] / sum);
+    }
+}
+
+int ddc_configure(ddc_t *ddc, int decimation, double nco_freq) {
+    if (!ddc) return -1;
+    if (decimation < 1 || decimation > DDC_MAX_DECIMATION || (decimation & (decimation - 1)) != 0) {
+        return -1;
+    }
+
+    ddc->decimation = decimation;
+    ddc->cic_decimation = decimation > 1 ? decimation / 2 : 1;
+
+    // NCO rotates by -nco_freq so that frequency lands at DC
+    ddc->nco_re = 1.0;
+    ddc->nco_im = 0.0;
+    ddc->step_re = cos(-2.0 * M_PI * nco_freq);
+    ddc->step_im = sin(-2.0 * M_PI * nco_freq);
+    ddc->nco_count = 0;
+
+    memset(ddc->integ, 0, sizeof(ddc->integ));
+    memset(ddc->comb, 0, sizeof(ddc->comb));
+    ddc->cic_phase = 0;
+    ddc->cic_norm = 1.0 / (CIC_SCALE * pow(ddc->cic_decimation, CIC_ORDER));
+
+    if (decimation > 1) {
+        design_fir(ddc->taps, ddc->cic_decimation);
+    }
+    memset(ddc->fir_hist, 0, sizeof(ddc->fir_hist));
+    ddc->fir_pos = 0;
+    ddc->fir_phase = 0;
+    return 0;
+}
+
+void ddc_set_nco(ddc_t *ddc, double nco_freq) {
+    if (!ddc) return;
+    ddc->step_re = cos(-2.0 * M_PI * nco_freq);
+    ddc->step_im = sin(-2.0 * M_PI * nco_freq);
+}
+
+int ddc_get_decimation(ddc_t *ddc) {
+    return ddc ? ddc->decimation : 1;
+}
+
+double ddc_get_delay(ddc_t *ddc) {
+    if (!ddc || ddc->decimation == 1) return 0.0;
+    // CIC: order * (R - 1) / 2 input samples; FIR: (taps - 1) / 2 of its
+    // inputs, two per output sample
+    double cic = CIC_ORDER * (ddc->cic_decimation - 1) / 2.0 / ddc->decimation;
+    return cic + (FIR_TAPS - 1) / 4.0;
+}
+
+// Run one CIC channel on a new input; returns true with *out set every R inputs
+static int cic_step(ddc_t *ddc, int ch, double x, double *out) {
+    uint64_t v = (uint64_t)(int64_t)llround(x * CIC_SCALE);
+    for (int s = 0; s < CIC_ORDER; s++) {
+        ddc->integ[ch][s] += v;
+        v = ddc->integ[ch][s];
+    }
+    if (ddc->cic_phase != ddc->cic_decimation - 1) return 0;
+
+    for (int s = 0; s < CIC_ORDER; s++) {
+        uint64_t prev = ddc->comb[ch][s];
+        ddc->comb[ch][s] = v;
+        v -= prev;
+    }
+    *out = (double)(int64_t)v * ddc->cic_norm;
+    return 1;
+}
+
+// Push one sample into the FIR; returns true with output on every 2nd input
+static int fir_step(ddc_t *ddc, float i_in, float q_in, float *i_out, float *q_out) {
+    int pos = ddc->fir_pos;
+    ddc->fir_hist[0][pos] = ddc->fir_hist[0][pos + FIR_TAPS] = i_in;
+    ddc->fir_hist[1][pos] = ddc->fir_hist[1][pos + FIR_TAPS] = q_in;
+    ddc->fir_pos = (pos + 1) % FIR_TAPS;
+
+    ddc->fir_phase ^= 1;
+    if (ddc->fir_phase) return 0;
+
+    // Oldest sample at fir_pos; taps are symmetric so order doesn't matter
+    const float *hi = &ddc->fir_hist[0][ddc->fir_pos];
+    const float *hq = &ddc->fir_hist[1][ddc->fir_pos];
+    const int half = FIR_TAPS / 2;
+    float acc_i = ddc->taps[half] * hi[half];
+    float acc_q = ddc->taps[half] * hq[half];
+    for (int k = 0; k < half; k++) {
+        float t = ddc->taps[k];
+        acc_i += t * (hi[k] + hi[FIR_TAPS - 1 - k]);
+        acc_q += t * (hq[k] + hq[FIR_TAPS - 1 - k]);
+    }
+    *i_out = acc_i;
+    *q_out = acc_q;
+    return 1;
+}
+
+int ddc_process(ddc_t *ddc, const float *input, int count, float *output) {
+    if (!ddc || !input || !output || count <= 0) return 0;
+
+    if (ddc->decimation == 1) {
+        memcpy(output, input, sizeof(float) * 2 * count);
+        return count;
+    }
+
+    int produced = 0;
+    for (int n = 0; n < count; n++) {
+        // NCO mix
+        double i_in = input[n * 2];
+        double q_in = input[n * 2 + 1];
+        double i_mix = i_in * ddc->nco_re - q_in * ddc->nco_im;
+        double q_mix = i_in * ddc->nco_im + q_in * ddc->nco_re;
+
+        double re = ddc->nco_re * ddc->step_re - ddc->nco_im * ddc->step_im;
+        double im = ddc->nco_re * ddc->step_im + ddc->nco_im * ddc->step_re;
+        ddc->nco_re = re;
+        ddc->nco_im = im;
+        if (++ddc->nco_count >= NCO_RENORM_INTERVAL) {
+            double mag = sqrt(re * re + im * im);
+            ddc->nco_re /= mag;
+            ddc->nco_im /= mag;
+            ddc->nco_count = 0;
+        }
+
+        // CIC decimation (bypassed for R = 1)
+        double i_cic = i_mix;
+        double q_cic = q_mix;
+        if (ddc->cic_decimation > 1) {
+            int ready = cic_step(ddc, 0, i_mix, &i_cic);
+            cic_step(ddc, 1, q_mix, &q_cic);
+            ddc->cic_phase = (ddc->cic_phase + 1) % ddc->cic_decimation;
+            if (!ready) continue;
+        }
+
+        // Compensating FIR, decimate by 2
+        float i_out, q_out;
+        if (fir_step(ddc, (float)i_cic, (float)q_cic, &i_out, &q_out)) {
+            output[produced * 2] = i_out;
+            output[produced * 2 + 1] = q_out;
+            produced++;
+        }
+    }
+    return produced;
+}
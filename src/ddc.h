@@ -0,0 +1,48 @@
+#ifndef DDC_H
+#define DDC_H
+
+// Digital down-converter for zoom FFT:
+//   NCO mix (shift pan centre to DC) -> CIC decimate by R/2 ->
+//   CIC-compensating FIR decimate by 2
+// Output rate is input rate / decimation, with the passband flat to
+// DDC_PASS_FRACTION of the output Nyquist frequency; the outer
+// DDC_EDGE_FRACTION of the output span on each side is attenuated and may
+// carry aliases, so displays mark it.
+
+typedef struct ddc ddc_t;
+
+#define DDC_PASS_FRACTION 0.8
+#define DDC_EDGE_FRACTION ((1.0 - DDC_PASS_FRACTION) / 2)
+
+// Maximum total decimation (zoom level)
+#define DDC_MAX_DECIMATION 16
+
+// Create down-converter (bypassed until configured)
+ddc_t *ddc_new(void);
+
+// Free down-converter
+void ddc_free(ddc_t *ddc);
+
+// Set total decimation (1 = bypass, or a power of two up to
+// DDC_MAX_DECIMATION) and NCO frequency in cycles per input sample
+// (-0.5 to 0.5, the frequency moved to DC). Resets filter state.
+// Returns 0 on success, -1 on invalid decimation
+int ddc_configure(ddc_t *ddc, int decimation, double nco_freq);
+
+// Move the NCO to nco_freq (cycles per input sample) without resetting
+// the phase or the filter state, so a pan is a pure frequency shift of
+// the output
+void ddc_set_nco(ddc_t *ddc, double nco_freq);
+
+// Get configured decimation
+int ddc_get_decimation(ddc_t *ddc);
+
+// Group delay from input to output, in output samples
+double ddc_get_delay(ddc_t *ddc);
+
+// Process count interleaved I/Q samples from input into output
+// Output must hold count / decimation + 1 samples; may not alias input
+// Returns number of output samples written
+int ddc_process(ddc_t *ddc, const float *input, int count, float *output);
+
+#endif // DDC_H
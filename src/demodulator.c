@@ -0,0 +1,549 @@
+#define _DEFAULT_SOURCE
+#include "demodulator.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <math.h>
+
+typedef float v8sf __attribute__((vector_size(32)));
+
+// Input samples handled per internal block
+#define DEMOD_BLOCK 2048
+
+// Stopband attenuation of all filters
+#define FILTER_ATTEN_DB 70.0
+
+// Longest filter per polyphase branch
+#define MAX_PHASE_TAPS 1024
+
+// Filters used when the radio does not report one
+#define DEFAULT_AM_BW_HZ 6000
+#define DEFAULT_SSB_BW_HZ 2700
+#define DEFAULT_CW_BW_HZ 500
+#define DEFAULT_FM_DEVIATION_HZ 5000
+
+// Lower passband edge of SSB filters measured from the carrier
+#define SSB_LOW_HZ 150
+
+// Audio bandwidth of FM speech (Carson: channel = 2 * (deviation + audio))
+#define FM_AUDIO_HZ 3500
+
+// AGC: output level, release time, and the level below which gain stops rising
+#define AGC_TARGET 0.3f
+#define AGC_RELEASE_S 0.3
+#define AGC_MIN_LEVEL 1e-6f
+
+// AM carrier tracking time constant (DC removal and carrier AGC)
+#define AM_CARRIER_S 0.2
+
+// Polyphase L/M resampler with real coefficients on one (real) or two
+// (complex, split re/im) streams. Each branch's taps are stored oldest
+// first, so an output is one contiguous dot product over the history.
+typedef struct {
+    int interp;      // L
+    int decim;       // M
+    int taps;        // Taps per branch (multiple of 8)
+    float *coef;     // interp * taps
+    float *hist[2];  // Doubled ring: a window never wraps
+    int pos;
+    int phase;       // Branch of the next output
+} polyphase_t;
+
+struct demodulator {
+    int input_rate;
+    demod_mode_t mode;
+    int bandwidth_hz;
+    int offset_hz;
+
+    int channel_rate;
+    int audio_factor;  // 48 kHz / channel rate
+
+    // NCO at the input rate, 8 lanes one sample apart
+    double nco_phase;
+    double nco_step;   // Radians per input sample
+    float nco_re[8];
+    float nco_im[8];
+
+    polyphase_t resamp;   // Input -> channel rate (complex)
+    polyphase_t channel;  // Channel filter (complex)
+    polyphase_t interp;   // Channel rate -> 48 kHz (audio)
+
+    // Detector state
+    double osc_phase;
+    double osc_step;      // Second oscillator, radians per channel sample
+    float fm_prev_re;
+    float fm_prev_im;
+    float fm_scale;
+    float am_carrier;
+    float am_alpha;
+    float agc_level;
+    float agc_decay;
+
+    // Scratch (DEMOD_BLOCK input samples and what they become)
+    int scratch_size;
+    float *in_re, *in_im;
+    float *ch_re, *ch_im;
+    float *flt_re, *flt_im;
+    float *det;
+};
+
+static int gcd(int a, int b) {
+    while (b) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < sum * 1e-12) break;
+    }
+    return sum;
+}
+
+// Kaiser-windowed sinc lowpass with unity DC gain
+// Returns the number of taps written (odd), or -1 on allocation failure
+static int design_lowpass(float **out, double rate, double cutoff_hz, double transition_hz,
+                          int max_taps) {
+    double beta = 0.1102 * (FILTER_ATTEN_DB - 8.7);
+    int n = (int)ceil((FILTER_ATTEN_DB - 7.95) / (2.285 * 2.0 * M_PI * transition_hz / rate)) + 1;
+    if (n > max_taps) n = max_taps;
+    if (n < 3) n = 3;
+    n |= 1;
+
+    float *h = malloc(sizeof(float) * n);
+    if (!h) return -1;
+
+    double fc = cutoff_hz / rate;
+    double mid = (n - 1) / 2.0;
+    double sum = 0.0;
+    for (int i = 0; i < n; i++) {
+        double x = i - mid;
+        double sinc = x == 0.0 ? 2.0 * fc : sin(2.0 * M_PI * fc * x) / (M_PI * x);
+        double r = x / mid;
+        double w = bessel_i0(beta * sqrt(1.0 - r * r)) / bessel_i0(beta);
+        h[i] = (float)(sinc * w);
+        sum += h[i];
+    }
+    for (int i = 0; i < n; i++) h[i] = (float)(h[i] / sum);
+
+    *out = h;
+    return n;
+}
+
+static void polyphase_free(polyphase_t *p) {
+    free(p->coef);
+    free(p->hist[0]);
+    free(p->hist[1]);
+    memset(p, 0, sizeof(*p));
+}
+
+// Split a prototype (designed at the input rate * interp) into branches
+// Returns 0 on success, -1 on allocation failure
+static int polyphase_init(polyphase_t *p, int interp, int decim, const float *proto, int length,
+                          int streams) {
+    memset(p, 0, sizeof(*p));
+    p->interp = interp;
+    p->decim = decim;
+    p->taps = ((length + interp - 1) / interp + 7) & ~7;
+    p->coef = calloc((size_t)interp * p->taps, sizeof(float));
+    for (int s = 0; s < streams; s++) {
+        p->hist[s] = calloc((size_t)p->taps * 2, sizeof(float));
+        if (!p->hist[s]) break;
+    }
+    if (!p->coef || !p->hist[0] || (streams == 2 && !p->hist[1])) {
+        polyphase_free(p);
+        return -1;
+    }
+
+    // Branch b, tap k applies to x[n - k]: proto[b + k * interp], scaled
+    // by interp to keep unity gain when interpolating
+    for (int b = 0; b < interp; b++) {
+        float *branch = p->coef + (size_t)b * p->taps;
+        for (int k = 0; b + k * interp < length; k++) {
+            branch[p->taps - 1 - k] = proto[b + k * interp] * interp;
+        }
+    }
+    return 0;
+}
+
+static float dot(const float *a, const float *b, int n) {
+    v8sf acc0 = { 0 }, acc1 = { 0 };
+    int i = 0;
+    for (; i + 16 <= n; i += 16) {
+        v8sf a0, a1, b0, b1;
+        memcpy(&a0, a + i, sizeof(a0));
+        memcpy(&b0, b + i, sizeof(b0));
+        memcpy(&a1, a + i + 8, sizeof(a1));
+        memcpy(&b1, b + i + 8, sizeof(b1));
+        acc0 += a0 * b0;
+        acc1 += a1 * b1;
+    }
+    for (; i < n; i += 8) {
+        v8sf a0, b0;
+        memcpy(&a0, a + i, sizeof(a0));
+        memcpy(&b0, b + i, sizeof(b0));
+        acc0 += a0 * b0;
+    }
+    acc0 += acc1;
+    return acc0[0] + acc0[1] + acc0[2] + acc0[3] + acc0[4] + acc0[5] + acc0[6] + acc0[7];
+}
+
+// Same coefficients applied to I and Q
+static void dot2(const float *c, const float *re, const float *im, int n,
+                 float *out_re, float *out_im) {
+    v8sf acc_re = { 0 }, acc_im = { 0 };
+    for (int i = 0; i < n; i += 8) {
+        v8sf cv, rv, iv;
+        memcpy(&cv, c + i, sizeof(cv));
+        memcpy(&rv, re + i, sizeof(rv));
+        memcpy(&iv, im + i, sizeof(iv));
+        acc_re += cv * rv;
+        acc_im += cv * iv;
+    }
+    *out_re = acc_re[0] + acc_re[1] + acc_re[2] + acc_re[3] +
+              acc_re[4] + acc_re[5] + acc_re[6] + acc_re[7];
+    *out_im = acc_im[0] + acc_im[1] + acc_im[2] + acc_im[3] +
+              acc_im[4] + acc_im[5] + acc_im[6] + acc_im[7];
+}
+
+// Run count samples through the resampler (in_im/out_im NULL for one stream)
+// Returns the number of outputs
+static int polyphase_process(polyphase_t *p, const float *in_re, const float *in_im, int count,
+                             float *out_re, float *out_im) {
+    int taps = p->taps;
+    int produced = 0;
+    for (int n = 0; n < count; n++) {
+        p->hist[0][p->pos] = p->hist[0][p->pos + taps] = in_re[n];
+        if (in_im) p->hist[1][p->pos] = p->hist[1][p->pos + taps] = in_im[n];
+        if (++p->pos == taps) p->pos = 0;
+
+        // Window of the newest taps samples, oldest first
+        const float *window_re = p->hist[0] + p->pos;
+        const float *window_im = in_im ? p->hist[1] + p->pos : NULL;
+        while (p->phase < p->interp) {
+            const float *c = p->coef + (size_t)p->phase * taps;
+            if (in_im) {
+                dot2(c, window_re, window_im, taps, &out_re[produced], &out_im[produced]);
+            } else {
+                out_re[produced] = dot(c, window_re, taps);
+            }
+            produced++;
+            p->phase += p->decim;
+        }
+        p->phase -= p->interp;
+    }
+    return produced;
+}
+
+// Load the NCO lanes for the current phase
+static void nco_reset_lanes(demodulator_t *d) {
+    for (int k = 0; k < 8; k++) {
+        double phi = d->nco_phase + k * d->nco_step;
+        d->nco_re[k] = (float)cos(phi);
+        d->nco_im[k] = (float)sin(phi);
+    }
+}
+
+// Multiply count samples by the NCO in place, 8 at a time
+static void nco_mix(demodulator_t *d, float *re, float *im, int count) {
+    v8sf pr, pi;
+    memcpy(&pr, d->nco_re, sizeof(pr));
+    memcpy(&pi, d->nco_im, sizeof(pi));
+    float step_re = (float)cos(8.0 * d->nco_step);
+    float step_im = (float)sin(8.0 * d->nco_step);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        v8sf xr, xi;
+        memcpy(&xr, re + i, sizeof(xr));
+        memcpy(&xi, im + i, sizeof(xi));
+        v8sf yr = xr * pr - xi * pi;
+        v8sf yi = xr * pi + xi * pr;
+        memcpy(re + i, &yr, sizeof(yr));
+        memcpy(im + i, &yi, sizeof(yi));
+        v8sf nr = pr * step_re - pi * step_im;
+        pi = pr * step_im + pi * step_re;
+        pr = nr;
+    }
+    for (int k = 0; i < count; i++, k++) {
+        float xr = re[i], xi = im[i];
+        re[i] = xr * pr[k] - xi * pi[k];
+        im[i] = xr * pi[k] + xi * pr[k];
+    }
+
+    // Restart the lanes from the exact phase (no drift from the recurrence)
+    d->nco_phase = fmod(d->nco_phase + count * d->nco_step, 2.0 * M_PI);
+    nco_reset_lanes(d);
+}
+
+// Channel samples -> audio at the channel rate
+static void detect(demodulator_t *d, const float *re, const float *im, int count, float *out) {
+    switch (d->mode) {
+        case DEMOD_AM:
+            // Envelope; the slowly tracked carrier level removes DC and sets the gain
+            for (int i = 0; i < count; i++) {
+                float env = sqrtf(re[i] * re[i] + im[i] * im[i]);
+                d->am_carrier += (env - d->am_carrier) * d->am_alpha;
+                float carrier = d->am_carrier > AGC_MIN_LEVEL ? d->am_carrier : AGC_MIN_LEVEL;
+                out[i] = 0.5f * (env - d->am_carrier) / carrier;
+            }
+            return;
+
+        case DEMOD_FM:
+            // Phase step between samples: arg(z[n] * conj(z[n-1]))
+            for (int i = 0; i < count; i++) {
+                float pr = d->fm_prev_re, pim = d->fm_prev_im;
+                out[i] = atan2f(im[i] * pr - re[i] * pim, re[i] * pr + im[i] * pim) * d->fm_scale;
+                d->fm_prev_re = re[i];
+                d->fm_prev_im = im[i];
+            }
+            return;
+
+        default: {
+            // SSB/CW: move the passband back up (or to the CW pitch) and
+            // take the real part, then peak AGC with instant attack
+            float c = (float)cos(d->osc_phase), s = (float)sin(d->osc_phase);
+            float step_c = (float)cos(d->osc_step), step_s = (float)sin(d->osc_step);
+            for (int i = 0; i < count; i++) {
+                float a = re[i] * c - im[i] * s;
+                float nc = c * step_c - s * step_s;
+                s = c * step_s + s * step_c;
+                c = nc;
+
+                float level = fabsf(a);
+                d->agc_level = level > d->agc_level ? level : d->agc_level * d->agc_decay;
+                float ref = d->agc_level > AGC_MIN_LEVEL ? d->agc_level : AGC_MIN_LEVEL;
+                out[i] = a * (AGC_TARGET / ref);
+            }
+            d->osc_phase = fmod(d->osc_phase + count * d->osc_step, 2.0 * M_PI);
+            return;
+        }
+    }
+}
+
+demodulator_t *demodulator_new(int input_rate) {
+    if (input_rate <= 0) return NULL;
+
+    demodulator_t *d = calloc(1, sizeof(demodulator_t));
+    if (!d) return NULL;
+
+    d->input_rate = input_rate;
+    d->scratch_size = (int)((int64_t)DEMOD_BLOCK * DEMOD_AUDIO_RATE / input_rate) + 2;
+    d->in_re = malloc(sizeof(float) * DEMOD_BLOCK);
+    d->in_im = malloc(sizeof(float) * DEMOD_BLOCK);
+    d->ch_re = malloc(sizeof(float) * d->scratch_size);
+    d->ch_im = malloc(sizeof(float) * d->scratch_size);
+    d->flt_re = malloc(sizeof(float) * d->scratch_size);
+    d->flt_im = malloc(sizeof(float) * d->scratch_size);
+    d->det = malloc(sizeof(float) * d->scratch_size);
+    if (!d->in_re || !d->in_im || !d->ch_re || !d->ch_im || !d->flt_re || !d->flt_im || !d->det ||
+        demodulator_set_mode(d, DEMOD_USB, 0, 0) != 0) {
+        demodulator_free(d);
+        return NULL;
+    }
+    return d;
+}
+
+void demodulator_free(demodulator_t *d) {
+    if (!d) return;
+
+    polyphase_free(&d->resamp);
+    polyphase_free(&d->channel);
+    polyphase_free(&d->interp);
+    free(d->in_re);
+    free(d->in_im);
+    free(d->ch_re);
+    free(d->ch_im);
+    free(d->flt_re);
+    free(d->flt_im);
+    free(d->det);
+    free(d);
+}
+
+int demodulator_set_mode(demodulator_t *d, demod_mode_t mode, int bandwidth_hz, int offset_hz) {
+    if (!d || mode < DEMOD_AM || mode > DEMOD_FM || bandwidth_hz < 0) return -1;
+
+    if (bandwidth_hz == 0) {
+        switch (mode) {
+            case DEMOD_AM:  bandwidth_hz = DEFAULT_AM_BW_HZ; break;
+            case DEMOD_USB:
+            case DEMOD_LSB: bandwidth_hz = DEFAULT_SSB_BW_HZ; break;
+            case DEMOD_FM:  bandwidth_hz = DEFAULT_FM_DEVIATION_HZ; break;
+            default:        bandwidth_hz = DEFAULT_CW_BW_HZ; break;
+        }
+    }
+
+    // Passband centre (shifted to 0 Hz), half width, second oscillator
+    // and highest audio frequency
+    double centre_hz = offset_hz, half_hz, osc_hz = 0.0, audio_hz;
+    switch (mode) {
+        case DEMOD_USB:
+        case DEMOD_LSB: {
+            double lo = offset_hz ? offset_hz - bandwidth_hz / 2.0 : SSB_LOW_HZ;
+            double hi = offset_hz ? offset_hz + bandwidth_hz / 2.0 : bandwidth_hz;
+            if (hi <= lo + 100) hi = lo + 100;
+            centre_hz = (mode == DEMOD_USB ? 1.0 : -1.0) * (lo + hi) / 2.0;
+            half_hz = (hi - lo) / 2.0;
+            osc_hz = centre_hz;
+            audio_hz = hi;
+            break;
+        }
+        case DEMOD_CW:
+        case DEMOD_CWR:
+            half_hz = bandwidth_hz / 2.0;
+            osc_hz = mode == DEMOD_CW ? DEMOD_CW_PITCH_HZ : -DEMOD_CW_PITCH_HZ;
+            audio_hz = DEMOD_CW_PITCH_HZ + half_hz;
+            break;
+        case DEMOD_FM:
+            half_hz = bandwidth_hz + FM_AUDIO_HZ;
+            audio_hz = FM_AUDIO_HZ;
+            break;
+        default:
+            half_hz = bandwidth_hz / 2.0;
+            audio_hz = half_hz;
+            break;
+    }
+    if (half_hz > DEMOD_AUDIO_RATE * 0.4) half_hz = DEMOD_AUDIO_RATE * 0.4;
+    if (audio_hz > DEMOD_AUDIO_RATE * 0.45) audio_hz = DEMOD_AUDIO_RATE * 0.45;
+
+    // Lowest channel rate (48 kHz / 1, 2, 4 or 8) that holds the passband
+    // and the audio
+    double need = fmax(2.5 * half_hz, 2.2 * audio_hz);
+    int factor = 8;
+    while (factor > 1 && DEMOD_AUDIO_RATE / factor < need) factor /= 2;
+    int channel_rate = DEMOD_AUDIO_RATE / factor;
+
+    polyphase_free(&d->resamp);
+    polyphase_free(&d->channel);
+    polyphase_free(&d->interp);
+
+    // Anti-alias resampler: aliases must stay outside the passband
+    int g = gcd(channel_rate, d->input_rate);
+    int up = channel_rate / g;
+    int down = d->input_rate / g;
+    double proto_rate = (double)d->input_rate * up;
+    double stop_hz = fmin(channel_rate, d->input_rate) - half_hz;
+    if (stop_hz < half_hz * 1.2) stop_hz = half_hz * 1.2;
+    float *proto = NULL;
+    int n = design_lowpass(&proto, proto_rate, (half_hz + stop_hz) / 2.0, stop_hz - half_hz,
+                           MAX_PHASE_TAPS * up);
+    int result = n > 0 ? polyphase_init(&d->resamp, up, down, proto, n, 2) : -1;
+    free(proto);
+
+    // Channel filter: the sharp one, at the channel rate
+    double transition = fmin(fmax((mode == DEMOD_FM ? 0.25 : 0.15) * 2.0 * half_hz, 50.0), 1000.0);
+    if (result == 0) {
+        n = design_lowpass(&proto, channel_rate, half_hz, transition, MAX_PHASE_TAPS);
+        result = n > 0 ? polyphase_init(&d->channel, 1, 1, proto, n, 2) : -1;
+        free(proto);
+    }
+
+    // Audio interpolator: images of the audio start at channel_rate - audio_hz
+    if (result == 0 && factor > 1) {
+        double audio_stop = channel_rate - audio_hz;
+        n = design_lowpass(&proto, DEMOD_AUDIO_RATE, (audio_hz + audio_stop) / 2.0,
+                           audio_stop - audio_hz, MAX_PHASE_TAPS * factor);
+        result = n > 0 ? polyphase_init(&d->interp, factor, 1, proto, n, 1) : -1;
+        free(proto);
+    }
+    if (result != 0) {
+        fprintf(stderr, "Demod: Out of memory building filters\n");
+        return -1;
+    }
+
+    d->mode = mode;
+    d->bandwidth_hz = bandwidth_hz;
+    d->offset_hz = offset_hz;
+    d->channel_rate = channel_rate;
+    d->audio_factor = factor;
+
+    d->nco_phase = 0.0;
+    d->nco_step = -2.0 * M_PI * centre_hz / d->input_rate;
+    nco_reset_lanes(d);
+    d->osc_phase = 0.0;
+    d->osc_step = 2.0 * M_PI * osc_hz / channel_rate;
+    d->fm_prev_re = 1.0f;
+    d->fm_prev_im = 0.0f;
+    d->fm_scale = (float)(channel_rate / (2.0 * M_PI * bandwidth_hz));
+    d->am_carrier = 0.0f;
+    d->am_alpha = (float)(1.0 - exp(-1.0 / (AM_CARRIER_S * channel_rate)));
+    d->agc_level = 0.0f;
+    d->agc_decay = (float)exp(-1.0 / (AGC_RELEASE_S * channel_rate));
+    return 0;
+}
+
+int demodulator_get_channel_rate(demodulator_t *d) {
+    return d ? d->channel_rate : 0;
+}
+
+int demodulator_max_output(demodulator_t *d, int samples) {
+    if (!d || samples <= 0) return 0;
+    int blocks = (samples + DEMOD_BLOCK - 1) / DEMOD_BLOCK;
+    return (int)((int64_t)samples * DEMOD_AUDIO_RATE / d->input_rate) + (blocks + 1) * 8;
+}
+
+int demodulator_process_s32(demodulator_t *d, const uint8_t *iq, int samples,
+                            float *audio, int max_audio) {
+    if (!d || !iq || !audio || samples <= 0) return 0;
+
+    const float scale = 1.0f / 2147483648.0f;
+    int written = 0;
+    for (int start = 0; start < samples; start += DEMOD_BLOCK) {
+        int count = samples - start < DEMOD_BLOCK ? samples - start : DEMOD_BLOCK;
+        const uint8_t *p = iq + (size_t)start * 8;
+        for (int i = 0; i < count; i++) {
+            int32_t v[2];
+            memcpy(v, p + (size_t)i * 8, sizeof(v));
+            d->in_re[i] = (float)v[0] * scale;
+            d->in_im[i] = (float)v[1] * scale;
+        }
+
+        nco_mix(d, d->in_re, d->in_im, count);
+        int ch = polyphase_process(&d->resamp, d->in_re, d->in_im, count, d->ch_re, d->ch_im);
+        polyphase_process(&d->channel, d->ch_re, d->ch_im, ch, d->flt_re, d->flt_im);
+        detect(d, d->flt_re, d->flt_im, ch, d->det);
+
+        if (d->audio_factor == 1) {
+            if (ch > max_audio - written) ch = max_audio - written;
+            memcpy(audio + written, d->det, sizeof(float) * ch);
+            written += ch;
+        } else {
+            // Interpolate in pieces that fit the caller's buffer
+            int room = (max_audio - written) / d->audio_factor;
+            if (ch > room) ch = room;
+            written += polyphase_process(&d->interp, d->det, NULL, ch, audio + written, NULL);
+        }
+    }
+    return written;
+}
+
+int demodulator_parse_mode(const char *name, demod_mode_t *mode) {
+    static const char *names[] = { "am", "usb", "lsb", "cw", "cwr", "fm" };
+    if (!name || !mode) return -1;
+    for (int i = 0; i <= DEMOD_FM; i++) {
+        if (strcasecmp(name, names[i]) == 0) {
+            *mode = (demod_mode_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+const char *demodulator_mode_name(demod_mode_t mode) {
+    switch (mode) {
+        case DEMOD_AM:  return "AM";
+        case DEMOD_USB: return "USB";
+        case DEMOD_LSB: return "LSB";
+        case DEMOD_CW:  return "CW";
+        case DEMOD_CWR: return "CWR";
+        case DEMOD_FM:  return "FM";
+    }
+    return "?";
+}
@@ -0,0 +1,73 @@
+#ifndef DEMODULATOR_H
+#define DEMODULATOR_H
+
+#include <stdint.h>
+
+// AM/SSB/CW/FM demodulator from wideband IQ to 48 kHz audio.
+//
+// Chain, all in float:
+//   NCO     shift the passband centre to 0 Hz (input rate)
+//   resamp  polyphase L/M anti-alias resampler down to the channel rate,
+//           48 kHz / D with D = 1, 2, 4 or 8 chosen from the filter width
+//   filter  channel FIR (Kaiser lowpass, half the passband width)
+//   detect  AM envelope, SSB/CW second oscillator (Weaver method: the
+//           passband is moved back up and the real part taken), FM
+//           quadrature (phase difference) detector; AGC except FM
+//   interp  polyphase interpolator to 48 kHz
+// FIR dot products use GCC/clang vector extensions (8 floats at a time,
+// SSE/AVX/NEON). Narrow modes run the sharp filter at 6-12 kHz, so the
+// cost is dominated by the wide anti-alias stage (see the demod result
+// of bench-demod).
+//
+// Not thread-safe: one thread creates, configures and runs a demodulator.
+
+#define DEMOD_AUDIO_RATE 48000
+#define DEMOD_CW_PITCH_HZ 700  // Audio tone of a zero-beat CW carrier
+
+typedef enum {
+    DEMOD_AM = 0,
+    DEMOD_USB,
+    DEMOD_LSB,
+    DEMOD_CW,
+    DEMOD_CWR,
+    DEMOD_FM,
+} demod_mode_t;
+
+typedef struct demodulator demodulator_t;
+
+// Create a demodulator for IQ at input_rate, in USB mode with the
+// default filter
+// Returns NULL on error
+demodulator_t *demodulator_new(int input_rate);
+
+// Free the demodulator
+void demodulator_free(demodulator_t *demod);
+
+// Select mode and filter and rebuild the filters
+// bandwidth_hz: filter width as the radio reports it (SSB: carrier to
+//   upper edge, AM/CW: full width, FM: peak deviation); 0 = mode default
+// offset_hz: passband centre relative to the carrier (data filters), 0 = none
+// Returns 0 on success, -1 on invalid arguments
+int demodulator_set_mode(demodulator_t *demod, demod_mode_t mode, int bandwidth_hz,
+                         int offset_hz);
+
+// Channel rate chosen for the current mode (Hz)
+int demodulator_get_channel_rate(demodulator_t *demod);
+
+// Largest number of audio samples produced for samples input samples
+int demodulator_max_output(demodulator_t *demod, int samples);
+
+// Demodulate 32-bit LE I/Q (the FDM-DUO USB format)
+// audio receives up to max_audio samples (full scale 1.0)
+// Returns the number of audio samples written
+int demodulator_process_s32(demodulator_t *demod, const uint8_t *iq, int samples,
+                            float *audio, int max_audio);
+
+// Parse "am", "usb", "lsb", "cw", "cwr" or "fm"
+// Returns 0 on success, -1 if name is not a known mode
+int demodulator_parse_mode(const char *name, demod_mode_t *mode);
+
+// Mode name ("AM", "USB", ...)
+const char *demodulator_mode_name(demod_mode_t mode);
+
+#endif // DEMODULATOR_H
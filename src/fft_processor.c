@@ -1,21 +1,58 @@
+#define _DEFAULT_SOURCE
 #include "fft_processor.h"
+#include "ddc.h"
+#include "perf_trace.h"
 #include <fftw3.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
+// Default number of FFT frames averaged per spectrum
 #define SPECTRUM_AVERAGING 3
 
+// Samples converted per block (one USB transfer)
+#define BLOCK_SAMPLES (USB_BUFFER_SIZE / 8)
+
+// Coherent gain of the Blackman-Harris window (a0); the WOLA prototype
+// is scaled to match so both estimators report the same tone level
+#define BH_COHERENT_GAIN 0.35875
+
+// WOLA prototype passband in bins: a little over one bin cuts scalloping
+// at bin edges from ~5.5 dB to ~3.7 dB, still >120 dB down 3 bins away
+#define WOLA_BIN_WIDTH 1.2
+
 struct fft_processor {
     int fft_size;
-    int sample_count;
+
+    // Sample history (interleaved I/Q, circular, oldest at history_pos)
+    // holding fft_size * taps samples
+    // An FFT runs every `hop` new samples: fft_size at zoom 1, less when
+    // zoomed so the decimated stream gives the same spectrum rate
+    float *history;
+    int history_len;
+    int history_pos;
+    int history_fill;
+    int hop;
+    int hop_count;
+
+    // Block buffers: converted input and DDC output
+    float *block;
+    float *ddc_out;
+
+    // Zoom FFT down-converter
+    ddc_t *ddc;
+    int zoom;
+    int pan_offset;
 
     // FFTW data
     double *fft_in;
     fftw_complex *fft_out;
     fftw_plan plan;
 
-    // Window coefficients (Blackman-Harris)
+    // Window coefficients: Blackman-Harris (fft_size), or the WOLA
+    // prototype filter (fft_size * taps)
+    fft_window_t window_type;
+    int taps;
     double *window;
 
     // Output spectrum in dB
@@ -23,6 +60,7 @@ struct fft_processor {
 
     // Averaging accumulator
     float *spectrum_accum;
+    int averaging;
     int avg_count;
 
     // RSSI (peak power in center passband)
@@ -48,7 +86,11 @@ fft_processor_t *fft_processor_new(int fft_size) {
     if (!fft) return NULL;
 
     fft->fft_size = fft_size;
-    fft->sample_count = 0;
+    fft->hop = fft_size;
+    fft->zoom = 1;
+    fft->window_type = FFT_WINDOW_BLACKMAN_HARRIS;
+    fft->taps = 1;
+    fft->history_len = fft_size;
 
     // Allocate FFTW arrays
     // For complex-to-complex FFT: input is interleaved I/Q
@@ -68,8 +110,8 @@ fft_processor_t *fft_processor_new(int fft_size) {
         return NULL;
     }
 
-    // Allocate and generate window
-    fft->window = malloc(sizeof(double) * fft_size);
+    // Allocate and generate window (sized for the WOLA prototype)
+    fft->window = malloc(sizeof(double) * fft_size * FFT_WOLA_TAPS);
     if (!fft->window) {
         fft_processor_free(fft);
         return NULL;
@@ -89,8 +131,19 @@ fft_processor_t *fft_processor_new(int fft_size) {
         fft_processor_free(fft);
         return NULL;
     }
+    fft->averaging = SPECTRUM_AVERAGING;
     fft->avg_count = 0;
 
+    // Sample history and block buffers
+    fft->history = calloc((size_t)fft_size * FFT_WOLA_TAPS * 2, sizeof(float));
+    fft->block = malloc(sizeof(float) * 2 * BLOCK_SAMPLES);
+    fft->ddc_out = malloc(sizeof(float) * 2 * (BLOCK_SAMPLES + 1));
+    fft->ddc = ddc_new();
+    if (!fft->history || !fft->block || !fft->ddc_out || !fft->ddc) {
+        fft_processor_free(fft);
+        return NULL;
+    }
+
     return fft;
 }
 
@@ -109,6 +162,10 @@ void fft_processor_free(fft_processor_t *fft) {
     free(fft->window);
     free(fft->spectrum_db);
     free(fft->spectrum_accum);
+    free(fft->history);
+    free(fft->block);
+    free(fft->ddc_out);
+    ddc_free(fft->ddc);
     free(fft);
 }
 
@@ -119,6 +176,175 @@ static inline float convert_32bit_sample(const uint8_t *data) {
     return (float)value / 2147483648.0f;
 }
 
+// WOLA prototype: sinc low-pass WOLA_BIN_WIDTH bins wide, spanning taps * fft_size
+// samples, shaped by a Blackman-Harris window of the same length
+static void generate_wola_prototype(double *window, int fft_size, int taps) {
+    const double pi = 3.141592653589793238462643383279502884197169399375105820974944592;
+    int len = fft_size * taps;
+    double center = (len - 1) / 2.0;
+    double sum = 0.0;
+
+    generate_window(window, len);
+    for (int i = 0; i < len; i++) {
+        double x = (i - center) * WOLA_BIN_WIDTH / fft_size;
+        window[i] *= (x == 0.0) ? 1.0 : sin(pi * x) / (pi * x);
+        sum += window[i];
+    }
+
+    // Same DC gain as the Blackman-Harris window
+    double scale = BH_COHERENT_GAIN * fft_size / sum;
+    for (int i = 0; i < len; i++) {
+        window[i] *= scale;
+    }
+}
+
+// 10 log10(power) without libm: exponent plus an atanh series for the
+// mantissa, reduced to [0.707, 1.414) (max error 3e-5 dB); simple enough
+// for the compiler to vectorize, where log10f costs ~10 ns per bin
+static inline float power_to_db(float power) {
+    uint32_t bits;
+    memcpy(&bits, &power, sizeof(bits));
+    int32_t e = (int32_t)((bits + 0x004AFB0Du) >> 23) - 127;
+    bits -= (uint32_t)e << 23;
+    float m;
+    memcpy(&m, &bits, sizeof(m));
+    float t = (m - 1.0f) / (m + 1.0f);
+    float t2 = t * t;
+    float ln_m = 2.0f * t * (1.0f + t2 * (1.0f / 3 + t2 * (1.0f / 5 + t2 * (1.0f / 7))));
+    return 4.34294482f * (ln_m + (float)e * 0.693147181f);
+}
+
+// Add 20 log10(|X| / N) of count bins to accum, floored at -200 dB, as
+// 10 log10(|X|^2) - 20 log10(N) (no square root)
+static void accumulate_db(const fftw_complex *bins, float *accum, int count, int n) {
+    float floor_power = 1e-10f * n * 1e-10f * n;
+    float offset = power_to_db((float)n * n);
+    for (int j = 0; j < count; j++) {
+        float power = (float)(bins[j][0] * bins[j][0] + bins[j][1] * bins[j][1]);
+        if (power < floor_power) power = floor_power;
+        accum[j] += power_to_db(power) - offset;
+    }
+}
+
+// Window the history (oldest first), run the FFT and accumulate the
+// dB spectrum; returns true when an averaged spectrum is complete
+static bool run_fft_frame(fft_processor_t *fft) {
+    int n = fft->fft_size;
+    int len = fft->history_len;
+
+    PERF_SPAN_BEGIN(window_start);
+    if (fft->taps == 1) {
+        int idx = fft->history_pos;
+        for (int k = 0; k < n; k++, idx++) {
+            if (idx == n) idx = 0;
+            double w = fft->window[k];
+            fft->fft_in[k * 2] = fft->history[idx * 2] * w;          // Real part
+            fft->fft_in[k * 2 + 1] = fft->history[idx * 2 + 1] * w;  // Imaginary part
+        }
+    } else {
+        // WOLA: weight taps * fft_size samples by the prototype filter and
+        // fold them onto fft_size FFT inputs
+        for (int k = 0; k < n; k++) {
+            double re = 0.0;
+            double im = 0.0;
+            int idx = fft->history_pos + k;
+            if (idx >= len) idx -= len;
+            for (int m = 0; m < fft->taps; m++) {
+                double w = fft->window[k + m * n];
+                re += fft->history[idx * 2] * w;
+                im += fft->history[idx * 2 + 1] * w;
+                idx += n;
+                if (idx >= len) idx -= len;
+            }
+            fft->fft_in[k * 2] = re;
+            fft->fft_in[k * 2 + 1] = im;
+        }
+    }
+    PERF_SPAN_END(window_start, PERF_STAGE_WINDOW);
+
+    // Execute FFT
+    PERF_SPAN_BEGIN(fft_start);
+    fftw_execute(fft->plan);
+    PERF_SPAN_END(fft_start, PERF_STAGE_FFT);
+
+    // Convert to magnitude in dB with FFT shift and accumulate
+    int half = fft->fft_size / 2;
+
+    // FFT shift: the second half of the output is the first half of the
+    // spectrum
+    PERF_SPAN_BEGIN(db_start);
+    accumulate_db(fft->fft_out + half, fft->spectrum_accum, half, n);
+    accumulate_db(fft->fft_out, fft->spectrum_accum + half, half, n);
+    fft->avg_count++;
+    PERF_SPAN_END(db_start, PERF_STAGE_DB);
+
+    // Check if we have enough frames for averaging
+    if (fft->avg_count < fft->averaging) return false;
+
+    float peak_db = -200.0f;
+    int center_start = half - 16;  // ~3kHz passband centered
+    int center_end = half + 16;
+
+    // Compute average and find RSSI
+    PERF_SPAN_BEGIN(average_start);
+    for (int j = 0; j < fft->fft_size; j++) {
+        fft->spectrum_db[j] = fft->spectrum_accum[j] / fft->averaging;
+        fft->spectrum_accum[j] = 0.0f;  // Reset accumulator
+
+        // Track peak in center passband for RSSI
+        if (j >= center_start && j < center_end) {
+            if (fft->spectrum_db[j] > peak_db) {
+                peak_db = fft->spectrum_db[j];
+            }
+        }
+    }
+    fft->rssi_db = peak_db;
+    fft->avg_count = 0;
+    PERF_SPAN_END(average_start, PERF_STAGE_AVERAGE);
+    return true;
+}
+
+// Append samples to the history, running an FFT every hop samples
+// Copies whole runs: up to the next FFT or the end of the circular buffer
+static bool feed_samples(fft_processor_t *fft, const float *iq, int count) {
+    bool fft_completed = false;
+
+    while (count > 0) {
+        // Wait for a full history, then transform every hop samples
+        int until_fft = fft->hop - fft->hop_count;
+        if (until_fft < fft->history_len - fft->history_fill) {
+            until_fft = fft->history_len - fft->history_fill;
+        }
+        int n = count;
+        if (n > until_fft) n = until_fft;
+        if (n > fft->history_len - fft->history_pos) n = fft->history_len - fft->history_pos;
+
+        memcpy(fft->history + fft->history_pos * 2, iq, sizeof(float) * 2 * n);
+        iq += n * 2;
+        count -= n;
+        fft->history_pos += n;
+        if (fft->history_pos == fft->history_len) fft->history_pos = 0;
+        fft->history_fill += n;
+        if (fft->history_fill > fft->history_len) fft->history_fill = fft->history_len;
+        fft->hop_count += n;
+
+        if (fft->hop_count >= fft->hop && fft->history_fill >= fft->history_len) {
+            fft->hop_count = 0;
+            if (run_fft_frame(fft)) fft_completed = true;
+        }
+    }
+    return fft_completed;
+}
+
+// Down-convert a block when zoomed, then feed it to the FFT
+static bool process_block(fft_processor_t *fft, const float *iq, int count) {
+    if (fft->zoom > 1) {
+        int produced = ddc_process(fft->ddc, iq, count, fft->ddc_out);
+        return feed_samples(fft, fft->ddc_out, produced);
+    }
+    return feed_samples(fft, iq, count);
+}
+
 bool fft_processor_process(fft_processor_t *fft, const uint8_t *usb_data, int length) {
     if (!fft || !usb_data) return false;
 
@@ -127,72 +353,150 @@ bool fft_processor_process(fft_processor_t *fft, const uint8_t *usb_data, int le
     int num_samples = length / bytes_per_sample;
     bool fft_completed = false;
 
-    for (int i = 0; i < num_samples; i++) {
-        const uint8_t *sample_data = usb_data + (i * bytes_per_sample);
-        float i_sample = convert_32bit_sample(sample_data);
-        float q_sample = convert_32bit_sample(sample_data + 4);
+    // Convert in blocks, down-convert when zoomed, then feed the FFT
+    for (int start = 0; start < num_samples; start += BLOCK_SAMPLES) {
+        int count = num_samples - start;
+        if (count > BLOCK_SAMPLES) count = BLOCK_SAMPLES;
 
-        // Apply window and store as complex (interleaved real/imag)
-        int idx = fft->sample_count;
-        double w = fft->window[idx];
-        fft->fft_in[idx * 2] = i_sample * w;      // Real part
-        fft->fft_in[idx * 2 + 1] = q_sample * w;  // Imaginary part
+        PERF_SPAN_BEGIN(convert_start);
+        for (int i = 0; i < count; i++) {
+            const uint8_t *sample_data = usb_data + ((start + i) * bytes_per_sample);
+            fft->block[i * 2] = convert_32bit_sample(sample_data);
+            fft->block[i * 2 + 1] = convert_32bit_sample(sample_data + 4);
+        }
+        PERF_SPAN_END(convert_start, PERF_STAGE_CONVERT);
 
-        fft->sample_count++;
+        if (process_block(fft, fft->block, count)) fft_completed = true;
+    }
 
-        // Check if we have enough samples for FFT
-        if (fft->sample_count >= fft->fft_size) {
-            // Execute FFT
-            fftw_execute(fft->plan);
+    return fft_completed;
+}
 
-            // Convert to magnitude in dB with FFT shift and accumulate
-            int half = fft->fft_size / 2;
+bool fft_processor_process_float(fft_processor_t *fft, const float *iq, int samples) {
+    if (!fft || !iq) return false;
 
-            for (int j = 0; j < fft->fft_size; j++) {
-                // FFT shift: swap first and second half
-                int src_idx = (j + half) % fft->fft_size;
-                double re = fft->fft_out[src_idx][0];
-                double im = fft->fft_out[src_idx][1];
-                double mag = sqrt(re * re + im * im) / fft->fft_size;
+    // Already converted: blocks only bound the DDC output buffer
+    bool fft_completed = false;
+    for (int start = 0; start < samples; start += BLOCK_SAMPLES) {
+        int count = samples - start;
+        if (count > BLOCK_SAMPLES) count = BLOCK_SAMPLES;
+        if (process_block(fft, iq + start * 2, count)) fft_completed = true;
+    }
+    return fft_completed;
+}
 
-                // Convert to dB, with floor to avoid -inf
-                if (mag < 1e-10) mag = 1e-10;
-                float db = 20.0f * log10f((float)mag);
+// Discard sample history and partial averages
+static void reset_history(fft_processor_t *fft) {
+    memset(fft->history, 0, sizeof(float) * 2 * fft->history_len);
+    fft->history_pos = 0;
+    fft->history_fill = 0;
+    fft->hop_count = 0;
+    memset(fft->spectrum_accum, 0, sizeof(float) * fft->fft_size);
+    fft->avg_count = 0;
+}
 
-                // Accumulate for averaging
-                fft->spectrum_accum[j] += db;
-            }
-            fft->avg_count++;
-
-            // Check if we have enough frames for averaging
-            if (fft->avg_count >= SPECTRUM_AVERAGING) {
-                float peak_db = -200.0f;
-                int center_start = half - 16;  // ~3kHz passband centered
-                int center_end = half + 16;
-
-                // Compute average and find RSSI
-                for (int j = 0; j < fft->fft_size; j++) {
-                    fft->spectrum_db[j] = fft->spectrum_accum[j] / SPECTRUM_AVERAGING;
-                    fft->spectrum_accum[j] = 0.0f;  // Reset accumulator
-
-                    // Track peak in center passband for RSSI
-                    if (j >= center_start && j < center_end) {
-                        if (fft->spectrum_db[j] > peak_db) {
-                            peak_db = fft->spectrum_db[j];
-                        }
-                    }
-                }
-                fft->rssi_db = peak_db;
-                fft->avg_count = 0;
-                fft_completed = true;
-            }
+// Pan at an unchanged zoom: the DDC output moves down by shift bins, a
+// pure frequency shift, so the partial average moves with it instead of
+// being discarded (every pan detent restarted the average)
+static void shift_pan(fft_processor_t *fft, int pan_offset, int shift) {
+    int n = fft->fft_size;
+    ddc_set_nco(fft->ddc, (double)pan_offset / n);
+    fft->pan_offset = pan_offset;
+
+    // The DDC filters still hold samples mixed at the old NCO: refill the
+    // history from samples past that transient (twice the group delay)
+    // rather than transform across the step
+    fft->history_fill = -(int)ceil(2.0 * ddc_get_delay(fft->ddc));
+    fft->hop_count = 0;
+
+    // Partial average: bins entering at the edge repeat the outermost bin
+    // that was kept
+    float *acc = fft->spectrum_accum;
+    if (shift > 0) {
+        memmove(acc, acc + shift, sizeof(float) * (n - shift));
+        for (int j = n - shift; j < n; j++) acc[j] = acc[n - shift - 1];
+    } else {
+        memmove(acc - shift, acc, sizeof(float) * (n + shift));
+        for (int j = 0; j < -shift; j++) acc[j] = acc[-shift];
+    }
+}
+
+int fft_processor_set_zoom(fft_processor_t *fft, int zoom, int pan_offset) {
+    if (!fft) return -1;
 
-            // Reset for next FFT - continue processing remaining samples
-            fft->sample_count = 0;
+    // NCO moves the pan centre (in full-resolution bins) to DC
+    double nco_freq = (double)pan_offset / fft->fft_size;
+    if (zoom <= 1) {
+        zoom = 1;
+        pan_offset = 0;
+        nco_freq = 0.0;
+    }
+    if (zoom > 1 && zoom == fft->zoom) {
+        int shift = (pan_offset - fft->pan_offset) * zoom;
+        if (shift == 0) return 0;
+        // Bins shifted in only fill the marked edge; a larger pan starts over
+        if (abs(shift) <= (int)(fft->fft_size * DDC_EDGE_FRACTION)) {
+            shift_pan(fft, pan_offset, shift);
+            return 0;
         }
     }
+    if (ddc_configure(fft->ddc, zoom, nco_freq) != 0) return -1;
 
-    return fft_completed;
+    fft->zoom = zoom;
+    fft->pan_offset = pan_offset;
+
+    // Keep the spectrum rate constant: decimated samples arrive zoom
+    // times slower, so overlap frames by the same factor
+    fft->hop = fft->fft_size / zoom;
+
+    // Discard history and partial averages from the previous setting
+    reset_history(fft);
+    return 0;
+}
+
+int fft_processor_set_window(fft_processor_t *fft, fft_window_t type) {
+    if (!fft) return -1;
+
+    if (type == FFT_WINDOW_WOLA) {
+        fft->taps = FFT_WOLA_TAPS;
+        generate_wola_prototype(fft->window, fft->fft_size, fft->taps);
+    } else if (type == FFT_WINDOW_BLACKMAN_HARRIS) {
+        fft->taps = 1;
+        generate_window(fft->window, fft->fft_size);
+    } else {
+        return -1;
+    }
+    fft->window_type = type;
+    fft->history_len = fft->fft_size * fft->taps;
+
+    reset_history(fft);
+    return 0;
+}
+
+int fft_processor_set_averaging(fft_processor_t *fft, int frames) {
+    if (!fft || frames < 1 || frames > FFT_MAX_AVERAGING) return -1;
+
+    fft->averaging = frames;
+    memset(fft->spectrum_accum, 0, sizeof(float) * fft->fft_size);
+    fft->avg_count = 0;
+    return 0;
+}
+
+void fft_processor_reset(fft_processor_t *fft) {
+    if (!fft) return;
+    reset_history(fft);
+}
+
+int fft_processor_get_averaging(fft_processor_t *fft) {
+    return fft ? fft->averaging : SPECTRUM_AVERAGING;
+}
+
+fft_window_t fft_processor_get_window(fft_processor_t *fft) {
+    return fft ? fft->window_type : FFT_WINDOW_BLACKMAN_HARRIS;
+}
+
+int fft_processor_get_zoom(fft_processor_t *fft) {
+    return fft ? fft->zoom : 1;
 }
 
 void fft_processor_get_spectrum_db(fft_processor_t *fft, float *output) {
@@ -6,6 +6,18 @@
 
 typedef struct fft_processor fft_processor_t;
 
+// Spectrum estimator front end
+typedef enum {
+    FFT_WINDOW_BLACKMAN_HARRIS = 0,  // Single window, low sidelobes, ~2x wide bins
+    FFT_WINDOW_WOLA = 1              // Polyphase filterbank (weighted overlap-add)
+} fft_window_t;
+
+// Prototype filter taps per branch for FFT_WINDOW_WOLA
+#define FFT_WOLA_TAPS 4
+
+// Upper limit for fft_processor_set_averaging
+#define FFT_MAX_AVERAGING 16
+
 // Create FFT processor with given FFT size
 fft_processor_t *fft_processor_new(int fft_size);
 
@@ -16,10 +28,50 @@ void fft_processor_free(fft_processor_t *fft);
 // Returns true if a new spectrum is ready
 bool fft_processor_process(fft_processor_t *fft, const uint8_t *usb_data, int length);
 
+// Process interleaved float I/Q samples (full scale = 1.0), e.g. from a
+// network stream, through the same zoom/window/FFT/averaging path
+// Returns true if a new spectrum is ready
+bool fft_processor_process_float(fft_processor_t *fft, const float *iq, int samples);
+
 // Get the computed spectrum in dB (call after process returns true)
 // Output array must be at least fft_size elements
 void fft_processor_get_spectrum_db(fft_processor_t *fft, float *output);
 
+// Zoom FFT: down-convert around the pan centre and decimate by zoom
+// (1 = full span, or a power of two up to 16) so the FFT covers only
+// the displayed span with zoom times finer bins
+// pan_offset is in full-resolution bins from the centre, like the widgets
+// Not thread-safe: call from the thread that runs fft_processor_process
+// Returns 0 on success, -1 on invalid zoom
+int fft_processor_set_zoom(fft_processor_t *fft, int zoom, int pan_offset);
+
+// Select the spectrum estimator front end
+// WOLA folds FFT_WOLA_TAPS * fft_size samples weighted by a polyphase
+// prototype filter into each FFT, giving near-rectangular bins
+// Not thread-safe: call from the thread that runs fft_processor_process
+// Returns 0 on success, -1 on unknown type
+int fft_processor_set_window(fft_processor_t *fft, fft_window_t type);
+
+// Set the number of FFT frames averaged (in dB) per output spectrum
+// (1 .. FFT_MAX_AVERAGING, default 3); discards the partial average
+// Not thread-safe: call from the thread that runs fft_processor_process
+// Returns 0 on success, -1 on out-of-range frames
+int fft_processor_set_averaging(fft_processor_t *fft, int frames);
+
+// Discard the sample history and partial average, so the next spectrum
+// holds only samples passed from now on (e.g. after a retune)
+// Not thread-safe: call from the thread that runs fft_processor_process
+void fft_processor_reset(fft_processor_t *fft);
+
+// Get current number of averaged frames
+int fft_processor_get_averaging(fft_processor_t *fft);
+
+// Get current estimator front end
+fft_window_t fft_processor_get_window(fft_processor_t *fft);
+
+// Get current zoom level
+int fft_processor_get_zoom(fft_processor_t *fft);
+
 // Get FFT size
 int fft_processor_get_size(fft_processor_t *fft);
 
@@ -0,0 +1,152 @@
+#include "iq_bfp.h"
+#include <string.h>
+#include <math.h>
+
+// Samples are moved between the LE wire format and vectors with memcpy
+_Static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "iq_bfp assumes a little-endian host");
+
+typedef int32_t v8si __attribute__((vector_size(32)));
+typedef int16_t v8hi __attribute__((vector_size(16)));
+typedef int8_t v8qi __attribute__((vector_size(8)));
+typedef float v8sf __attribute__((vector_size(32)));
+
+// I and Q values per block, and 8-value vectors per block
+#define BLOCK_VALUES (IQ_BFP_BLOCK_SAMPLES * 2)
+#define BLOCK_VECS (BLOCK_VALUES / 8)
+
+bool iq_bfp_valid_bits(int bits) {
+    return bits == 8 || bits == 12 || bits == 16;
+}
+
+int iq_bfp_block_bytes(int bits) {
+    return 1 + BLOCK_VALUES * bits / 8;
+}
+
+// 12-bit mantissas, two per three bytes
+static void pack12(const int32_t *q, int count, uint8_t *out) {
+    for (int i = 0; i < count; i += 2, out += 3) {
+        uint32_t a = (uint32_t)q[i] & 0xFFF;
+        uint32_t b = (uint32_t)q[i + 1] & 0xFFF;
+        out[0] = (uint8_t)a;
+        out[1] = (uint8_t)((a >> 8) | (b << 4));
+        out[2] = (uint8_t)(b >> 4);
+    }
+}
+
+static void unpack12(const uint8_t *in, int count, int32_t *q) {
+    for (int i = 0; i < count; i += 2, in += 3) {
+        uint32_t a = in[0] | (uint32_t)(in[1] & 0x0F) << 8;
+        uint32_t b = (uint32_t)(in[1] >> 4) | (uint32_t)in[2] << 4;
+        q[i] = (int32_t)(a << 20) >> 20;
+        q[i + 1] = (int32_t)(b << 20) >> 20;
+    }
+}
+
+static void encode_block(const uint8_t *in, int bits, uint8_t *out) {
+    v8si x[BLOCK_VECS];
+    v8si acc = { 0 };
+
+    // Largest magnitude (one's complement, so -2^31 needs no special case)
+    for (int k = 0; k < BLOCK_VECS; k++) {
+        memcpy(&x[k], in + k * sizeof(v8si), sizeof(v8si));
+        acc |= x[k] ^ (x[k] >> 31);
+    }
+    uint32_t mag = 0;
+    for (int l = 0; l < 8; l++) mag |= (uint32_t)acc[l];
+    int used = mag ? 32 - __builtin_clz(mag) : 0;
+    int shift = used > bits - 1 ? used - (bits - 1) : 0;
+    out[0] = (uint8_t)shift;
+    out++;
+
+    v8si max_q = (v8si){ 0 } + ((1 << (bits - 1)) - 1);
+    int32_t q12[BLOCK_VALUES];
+    for (int k = 0; k < BLOCK_VECS; k++) {
+        v8si v = x[k];
+        if (shift > 0) {
+            // Round to nearest; only the positive side can overflow
+            v = ((v >> (shift - 1)) + 1) >> 1;
+            v8si over = v > max_q;
+            v = (v & ~over) | (max_q & over);
+        }
+        if (bits == 8) {
+            v8qi b = __builtin_convertvector(v, v8qi);
+            memcpy(out + k * sizeof(b), &b, sizeof(b));
+        } else if (bits == 16) {
+            v8hi h = __builtin_convertvector(v, v8hi);
+            memcpy(out + k * sizeof(h), &h, sizeof(h));
+        } else {
+            memcpy(q12 + k * 8, &v, sizeof(v));
+        }
+    }
+    if (bits == 12) pack12(q12, BLOCK_VALUES, out);
+}
+
+// Mantissas of one block (exponent byte skipped)
+static void load_mantissas(const uint8_t *in, int bits, v8si *m) {
+    if (bits == 12) {
+        int32_t q[BLOCK_VALUES];
+        unpack12(in, BLOCK_VALUES, q);
+        memcpy(m, q, sizeof(q));
+        return;
+    }
+    for (int k = 0; k < BLOCK_VECS; k++) {
+        if (bits == 8) {
+            v8qi b;
+            memcpy(&b, in + k * sizeof(b), sizeof(b));
+            m[k] = __builtin_convertvector(b, v8si);
+        } else {
+            v8hi h;
+            memcpy(&h, in + k * sizeof(h), sizeof(h));
+            m[k] = __builtin_convertvector(h, v8si);
+        }
+    }
+}
+
+int iq_bfp_encode(const uint8_t *iq_s32, int samples, int bits, uint8_t *out) {
+    if (!iq_s32 || !out || !iq_bfp_valid_bits(bits) || samples < 0 ||
+        samples % IQ_BFP_BLOCK_SAMPLES) {
+        return -1;
+    }
+    int block_bytes = iq_bfp_block_bytes(bits);
+    int blocks = samples / IQ_BFP_BLOCK_SAMPLES;
+    for (int b = 0; b < blocks; b++) {
+        encode_block(iq_s32 + (size_t)b * BLOCK_VALUES * 4, bits, out + (size_t)b * block_bytes);
+    }
+    return blocks * block_bytes;
+}
+
+int iq_bfp_decode_s32(const uint8_t *in, int bytes, int bits, uint8_t *iq_s32) {
+    if (!in || !iq_s32 || !iq_bfp_valid_bits(bits)) return -1;
+    int block_bytes = iq_bfp_block_bytes(bits);
+    if (bytes < 0 || bytes % block_bytes) return -1;
+
+    int blocks = bytes / block_bytes;
+    v8si m[BLOCK_VECS];
+    for (int b = 0; b < blocks; b++, in += block_bytes) {
+        int shift = in[0] & 31;
+        load_mantissas(in + 1, bits, m);
+        for (int k = 0; k < BLOCK_VECS; k++) {
+            v8si v = m[k] << shift;
+            memcpy(iq_s32 + ((size_t)b * BLOCK_VECS + k) * sizeof(v), &v, sizeof(v));
+        }
+    }
+    return blocks * IQ_BFP_BLOCK_SAMPLES;
+}
+
+int iq_bfp_decode_f32(const uint8_t *in, int bytes, int bits, float *iq) {
+    if (!in || !iq || !iq_bfp_valid_bits(bits)) return -1;
+    int block_bytes = iq_bfp_block_bytes(bits);
+    if (bytes < 0 || bytes % block_bytes) return -1;
+
+    int blocks = bytes / block_bytes;
+    v8si m[BLOCK_VECS];
+    for (int b = 0; b < blocks; b++, in += block_bytes) {
+        float scale = ldexpf(1.0f, (in[0] & 31) - 31);
+        load_mantissas(in + 1, bits, m);
+        for (int k = 0; k < BLOCK_VECS; k++) {
+            v8sf f = __builtin_convertvector(m[k], v8sf) * scale;
+            memcpy(iq + ((size_t)b * BLOCK_VECS + k) * 8, &f, sizeof(f));
+        }
+    }
+    return blocks * IQ_BFP_BLOCK_SAMPLES;
+}
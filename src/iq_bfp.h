@@ -0,0 +1,42 @@
+#ifndef IQ_BFP_H
+#define IQ_BFP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Block floating point IQ compression for network streams.
+//
+// Every IQ_BFP_BLOCK_SAMPLES complex samples share one exponent byte
+// (right shift applied to the 32-bit samples), followed by the I/Q
+// mantissas: 8 or 16 bits each (little-endian), or 12 bits packed two
+// per three bytes. Against 32-bit I/Q a block is 3.9x (8-bit), 2.6x
+// (12-bit) or 2.0x (16-bit) smaller. The quantization error is about
+// 6 dB per mantissa bit below the strongest sample of its block (see
+// the bfp result of bench-transport).
+//
+// The kernels work on 8 values at a time with GCC/clang vector
+// extensions, so encode and decode run at memory speed on SSE/AVX/NEON.
+
+// Complex samples per block
+#define IQ_BFP_BLOCK_SAMPLES 32
+
+// True for the supported mantissa widths (8, 12, 16)
+bool iq_bfp_valid_bits(int bits);
+
+// Encoded size of one block with bits per mantissa
+int iq_bfp_block_bytes(int bits);
+
+// Encode 32-bit LE I/Q (the FDM-DUO USB format); samples must be a
+// multiple of IQ_BFP_BLOCK_SAMPLES
+// Returns bytes written to out, -1 on invalid arguments
+int iq_bfp_encode(const uint8_t *iq_s32, int samples, int bits, uint8_t *out);
+
+// Decode whole blocks to 32-bit LE I/Q
+// Returns samples written, -1 if bytes is not a whole number of blocks
+int iq_bfp_decode_s32(const uint8_t *in, int bytes, int bits, uint8_t *iq_s32);
+
+// Decode whole blocks to float I/Q (full scale 1.0)
+// Returns samples written, -1 if bytes is not a whole number of blocks
+int iq_bfp_decode_f32(const uint8_t *in, int bytes, int bits, float *iq);
+
+#endif // IQ_BFP_H
@@ -0,0 +1,382 @@
+#define _DEFAULT_SOURCE
+#include "iq_playback.h"
+#include "app_state.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// FDM-DUO stream layout: 32-bit I + 32-bit Q
+#define BYTES_PER_SAMPLE 8
+
+// Deliver data in the same chunk size as the USB transfers
+#define PLAYBACK_CHUNK_SIZE USB_BUFFER_SIZE
+
+// Time index granularity
+#define INDEX_INTERVAL_US 100000
+
+// Index entry: time since start of file -> byte offset of that sample
+typedef struct {
+    int64_t time_us;
+    size_t offset;
+} index_entry_t;
+
+struct iq_playback {
+    int fd;
+    uint8_t *map;
+    size_t map_size;
+
+    // Sample data region within the mapping
+    size_t data_start;
+    size_t data_end;
+    int sample_rate;
+
+    // Time -> offset index (sorted by time)
+    index_entry_t *index;
+    int index_count;
+
+    // Playback control
+    double speed;
+    bool loop;
+    iq_playback_callback_t callback;
+    void *callback_user_data;
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+    atomic_int finished;
+    atomic_llong position;      // Current byte offset
+    atomic_llong pending_seek;  // Byte offset to jump to, or -1
+
+    // Throughput measurement
+    atomic_llong samples_delivered;
+    struct timespec start_time;
+};
+
+static int64_t timespec_diff_ns(const struct timespec *a, const struct timespec *b) {
+    return (int64_t)(a->tv_sec - b->tv_sec) * 1000000000LL + (a->tv_nsec - b->tv_nsec);
+}
+
+static uint32_t read_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t read_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+// Locate the sample data in a WAV file
+// Returns 0 on success (data_start/data_end/sample_rate set), -1 if not a usable WAV
+static int parse_wav_header(iq_playback_t *pb) {
+    if (pb->map_size < 12 || memcmp(pb->map, "RIFF", 4) != 0 || memcmp(pb->map + 8, "WAVE", 4) != 0) {
+        return -1;
+    }
+
+    size_t pos = 12;
+    int have_fmt = 0;
+    while (pos + 8 <= pb->map_size) {
+        const uint8_t *chunk = pb->map + pos;
+        uint32_t chunk_size = read_le32(chunk + 4);
+        size_t body = pos + 8;
+
+        if (memcmp(chunk, "fmt ", 4) == 0 && chunk_size >= 16 && body + 16 <= pb->map_size) {
+            uint16_t format = read_le16(pb->map + body);
+            uint16_t channels = read_le16(pb->map + body + 2);
+            uint32_t rate = read_le32(pb->map + body + 4);
+            uint16_t bits = read_le16(pb->map + body + 14);
+
+            // PCM (1) or WAVE_FORMAT_EXTENSIBLE (0xFFFE) with 2 x 32-bit channels
+            if ((format != 1 && format != 0xFFFE) || channels != 2 || bits != 32) {
+                fprintf(stderr, "Playback: Unsupported WAV format (fmt=%u, ch=%u, bits=%u)\n",
+                        format, channels, bits);
+                return -1;
+            }
+            pb->sample_rate = (int)rate;
+            have_fmt = 1;
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!have_fmt) return -1;
+            pb->data_start = body;
+            pb->data_end = body + chunk_size;
+            if (pb->data_end > pb->map_size) pb->data_end = pb->map_size;
+            return 0;
+        }
+
+        // Chunks are padded to even size
+        pos = body + chunk_size + (chunk_size & 1);
+    }
+
+    return -1;
+}
+
+// Build the time -> byte offset index
+// Offsets are aligned to chunk boundaries so a seek resumes on the same
+// transfer grid as normal playback
+static int build_index(iq_playback_t *pb) {
+    size_t data_len = pb->data_end - pb->data_start;
+    int64_t total_samples = (int64_t)(data_len / BYTES_PER_SAMPLE);
+    int64_t duration_us = total_samples * 1000000LL / pb->sample_rate;
+
+    pb->index_count = (int)(duration_us / INDEX_INTERVAL_US) + 1;
+    pb->index = malloc(sizeof(index_entry_t) * pb->index_count);
+    if (!pb->index) return -1;
+
+    for (int i = 0; i < pb->index_count; i++) {
+        int64_t sample = (int64_t)i * INDEX_INTERVAL_US * pb->sample_rate / 1000000LL;
+        size_t offset = (size_t)sample * BYTES_PER_SAMPLE;
+        offset -= offset % PLAYBACK_CHUNK_SIZE;
+
+        pb->index[i].offset = pb->data_start + offset;
+        pb->index[i].time_us = (int64_t)(offset / BYTES_PER_SAMPLE) * 1000000LL / pb->sample_rate;
+    }
+
+    return 0;
+}
+
+iq_playback_t *iq_playback_open(const char *path, int sample_rate) {
+    if (!path) return NULL;
+
+    iq_playback_t *pb = calloc(1, sizeof(iq_playback_t));
+    if (!pb) return NULL;
+    pb->fd = -1;
+    pb->speed = 1.0;
+    atomic_store(&pb->pending_seek, -1);
+
+    pb->fd = open(path, O_RDONLY);
+    if (pb->fd < 0) {
+        fprintf(stderr, "Playback: Cannot open %s: %s\n", path, strerror(errno));
+        iq_playback_free(pb);
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(pb->fd, &st) != 0 || st.st_size < BYTES_PER_SAMPLE) {
+        fprintf(stderr, "Playback: %s is empty or unreadable\n", path);
+        iq_playback_free(pb);
+        return NULL;
+    }
+    pb->map_size = (size_t)st.st_size;
+
+    pb->map = mmap(NULL, pb->map_size, PROT_READ, MAP_PRIVATE, pb->fd, 0);
+    if (pb->map == MAP_FAILED) {
+        fprintf(stderr, "Playback: mmap failed: %s\n", strerror(errno));
+        pb->map = NULL;
+        iq_playback_free(pb);
+        return NULL;
+    }
+    // Data is consumed front to back - let the kernel read ahead aggressively
+    madvise(pb->map, pb->map_size, MADV_SEQUENTIAL);
+
+    if (parse_wav_header(pb) != 0) {
+        // Raw dump of the USB stream
+        pb->data_start = 0;
+        pb->data_end = pb->map_size;
+        pb->sample_rate = sample_rate > 0 ? sample_rate : DEFAULT_SAMPLE_RATE;
+    }
+    // Drop any trailing partial sample
+    pb->data_end -= (pb->data_end - pb->data_start) % BYTES_PER_SAMPLE;
+
+    if (pb->sample_rate <= 0 || pb->data_end <= pb->data_start || build_index(pb) != 0) {
+        fprintf(stderr, "Playback: No usable IQ data in %s\n", path);
+        iq_playback_free(pb);
+        return NULL;
+    }
+
+    atomic_store(&pb->position, (long long)pb->data_start);
+
+    fprintf(stderr, "Playback: Opened %s (%d Hz, %.1f s)\n",
+            path, pb->sample_rate, iq_playback_get_duration(pb));
+    return pb;
+}
+
+void iq_playback_free(iq_playback_t *pb) {
+    if (!pb) return;
+
+    iq_playback_stop(pb);
+
+    if (pb->map) {
+        munmap(pb->map, pb->map_size);
+    }
+    if (pb->fd >= 0) {
+        close(pb->fd);
+    }
+    free(pb->index);
+    free(pb);
+}
+
+void iq_playback_set_speed(iq_playback_t *pb, double speed) {
+    if (!pb) return;
+    pb->speed = speed > 0.0 ? speed : IQ_PLAYBACK_SPEED_MAX;
+}
+
+void iq_playback_set_loop(iq_playback_t *pb, bool loop) {
+    if (!pb) return;
+    pb->loop = loop;
+}
+
+// Find byte offset for a time using binary search over the index
+static long long index_lookup(const iq_playback_t *pb, int64_t time_us) {
+    int lo = 0;
+    int hi = pb->index_count - 1;
+
+    // Largest entry with time_us <= target
+    while (lo < hi) {
+        int mid = (lo + hi + 1) / 2;
+        if (pb->index[mid].time_us <= time_us) {
+            lo = mid;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return (long long)pb->index[lo].offset;
+}
+
+int iq_playback_seek(iq_playback_t *pb, double seconds) {
+    if (!pb || seconds < 0.0 || seconds > iq_playback_get_duration(pb)) return -1;
+
+    long long offset = index_lookup(pb, (int64_t)(seconds * 1e6));
+
+    if (pb->thread_started) {
+        // Picked up by the playback thread before the next chunk
+        atomic_store(&pb->pending_seek, offset);
+    } else {
+        atomic_store(&pb->position, offset);
+    }
+    atomic_store(&pb->finished, 0);
+    return 0;
+}
+
+static void *playback_thread_func(void *user_data) {
+    iq_playback_t *pb = (iq_playback_t *)user_data;
+
+    fprintf(stderr, "Playback thread started (%s)\n",
+            pb->speed == IQ_PLAYBACK_SPEED_MAX ? "as fast as possible" : "paced");
+
+    // Pacing origin: wall clock time and sample count at which it was taken
+    struct timespec pace_start;
+    int64_t pace_samples = 0;
+    clock_gettime(CLOCK_MONOTONIC, &pace_start);
+
+    size_t pos = (size_t)atomic_load(&pb->position);
+
+    while (atomic_load(&pb->running)) {
+        long long seek = atomic_exchange(&pb->pending_seek, -1);
+        if (seek >= 0) {
+            pos = (size_t)seek;
+            clock_gettime(CLOCK_MONOTONIC, &pace_start);
+            pace_samples = 0;
+        }
+
+        if (pos >= pb->data_end) {
+            if (!pb->loop) {
+                atomic_store(&pb->finished, 1);
+                break;
+            }
+            pos = pb->data_start;
+        }
+
+        size_t len = pb->data_end - pos;
+        if (len > PLAYBACK_CHUNK_SIZE) len = PLAYBACK_CHUNK_SIZE;
+
+        // Zero-copy: hand the mapped pages straight to the pipeline
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        uint64_t now_ns = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+        pb->callback(pb->map + pos, (int)len, now_ns, pb->callback_user_data);
+
+        pos += len;
+        atomic_store(&pb->position, (long long)pos);
+
+        int64_t samples = (int64_t)(len / BYTES_PER_SAMPLE);
+        atomic_fetch_add(&pb->samples_delivered, samples);
+        pace_samples += samples;
+
+        // Pace to the requested speed
+        if (pb->speed != IQ_PLAYBACK_SPEED_MAX) {
+            int64_t due_ns = (int64_t)((double)pace_samples * 1e9 / (pb->sample_rate * pb->speed));
+            struct timespec due = pace_start;
+            due.tv_sec += due_ns / 1000000000LL;
+            due.tv_nsec += due_ns % 1000000000LL;
+            if (due.tv_nsec >= 1000000000L) {
+                due.tv_sec++;
+                due.tv_nsec -= 1000000000L;
+            }
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+        }
+    }
+
+    if (pb->speed == IQ_PLAYBACK_SPEED_MAX) {
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double elapsed = timespec_diff_ns(&now, &pb->start_time) / 1e9;
+        fprintf(stderr, "Playback: %lld samples in %.3f s = %.2f MS/s through the pipeline\n",
+                (long long)atomic_load(&pb->samples_delivered), elapsed,
+                iq_playback_get_throughput_msps(pb));
+    }
+
+    fprintf(stderr, "Playback thread stopped\n");
+    return NULL;
+}
+
+int iq_playback_start(iq_playback_t *pb, iq_playback_callback_t callback, void *user_data) {
+    if (!pb || !callback) return -1;
+    if (pb->thread_started) return 0;
+
+    pb->callback = callback;
+    pb->callback_user_data = user_data;
+    atomic_store(&pb->samples_delivered, 0);
+    atomic_store(&pb->finished, 0);
+    atomic_store(&pb->running, 1);
+    clock_gettime(CLOCK_MONOTONIC, &pb->start_time);
+
+    if (pthread_create(&pb->thread, NULL, playback_thread_func, pb) != 0) {
+        fprintf(stderr, "Playback: Failed to create thread\n");
+        atomic_store(&pb->running, 0);
+        return -1;
+    }
+    pb->thread_started = 1;
+    return 0;
+}
+
+void iq_playback_stop(iq_playback_t *pb) {
+    if (!pb || !pb->thread_started) return;
+
+    atomic_store(&pb->running, 0);
+    pthread_join(pb->thread, NULL);
+    pb->thread_started = 0;
+}
+
+bool iq_playback_is_finished(iq_playback_t *pb) {
+    return pb && atomic_load(&pb->finished) != 0;
+}
+
+double iq_playback_get_duration(iq_playback_t *pb) {
+    if (!pb || pb->sample_rate <= 0) return 0.0;
+    return (double)((pb->data_end - pb->data_start) / BYTES_PER_SAMPLE) / pb->sample_rate;
+}
+
+double iq_playback_get_position(iq_playback_t *pb) {
+    if (!pb || pb->sample_rate <= 0) return 0.0;
+    size_t pos = (size_t)atomic_load(&pb->position);
+    return (double)((pos - pb->data_start) / BYTES_PER_SAMPLE) / pb->sample_rate;
+}
+
+int iq_playback_get_sample_rate(iq_playback_t *pb) {
+    return pb ? pb->sample_rate : 0;
+}
+
+double iq_playback_get_throughput_msps(iq_playback_t *pb) {
+    if (!pb) return 0.0;
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double elapsed = timespec_diff_ns(&now, &pb->start_time) / 1e9;
+    if (elapsed <= 0.0) return 0.0;
+
+    return (double)atomic_load(&pb->samples_delivered) / elapsed / 1e6;
+}
@@ -0,0 +1,59 @@
+#ifndef IQ_PLAYBACK_H
+#define IQ_PLAYBACK_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Playback speed value meaning "as fast as possible" (benchmark mode)
+#define IQ_PLAYBACK_SPEED_MAX 0.0
+
+typedef struct iq_playback iq_playback_t;
+
+// Callback for played-back IQ data (same layout as the FDM-DUO USB stream:
+// 32-bit little-endian I then Q, 8 bytes per sample). The data pointer
+// points straight into the memory-mapped file and is only valid during
+// the call. timestamp_ns is the delivery time (CLOCK_MONOTONIC).
+typedef void (*iq_playback_callback_t)(const uint8_t *data, int length, uint64_t timestamp_ns,
+                                       void *user_data);
+
+// Open a recorded IQ file and memory-map it
+// Accepts raw 32-bit IQ dumps (sample_rate is used) or 32-bit stereo
+// PCM WAV files (sample rate is read from the header)
+// Returns NULL on error
+iq_playback_t *iq_playback_open(const char *path, int sample_rate);
+
+// Stop playback, unmap the file and free the player
+void iq_playback_free(iq_playback_t *pb);
+
+// Set playback speed: 1.0 = real time, N = N x real time,
+// IQ_PLAYBACK_SPEED_MAX = as fast as possible
+void iq_playback_set_speed(iq_playback_t *pb, double speed);
+
+// Restart from the beginning when the end of file is reached
+void iq_playback_set_loop(iq_playback_t *pb, bool loop);
+
+// Seek to a position in seconds (uses the time index)
+// Returns 0 on success, -1 if the position is outside the file
+int iq_playback_seek(iq_playback_t *pb, double seconds);
+
+// Start the playback thread, delivering data to callback
+// Returns 0 on success, -1 on error
+int iq_playback_start(iq_playback_t *pb, iq_playback_callback_t callback, void *user_data);
+
+// Stop the playback thread (blocks until it exits)
+void iq_playback_stop(iq_playback_t *pb);
+
+// Check if playback reached the end of the file (never true when looping)
+bool iq_playback_is_finished(iq_playback_t *pb);
+
+// Get file duration and current position in seconds
+double iq_playback_get_duration(iq_playback_t *pb);
+double iq_playback_get_position(iq_playback_t *pb);
+
+// Get sample rate of the file
+int iq_playback_get_sample_rate(iq_playback_t *pb);
+
+// Get pipeline throughput in mega-samples per second since start
+double iq_playback_get_throughput_msps(iq_playback_t *pb);
+
+#endif // IQ_PLAYBACK_H
@@ -0,0 +1,144 @@
+#define _DEFAULT_SOURCE
+#include "iq_ring.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+
+typedef struct {
+    int length;
+    uint64_t timestamp_ns;
+    uint8_t *data;
+} ring_slot_t;
+
+struct iq_ring {
+    ring_slot_t *slots;
+    uint8_t *storage;
+    int slot_count;
+    int slot_size;
+
+    // Producer-owned write index, consumer-owned read index
+    int write_index;
+    int read_index;
+
+    sem_t free_slots;  // Slots the producer may fill
+    sem_t used_slots;  // Slots the consumer may read
+
+    atomic_long dropped;
+};
+
+iq_ring_t *iq_ring_new(int slot_count, int slot_size) {
+    if (slot_count <= 0 || slot_size <= 0) return NULL;
+
+    iq_ring_t *ring = calloc(1, sizeof(iq_ring_t));
+    if (!ring) return NULL;
+
+    ring->slot_count = slot_count;
+    ring->slot_size = slot_size;
+    ring->slots = calloc(slot_count, sizeof(ring_slot_t));
+    ring->storage = malloc((size_t)slot_count * slot_size);
+    if (!ring->slots || !ring->storage) {
+        free(ring->slots);
+        free(ring->storage);
+        free(ring);
+        return NULL;
+    }
+
+    for (int i = 0; i < slot_count; i++) {
+        ring->slots[i].data = ring->storage + (size_t)i * slot_size;
+    }
+
+    sem_init(&ring->free_slots, 0, slot_count);
+    sem_init(&ring->used_slots, 0, 0);
+    return ring;
+}
+
+void iq_ring_free(iq_ring_t *ring) {
+    if (!ring) return;
+    sem_destroy(&ring->free_slots);
+    sem_destroy(&ring->used_slots);
+    free(ring->slots);
+    free(ring->storage);
+    free(ring);
+}
+
+// sem_timedwait with a relative timeout in milliseconds
+static int sem_wait_ms(sem_t *sem, int timeout_ms) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout_ms / 1000;
+    ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+
+    while (sem_timedwait(sem, &ts) != 0) {
+        if (errno != EINTR) return -1;
+    }
+    return 0;
+}
+
+int iq_ring_push(iq_ring_t *ring, const uint8_t *data, int length, uint64_t timestamp_ns,
+                 bool block, int timeout_ms) {
+    if (!ring || !data || length <= 0) return -1;
+
+    int res = block ? sem_wait_ms(&ring->free_slots, timeout_ms) : sem_trywait(&ring->free_slots);
+    if (res != 0) {
+        atomic_fetch_add_explicit(&ring->dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    if (length > ring->slot_size) length = ring->slot_size;
+
+    ring_slot_t *slot = &ring->slots[ring->write_index];
+    memcpy(slot->data, data, length);
+    slot->length = length;
+    slot->timestamp_ns = timestamp_ns;
+    ring->write_index = (ring->write_index + 1) % ring->slot_count;
+
+    // sem_post publishes the slot contents to the consumer
+    sem_post(&ring->used_slots);
+    return 0;
+}
+
+const uint8_t *iq_ring_read_begin(iq_ring_t *ring, int *length, uint64_t *timestamp_ns,
+                                  int timeout_ms) {
+    if (!ring) return NULL;
+
+    if (sem_wait_ms(&ring->used_slots, timeout_ms) != 0) {
+        return NULL;
+    }
+
+    ring_slot_t *slot = &ring->slots[ring->read_index];
+    if (length) *length = slot->length;
+    if (timestamp_ns) *timestamp_ns = slot->timestamp_ns;
+    return slot->data;
+}
+
+void iq_ring_read_commit(iq_ring_t *ring) {
+    if (!ring) return;
+    ring->read_index = (ring->read_index + 1) % ring->slot_count;
+    sem_post(&ring->free_slots);
+}
+
+void iq_ring_flush(iq_ring_t *ring) {
+    if (!ring) return;
+    while (sem_trywait(&ring->used_slots) == 0) {
+        iq_ring_read_commit(ring);
+    }
+}
+
+long iq_ring_get_dropped(iq_ring_t *ring) {
+    return ring ? atomic_load_explicit(&ring->dropped, memory_order_relaxed) : 0;
+}
+
+int iq_ring_get_fill(iq_ring_t *ring) {
+    if (!ring) return 0;
+    int value = 0;
+    sem_getvalue(&ring->used_slots, &value);
+    return value;
+}
@@ -0,0 +1,45 @@
+#ifndef IQ_RING_H
+#define IQ_RING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Single-producer / single-consumer ring of fixed-size IQ chunks.
+// The producer (USB callback or playback thread) copies whole transfers in,
+// the consumer (DSP thread) processes them in order. Slot indices are only
+// written by their owning side; counting semaphores provide the wakeups.
+
+typedef struct iq_ring iq_ring_t;
+
+// Create ring with slot_count slots of slot_size bytes each
+iq_ring_t *iq_ring_new(int slot_count, int slot_size);
+
+// Free ring
+void iq_ring_free(iq_ring_t *ring);
+
+// Copy a chunk into the ring, with its capture timestamp
+// If the ring is full: drop the chunk (block = false) or wait for a free
+// slot (block = true, gives up after timeout_ms and drops)
+// Returns 0 if queued, -1 if dropped
+int iq_ring_push(iq_ring_t *ring, const uint8_t *data, int length, uint64_t timestamp_ns,
+                 bool block, int timeout_ms);
+
+// Wait up to timeout_ms for the next chunk
+// timestamp_ns (may be NULL) receives the timestamp it was pushed with
+// Returns pointer to chunk data (valid until iq_ring_read_commit) or NULL on timeout
+const uint8_t *iq_ring_read_begin(iq_ring_t *ring, int *length, uint64_t *timestamp_ns,
+                                  int timeout_ms);
+
+// Release the chunk returned by iq_ring_read_begin
+void iq_ring_read_commit(iq_ring_t *ring);
+
+// Discard all queued chunks (consumer side)
+void iq_ring_flush(iq_ring_t *ring);
+
+// Number of chunks dropped because the ring was full
+long iq_ring_get_dropped(iq_ring_t *ring);
+
+// Number of chunks currently queued
+int iq_ring_get_fill(iq_ring_t *ring);
+
+#endif // IQ_RING_H
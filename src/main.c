@@ -4,7 +4,12 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
 #include <unistd.h>
+#include <math.h>
+#include <sys/stat.h>
 
 #include "app_state.h"
 #include "usb_device.h"
@@ -14,6 +19,19 @@
 #include "cat_control.h"
 #include "settings.h"
 #include "bandplan.h"
+#include "iq_playback.h"
+#include "synthetic_source.h"
+#include "radio_pipeline.h"
+#include "rt_sched.h"
+#include "perf_trace.h"
+#include "metrics_server.h"
+#include "mono_clock.h"
+#include "spectrum_server.h"
+#include "tile_writer.h"
+#include "occupancy.h"
+#include "spectrum_archive.h"
+#include "audio_output.h"
+#include "cw_bank.h"
 #ifdef HAVE_GPIOD
 #include "rotary_encoder.h"
 #endif
@@ -33,22 +51,84 @@ typedef enum {
     ENCODER2_MODE_PAN = 1
 } encoder2_mode_t;
 
-// Application state
+// Maximum number of radios shown side by side
+#define MAX_RADIOS 4
+
+// Default CAT serial port (used by the first radio)
+#define DEFAULT_CAT_DEVICE "/dev/ttyUSB0"
+
+// Band plan activity frequencies followed per radio (--channels)
+#define MAX_CHANNEL_TARGETS 32
+
+// --cw-decode: channelizer size when --channels is not given (375 Hz
+// channels at 192 kS/s), and the widest detection taken for a CW carrier
+#define CW_DEFAULT_CHANNELS 512
+#define CW_MAX_WIDTH_HZ 300.0
+
+// Occupancy heatmap ('o'): columns across the span, and refresh interval
+// in display frames (~10 s)
+#define OCCUPANCY_COLUMNS 1024
+#define OCCUPANCY_REFRESH_FRAMES 300
+
+// Activity frequency in a radio's span and the channel that carries it
 typedef struct {
-    GtkApplication *app;
-    GtkWidget *window;
+    const band_frequency_t *freq;
+    int64_t centre_hz;    // Centre of the activity (dial + 1500 Hz for digital modes)
+    int channel;          // Channelizer channel
+    double residual_hz;   // centre_hz relative to the channel centre
+} channel_target_t;
+
+// Per-radio pipeline and display pane
+typedef struct {
+    radio_pipeline_t *pipeline;
+    cat_control_t *cat;      // NULL if this radio has no CAT port
+    spectrum_shm_t *shm;     // Shared-memory ring (--shm), NULL if off
+    tile_writer_t *tiles;    // Waterfall tiles (--headless), NULL if off
+    cw_bank_t *cw;           // CW decoders (--cw-decode), NULL if off
+    occupancy_t *occupancy;  // Occupancy store (--occupancy), NULL if off
+    spectrum_archive_t *archive;  // Spectrum archive (--archive), NULL if off
+    band_sweep_t *sweep;     // Band sweep (--sweep), NULL if off
+    long sweeps_reported;
+    char serial[USB_SERIAL_LEN];
+    char cat_device[64];
+
     GtkWidget *spectrum;
     GtkWidget *spectrum_frame;
     GtkWidget *waterfall;
     GtkWidget *status_icon;  // Actually a label with colored circle
+
+    int center_freq_hz;
+    elad_mode_t current_mode;
+    int current_vfo;  // 0=VFO A, 1=VFO B
+    char current_filter[16];  // Filter bandwidth string
+    int connect_count;  // Last seen pipeline connect count
+
+    // Channels carrying the band plan activity frequencies in the span
+    channel_target_t channel_targets[MAX_CHANNEL_TARGETS];
+    int channel_target_count;
+
+    // Previous USB statistics snapshot (for per-second rates)
+    usb_stats_t last_stats;
+    gint64 last_stats_time;
+
+    // Smoothed noise floor and peak (automatic ref/range)
+    spectrum_levels_t levels;
+    gboolean have_levels;
+} radio_pane_t;
+
+// Application state
+typedef struct {
+    GtkApplication *app;
+    GtkWidget *window;
     GtkAdjustment *ref_adj;           // Spectrum reference level
     GtkAdjustment *range_adj;         // Spectrum dynamic range
     GtkAdjustment *waterfall_ref_adj;   // Waterfall reference level
     GtkAdjustment *waterfall_range_adj; // Waterfall dynamic range
 
-    usb_device_t *usb;
-    fft_processor_t *fft;
-    cat_control_t *cat;
+    // One pane per radio
+    radio_pane_t panes[MAX_RADIOS];
+    int num_panes;
+    libusb_context *usb_ctx;  // Radio enumeration only
 #ifdef HAVE_GPIOD
     rotary_encoder_t *encoder1;       // Parameter control encoder
     rotary_encoder_t *encoder2;       // Zoom/pan control encoder
@@ -60,20 +140,44 @@ typedef struct {
     int pan_offset;                   // Shared pan for spectrum/waterfall
 #endif
 
-    pthread_t usb_thread;
     atomic_int running;
-    atomic_int usb_connected;
-
-    // Latest spectrum for display update
-    GMutex spectrum_mutex;
-    float spectrum_db[FFT_SIZE];
-    atomic_int spectrum_ready;
-
-    int center_freq_hz;
-    elad_mode_t current_mode;
-    int current_vfo;  // 0=VFO A, 1=VFO B
-    char current_filter[16];  // Filter bandwidth string
     int freq_poll_counter;
+    int stats_counter;
+    gboolean show_usb_stats;  // USB stream health overlay
+    gboolean show_perf_stats; // Stage timing overlay (first pane)
+    int perf_dump_seconds;    // --stats interval (0 = off)
+    int metrics_port;         // --metrics-port (0 = off)
+    metrics_server_t *metrics;
+    int spectrum_port;        // --spectrum-port (0 = off)
+    spectrum_server_t *spectrum_server;
+    gboolean shm_enabled;     // --shm: per-radio shared-memory rings
+
+    // Previous stage timing snapshots, for per-interval percentiles
+    perf_snapshot_t perf_overlay_prev;
+    gint64 perf_overlay_time;
+    perf_snapshot_t perf_dump_prev;
+    gint64 perf_dump_time;
+
+    // Sample-to-pixel latency self-test (--latency-test)
+    gboolean latency_test;
+    int latency_bursts;         // Bursts seen in fetched spectra
+    gboolean latency_burst_on;  // Tone was above noise in the last spectrum
+
+    // Thread scheduling (--usb-cpu, --dsp-cpu, --rt-policy, --rt-prio, --mlock)
+    rt_thread_config_t usb_rt;
+    rt_thread_config_t dsp_rt;
+    gboolean lock_memory;
+    fft_window_t fft_window;  // Spectrum estimator (--window)
+    gboolean detect_signals;  // Carrier detector and markers (--detect)
+    gboolean auto_range;      // Ref/range follow noise floor and peaks
+    GtkWidget *auto_check;    // "Auto" check button (normal mode)
+    GtkWidget *ref_spin;      // Spectrum Ref/Rng spin buttons (normal mode)
+    GtkWidget *range_spin;
+    int default_freq_hz;  // Shown until a radio reports its frequency
+
+    // Radios requested on the command line (--radio SERIAL[,CATDEV])
+    const char *radio_args[MAX_RADIOS];
+    int num_radio_args;
 
     // Command-line options
     gboolean fullscreen;
@@ -81,6 +185,48 @@ typedef struct {
     int window_width;
     int window_height;
 
+    // IQ file playback (replaces the USB source when set)
+    const char *playback_path;
+    double playback_speed;
+    double playback_seek;
+    int playback_rate;
+    gboolean playback_loop;
+
+    // UDP IQ stream (replaces the USB source when set, rate from --rate)
+    int udp_port;
+
+    // Headless mode: waterfall tiles instead of a window (--headless DIR)
+    const char *headless_dir;
+    tile_writer_config_t tile_config;
+
+    // Polyphase channelizer per radio (--channels N, 0 = off)
+    int channelizer_channels;
+
+    // CW decoder bank per radio on the detected carriers (--cw-decode)
+    gboolean cw_decode;
+    int cw_threads;  // Worker threads (--cw-threads, 0 = auto)
+
+    // Long-term occupancy per radio (--occupancy DIR, --occupancy-db)
+    const char *occupancy_dir;
+    float occupancy_db;
+    gboolean show_occupancy;  // Heatmap over the waterfall ('o')
+    int occupancy_counter;
+
+    // Every spectrum line per radio (--archive DIR, --archive-gate)
+    const char *archive_dir;
+    float archive_gate_db;
+
+    // Panoramic sweep instead of the radio's own span (--sweep START-STOP,
+    // --sweep-frames, --sweep-settle)
+    gboolean sweep_enabled;
+    band_sweep_config_t sweep_config;
+
+    // Demodulated audio of the first radio (--audio SINK, --mode)
+    const char *audio_sink;
+    audio_output_t *audio;
+    demod_mode_t audio_mode;
+    gboolean audio_mode_forced;  // --mode given: ignore the radio's mode
+
     // Settings auto-save
     guint save_timeout_id;
 
@@ -130,195 +276,360 @@ static int parse_bandwidth_hz(const char *bw_str, int *offset_hz, int *is_resona
     return (int)value;
 }
 
-// USB data callback - called from USB thread
-static void usb_data_callback(const uint8_t *data, int length, void *user_data) {
-    app_data_t *app_data = (app_data_t *)user_data;
-    (void)length;  // Unused
+// Follow the first radio's mode and filter with the demodulator
+// (--mode fixes the mode, e.g. for recordings without CAT)
+static void update_audio_mode(app_data_t *app_data, radio_pane_t *pane) {
+    if (!app_data->audio || pane != &app_data->panes[0]) return;
+
+    demod_mode_t mode = app_data->audio_mode;
+    if (!app_data->audio_mode_forced) {
+        switch (pane->current_mode) {
+            case ELAD_MODE_AM:  mode = DEMOD_AM; break;
+            case ELAD_MODE_LSB: mode = DEMOD_LSB; break;
+            case ELAD_MODE_USB: mode = DEMOD_USB; break;
+            case ELAD_MODE_CW:  mode = DEMOD_CW; break;
+            case ELAD_MODE_CWR: mode = DEMOD_CWR; break;
+            case ELAD_MODE_FM:  mode = DEMOD_FM; break;
+            default: return;  // Not known yet: keep the current mode
+        }
+    }
 
-    // Process data through FFT
-    if (fft_processor_process(app_data->fft, data, length)) {
-        // New spectrum ready - copy to shared buffer
-        g_mutex_lock(&app_data->spectrum_mutex);
-        fft_processor_get_spectrum_db(app_data->fft, app_data->spectrum_db);
-        atomic_store(&app_data->spectrum_ready, 1);
-        g_mutex_unlock(&app_data->spectrum_mutex);
+    // The filter string belongs to the radio's mode, only use it with that
+    int offset_hz = 0;
+    int bandwidth_hz = 0;
+    if (!app_data->audio_mode_forced) {
+        bandwidth_hz = parse_bandwidth_hz(pane->current_filter, &offset_hz, NULL);
     }
+    audio_output_set_mode(app_data->audio, mode, bandwidth_hz, offset_hz);
 }
 
-// USB thread function
-static void *usb_thread_func(void *user_data) {
-    app_data_t *app_data = (app_data_t *)user_data;
-
-    fprintf(stderr, "USB thread started\n");
-
-    while (atomic_load(&app_data->running)) {
-        // Check for disconnection (detected via transfer errors)
-        if (usb_device_is_open(app_data->usb) && usb_device_check_disconnected(app_data->usb)) {
-            fprintf(stderr, "USB device disconnected, closing...\n");
-            usb_device_close(app_data->usb);
-            atomic_store(&app_data->usb_connected, 0);
-            // Also close CAT - serial port will be invalid
-            cat_control_close(app_data->cat);
-            usleep(500000);  // Wait 500ms before attempting reconnect
-            continue;
-        }
+// Map the band plan activity frequencies in a radio's span to channels
+// of its channelizer, and restart CW decoding (after every retune)
+static void update_pane_channels(app_data_t *app_data, radio_pane_t *pane) {
+    cw_bank_clear(pane->cw);
+    channelizer_t *ch = radio_pipeline_get_channelizer(pane->pipeline);
+    pane->channel_target_count = 0;
+    if (!ch || pane->center_freq_hz <= 0) return;
+
+    int sample_rate = radio_pipeline_get_sample_rate(pane->pipeline);
+    int indices[MAX_CHANNEL_TARGETS];
+    int found = bandplan_find_frequencies(&app_data->bandplan,
+                                          pane->center_freq_hz - sample_rate / 2,
+                                          pane->center_freq_hz + sample_rate / 2,
+                                          indices, MAX_CHANNEL_TARGETS);
+    for (int i = 0; i < found; i++) {
+        const band_frequency_t *freq = &app_data->bandplan.frequencies[indices[i]];
+
+        // Digital modes are listed by their USB dial frequency, the
+        // signals sit 0-3 kHz above it; CW entries are the signal itself
+        int64_t centre_hz = freq->freq_hz;
+        if (strncmp(freq->mode, "cw", 2) != 0) centre_hz += 1500;
+
+        channel_target_t *target = &pane->channel_targets[pane->channel_target_count];
+        target->channel = channelizer_find_channel(ch, (double)(centre_hz - pane->center_freq_hz),
+                                                   &target->residual_hz);
+        if (target->channel < 0) continue;
+        target->freq = freq;
+        target->centre_hz = centre_hz;
+        pane->channel_target_count++;
+
+        fprintf(stderr, "Channelizer: %.6f MHz %s -> channel %d (%+.0f Hz)\n",
+                freq->freq_hz / 1e6, freq->mode, target->channel, target->residual_hz);
+    }
+}
 
-        if (!usb_device_is_open(app_data->usb)) {
-            // Try to open device
-            if (usb_device_open(app_data->usb) == 0) {
-                // Give device time to fully initialize after power-on
-                // The FPGA and USB controller need time to stabilize
-                fprintf(stderr, "Waiting for device to stabilize (3s)...\n");
-                usleep(3000000);  // 3 seconds
+// Update a pane's frame label (VFO, plus serial when several radios are shown)
+static void update_pane_label(app_data_t *app_data, radio_pane_t *pane) {
+    const char *vfo_str = pane->current_vfo == 0 ? "VFO A" : "VFO B";
+    if (app_data->num_panes > 1) {
+        char label[64];
+        const char *serial = radio_pipeline_get_serial(pane->pipeline);
+        snprintf(label, sizeof(label), "%s - %s", serial[0] ? serial : "FDM-DUO", vfo_str);
+        gtk_frame_set_label(GTK_FRAME(pane->spectrum_frame), label);
+    } else {
+        gtk_frame_set_label(GTK_FRAME(pane->spectrum_frame), vfo_str);
+    }
+}
 
-                atomic_store(&app_data->usb_connected, 1);
-                fprintf(stderr, "USB device connected\n");
+// Whether the pipeline's USB thread polls this radio's tuning itself (no
+// CAT port, not sweeping); the UI then only reads what it published
+static gboolean pane_tuning_polled(radio_pane_t *pane) {
+    return radio_pipeline_get_usb(pane->pipeline) && !pane->sweep &&
+           !cat_control_is_open(pane->cat);
+}
 
-                // Try to reopen CAT serial port (it may have been recreated)
-                if (!cat_control_is_open(app_data->cat)) {
-                    cat_control_open(app_data->cat, "/dev/ttyUSB0");
-                }
+// Update overlay with frequency, mode and filter, and the waterfall bandwidth lines
+static void update_pane_overlay(radio_pane_t *pane) {
+    char freq_str[32];
+    char mode_filter_str[32];
+    snprintf(freq_str, sizeof(freq_str), "%.6f MHz", pane->center_freq_hz / 1e6);
+    snprintf(mode_filter_str, sizeof(mode_filter_str), "%s %s",
+             usb_device_mode_name(pane->current_mode),
+             pane->current_filter);
+    spectrum_widget_set_overlay(SPECTRUM_WIDGET(pane->spectrum),
+                                freq_str, mode_filter_str);
+
+    int offset_hz = 0;
+    int is_resonator = 0;
+    int bw_hz = parse_bandwidth_hz(pane->current_filter, &offset_hz, &is_resonator);
+    waterfall_widget_set_bandwidth(WATERFALL_WIDGET(pane->waterfall),
+                                   bw_hz, pane->current_mode, offset_hz, is_resonator);
+
+    if (!pane_tuning_polled(pane)) {
+        radio_pipeline_set_tuning(pane->pipeline, pane->center_freq_hz, pane->current_mode);
+    }
+}
 
-                // Read current frequency from radio (don't change it)
-                long freq = usb_device_get_frequency(app_data->usb);
-                if (freq > 0 && freq < 100000000) {  // Sanity check: < 100 MHz
-                    app_data->center_freq_hz = (int)freq;
-                    fprintf(stderr, "Radio frequency: %ld Hz\n", freq);
-                } else {
-                    fprintf(stderr, "Radio frequency invalid: %ld Hz (using previous)\n", freq);
-                }
+// Update a pane's connection indicator
+static void update_pane_status(radio_pane_t *pane) {
+    if (gtk_widget_has_css_class(pane->status_icon, "error")) return;
 
-                // Start streaming
-                if (usb_device_start_streaming(app_data->usb, usb_data_callback, app_data) != 0) {
-                    fprintf(stderr, "Failed to start streaming\n");
-                    usb_device_close(app_data->usb);
-                    atomic_store(&app_data->usb_connected, 0);
-                }
-            } else {
-                // Device not found, wait and retry
-                usleep(1000000);  // 1 second
-                continue;
-            }
-        }
+    if (radio_pipeline_is_connected(pane->pipeline)) {
+        gtk_label_set_text(GTK_LABEL(pane->status_icon), "●");
+        gtk_widget_remove_css_class(GTK_WIDGET(pane->status_icon), "disconnected");
+        gtk_widget_add_css_class(GTK_WIDGET(pane->status_icon), "connected");
+    } else {
+        gtk_label_set_text(GTK_LABEL(pane->status_icon), "○");
+        gtk_widget_remove_css_class(GTK_WIDGET(pane->status_icon), "connected");
+        gtk_widget_add_css_class(GTK_WIDGET(pane->status_icon), "disconnected");
+    }
+}
 
-        // Handle USB events (with timeout to allow disconnect check)
-        int res = usb_device_handle_events(app_data->usb);
-        if (res < 0) {
-            fprintf(stderr, "USB error: %d\n", res);
-            usb_device_close(app_data->usb);
-            atomic_store(&app_data->usb_connected, 0);
-        }
+// Read frequency, mode and VFO (left unchanged without CAT) from one radio
+// Returns 0 on success, -1 if the radio did not answer
+static int read_pane_tuning(radio_pane_t *pane, long *freq, elad_mode_t *mode, int *vfo) {
+    if (cat_control_is_open(pane->cat)) {
+        return cat_control_get_freq_mode(pane->cat, freq, mode, vfo);
     }
+    if (!radio_pipeline_get_usb(pane->pipeline)) return -1;
+    *freq = radio_pipeline_get_tuned_freq(pane->pipeline);
+    *mode = radio_pipeline_get_tuned_mode(pane->pipeline);
+    return *freq > 0 ? 0 : -1;
+}
 
-    // Cleanup
-    usb_device_stop_streaming(app_data->usb);
-    usb_device_close(app_data->usb);
+// Read frequency, mode, VFO and filter from one radio
+// Uses the CAT port if the radio has one, otherwise the USB control channel
+static void poll_pane(app_data_t *app_data, radio_pane_t *pane) {
+    long freq;
+    elad_mode_t mode;
+    int vfo = pane->current_vfo;
 
-    fprintf(stderr, "USB thread stopped\n");
-    return NULL;
-}
+    if (read_pane_tuning(pane, &freq, &mode, &vfo) != 0) return;
 
-// Display refresh timer callback - called from GTK main thread
-static gboolean refresh_display(gpointer user_data) {
-    app_data_t *app_data = (app_data_t *)user_data;
+    gboolean freq_changed = (freq > 0 && freq != pane->center_freq_hz);
+    gboolean mode_changed = (mode != pane->current_mode);
+    gboolean vfo_changed = (vfo != pane->current_vfo);
 
-    if (!atomic_load(&app_data->running)) {
-        return G_SOURCE_REMOVE;
+    if (freq_changed) {
+        pane->center_freq_hz = (int)freq;
+
+        // Update spectrum display
+        spectrum_widget_set_center_freq(SPECTRUM_WIDGET(pane->spectrum), pane->center_freq_hz);
+        update_pane_channels(app_data, pane);
     }
 
-    // Update status
-    if (atomic_load(&app_data->usb_connected)) {
-        gtk_label_set_text(GTK_LABEL(app_data->status_icon), "●");
-        gtk_widget_remove_css_class(GTK_WIDGET(app_data->status_icon), "disconnected");
-        gtk_widget_add_css_class(GTK_WIDGET(app_data->status_icon), "connected");
-    } else {
-        gtk_label_set_text(GTK_LABEL(app_data->status_icon), "○");
-        gtk_widget_remove_css_class(GTK_WIDGET(app_data->status_icon), "connected");
-        gtk_widget_add_css_class(GTK_WIDGET(app_data->status_icon), "disconnected");
+    if (mode_changed) {
+        pane->current_mode = mode;
     }
 
-    // Poll frequency and mode from radio every ~10 frames (~300ms)
-    app_data->freq_poll_counter++;
-    if (app_data->freq_poll_counter >= 10 && atomic_load(&app_data->usb_connected)) {
-        app_data->freq_poll_counter = 0;
+    if (vfo_changed) {
+        pane->current_vfo = vfo;
 
-        // Read frequency, mode and VFO via CAT serial port
-        long freq;
-        elad_mode_t mode;
-        int vfo;
-        if (cat_control_is_open(app_data->cat) &&
-            cat_control_get_freq_mode(app_data->cat, &freq, &mode, &vfo) == 0) {
+        // Update spectrum frame label
+        update_pane_label(app_data, pane);
+    }
 
-            gboolean freq_changed = (freq > 0 && freq != app_data->center_freq_hz);
-            gboolean mode_changed = (mode != app_data->current_mode);
-            gboolean vfo_changed = (vfo != app_data->current_vfo);
+    // Read filter bandwidth (may have changed even if mode didn't)
+    char filter_str[16] = "";
+    gboolean filter_changed = FALSE;
+    if (cat_control_is_open(pane->cat) &&
+        cat_control_get_filter_bw(pane->cat, pane->current_mode,
+                                  filter_str, sizeof(filter_str)) == 0) {
+        if (strcmp(filter_str, pane->current_filter) != 0) {
+            strncpy(pane->current_filter, filter_str, sizeof(pane->current_filter) - 1);
+            pane->current_filter[sizeof(pane->current_filter) - 1] = '\0';
+            filter_changed = TRUE;
+        }
+    }
 
-            if (freq_changed) {
-                app_data->center_freq_hz = (int)freq;
+    if (freq_changed || mode_changed || filter_changed) {
+        update_pane_overlay(pane);
+    }
+    if (mode_changed || filter_changed) {
+        update_audio_mode(app_data, pane);
+    }
+}
 
-                // Update spectrum display
-                spectrum_widget_set_center_freq(SPECTRUM_WIDGET(app_data->spectrum), app_data->center_freq_hz);
-            }
+// Format a pane's USB stream health statistics
+// Returns the length written
+static int format_pane_stats(radio_pane_t *pane, char *text, size_t size) {
+    int len = 0;
+    usb_device_t *usb = radio_pipeline_get_usb(pane->pipeline);
+
+    if (usb) {
+        usb_stats_t stats;
+        usb_device_get_stats(usb, &stats);
+
+        // Rates over the interval since the previous snapshot
+        gint64 now = g_get_monotonic_time();
+        double dt = (now - pane->last_stats_time) / 1e6;
+        double bytes_per_sec = 0.0;
+        double transfers_per_sec = 0.0;
+        if (pane->last_stats_time > 0 && dt > 0.0) {
+            bytes_per_sec = (stats.bytes - pane->last_stats.bytes) / dt;
+            transfers_per_sec = (stats.transfers - pane->last_stats.transfers) / dt;
+        }
+        pane->last_stats = stats;
+        pane->last_stats_time = now;
+
+        len += snprintf(text + len, size - len,
+                        "USB  %.2f MB/s (exp %.2f)  %.1f xfer/s\n",
+                        bytes_per_sec / 1e6, DEFAULT_SAMPLE_RATE * 8 / 1e6, transfers_per_sec);
+        len += snprintf(text + len, size - len,
+                        "Gap  p50<%.1fms p99<%.1fms max %.1fms\n",
+                        usb_stats_percentile_us(stats.gap_hist, 50) / 1e3,
+                        usb_stats_percentile_us(stats.gap_hist, 99) / 1e3,
+                        stats.max_gap_us / 1e3);
+        len += snprintf(text + len, size - len,
+                        "Lat  p50<%.1fms p99<%.1fms\n",
+                        usb_stats_percentile_us(stats.latency_hist, 50) / 1e3,
+                        usb_stats_percentile_us(stats.latency_hist, 99) / 1e3);
+        len += snprintf(text + len, size - len,
+                        "Tmo %llu  Err %llu  Resub %llu  Short %llu  Reconn %d\n",
+                        (unsigned long long)stats.timeouts, (unsigned long long)stats.errors,
+                        (unsigned long long)stats.resubmit_failures,
+                        (unsigned long long)stats.short_transfers,
+                        stats.streams > 0 ? stats.streams - 1 : 0);
+        len += snprintf(text + len, size - len,
+                        "Lost ~%lld samples  ", (long long)stats.samples_lost);
+    }
+    len += snprintf(text + len, size - len, "Ring drops %ld",
+                    radio_pipeline_get_dropped(pane->pipeline));
+    return len;
+}
 
-            if (mode_changed) {
-                app_data->current_mode = mode;
-            }
+// Format stage timings over the interval since *prev, then advance it
+static void format_perf_stats(perf_snapshot_t *prev, gint64 *prev_time, char *text, size_t size) {
+    static perf_snapshot_t now;  // GTK thread only; too big for the stack
+    perf_trace_snapshot(&now);
 
-            if (vfo_changed) {
-                app_data->current_vfo = vfo;
+    gint64 time = g_get_monotonic_time();
+    double seconds = *prev_time > 0 ? (time - *prev_time) / 1e6 : 0.0;
+    perf_trace_format(&now, *prev_time > 0 ? prev : NULL, seconds, text, size);
+    *prev = now;
+    *prev_time = time;
+}
 
-                // Update spectrum frame label
-                gtk_frame_set_label(GTK_FRAME(app_data->spectrum_frame),
-                                    vfo == 0 ? "VFO A" : "VFO B");
-            }
+// Rebuild the info overlays: USB statistics on every pane, stage
+// timings (process-wide) on the first
+static void update_info_overlays(app_data_t *app_data) {
+    char perf_text[1024] = "";
+    if (app_data->show_perf_stats) {
+        format_perf_stats(&app_data->perf_overlay_prev, &app_data->perf_overlay_time,
+                          perf_text, sizeof(perf_text));
+    }
 
-            // Read filter bandwidth (may have changed even if mode didn't)
-            char filter_str[16] = "";
-            gboolean filter_changed = FALSE;
-            if (cat_control_get_filter_bw(app_data->cat, app_data->current_mode,
-                                          filter_str, sizeof(filter_str)) == 0) {
-                if (strcmp(filter_str, app_data->current_filter) != 0) {
-                    strncpy(app_data->current_filter, filter_str, sizeof(app_data->current_filter) - 1);
-                    app_data->current_filter[sizeof(app_data->current_filter) - 1] = '\0';
-                    filter_changed = TRUE;
-                }
-            }
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        char text[1536] = "";
+        int len = 0;
+        if (app_data->show_usb_stats) {
+            len = format_pane_stats(pane, text, sizeof(text));
+        }
+        if (i == 0 && perf_text[0] && len < (int)sizeof(text)) {
+            snprintf(text + len, sizeof(text) - len, "%s%s", len > 0 ? "\n" : "", perf_text);
+        }
+        spectrum_widget_set_info_overlay(SPECTRUM_WIDGET(pane->spectrum), text[0] ? text : NULL);
+    }
+}
 
-            // Update overlay with frequency, mode and filter
-            if (freq_changed || mode_changed || filter_changed) {
-                char freq_str[32];
-                char mode_filter_str[32];
-                snprintf(freq_str, sizeof(freq_str), "%.6f MHz", app_data->center_freq_hz / 1e6);
-                snprintf(mode_filter_str, sizeof(mode_filter_str), "%s %s",
-                         usb_device_mode_name(app_data->current_mode),
-                         app_data->current_filter);
-                spectrum_widget_set_overlay(SPECTRUM_WIDGET(app_data->spectrum),
-                                            freq_str, mode_filter_str);
-
-                // Update waterfall bandwidth lines
-                int offset_hz = 0;
-                int is_resonator = 0;
-                int bw_hz = parse_bandwidth_hz(app_data->current_filter, &offset_hz, &is_resonator);
-                waterfall_widget_set_bandwidth(WATERFALL_WIDGET(app_data->waterfall),
-                                               bw_hz, app_data->current_mode, offset_hz, is_resonator);
-            }
+// Occupancy heatmaps over the waterfalls (or hide them): busy fraction
+// per hour of day across the current span, from each radio's store
+static void update_occupancy_overlays(app_data_t *app_data) {
+    float *busy = app_data->show_occupancy ? g_new(float, 24 * OCCUPANCY_COLUMNS) : NULL;
+
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        // The pipeline records nothing while sweeping
+        if (!busy || !pane->occupancy || pane->sweep) {
+            waterfall_widget_set_occupancy(WATERFALL_WIDGET(pane->waterfall), NULL, 0);
+            continue;
+        }
+        long frames = occupancy_heatmap(pane->occupancy, pane->center_freq_hz,
+                                        (uint32_t)radio_pipeline_get_sample_rate(pane->pipeline),
+                                        0, OCCUPANCY_BUSY, busy, OCCUPANCY_COLUMNS);
+        // Nothing recorded at this frequency yet: an empty map
+        if (frames < 0) {
+            for (int j = 0; j < 24 * OCCUPANCY_COLUMNS; j++) busy[j] = NAN;
         }
+        waterfall_widget_set_occupancy(WATERFALL_WIDGET(pane->waterfall), busy, OCCUPANCY_COLUMNS);
     }
+    g_free(busy);
+}
 
-    // Check if new spectrum data is available
-    if (atomic_exchange(&app_data->spectrum_ready, 0)) {
-        float spectrum_copy[FFT_SIZE];
+// Periodic stage timing dump (--stats)
+static gboolean perf_dump_timeout(gpointer user_data) {
+    app_data_t *app_data = (app_data_t *)user_data;
+    if (!atomic_load(&app_data->running)) return G_SOURCE_REMOVE;
 
-        g_mutex_lock(&app_data->spectrum_mutex);
-        memcpy(spectrum_copy, app_data->spectrum_db, sizeof(spectrum_copy));
-        g_mutex_unlock(&app_data->spectrum_mutex);
+    char text[1024];
+    format_perf_stats(&app_data->perf_dump_prev, &app_data->perf_dump_time, text, sizeof(text));
+    fprintf(stderr, "Perf: last %d s\n%s\n", app_data->perf_dump_seconds, text);
+    return G_SOURCE_CONTINUE;
+}
 
-        // Update display widgets
-        spectrum_widget_update(SPECTRUM_WIDGET(app_data->spectrum), spectrum_copy, FFT_SIZE);
-        waterfall_widget_add_line(WATERFALL_WIDGET(app_data->waterfall), spectrum_copy, FFT_SIZE);
+// Latency self-test: bursts to measure, detection threshold over the
+// noise floor, and time left for the last frames to be presented
+#define LATENCY_TEST_BURSTS 30
+#define LATENCY_TEST_THRESHOLD_DB 30.0f
+#define LATENCY_TEST_SETTLE_MS 500
+
+// Print the latency stages and quit (end of --latency-test)
+static gboolean latency_test_finish(gpointer user_data) {
+    app_data_t *app_data = (app_data_t *)user_data;
+
+    static perf_snapshot_t snap;  // Too big for the stack
+    perf_trace_snapshot(&snap);
+
+    fprintf(stderr, "Latency: %d bursts\n", app_data->latency_bursts);
+    fprintf(stderr, "%-12s %7s %9s %9s %9s\n", "Stage", "count", "p50<", "p99<", "max<");
+    for (int s = PERF_STAGE_LAT_FETCH; s <= PERF_STAGE_LAT_BURST; s++) {
+        perf_stage_stats_t st;
+        perf_trace_stats(&snap, NULL, (perf_stage_t)s, &st);
+        if (st.count == 0) {
+            fprintf(stderr, "%-12s %7d %9s %9s %9s\n", perf_stage_name((perf_stage_t)s), 0,
+                    "-", "-", "-");
+            continue;
+        }
+        fprintf(stderr, "%-12s %7llu %7.1fms %7.1fms %7.1fms\n", perf_stage_name((perf_stage_t)s),
+                (unsigned long long)st.count, st.p50_ns / 1e6, st.p99_ns / 1e6, st.max_ns / 1e6);
     }
 
-    return G_SOURCE_CONTINUE;
+    gtk_window_close(GTK_WINDOW(app_data->window));
+    return G_SOURCE_REMOVE;
+}
+
+// Look for the synthetic tone burst in a fetched spectrum; on its rising
+// edge, tag the waterfall line so the frame showing it reports the delay
+// from the burst onset to presentation
+static void latency_test_check(app_data_t *app_data, radio_pane_t *pane, const float *spectrum) {
+    synthetic_source_t *src = radio_pipeline_get_synthetic(pane->pipeline);
+    spectrum_levels_t levels;
+    if (!src || !radio_pipeline_get_levels(pane->pipeline, &levels)) return;
+
+    double bin_hz = (double)synthetic_source_get_sample_rate(src) / FFT_SIZE;
+    int bin = FFT_SIZE / 2 + (int)lround(synthetic_source_get_tone_hz(src) / bin_hz);
+    if (bin < 0 || bin >= FFT_SIZE) return;
+
+    gboolean on = spectrum[bin] > levels.noise_db + LATENCY_TEST_THRESHOLD_DB;
+    if (on && !app_data->latency_burst_on && app_data->latency_bursts < LATENCY_TEST_BURSTS) {
+        waterfall_widget_set_latency_probe(WATERFALL_WIDGET(pane->waterfall),
+                                           synthetic_source_get_burst_start(src));
+        if (++app_data->latency_bursts == LATENCY_TEST_BURSTS) {
+            g_timeout_add(LATENCY_TEST_SETTLE_MS, latency_test_finish, app_data);
+        }
+    }
+    app_data->latency_burst_on = on;
 }
 
 // Auto-save settings after 3 seconds of no changes
@@ -332,6 +643,7 @@ static gboolean save_settings_timeout(gpointer user_data) {
     settings.spectrum_range = gtk_adjustment_get_value(app_data->range_adj);
     settings.waterfall_ref = gtk_adjustment_get_value(app_data->waterfall_ref_adj);
     settings.waterfall_range = gtk_adjustment_get_value(app_data->waterfall_range_adj);
+    settings.auto_range = app_data->auto_range;
 #ifdef HAVE_GPIOD
     if (app_data->pi_mode) {
         settings.zoom_level = app_data->zoom_level;
@@ -362,26 +674,47 @@ static void schedule_settings_save(app_data_t *app_data) {
 // Spectrum range changed callback
 static void on_spectrum_range_changed(GtkAdjustment *adj G_GNUC_UNUSED, gpointer user_data) {
     app_data_t *app_data = (app_data_t *)user_data;
-    if (!app_data->spectrum || !app_data->ref_adj || !app_data->range_adj) return;
+    if (!app_data->ref_adj || !app_data->range_adj) return;
     float ref_db = (float)gtk_adjustment_get_value(app_data->ref_adj);
     float range_db = (float)gtk_adjustment_get_value(app_data->range_adj);
     float min_db = ref_db - range_db;
-    spectrum_widget_set_range(SPECTRUM_WIDGET(app_data->spectrum), min_db, ref_db);
+    for (int i = 0; i < app_data->num_panes; i++) {
+        if (!app_data->panes[i].spectrum) continue;  // Widget not created yet
+        spectrum_widget_set_range(SPECTRUM_WIDGET(app_data->panes[i].spectrum), min_db, ref_db);
+    }
     schedule_settings_save(app_data);
 }
 
 // Waterfall range changed callback
 static void on_waterfall_range_changed(GtkAdjustment *adj G_GNUC_UNUSED, gpointer user_data) {
     app_data_t *app_data = (app_data_t *)user_data;
-    if (!app_data->waterfall) return;  // Widget not created yet
+    if (!app_data->waterfall_ref_adj || !app_data->waterfall_range_adj) return;
     float ref_db = (float)gtk_adjustment_get_value(app_data->waterfall_ref_adj);
     float range_db = (float)gtk_adjustment_get_value(app_data->waterfall_range_adj);
     float min_db = ref_db - range_db;
-    waterfall_widget_set_range(WATERFALL_WIDGET(app_data->waterfall), min_db, ref_db);
+    for (int i = 0; i < app_data->num_panes; i++) {
+        if (!app_data->panes[i].waterfall) continue;  // Widget not created yet
+        waterfall_widget_set_range(WATERFALL_WIDGET(app_data->panes[i].waterfall), min_db, ref_db);
+    }
     schedule_settings_save(app_data);
 }
 
 #ifdef HAVE_GPIOD
+// Apply zoom and pan to every pane
+// The DSP thread retunes its down-converter, so zoom adds real resolution
+static void apply_zoom_pan(app_data_t *app_data) {
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        // The sweep owns the radio's frequency and the span shown
+        if (pane->sweep) continue;
+        radio_pipeline_set_zoom(pane->pipeline, app_data->zoom_level, app_data->pan_offset);
+        spectrum_widget_set_zoom(SPECTRUM_WIDGET(pane->spectrum), app_data->zoom_level);
+        spectrum_widget_set_pan(SPECTRUM_WIDGET(pane->spectrum), app_data->pan_offset);
+        waterfall_widget_set_zoom(WATERFALL_WIDGET(pane->waterfall), app_data->zoom_level);
+        waterfall_widget_set_pan(WATERFALL_WIDGET(pane->waterfall), app_data->pan_offset);
+    }
+}
+
 // Get adjustment for current parameter
 static GtkAdjustment *get_active_adjustment(app_data_t *app_data) {
     switch (app_data->active_param) {
@@ -404,12 +737,14 @@ static void update_param_label(app_data_t *app_data) {
     int wf_rng = (int)gtk_adjustment_get_value(app_data->waterfall_range_adj);
 
     // Build markup string with active parameter in cyan, others in white
-    char label[256];
+    char label[320];
     snprintf(label, sizeof(label),
+             "%s"
              "<span foreground='%s' weight='bold'>SP.REF %d</span>  "
              "<span foreground='%s' weight='bold'>SP.RNG %d</span>  "
              "<span foreground='%s' weight='bold'>WF.REF %d</span>  "
              "<span foreground='%s' weight='bold'>WF.RNG %d</span>",
+             app_data->auto_range ? "<span foreground='lime' weight='bold'>AUTO</span>  " : "",
              app_data->active_param == PARAM_SPECTRUM_REF ? "cyan" : "white", sp_ref,
              app_data->active_param == PARAM_SPECTRUM_RANGE ? "cyan" : "white", sp_rng,
              app_data->active_param == PARAM_WATERFALL_REF ? "cyan" : "white", wf_ref,
@@ -441,10 +776,109 @@ static void update_zoom_label(app_data_t *app_data) {
     gtk_label_set_markup(GTK_LABEL(app_data->zoom_label), label);
 }
 
+#endif
+
+// Automatic reference level and range: the smoothed noise floor and
+// peaks of all radios set the spectrum from 10 dB below the noise to
+// 10 dB above the peaks, and the waterfall from just below the noise to
+// the peaks
+#define AUTO_RANGE_SMOOTHING 0.1f         // Per spectrum (~15/s, ~0.7 s time constant)
+#define AUTO_RANGE_DEADBAND_DB 2.0        // Smaller changes are ignored (no jitter)
+#define AUTO_SPECTRUM_HEADROOM_DB 10.0
+#define AUTO_SPECTRUM_FLOOR_DB 10.0
+#define AUTO_WATERFALL_FLOOR_DB 5.0
+#define AUTO_WATERFALL_MIN_SPAN_DB 30.0
+
+// Smooth a pane's noise floor and peak after a new spectrum
+static void update_pane_levels(radio_pane_t *pane) {
+    spectrum_levels_t levels;
+    if (!radio_pipeline_get_levels(pane->pipeline, &levels)) return;
+
+    if (!pane->have_levels) {
+        pane->levels = levels;
+        pane->have_levels = TRUE;
+        return;
+    }
+    pane->levels.noise_db += AUTO_RANGE_SMOOTHING * (levels.noise_db - pane->levels.noise_db);
+    pane->levels.peak_db += AUTO_RANGE_SMOOTHING * (levels.peak_db - pane->levels.peak_db);
+}
+
+// Move an adjustment to target (whole dB, within its bounds) unless the
+// change is inside the deadband
+static void set_auto_value(GtkAdjustment *adj, double target) {
+    double lower = gtk_adjustment_get_lower(adj);
+    double upper = gtk_adjustment_get_upper(adj);
+    if (target < lower) target = lower;
+    if (target > upper) target = upper;
+    if (fabs(target - gtk_adjustment_get_value(adj)) < AUTO_RANGE_DEADBAND_DB) return;
+    gtk_adjustment_set_value(adj, round(target));
+}
+
+static void apply_auto_range(app_data_t *app_data) {
+    gboolean valid = FALSE;
+    double noise_db = 0.0;
+    double peak_db = 0.0;
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        if (!pane->have_levels) continue;
+        if (!valid || pane->levels.noise_db < noise_db) noise_db = pane->levels.noise_db;
+        if (!valid || pane->levels.peak_db > peak_db) peak_db = pane->levels.peak_db;
+        valid = TRUE;
+    }
+    if (!valid) return;
+
+    // Ranges follow the reference actually applied (deadband, bounds)
+    set_auto_value(app_data->ref_adj, peak_db + AUTO_SPECTRUM_HEADROOM_DB);
+    double ref_db = gtk_adjustment_get_value(app_data->ref_adj);
+    set_auto_value(app_data->range_adj, ref_db - (noise_db - AUTO_SPECTRUM_FLOOR_DB));
+
+    double wf_top_db = peak_db;
+    if (wf_top_db < noise_db + AUTO_WATERFALL_MIN_SPAN_DB) {
+        wf_top_db = noise_db + AUTO_WATERFALL_MIN_SPAN_DB;
+    }
+    set_auto_value(app_data->waterfall_ref_adj, wf_top_db);
+    double wf_ref_db = gtk_adjustment_get_value(app_data->waterfall_ref_adj);
+    set_auto_value(app_data->waterfall_range_adj, wf_ref_db - (noise_db - AUTO_WATERFALL_FLOOR_DB));
+
+#ifdef HAVE_GPIOD
+    update_param_label(app_data);
+#endif
+}
+
+// Switch automatic ref/range on or off; manual controls are disabled
+// while it is on
+static void set_auto_range(app_data_t *app_data, gboolean enabled) {
+    if (app_data->auto_range == enabled) return;
+    app_data->auto_range = enabled;
+
+    if (app_data->ref_spin) gtk_widget_set_sensitive(app_data->ref_spin, !enabled);
+    if (app_data->range_spin) gtk_widget_set_sensitive(app_data->range_spin, !enabled);
+    if (app_data->auto_check) {
+        gtk_check_button_set_active(GTK_CHECK_BUTTON(app_data->auto_check), enabled);
+    }
+#ifdef HAVE_GPIOD
+    update_param_label(app_data);
+#endif
+
+    if (enabled) {
+        apply_auto_range(app_data);
+    }
+    schedule_settings_save(app_data);
+}
+
+static void on_auto_range_toggled(GtkCheckButton *button, gpointer user_data) {
+    app_data_t *app_data = (app_data_t *)user_data;
+    set_auto_range(app_data, gtk_check_button_get_active(button));
+}
+
+#ifdef HAVE_GPIOD
 // Encoder 1 rotation callback - adjusts active parameter
 static void on_encoder1_rotation(int direction, void *user_data) {
     app_data_t *app_data = (app_data_t *)user_data;
 
+    // Turning the knob takes over from automatic ref/range
+    set_auto_range(app_data, FALSE);
+
     GtkAdjustment *adj = get_active_adjustment(app_data);
     if (!adj) return;
 
@@ -496,11 +930,8 @@ static void on_encoder2_rotation(int direction, void *user_data) {
             // Reset pan when zoom changes
             app_data->pan_offset = 0;
 
-            // Apply zoom and reset pan to both widgets
-            spectrum_widget_set_zoom(SPECTRUM_WIDGET(app_data->spectrum), app_data->zoom_level);
-            spectrum_widget_set_pan(SPECTRUM_WIDGET(app_data->spectrum), 0);
-            waterfall_widget_set_zoom(WATERFALL_WIDGET(app_data->waterfall), app_data->zoom_level);
-            waterfall_widget_set_pan(WATERFALL_WIDGET(app_data->waterfall), 0);
+            // Apply zoom and reset pan to all widgets
+            apply_zoom_pan(app_data);
 
             update_zoom_label(app_data);
             schedule_settings_save(app_data);
@@ -524,9 +955,8 @@ static void on_encoder2_rotation(int direction, void *user_data) {
         if (app_data->pan_offset < -max_pan) app_data->pan_offset = -max_pan;
         if (app_data->pan_offset > max_pan) app_data->pan_offset = max_pan;
 
-        // Apply pan to both widgets
-        spectrum_widget_set_pan(SPECTRUM_WIDGET(app_data->spectrum), app_data->pan_offset);
-        waterfall_widget_set_pan(WATERFALL_WIDGET(app_data->waterfall), app_data->pan_offset);
+        // Apply pan to all widgets
+        apply_zoom_pan(app_data);
 
         update_zoom_label(app_data);
         schedule_settings_save(app_data);
@@ -548,6 +978,280 @@ static void on_encoder2_button(void *user_data) {
 }
 #endif
 
+// Keyboard shortcuts: 'u' toggles the USB statistics overlay, 'p' the
+// stage timing overlay, 'a' the automatic reference level and range,
+// 'o' the occupancy heatmap
+static gboolean on_key_pressed(GtkEventControllerKey *controller G_GNUC_UNUSED, guint keyval,
+                               guint keycode G_GNUC_UNUSED, GdkModifierType state G_GNUC_UNUSED,
+                               gpointer user_data) {
+    app_data_t *app_data = (app_data_t *)user_data;
+
+    if (keyval == GDK_KEY_u || keyval == GDK_KEY_U) {
+        app_data->show_usb_stats = !app_data->show_usb_stats;
+        app_data->stats_counter = 0;
+        update_info_overlays(app_data);
+        return TRUE;
+    }
+    if (keyval == GDK_KEY_p || keyval == GDK_KEY_P) {
+        app_data->show_perf_stats = !app_data->show_perf_stats;
+        app_data->stats_counter = 0;
+        update_info_overlays(app_data);
+        return TRUE;
+    }
+    if (keyval == GDK_KEY_a || keyval == GDK_KEY_A) {
+        set_auto_range(app_data, !app_data->auto_range);
+        return TRUE;
+    }
+    if ((keyval == GDK_KEY_o || keyval == GDK_KEY_O) && app_data->occupancy_dir) {
+        app_data->show_occupancy = !app_data->show_occupancy;
+        app_data->occupancy_counter = 0;
+        update_occupancy_overlays(app_data);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+// Frequency span of a pane's spectra for the spectrum server: the DSP
+// path zooms around the pan centre, so bins cover sample_rate / zoom; a
+// sweep covers its whole range
+static void pane_frame_meta(app_data_t *app_data, int index, uint64_t timestamp_ns,
+                            spectrum_frame_meta_t *meta) {
+    radio_pane_t *pane = &app_data->panes[index];
+    meta->radio = index;
+    meta->timestamp_ns = timestamp_ns;
+    if (pane->sweep) {
+        uint32_t span_hz;
+        band_sweep_get_span(pane->sweep, &meta->center_hz, &span_hz);
+        meta->span_hz = (int)span_hz;
+        return;
+    }
+
+    int sample_rate = radio_pipeline_get_sample_rate(pane->pipeline);
+    int zoom = 1;
+    int pan_offset = 0;
+#ifdef HAVE_GPIOD
+    if (app_data->zoom_level > 1) {
+        zoom = app_data->zoom_level;
+        pan_offset = app_data->pan_offset;
+    }
+#endif
+
+    meta->center_hz = pane->center_freq_hz + (int64_t)pan_offset * sample_rate / FFT_SIZE;
+    meta->span_hz = sample_rate / zoom;
+}
+
+// Show the swept range, with mode_str (e.g. the sweep time) in the mode slot
+static void set_sweep_overlay(radio_pane_t *pane, const char *mode_str) {
+    int64_t center_hz;
+    uint32_t span_hz;
+    char range_str[32];
+    if (!pane->spectrum) return;
+    band_sweep_get_span(pane->sweep, &center_hz, &span_hz);
+    snprintf(range_str, sizeof(range_str), "%.3f-%.3f MHz",
+             (center_hz - span_hz / 2) / 1e6, (center_hz + span_hz / 2) / 1e6);
+    spectrum_widget_set_overlay(SPECTRUM_WIDGET(pane->spectrum), range_str, mode_str);
+}
+
+// Report the sweep rate once per complete sweep (--sweep): logged, shown
+// in the overlay, and the waterfall's time axis follows the step rate
+// (one line per step)
+static void report_pane_sweep(radio_pane_t *pane) {
+    band_sweep_stats_t stats;
+    if (!pane->sweep) return;
+    band_sweep_get_stats(pane->sweep, &stats);
+    if (stats.sweeps == pane->sweeps_reported) return;
+    pane->sweeps_reported = stats.sweeps;
+    fprintf(stderr, "Sweep: %d steps in %.1f s (retune %.1f ms, %ld chunks discarded)\n",
+            stats.steps, stats.sweep_s, stats.retune_ms, stats.discarded);
+    if (stats.sweep_s <= 0.0) return;
+
+    char mode_str[32];
+    snprintf(mode_str, sizeof(mode_str), "Sweep %.1f s", stats.sweep_s);
+    set_sweep_overlay(pane, mode_str);
+    if (pane->waterfall) {
+        waterfall_widget_set_line_rate(WATERFALL_WIDGET(pane->waterfall),
+                                       stats.steps / stats.sweep_s);
+    }
+}
+
+// Queue a pane's spectrum line for its archive (--archive)
+static void archive_pane_line(radio_pane_t *pane, const float *spectrum, uint64_t timestamp_ns,
+                              const spectrum_frame_meta_t *meta) {
+    spectrum_levels_t levels;
+    if (!pane->archive || !radio_pipeline_get_levels(pane->pipeline, &levels)) return;
+    spectrum_archive_add_line(pane->archive, spectrum, levels.noise_db,
+                              monotonic_to_realtime_ns(timestamp_ns), meta->center_hz,
+                              (uint32_t)meta->span_hz);
+}
+
+// Waterfall scrollback from a pane's archive reader (waterfall worker
+// thread, one read at a time; the widget closes the reader)
+static int pane_history(gpointer user_data, int64_t start_ns, int max_lines, float *lines,
+                        int64_t *times_ns, int bins) {
+    spectrum_archive_reader_t *reader = (spectrum_archive_reader_t *)user_data;
+    spectrum_archive_line_t *info = g_new(spectrum_archive_line_t, max_lines);
+    int count = spectrum_archive_read(reader, start_ns, max_lines, lines, bins, info);
+    for (int i = 0; i < count; i++) {
+        times_ns[i] = info[i].time_ns;
+    }
+    g_free(info);
+    return count;
+}
+
+// Mark the signals found by the pipeline's detector on the spectrum; with
+// --cw-decode, hand the narrow ones to the CW bank and show their text
+static void update_pane_markers(app_data_t *app_data, int index) {
+    radio_pane_t *pane = &app_data->panes[index];
+    detected_signal_t signals[SIGNAL_DETECTOR_MAX_SIGNALS];
+    int count = radio_pipeline_get_signals(pane->pipeline, signals, SIGNAL_DETECTOR_MAX_SIGNALS);
+
+    spectrum_marker_t markers[SPECTRUM_MAX_MARKERS];
+    if (count > SPECTRUM_MAX_MARKERS) count = SPECTRUM_MAX_MARKERS;
+    for (int i = 0; i < count; i++) {
+        markers[i].center_bin = signals[i].center_bin;
+        markers[i].width_bins = signals[i].bandwidth_bins;
+        markers[i].snr_db = signals[i].snr_db;
+        markers[i].text[0] = '\0';
+    }
+
+    if (pane->cw) {
+        // Bins are in the displayed (zoomed) span, the bank wants offsets
+        // from the radio's centre
+        spectrum_frame_meta_t meta;
+        pane_frame_meta(app_data, index, 0, &meta);
+        double bin_hz = (double)meta.span_hz / FFT_SIZE;
+        double span_offset_hz = (double)(meta.center_hz - pane->center_freq_hz);
+
+        cw_carrier_t carriers[SIGNAL_DETECTOR_MAX_SIGNALS];
+        double offsets[SIGNAL_DETECTOR_MAX_SIGNALS];
+        int carrier_count = 0;
+        for (int i = 0; i < count; i++) {
+            offsets[i] = span_offset_hz + (signals[i].center_bin - FFT_SIZE / 2) * bin_hz;
+            if (signals[i].bandwidth_bins * bin_hz > CW_MAX_WIDTH_HZ) continue;
+            carriers[carrier_count++].offset_hz = offsets[i];
+        }
+        cw_bank_update(pane->cw, carriers, carrier_count);
+
+        // Text goes to the marker nearest each decoder
+        cw_decoded_t decoded[CW_BANK_MAX_DECODERS];
+        int decoded_count = cw_bank_get_decoded(pane->cw, decoded, CW_BANK_MAX_DECODERS);
+        for (int d = 0; d < decoded_count; d++) {
+            int nearest = -1;
+            double best = CW_MAX_WIDTH_HZ;
+            for (int i = 0; i < count; i++) {
+                double distance = fabs(offsets[i] - decoded[d].offset_hz);
+                if (distance < best) {
+                    best = distance;
+                    nearest = i;
+                }
+            }
+            if (nearest < 0) continue;
+
+            // The most recent characters that fit
+            const char *text = decoded[d].text;
+            size_t len = strlen(text);
+            if (len >= SPECTRUM_MARKER_TEXT_LEN) text += len - (SPECTRUM_MARKER_TEXT_LEN - 1);
+            snprintf(markers[nearest].text, SPECTRUM_MARKER_TEXT_LEN, "%s", text);
+        }
+    }
+    spectrum_widget_set_markers(SPECTRUM_WIDGET(pane->spectrum), markers, count);
+}
+
+// Display refresh timer callback - called from GTK main thread
+static gboolean refresh_display(gpointer user_data) {
+    app_data_t *app_data = (app_data_t *)user_data;
+
+    if (!atomic_load(&app_data->running)) {
+        return G_SOURCE_REMOVE;
+    }
+
+    // Poll frequency and mode from radios every ~10 frames (~300ms)
+    app_data->freq_poll_counter++;
+    gboolean poll = app_data->freq_poll_counter >= 10 && !app_data->playback_path &&
+                    !app_data->latency_test && !app_data->udp_port;
+    if (app_data->freq_poll_counter >= 10) {
+        app_data->freq_poll_counter = 0;
+    }
+
+    // Refresh USB statistics and stage timing overlays every ~30 frames (~1s)
+    if ((app_data->show_usb_stats || app_data->show_perf_stats) && ++app_data->stats_counter >= 30) {
+        app_data->stats_counter = 0;
+        update_info_overlays(app_data);
+    }
+
+    // Statistics change slowly: refresh the heatmap every ~10 s
+    if (app_data->show_occupancy && ++app_data->occupancy_counter >= OCCUPANCY_REFRESH_FRAMES) {
+        app_data->occupancy_counter = 0;
+        update_occupancy_overlays(app_data);
+    }
+
+    gboolean new_spectrum = FALSE;
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+
+        // Update status
+        update_pane_status(pane);
+
+        // Pick up the frequency read by the USB thread after a (re)connect
+        int connect_count = radio_pipeline_get_connect_count(pane->pipeline);
+        if (connect_count != pane->connect_count) {
+            pane->connect_count = connect_count;
+            long freq = radio_pipeline_get_radio_freq(pane->pipeline);
+            if (freq > 0 && freq != pane->center_freq_hz && !pane->sweep) {
+                pane->center_freq_hz = (int)freq;
+                spectrum_widget_set_center_freq(SPECTRUM_WIDGET(pane->spectrum), pane->center_freq_hz);
+                update_pane_overlay(pane);
+                update_pane_channels(app_data, pane);
+            }
+        }
+
+        // The sweep owns the radio's frequency
+        if (poll && !pane->sweep && radio_pipeline_is_connected(pane->pipeline)) {
+            poll_pane(app_data, pane);
+        }
+        report_pane_sweep(pane);
+
+        // Check if new spectrum data is available
+        float spectrum_copy[FFT_SIZE];
+        uint64_t timestamp_ns = 0;
+        spectrum_frame_meta_t meta;
+        if (radio_pipeline_get_spectrum(pane->pipeline, spectrum_copy, FFT_SIZE, &timestamp_ns)) {
+            uint64_t fetched_ns = (uint64_t)g_get_monotonic_time() * 1000;
+            if (timestamp_ns && fetched_ns > timestamp_ns) {
+                PERF_RECORD(PERF_STAGE_LAT_FETCH, fetched_ns - timestamp_ns);
+            }
+            if (app_data->latency_test) {
+                latency_test_check(app_data, pane, spectrum_copy);
+            }
+
+            // Update display widgets
+            spectrum_widget_update(SPECTRUM_WIDGET(pane->spectrum), spectrum_copy, FFT_SIZE);
+            waterfall_widget_add_line(WATERFALL_WIDGET(pane->waterfall), spectrum_copy, FFT_SIZE,
+                                      timestamp_ns);
+
+            if (app_data->detect_signals) {
+                update_pane_markers(app_data, i);
+            }
+            update_pane_levels(pane);
+            new_spectrum = TRUE;
+
+            if (app_data->spectrum_server || pane->archive) {
+                pane_frame_meta(app_data, i, timestamp_ns, &meta);
+                archive_pane_line(pane, spectrum_copy, timestamp_ns, &meta);
+            }
+            if (app_data->spectrum_server) {
+                spectrum_server_publish(app_data->spectrum_server, &meta, spectrum_copy, FFT_SIZE);
+            }
+        }
+    }
+
+    if (app_data->auto_range && new_spectrum) {
+        apply_auto_range(app_data);
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
 // Window close handler
 static gboolean on_window_close(GtkWindow *window G_GNUC_UNUSED, gpointer user_data) {
     app_data_t *app_data = (app_data_t *)user_data;
@@ -558,6 +1262,7 @@ static gboolean on_window_close(GtkWindow *window G_GNUC_UNUSED, gpointer user_d
     settings.spectrum_range = gtk_adjustment_get_value(app_data->range_adj);
     settings.waterfall_ref = gtk_adjustment_get_value(app_data->waterfall_ref_adj);
     settings.waterfall_range = gtk_adjustment_get_value(app_data->waterfall_range_adj);
+    settings.auto_range = app_data->auto_range;
 #ifdef HAVE_GPIOD
     if (app_data->pi_mode) {
         settings.zoom_level = app_data->zoom_level;
@@ -572,15 +1277,368 @@ static gboolean on_window_close(GtkWindow *window G_GNUC_UNUSED, gpointer user_d
 #endif
     settings_save(&settings);
 
-    // Signal USB thread to stop
+    // Signal pipelines to stop and wait for their threads
     atomic_store(&app_data->running, 0);
-
-    // Wait for USB thread
-    pthread_join(app_data->usb_thread, NULL);
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pipeline_stop(app_data->panes[i].pipeline);
+    }
 
     return FALSE;  // Allow window to close
 }
 
+// Create the pipelines for all panes
+// Latency test: one pane fed from the synthetic burst source
+// Playback: one pane fed from the file
+// UDP: one pane fed from the network stream
+// --radio given: one pane per requested serial, with the given CAT device
+// Otherwise: one pane per connected radio, CAT on the first one only
+static void create_pipelines(app_data_t *app_data) {
+    if (app_data->latency_test) {
+        // Burst 24 kHz above centre (exactly on a bin), 200 ms every second
+        synthetic_source_t *src = synthetic_source_new(DEFAULT_SAMPLE_RATE, 24000.0, 1000, 200);
+        app_data->num_panes = 1;
+        app_data->panes[0].pipeline = radio_pipeline_new_synthetic(src);
+        return;
+    }
+
+    if (app_data->playback_path) {
+        iq_playback_t *playback = iq_playback_open(app_data->playback_path, app_data->playback_rate);
+        if (playback) {
+            iq_playback_set_speed(playback, app_data->playback_speed);
+            iq_playback_set_loop(playback, app_data->playback_loop);
+            if (app_data->playback_seek > 0.0 &&
+                iq_playback_seek(playback, app_data->playback_seek) != 0) {
+                fprintf(stderr, "Playback: Seek position %.1f s is past the end of file\n",
+                        app_data->playback_seek);
+            }
+        }
+        app_data->num_panes = 1;
+        app_data->panes[0].pipeline = radio_pipeline_new_playback(playback);
+        return;
+    }
+
+    if (app_data->udp_port) {
+        udp_iq_receiver_t *udp = udp_iq_receiver_new(app_data->udp_port, UDP_IQ_FORMAT_S32,
+                                                     USB_BUFFER_SIZE);
+        app_data->num_panes = 1;
+        app_data->panes[0].pipeline = radio_pipeline_new_udp(udp, app_data->playback_rate);
+        return;
+    }
+
+    if (libusb_init(&app_data->usb_ctx) < 0) {
+        fprintf(stderr, "Failed to initialize libusb\n");
+        app_data->usb_ctx = NULL;
+        app_data->num_panes = 1;  // Single pane showing the error
+        return;
+    }
+
+    if (app_data->num_radio_args > 0) {
+        for (int i = 0; i < app_data->num_radio_args; i++) {
+            radio_pane_t *pane = &app_data->panes[i];
+            const char *arg = app_data->radio_args[i];
+            const char *comma = strchr(arg, ',');
+            size_t serial_len = comma ? (size_t)(comma - arg) : strlen(arg);
+            if (serial_len >= sizeof(pane->serial)) serial_len = sizeof(pane->serial) - 1;
+            memcpy(pane->serial, arg, serial_len);
+            pane->serial[serial_len] = '\0';
+            if (comma && comma[1]) {
+                snprintf(pane->cat_device, sizeof(pane->cat_device), "%s", comma + 1);
+            }
+        }
+        app_data->num_panes = app_data->num_radio_args;
+    } else {
+        char serials[MAX_RADIOS][USB_SERIAL_LEN];
+        int found = usb_device_enumerate(app_data->usb_ctx, serials, MAX_RADIOS);
+        if (found > 1) {
+            for (int i = 0; i < found; i++) {
+                snprintf(app_data->panes[i].serial, sizeof(app_data->panes[i].serial), "%s", serials[i]);
+            }
+            app_data->num_panes = found;
+        } else {
+            // Zero or one radio: open whichever appears first, like before
+            app_data->num_panes = 1;
+        }
+        snprintf(app_data->panes[0].cat_device, sizeof(app_data->panes[0].cat_device),
+                 "%s", DEFAULT_CAT_DEVICE);
+    }
+
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        // Own libusb context per radio: a shared one would complete every
+        // radio's transfers on whichever USB thread holds the event lock,
+        // whatever --usb-cpu and --rt-prio set for the radio's own thread
+        pane->pipeline = radio_pipeline_new_usb(NULL, pane->serial[0] ? pane->serial : NULL);
+        if (pane->pipeline && pane->cat_device[0]) {
+            pane->cat = cat_control_new();
+            radio_pipeline_set_cat(pane->pipeline, pane->cat, pane->cat_device);
+        }
+    }
+}
+
+// Create the spectrum/waterfall widgets of one radio
+// Returns the paned container holding them
+static GtkWidget *create_pane(app_data_t *app_data, radio_pane_t *pane, int rows) {
+    int sample_rate = pane->pipeline ? radio_pipeline_get_sample_rate(pane->pipeline) : DEFAULT_SAMPLE_RATE;
+    pane->center_freq_hz = app_data->default_freq_hz;
+
+    // Paned container for spectrum and waterfall
+    GtkWidget *paned = gtk_paned_new(GTK_ORIENTATION_VERTICAL);
+    gtk_widget_set_vexpand(paned, TRUE);
+    gtk_widget_set_hexpand(paned, TRUE);
+
+    // Spectrum widget (same height as waterfall)
+    pane->spectrum = spectrum_widget_new();
+    int display_min_h = (app_data->window_height <= 480) ? 100 : 150;
+    display_min_h /= rows;
+    gtk_widget_set_size_request(pane->spectrum, -1, display_min_h);
+    spectrum_widget_set_center_freq(SPECTRUM_WIDGET(pane->spectrum), pane->center_freq_hz);
+    spectrum_widget_set_sample_rate(SPECTRUM_WIDGET(pane->spectrum), sample_rate);
+
+    // Set initial range from adjustments
+    float ref_db = (float)gtk_adjustment_get_value(app_data->ref_adj);
+    float range_db = (float)gtk_adjustment_get_value(app_data->range_adj);
+    spectrum_widget_set_range(SPECTRUM_WIDGET(pane->spectrum), ref_db - range_db, ref_db);
+
+    // Set initial overlay
+    char freq_str[32];
+    snprintf(freq_str, sizeof(freq_str), "%.6f MHz", pane->center_freq_hz / 1e6);
+    spectrum_widget_set_overlay(SPECTRUM_WIDGET(pane->spectrum), freq_str, "---");
+
+    spectrum_widget_set_bandplan(SPECTRUM_WIDGET(pane->spectrum), &app_data->bandplan);
+
+    // Zoom is done by the pipeline's zoom FFT, not by slicing bins
+    spectrum_widget_set_zoom_fft(SPECTRUM_WIDGET(pane->spectrum), TRUE);
+
+    pane->spectrum_frame = gtk_frame_new(NULL);
+    update_pane_label(app_data, pane);
+    gtk_frame_set_child(GTK_FRAME(pane->spectrum_frame), pane->spectrum);
+    gtk_paned_set_start_child(GTK_PANED(paned), pane->spectrum_frame);
+    gtk_paned_set_resize_start_child(GTK_PANED(paned), TRUE);
+    gtk_paned_set_shrink_start_child(GTK_PANED(paned), TRUE);
+
+    // Waterfall widget (same height as spectrum)
+    pane->waterfall = waterfall_widget_new();
+    gtk_widget_set_size_request(pane->waterfall, -1, display_min_h);
+    waterfall_widget_set_sample_rate(WATERFALL_WIDGET(pane->waterfall), sample_rate);
+    waterfall_widget_set_zoom_fft(WATERFALL_WIDGET(pane->waterfall), TRUE);
+    // Use waterfall-specific adjustments for initial range
+    float wf_ref_db = (float)gtk_adjustment_get_value(app_data->waterfall_ref_adj);
+    float wf_range_db = (float)gtk_adjustment_get_value(app_data->waterfall_range_adj);
+    waterfall_widget_set_range(WATERFALL_WIDGET(pane->waterfall), wf_ref_db - wf_range_db, wf_ref_db);
+
+    GtkWidget *waterfall_frame = gtk_frame_new(NULL);
+    gtk_frame_set_child(GTK_FRAME(waterfall_frame), pane->waterfall);
+    gtk_paned_set_end_child(GTK_PANED(paned), waterfall_frame);
+    gtk_paned_set_resize_end_child(GTK_PANED(paned), TRUE);
+    gtk_paned_set_shrink_end_child(GTK_PANED(paned), TRUE);
+
+    // Set paned position (equal split for spectrum and waterfall)
+    int paned_pos = (app_data->window_height - 60) / rows / 2;  // 60 for margins and control bar
+    gtk_paned_set_position(GTK_PANED(paned), paned_pos);
+
+    return paned;
+}
+
+// Lock memory before the RT threads start (the playback file mapping
+// would be locked too, so playback skips it)
+static void lock_memory(app_data_t *app_data) {
+    if (!app_data->lock_memory) return;
+
+    if (app_data->playback_path) {
+        fprintf(stderr, "RT: --mlock ignored during playback\n");
+    } else {
+        rt_sched_lock_memory();
+    }
+}
+
+// Configure and start the USB (or playback) and DSP threads of one radio
+// Returns 0 on success, -1 if the radio has no pipeline or it failed to start
+static int start_pane_pipeline(app_data_t *app_data, int index) {
+    radio_pane_t *pane = &app_data->panes[index];
+    if (!pane->pipeline) return -1;
+
+    radio_pipeline_set_thread_config(pane->pipeline, &app_data->usb_rt, &app_data->dsp_rt);
+    radio_pipeline_set_window(pane->pipeline, app_data->fft_window);
+    if (app_data->detect_signals) {
+        radio_pipeline_enable_detector(pane->pipeline, NULL);
+    }
+    if (app_data->channelizer_channels > 0) {
+        radio_pipeline_enable_channelizer(pane->pipeline, app_data->channelizer_channels);
+    }
+    // Decoded text is shown on the spectrum, so not in headless mode
+    channelizer_t *ch = radio_pipeline_get_channelizer(pane->pipeline);
+    if (app_data->cw_decode && !app_data->headless_dir && ch && !pane->cw) {
+        pane->cw = cw_bank_new(ch, app_data->cw_threads);
+        if (!pane->cw || cw_bank_start(pane->cw) != 0) {
+            fprintf(stderr, "CW: decoding disabled\n");
+            cw_bank_free(pane->cw);
+            pane->cw = NULL;
+        }
+    }
+    if (app_data->shm_enabled) {
+        char name[32];
+        snprintf(name, sizeof(name), "/elad-spectrum-%d", index);
+        pane->shm = spectrum_shm_create(name, FFT_SIZE, SPECTRUM_SHM_DEFAULT_SLOTS,
+                                        radio_pipeline_get_sample_rate(pane->pipeline));
+        radio_pipeline_set_shm(pane->pipeline, pane->shm);
+    }
+    if (app_data->occupancy_dir) {
+        // One subdirectory per radio when there are several
+        char dir[512];
+        if (app_data->num_panes == 1) {
+            snprintf(dir, sizeof(dir), "%s", app_data->occupancy_dir);
+        } else if (pane->serial[0]) {
+            snprintf(dir, sizeof(dir), "%s/%s", app_data->occupancy_dir, pane->serial);
+        } else {
+            snprintf(dir, sizeof(dir), "%s/%d", app_data->occupancy_dir, index);
+        }
+        if (app_data->num_panes > 1 && mkdir(app_data->occupancy_dir, 0755) != 0 &&
+            errno != EEXIST) {
+            fprintf(stderr, "Occupancy: Cannot create %s: %s\n", app_data->occupancy_dir,
+                    strerror(errno));
+        }
+        pane->occupancy = occupancy_new(dir, FFT_SIZE, app_data->occupancy_db);
+        radio_pipeline_set_occupancy(pane->pipeline, pane->occupancy);
+    }
+    if (app_data->archive_dir) {
+        char dir[512];
+        if (app_data->num_panes == 1) {
+            snprintf(dir, sizeof(dir), "%s", app_data->archive_dir);
+        } else if (pane->serial[0]) {
+            snprintf(dir, sizeof(dir), "%s/%s", app_data->archive_dir, pane->serial);
+        } else {
+            snprintf(dir, sizeof(dir), "%s/%d", app_data->archive_dir, index);
+        }
+        if (app_data->num_panes > 1 && mkdir(app_data->archive_dir, 0755) != 0 &&
+            errno != EEXIST) {
+            fprintf(stderr, "Archive: Cannot create %s: %s\n", app_data->archive_dir,
+                    strerror(errno));
+        }
+        spectrum_archive_config_t config = SPECTRUM_ARCHIVE_CONFIG_DEFAULT;
+        config.gate_db = app_data->archive_gate_db;
+        pane->archive = spectrum_archive_new(dir, FFT_SIZE, &config);
+        if (!pane->archive || spectrum_archive_start(pane->archive) != 0) {
+            fprintf(stderr, "Archive: recording disabled\n");
+            spectrum_archive_free(pane->archive);
+            pane->archive = NULL;
+        } else if (pane->waterfall) {
+            spectrum_archive_reader_t *reader = spectrum_archive_reader_open(dir);
+            if (reader) {
+                waterfall_widget_set_history(WATERFALL_WIDGET(pane->waterfall), pane_history,
+                                             reader,
+                                             (GDestroyNotify)spectrum_archive_reader_close);
+            }
+        }
+    }
+    if (app_data->sweep_enabled && !radio_pipeline_get_usb(pane->pipeline)) {
+        fprintf(stderr, "Sweep: needs a USB radio\n");
+    } else if (app_data->sweep_enabled) {
+        pane->sweep = band_sweep_new(&app_data->sweep_config,
+                                     radio_pipeline_get_sample_rate(pane->pipeline));
+        if (pane->sweep) {
+            int64_t center_hz;
+            uint32_t span_hz;
+            band_sweep_get_span(pane->sweep, &center_hz, &span_hz);
+            pane->center_freq_hz = (int)center_hz;
+            radio_pipeline_set_sweep(pane->pipeline, pane->sweep);
+            if (pane->spectrum) {
+                spectrum_widget_set_center_freq(SPECTRUM_WIDGET(pane->spectrum), pane->center_freq_hz);
+                spectrum_widget_set_sample_rate(SPECTRUM_WIDGET(pane->spectrum), (int)span_hz);
+                set_sweep_overlay(pane, "Sweep");
+                waterfall_widget_set_sample_rate(WATERFALL_WIDGET(pane->waterfall), (int)span_hz);
+                waterfall_widget_set_bandwidth(WATERFALL_WIDGET(pane->waterfall), 0, 0, 0, 0);
+            }
+        }
+    }
+    if (app_data->audio_sink && index == 0) {
+        app_data->audio = audio_output_new(app_data->audio_sink,
+                                           radio_pipeline_get_sample_rate(pane->pipeline));
+        if (app_data->audio && audio_output_start(app_data->audio) == 0) {
+            audio_output_set_mode(app_data->audio, app_data->audio_mode, 0, 0);
+            update_audio_mode(app_data, pane);
+            radio_pipeline_set_audio(pane->pipeline, app_data->audio);
+        } else {
+            fprintf(stderr, "Audio: disabled\n");
+            audio_output_free(app_data->audio);
+            app_data->audio = NULL;
+        }
+    }
+    return radio_pipeline_start(pane->pipeline);
+}
+
+// Start the metrics endpoint and spectrum streaming if requested
+static void start_servers(app_data_t *app_data) {
+    // Prometheus endpoint for headless monitoring
+    if (app_data->metrics_port > 0) {
+        app_data->metrics = metrics_server_new(app_data->metrics_port);
+        for (int i = 0; i < app_data->num_panes && app_data->metrics; i++) {
+            radio_pane_t *pane = &app_data->panes[i];
+            if (!pane->pipeline) continue;
+            char label[USB_SERIAL_LEN];
+            if (pane->serial[0]) {
+                snprintf(label, sizeof(label), "%s", pane->serial);
+            } else {
+                snprintf(label, sizeof(label), "%d", i);
+            }
+            metrics_server_add_radio(app_data->metrics, label, pane->pipeline, pane->cat);
+        }
+        if (!app_data->metrics || metrics_server_start(app_data->metrics) != 0) {
+            fprintf(stderr, "Metrics: endpoint disabled\n");
+        }
+    }
+
+    // Spectrum streaming to remote viewers
+    if (app_data->spectrum_port > 0) {
+        app_data->spectrum_server = spectrum_server_new(app_data->spectrum_port);
+        if (!app_data->spectrum_server || spectrum_server_start(app_data->spectrum_server) != 0) {
+            fprintf(stderr, "Spectrum server: streaming disabled\n");
+            spectrum_server_free(app_data->spectrum_server);
+            app_data->spectrum_server = NULL;
+        }
+    }
+}
+
+// Stop and free servers, tile writers, audio, pipelines and radios
+static void cleanup_app(app_data_t *app_data) {
+    // Servers first: they read the pipelines
+    metrics_server_free(app_data->metrics);
+    spectrum_server_free(app_data->spectrum_server);
+#ifdef HAVE_GPIOD
+    rotary_encoder_free(app_data->encoder1);
+    rotary_encoder_free(app_data->encoder2);
+#endif
+    for (int i = 0; i < app_data->num_panes; i++) {
+        // Before its pipeline: the bank reads the pipeline's channelizer
+        cw_bank_free(app_data->panes[i].cw);
+        radio_pipeline_free(app_data->panes[i].pipeline);
+        tile_writer_free(app_data->panes[i].tiles);
+        cat_control_free(app_data->panes[i].cat);
+        spectrum_shm_free(app_data->panes[i].shm);
+        occupancy_free(app_data->panes[i].occupancy);
+        // Writes the queued lines
+        spectrum_archive_free(app_data->panes[i].archive);
+        // After its pipeline: the USB and DSP threads use it
+        band_sweep_free(app_data->panes[i].sweep);
+    }
+    // After the pipelines: the first one pushes IQ into it
+    audio_output_free(app_data->audio);
+    app_data->audio = NULL;
+    if (app_data->usb_ctx) {
+        libusb_exit(app_data->usb_ctx);
+    }
+    bandplan_free(&app_data->bandplan);
+}
+
+// Load the band plan (overlays and channelizer targets)
+// Try development path first, then installed path
+static void load_bandplan(app_data_t *app_data) {
+    if (bandplan_load(&app_data->bandplan, "./resources/bands-r1.json") != 0) {
+        if (bandplan_load(&app_data->bandplan, "/usr/share/elad-spectrum/bands-r1.json") != 0) {
+            fprintf(stderr, "Bandplan: No bandplan file found, band overlays disabled\n");
+        }
+    }
+}
+
 static void activate(GtkApplication *gtk_app, gpointer user_data) {
     app_data_t *app_data = (app_data_t *)user_data;
 
@@ -642,6 +1700,11 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
     // Connect close handler
     g_signal_connect(app_data->window, "close-request", G_CALLBACK(on_window_close), app_data);
 
+    // Keyboard shortcuts
+    GtkEventController *key_controller = gtk_event_controller_key_new();
+    g_signal_connect(key_controller, "key-pressed", G_CALLBACK(on_key_pressed), app_data);
+    gtk_widget_add_controller(app_data->window, key_controller);
+
     // Main vertical box
     GtkWidget *vbox = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
     gtk_widget_set_margin_start(vbox, 5);
@@ -654,15 +1717,32 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
     GtkWidget *hbox = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
     gtk_widget_set_halign(hbox, GTK_ALIGN_CENTER);
 
-    // Status indicator - colored circle
-    app_data->status_icon = gtk_label_new("○");
-    gtk_widget_add_css_class(GTK_WIDGET(app_data->status_icon), "status-indicator");
-    gtk_widget_add_css_class(GTK_WIDGET(app_data->status_icon), "disconnected");
-    gtk_box_append(GTK_BOX(hbox), app_data->status_icon);
+    // Create one pipeline per radio (or one for the playback file)
+    create_pipelines(app_data);
+
+    // Status indicators - one colored circle per radio
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        pane->status_icon = gtk_label_new("○");
+        gtk_widget_add_css_class(GTK_WIDGET(pane->status_icon), "status-indicator");
+        gtk_widget_add_css_class(GTK_WIDGET(pane->status_icon), "disconnected");
+        if (app_data->num_panes > 1) {
+            const char *serial = radio_pipeline_get_serial(pane->pipeline);
+            gtk_widget_set_tooltip_text(pane->status_icon, serial[0] ? serial : NULL);
+        }
+        if (!pane->pipeline) {
+            gtk_label_set_text(GTK_LABEL(pane->status_icon), "✖");
+            gtk_widget_add_css_class(GTK_WIDGET(pane->status_icon), "error");
+        }
+        gtk_box_append(GTK_BOX(hbox), pane->status_icon);
+    }
 
-    // Load saved settings
+    // Load saved settings (--auto-range turns auto on regardless)
     app_settings_t settings;
     settings_load(&settings);
+    if (settings.auto_range) {
+        app_data->auto_range = TRUE;
+    }
 
     // Create all adjustments with loaded values
     app_data->ref_adj = gtk_adjustment_new(settings.spectrum_ref, -80.0, 20.0, 5.0, 10.0, 0.0);
@@ -692,140 +1772,71 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
         GtkWidget *ref_label = gtk_label_new("Ref");
         gtk_box_append(GTK_BOX(hbox), ref_label);
 
-        GtkWidget *ref_spin = gtk_spin_button_new(app_data->ref_adj, 1.0, 0);
-        gtk_box_append(GTK_BOX(hbox), ref_spin);
+        app_data->ref_spin = gtk_spin_button_new(app_data->ref_adj, 1.0, 0);
+        gtk_box_append(GTK_BOX(hbox), app_data->ref_spin);
 
         GtkWidget *range_label = gtk_label_new("Rng");
         gtk_box_append(GTK_BOX(hbox), range_label);
 
-        GtkWidget *range_spin = gtk_spin_button_new(app_data->range_adj, 1.0, 0);
-        gtk_box_append(GTK_BOX(hbox), range_spin);
-    }
-
-    // Paned container for spectrum and waterfall
-    GtkWidget *paned = gtk_paned_new(GTK_ORIENTATION_VERTICAL);
-    gtk_widget_set_vexpand(paned, TRUE);
-    gtk_box_append(GTK_BOX(vbox), paned);
+        app_data->range_spin = gtk_spin_button_new(app_data->range_adj, 1.0, 0);
+        gtk_box_append(GTK_BOX(hbox), app_data->range_spin);
 
-    // Spectrum widget (same height as waterfall)
-    app_data->spectrum = spectrum_widget_new();
-    int display_min_h = (app_data->window_height <= 480) ? 100 : 150;
-    gtk_widget_set_size_request(app_data->spectrum, -1, display_min_h);
-    spectrum_widget_set_center_freq(SPECTRUM_WIDGET(app_data->spectrum), app_data->center_freq_hz);
-    spectrum_widget_set_sample_rate(SPECTRUM_WIDGET(app_data->spectrum), DEFAULT_SAMPLE_RATE);
-
-    // Set initial range from adjustments
-    float ref_db = (float)gtk_adjustment_get_value(app_data->ref_adj);
-    float range_db = (float)gtk_adjustment_get_value(app_data->range_adj);
-    spectrum_widget_set_range(SPECTRUM_WIDGET(app_data->spectrum), ref_db - range_db, ref_db);
-
-    // Set initial overlay
-    char freq_str[32];
-    snprintf(freq_str, sizeof(freq_str), "%.6f MHz", app_data->center_freq_hz / 1e6);
-    spectrum_widget_set_overlay(SPECTRUM_WIDGET(app_data->spectrum), freq_str, "---");
+        // Automatic ref/range (also 'a'); disables the spin buttons
+        app_data->auto_check = gtk_check_button_new_with_label("Auto");
+        gtk_check_button_set_active(GTK_CHECK_BUTTON(app_data->auto_check), app_data->auto_range);
+        g_signal_connect(app_data->auto_check, "toggled", G_CALLBACK(on_auto_range_toggled), app_data);
+        gtk_box_append(GTK_BOX(hbox), app_data->auto_check);
+        gtk_widget_set_sensitive(app_data->ref_spin, !app_data->auto_range);
+        gtk_widget_set_sensitive(app_data->range_spin, !app_data->auto_range);
+    }
 
     // Load bandplan for band overlay display
-    // Try development path first, then installed path
-    if (bandplan_load(&app_data->bandplan, "./resources/bands-r1.json") != 0) {
-        if (bandplan_load(&app_data->bandplan, "/usr/share/elad-spectrum/bands-r1.json") != 0) {
-            fprintf(stderr, "Bandplan: No bandplan file found, band overlays disabled\n");
-        }
+    load_bandplan(app_data);
+
+    // Grid of radio panes, two per row
+    GtkWidget *grid = gtk_grid_new();
+    gtk_grid_set_column_spacing(GTK_GRID(grid), 5);
+    gtk_grid_set_row_spacing(GTK_GRID(grid), 5);
+    gtk_grid_set_column_homogeneous(GTK_GRID(grid), TRUE);
+    gtk_grid_set_row_homogeneous(GTK_GRID(grid), TRUE);
+    gtk_widget_set_vexpand(grid, TRUE);
+    gtk_box_append(GTK_BOX(vbox), grid);
+
+    int rows = (app_data->num_panes + 1) / 2;
+    for (int i = 0; i < app_data->num_panes; i++) {
+        GtkWidget *paned = create_pane(app_data, &app_data->panes[i], rows);
+        gtk_grid_attach(GTK_GRID(grid), paned, i % 2, i / 2, 1, 1);
     }
-    spectrum_widget_set_bandplan(SPECTRUM_WIDGET(app_data->spectrum), &app_data->bandplan);
-
-    app_data->spectrum_frame = gtk_frame_new("VFO A");
-    gtk_frame_set_child(GTK_FRAME(app_data->spectrum_frame), app_data->spectrum);
-    gtk_paned_set_start_child(GTK_PANED(paned), app_data->spectrum_frame);
-    gtk_paned_set_resize_start_child(GTK_PANED(paned), TRUE);
-    gtk_paned_set_shrink_start_child(GTK_PANED(paned), TRUE);
-
-    // Waterfall widget (same height as spectrum)
-    app_data->waterfall = waterfall_widget_new();
-    gtk_widget_set_size_request(app_data->waterfall, -1, display_min_h);
-    waterfall_widget_set_sample_rate(WATERFALL_WIDGET(app_data->waterfall), DEFAULT_SAMPLE_RATE);
-    // Use waterfall-specific adjustments for initial range
-    float wf_ref_db = (float)gtk_adjustment_get_value(app_data->waterfall_ref_adj);
-    float wf_range_db = (float)gtk_adjustment_get_value(app_data->waterfall_range_adj);
-    waterfall_widget_set_range(WATERFALL_WIDGET(app_data->waterfall), wf_ref_db - wf_range_db, wf_ref_db);
-
-    GtkWidget *waterfall_frame = gtk_frame_new(NULL);
-    gtk_frame_set_child(GTK_FRAME(waterfall_frame), app_data->waterfall);
-    gtk_paned_set_end_child(GTK_PANED(paned), waterfall_frame);
-    gtk_paned_set_resize_end_child(GTK_PANED(paned), TRUE);
-    gtk_paned_set_shrink_end_child(GTK_PANED(paned), TRUE);
-
-    // Set paned position (equal split for spectrum and waterfall)
-    int paned_pos = (app_data->window_height - 60) / 2;  // 60 for margins and control bar
-    gtk_paned_set_position(GTK_PANED(paned), paned_pos);
 
     // Add control bar at bottom
     gtk_box_append(GTK_BOX(vbox), hbox);
 
-    // Initialize USB device
-    app_data->usb = usb_device_new();
-    if (!app_data->usb) {
-        fprintf(stderr, "Failed to initialize USB\n");
-        gtk_label_set_text(GTK_LABEL(app_data->status_icon), "✖");
-        gtk_widget_add_css_class(GTK_WIDGET(app_data->status_icon), "error");
-    }
-
-    // Initialize CAT control
-    app_data->cat = cat_control_new();
-    if (app_data->cat) {
-        if (cat_control_open(app_data->cat, "/dev/ttyUSB0") == 0) {
-            // Query frequency immediately on connect
-            long freq;
-            elad_mode_t mode;
-            int vfo;
-            if (cat_control_get_freq_mode(app_data->cat, &freq, &mode, &vfo) == 0) {
-                if (freq > 0) {
-                    app_data->center_freq_hz = (int)freq;
-                    app_data->current_mode = mode;
-                    app_data->current_vfo = vfo;
-
-                    // Update spectrum display
-                    spectrum_widget_set_center_freq(SPECTRUM_WIDGET(app_data->spectrum), app_data->center_freq_hz);
-
-                    // Update overlay
-                    char freq_str[32];
-                    snprintf(freq_str, sizeof(freq_str), "%.6f MHz", app_data->center_freq_hz / 1e6);
-                    spectrum_widget_set_overlay(SPECTRUM_WIDGET(app_data->spectrum), freq_str,
-                                                usb_device_mode_name(app_data->current_mode));
-
-                    // Update frame label
-                    gtk_frame_set_label(GTK_FRAME(app_data->spectrum_frame),
-                                        vfo == 0 ? "VFO A" : "VFO B");
-
-                    fprintf(stderr, "CAT: Initial frequency %.6f MHz, mode %s, VFO %c\n",
-                            freq / 1e6, usb_device_mode_name(mode), vfo == 0 ? 'A' : 'B');
-                }
-            }
+    // Query CAT immediately for radios that have a port
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        if (!pane->cat) continue;
+
+        if (cat_control_open(pane->cat, pane->cat_device) == 0) {
+            poll_pane(app_data, pane);
+            fprintf(stderr, "CAT: Initial frequency %.6f MHz, mode %s, VFO %c\n",
+                    pane->center_freq_hz / 1e6, usb_device_mode_name(pane->current_mode),
+                    pane->current_vfo == 0 ? 'A' : 'B');
         } else {
             fprintf(stderr, "CAT: Will retry when USB connects\n");
         }
     }
 
-    // Initialize FFT processor
-    app_data->fft = fft_processor_new(FFT_SIZE);
-    if (!app_data->fft) {
-        fprintf(stderr, "Failed to initialize FFT\n");
-        gtk_label_set_text(GTK_LABEL(app_data->status_icon), "✖");
-        gtk_widget_add_css_class(GTK_WIDGET(app_data->status_icon), "error");
-    }
-
 #ifdef HAVE_GPIOD
     // Initialize rotary encoders (Pi mode only)
     if (app_data->pi_mode) {
-        app_data->zoom_level = settings.zoom_level;
-        app_data->pan_offset = settings.pan_offset;
+        // The latency test looks for its tone in the full span
+        app_data->zoom_level = app_data->latency_test ? 1 : settings.zoom_level;
+        app_data->pan_offset = app_data->latency_test ? 0 : settings.pan_offset;
         app_data->active_param = PARAM_SPECTRUM_REF;
         app_data->encoder2_mode = ENCODER2_MODE_ZOOM;
 
         // Apply saved zoom/pan to widgets
-        spectrum_widget_set_zoom(SPECTRUM_WIDGET(app_data->spectrum), app_data->zoom_level);
-        spectrum_widget_set_pan(SPECTRUM_WIDGET(app_data->spectrum), app_data->pan_offset);
-        waterfall_widget_set_zoom(WATERFALL_WIDGET(app_data->waterfall), app_data->zoom_level);
-        waterfall_widget_set_pan(WATERFALL_WIDGET(app_data->waterfall), app_data->pan_offset);
+        apply_zoom_pan(app_data);
 
         // Encoder 1 - Parameter control (GPIO 17/27/22)
         app_data->encoder1 = rotary_encoder_new_with_pins(
@@ -861,20 +1872,37 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
     }
 #endif
 
-    // Start USB thread
+    // Start the USB (or playback) and DSP threads of every radio
+    lock_memory(app_data);
     atomic_store(&app_data->running, 1);
-    atomic_store(&app_data->usb_connected, 0);
-    atomic_store(&app_data->spectrum_ready, 0);
-
-    if (pthread_create(&app_data->usb_thread, NULL, usb_thread_func, app_data) != 0) {
-        fprintf(stderr, "Failed to create USB thread\n");
-        gtk_label_set_text(GTK_LABEL(app_data->status_icon), "✖");
-        gtk_widget_add_css_class(GTK_WIDGET(app_data->status_icon), "error");
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        if (start_pane_pipeline(app_data, i) != 0 && pane->pipeline) {
+            gtk_label_set_text(GTK_LABEL(pane->status_icon), "✖");
+            gtk_widget_add_css_class(GTK_WIDGET(pane->status_icon), "error");
+        }
     }
 
     // Start display refresh timer (~30 FPS)
     g_timeout_add(33, refresh_display, app_data);
 
+    start_servers(app_data);
+
+    // Periodic stage timing dump
+    if (app_data->perf_dump_seconds > 0) {
+        if (perf_trace_enabled()) {
+            perf_trace_snapshot(&app_data->perf_dump_prev);
+            app_data->perf_dump_time = g_get_monotonic_time();
+            g_timeout_add_seconds(app_data->perf_dump_seconds, perf_dump_timeout, app_data);
+        } else {
+            fprintf(stderr, "Perf: --stats ignored, built without -Dperf_trace=true\n");
+        }
+    }
+
+    if (app_data->latency_test) {
+        fprintf(stderr, "Latency: measuring %d test bursts...\n", LATENCY_TEST_BURSTS);
+    }
+
     // Apply fullscreen if requested
     if (app_data->fullscreen) {
         gtk_window_fullscreen(GTK_WINDOW(app_data->window));
@@ -884,18 +1912,37 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
 }
 
 static void shutdown_app(GtkApplication *gtk_app G_GNUC_UNUSED, gpointer user_data) {
-    app_data_t *app_data = (app_data_t *)user_data;
+    cleanup_app((app_data_t *)user_data);
+}
 
-    // Cleanup
-#ifdef HAVE_GPIOD
-    rotary_encoder_free(app_data->encoder1);
-    rotary_encoder_free(app_data->encoder2);
-#endif
-    fft_processor_free(app_data->fft);
-    usb_device_free(app_data->usb);
-    cat_control_free(app_data->cat);
-    bandplan_free(&app_data->bandplan);
-    g_mutex_clear(&app_data->spectrum_mutex);
+// Default real-time priority of the USB thread (DSP thread runs one below)
+#define DEFAULT_RT_PRIORITY 50
+
+// Option values: the whole string must be a number in min..max
+// Returns 0 on success, -1 (message printed) otherwise
+static int parse_int_option(const char *option, const char *value, long min, long max, int *out) {
+    char *end;
+    errno = 0;
+    long parsed = strtol(value, &end, 10);
+    if (end == value || *end != '\0' || errno == ERANGE || parsed < min || parsed > max) {
+        fprintf(stderr, "Invalid %s '%s' (use an integer in %ld-%ld)\n", option, value, min, max);
+        return -1;
+    }
+    *out = (int)parsed;
+    return 0;
+}
+
+static int parse_double_option(const char *option, const char *value, double min, double max,
+                               double *out) {
+    char *end;
+    errno = 0;
+    double parsed = strtod(value, &end);
+    if (end == value || *end != '\0' || errno == ERANGE || !(parsed >= min && parsed <= max)) {
+        fprintf(stderr, "Invalid %s '%s' (use a number in %g-%g)\n", option, value, min, max);
+        return -1;
+    }
+    *out = parsed;
+    return 0;
 }
 
 static void print_usage(const char *prog) {
@@ -903,25 +1950,242 @@ static void print_usage(const char *prog) {
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "  -f, --fullscreen    Start in fullscreen mode\n");
     fprintf(stderr, "  -p, --pi            Set window size to 800x480 (5\" LCD)\n");
+    fprintf(stderr, "  --radio SERIAL[,TTY] Show this radio (repeat for up to %d radios)\n", MAX_RADIOS);
+    fprintf(stderr, "  --list-radios       List connected radios and exit\n");
+    fprintf(stderr, "  --play FILE         Replay a recorded IQ file instead of the radio\n");
+    fprintf(stderr, "  --speed N|max       Playback speed (1 = real time, max = benchmark)\n");
+    fprintf(stderr, "  --seek SECONDS      Start playback at this position\n");
+    fprintf(stderr, "  --rate HZ           Sample rate of raw IQ files and UDP streams (default %d)\n",
+            DEFAULT_SAMPLE_RATE);
+    fprintf(stderr, "  --loop              Restart playback at end of file\n");
+    fprintf(stderr, "  --udp PORT          Receive IQ over UDP on PORT instead of the radio\n");
+    fprintf(stderr, "  --headless DIR      No window: write waterfall tiles and index.json to DIR\n");
+    fprintf(stderr, "  --tile-seconds N    Duration of one tile (default 60)\n");
+    fprintf(stderr, "  --tile-width PX     Width of the tiles in pixels (default 1024)\n");
+    fprintf(stderr, "  --tile-format F     Tile format: png (default) or raw\n");
+    fprintf(stderr, "  --audio SINK        Demodulate the first radio to pulse, FILE.wav or - (stdout)\n");
+    fprintf(stderr, "  --mode M            Demodulator mode am|usb|lsb|cw|cwr|fm (default: radio's)\n");
+    fprintf(stderr, "  --channels N        Split each radio's IQ into N channels (power of two, 8-4096)\n");
+    fprintf(stderr, "  --cw-decode         Decode every CW carrier and show the text (implies --detect)\n");
+    fprintf(stderr, "  --cw-threads N      CW decoder worker threads (default: one per core but one)\n");
+    fprintf(stderr, "  --occupancy DIR     Keep per-hour band occupancy in DIR (heatmap with 'o')\n");
+    fprintf(stderr, "  --occupancy-db DB   Busy above noise floor + DB (default %.0f)\n",
+            OCCUPANCY_DEFAULT_THRESHOLD_DB);
+    fprintf(stderr, "  --archive DIR       Record every spectrum line to DIR (drag the waterfall back)\n");
+    fprintf(stderr, "  --archive-gate DB   Archive levels below noise floor + DB as the floor (default 8)\n");
+    fprintf(stderr, "  --sweep START-STOP  Sweep the radio across START-STOP MHz (0-54, e.g. 3-30)\n");
+    fprintf(stderr, "  --sweep-frames N    FFT frames averaged per sweep step (default 3)\n");
+    fprintf(stderr, "  --sweep-settle N    FFT frames discarded after each retune (default 1)\n");
+    fprintf(stderr, "  --usb-stats         Show USB stream statistics overlay (toggle with 'u')\n");
+    fprintf(stderr, "  --perf-stats        Show stage timing overlay (toggle with 'p')\n");
+    fprintf(stderr, "  --stats SECONDS     Print stage timings (p50/p99) every SECONDS\n");
+    fprintf(stderr, "  --metrics-port N    Serve Prometheus metrics on 127.0.0.1:N/metrics\n");
+    fprintf(stderr, "  --spectrum-port N   Stream spectra to remote viewers on TCP port N\n");
+    fprintf(stderr, "  --shm               Publish spectra in shared memory (/elad-spectrum-N)\n");
+    fprintf(stderr, "  --latency-test      Measure sample-to-pixel latency with a synthetic signal\n");
+    fprintf(stderr, "  --usb-cpu N         Pin USB threads to CPU core N\n");
+    fprintf(stderr, "  --dsp-cpu N         Pin DSP threads to CPU core N\n");
+    fprintf(stderr, "  --rt-policy P       Real-time policy for USB/DSP threads: fifo, rr or none\n");
+    fprintf(stderr, "  --rt-prio N         Real-time priority of USB threads (DSP gets N-1, default %d)\n",
+            DEFAULT_RT_PRIORITY);
+    fprintf(stderr, "  --mlock             Lock memory to avoid page faults\n");
+    fprintf(stderr, "  --window W          Spectrum estimator: bh (Blackman-Harris, default) or wola\n");
+    fprintf(stderr, "  --detect            Detect carriers and mark them on the spectrum\n");
+    fprintf(stderr, "  --auto-range        Set ref/range from noise floor and peaks (toggle with 'a')\n");
     fprintf(stderr, "  -h, --help          Show this help message\n");
 }
 
+// Print serial numbers of connected radios (for --radio)
+static int list_radios(void) {
+    libusb_context *ctx = NULL;
+    if (libusb_init(&ctx) < 0) {
+        fprintf(stderr, "Failed to initialize libusb\n");
+        return 1;
+    }
+
+    char serials[MAX_RADIOS][USB_SERIAL_LEN];
+    int found = usb_device_enumerate(ctx, serials, MAX_RADIOS);
+    for (int i = 0; i < found; i++) {
+        printf("%s\n", serials[i]);
+    }
+    if (found == 0) {
+        fprintf(stderr, "No FDM-DUO radios found\n");
+    }
+
+    libusb_exit(ctx);
+    return found > 0 ? 0 : 1;
+}
+
+// Set by SIGINT/SIGTERM to end headless mode
+static volatile sig_atomic_t headless_stop;
+
+static void on_headless_signal(int sig G_GNUC_UNUSED) {
+    headless_stop = 1;
+}
+
+// Headless mode (--headless DIR): run the pipelines without GTK and write
+// waterfall tiles to DIR (one subdirectory per radio when there are several)
+// until SIGINT/SIGTERM
+// Returns the process exit status
+static int run_headless(app_data_t *app_data) {
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = on_headless_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    create_pipelines(app_data);
+    if (app_data->channelizer_channels > 0) {
+        load_bandplan(app_data);
+    }
+
+    // Same palette range as the waterfall in the window
+    app_settings_t settings;
+    settings_load(&settings);
+    app_data->tile_config.max_db = (float)settings.waterfall_ref;
+    app_data->tile_config.min_db = (float)(settings.waterfall_ref - settings.waterfall_range);
+
+    if (app_data->num_panes > 1 && mkdir(app_data->headless_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Headless: Cannot create %s: %s\n", app_data->headless_dir, strerror(errno));
+    }
+
+    lock_memory(app_data);
+    atomic_store(&app_data->running, 1);
+    int started = 0;
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        pane->center_freq_hz = app_data->default_freq_hz;
+        if (!pane->pipeline) continue;
+
+        char dir[512];
+        if (app_data->num_panes == 1) {
+            snprintf(dir, sizeof(dir), "%s", app_data->headless_dir);
+        } else if (pane->serial[0]) {
+            snprintf(dir, sizeof(dir), "%s/%s", app_data->headless_dir, pane->serial);
+        } else {
+            snprintf(dir, sizeof(dir), "%s/%d", app_data->headless_dir, i);
+        }
+        pane->tiles = tile_writer_new(dir, FFT_SIZE, &app_data->tile_config);
+        if (!pane->tiles || tile_writer_start(pane->tiles) != 0) continue;
+
+        // Without a port yet, CAT is opened again when USB connects
+        if (pane->cat) {
+            cat_control_open(pane->cat, pane->cat_device);
+        }
+        if (start_pane_pipeline(app_data, i) == 0) {
+            started++;
+        }
+    }
+    if (started == 0) {
+        fprintf(stderr, "Headless: No radio to record, exiting\n");
+        cleanup_app(app_data);
+        return 1;
+    }
+
+    start_servers(app_data);
+
+    gboolean poll_radios = !app_data->playback_path && !app_data->latency_test &&
+                           !app_data->udp_port;
+    int poll_counter = 0;
+    while (!headless_stop) {
+        // Fetch at the display refresh rate, so tiles match the window
+        usleep(33000);
+
+        // Follow the radio frequency about once a second
+        gboolean poll = poll_radios && ++poll_counter >= 30;
+        if (poll) poll_counter = 0;
+
+        for (int i = 0; i < app_data->num_panes; i++) {
+            radio_pane_t *pane = &app_data->panes[i];
+            if (!pane->tiles) continue;
+
+            long freq = -1;
+            elad_mode_t mode = pane->current_mode;
+            int vfo = pane->current_vfo;
+            int connect_count = radio_pipeline_get_connect_count(pane->pipeline);
+            if (pane->sweep) {
+                report_pane_sweep(pane);
+            } else if (connect_count != pane->connect_count) {
+                pane->connect_count = connect_count;
+                freq = radio_pipeline_get_radio_freq(pane->pipeline);
+            } else if (poll && radio_pipeline_is_connected(pane->pipeline) &&
+                       read_pane_tuning(pane, &freq, &mode, &vfo) != 0) {
+                freq = -1;
+            }
+            if (freq > 0 && (freq != pane->center_freq_hz || mode != pane->current_mode)) {
+                pane->center_freq_hz = (int)freq;
+                pane->current_mode = mode;
+                pane->current_vfo = vfo;
+                if (!pane_tuning_polled(pane)) {
+                    radio_pipeline_set_tuning(pane->pipeline, pane->center_freq_hz,
+                                              pane->current_mode);
+                }
+                update_audio_mode(app_data, pane);
+                update_pane_channels(app_data, pane);
+            }
+
+            float spectrum[FFT_SIZE];
+            uint64_t timestamp_ns = 0;
+            if (!radio_pipeline_get_spectrum(pane->pipeline, spectrum, FFT_SIZE, &timestamp_ns)) {
+                continue;
+            }
+            spectrum_frame_meta_t meta;
+            pane_frame_meta(app_data, i, timestamp_ns, &meta);
+            tile_writer_add_line(pane->tiles, spectrum, monotonic_to_realtime_ns(timestamp_ns),
+                                 meta.center_hz, meta.span_hz);
+            archive_pane_line(pane, spectrum, timestamp_ns, &meta);
+            if (app_data->spectrum_server) {
+                spectrum_server_publish(app_data->spectrum_server, &meta, spectrum, FFT_SIZE);
+            }
+        }
+    }
+
+    fprintf(stderr, "Headless: Stopping\n");
+    atomic_store(&app_data->running, 0);
+    for (int i = 0; i < app_data->num_panes; i++) {
+        radio_pane_t *pane = &app_data->panes[i];
+        if (!pane->tiles) continue;
+
+        // Writes the unfinished tile
+        tile_writer_stop(pane->tiles);
+        fprintf(stderr, "Headless: Radio %d: %ld tiles written, %ld lines dropped\n", i,
+                tile_writer_get_tiles(pane->tiles), tile_writer_get_dropped(pane->tiles));
+    }
+    cleanup_app(app_data);
+    return 0;
+}
+
 int main(int argc, char *argv[]) {
     // Initialize app data
     memset(&app, 0, sizeof(app));
-    g_mutex_init(&app.spectrum_mutex);
-    app.center_freq_hz = 15300000;  // 15.3 MHz default
+    app.default_freq_hz = 15300000;  // 15.3 MHz default
     app.fullscreen = FALSE;
     app.pi_mode = FALSE;
     app.window_width = 1024;   // Default size
     app.window_height = 768;
+    app.playback_speed = 1.0;
+    rt_thread_config_t default_rt = RT_THREAD_CONFIG_DEFAULT;
+    app.usb_rt = default_rt;
+    app.dsp_rt = default_rt;
+    int rt_prio = DEFAULT_RT_PRIORITY;
+    gboolean rt_prio_given = FALSE;
+    tile_writer_config_t default_tiles = TILE_WRITER_CONFIG_DEFAULT;
+    app.tile_config = default_tiles;
+    app.audio_mode = DEMOD_USB;
+    app.occupancy_db = OCCUPANCY_DEFAULT_THRESHOLD_DB;
+    spectrum_archive_config_t default_archive = SPECTRUM_ARCHIVE_CONFIG_DEFAULT;
+    app.archive_gate_db = default_archive.gate_db;
+    band_sweep_config_t default_sweep = BAND_SWEEP_CONFIG_DEFAULT;
+    app.sweep_config = default_sweep;
 
     // Parse and filter command-line options (before GTK takes over)
     int new_argc = 1;
     char **new_argv = g_malloc(sizeof(char *) * (argc + 1));
     new_argv[0] = argv[0];
 
-    for (int i = 1; i < argc; i++) {
+    gboolean bad_option = FALSE;
+    long max_cpu = sysconf(_SC_NPROCESSORS_CONF) - 1;
+    for (int i = 1; i < argc && !bad_option; i++) {
         if (strcmp(argv[i], "-f") == 0 || strcmp(argv[i], "--fullscreen") == 0) {
             app.fullscreen = TRUE;
             // Don't pass to GTK
@@ -930,6 +2194,177 @@ int main(int argc, char *argv[]) {
             app.window_width = 800;
             app.window_height = 480;
             // Don't pass to GTK
+        } else if (strcmp(argv[i], "--radio") == 0 && i + 1 < argc) {
+            i++;
+            if (app.num_radio_args < MAX_RADIOS) {
+                app.radio_args[app.num_radio_args++] = argv[i];
+            } else {
+                fprintf(stderr, "Ignoring --radio %s (at most %d radios)\n", argv[i], MAX_RADIOS);
+            }
+        } else if (strcmp(argv[i], "--list-radios") == 0) {
+            g_free(new_argv);
+            return list_radios();
+        } else if (strcmp(argv[i], "--play") == 0 && i + 1 < argc) {
+            app.playback_path = argv[++i];
+        } else if (strcmp(argv[i], "--speed") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "max") == 0) {
+                app.playback_speed = IQ_PLAYBACK_SPEED_MAX;
+            } else {
+                // 0 would mean max: only accept a positive number
+                char *end;
+                app.playback_speed = strtod(argv[i], &end);
+                if (end == argv[i] || *end != '\0' || !(app.playback_speed > 0.0)) {
+                    fprintf(stderr, "Invalid --speed '%s' (use a positive number or max)\n", argv[i]);
+                    bad_option = TRUE;
+                }
+            }
+        } else if (strcmp(argv[i], "--seek") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_double_option("--seek", argv[i], 0.0, 1e9, &app.playback_seek) != 0;
+        } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--rate", argv[i], 1, 100000000, &app.playback_rate) != 0;
+        } else if (strcmp(argv[i], "--loop") == 0) {
+            app.playback_loop = TRUE;
+        } else if (strcmp(argv[i], "--udp") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--udp", argv[i], 1, 65535, &app.udp_port) != 0;
+        } else if (strcmp(argv[i], "--headless") == 0 && i + 1 < argc) {
+            app.headless_dir = argv[++i];
+        } else if (strcmp(argv[i], "--audio") == 0 && i + 1 < argc) {
+            app.audio_sink = argv[++i];
+        } else if (strcmp(argv[i], "--mode") == 0 && i + 1 < argc) {
+            i++;
+            if (demodulator_parse_mode(argv[i], &app.audio_mode) != 0) {
+                fprintf(stderr, "Unknown --mode '%s' (use am, usb, lsb, cw, cwr or fm)\n", argv[i]);
+                g_free(new_argv);
+                return 1;
+            }
+            app.audio_mode_forced = TRUE;
+        } else if (strcmp(argv[i], "--channels") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--channels", argv[i], 8, 4096,
+                                          &app.channelizer_channels) != 0;
+        } else if (strcmp(argv[i], "--cw-decode") == 0) {
+            app.cw_decode = TRUE;
+        } else if (strcmp(argv[i], "--cw-threads") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--cw-threads", argv[i], 0, CW_BANK_MAX_THREADS,
+                                          &app.cw_threads) != 0;
+        } else if (strcmp(argv[i], "--occupancy") == 0 && i + 1 < argc) {
+            app.occupancy_dir = argv[++i];
+        } else if (strcmp(argv[i], "--occupancy-db") == 0 && i + 1 < argc) {
+            double db;
+            i++;
+            bad_option = parse_double_option("--occupancy-db", argv[i], 0.0, 120.0, &db) != 0;
+            app.occupancy_db = (float)db;
+        } else if (strcmp(argv[i], "--archive") == 0 && i + 1 < argc) {
+            app.archive_dir = argv[++i];
+        } else if (strcmp(argv[i], "--archive-gate") == 0 && i + 1 < argc) {
+            double db;
+            i++;
+            bad_option = parse_double_option("--archive-gate", argv[i], 0.0, 120.0, &db) != 0;
+            app.archive_gate_db = (float)db;
+        } else if (strcmp(argv[i], "--sweep") == 0 && i + 1 < argc) {
+            double start_mhz, stop_mhz;
+            double max_mhz = BAND_SWEEP_MAX_HZ / 1e6;
+            if (sscanf(argv[++i], "%lf-%lf", &start_mhz, &stop_mhz) != 2 || start_mhz < 0.0 ||
+                stop_mhz <= start_mhz || stop_mhz > max_mhz) {
+                fprintf(stderr, "Invalid --sweep '%s' (use START-STOP in MHz within 0-%.0f, "
+                        "e.g. 3-30)\n", argv[i], max_mhz);
+                bad_option = TRUE;
+                continue;
+            }
+            app.sweep_enabled = TRUE;
+            app.sweep_config.start_hz = (int64_t)(start_mhz * 1e6);
+            app.sweep_config.stop_hz = (int64_t)(stop_mhz * 1e6);
+        } else if (strcmp(argv[i], "--sweep-frames") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--sweep-frames", argv[i], 1, FFT_MAX_AVERAGING,
+                                          &app.sweep_config.frames) != 0;
+        } else if (strcmp(argv[i], "--sweep-settle") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--sweep-settle", argv[i], 0, 100,
+                                          &app.sweep_config.settle_frames) != 0;
+        } else if (strcmp(argv[i], "--tile-seconds") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--tile-seconds", argv[i], 1, 86400,
+                                          &app.tile_config.seconds) != 0;
+        } else if (strcmp(argv[i], "--tile-width") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--tile-width", argv[i], 1, FFT_SIZE,
+                                          &app.tile_config.width) != 0;
+        } else if (strcmp(argv[i], "--tile-format") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "png") == 0) {
+                app.tile_config.format = TILE_FORMAT_PNG;
+            } else if (strcmp(argv[i], "raw") == 0) {
+                app.tile_config.format = TILE_FORMAT_RAW;
+            } else {
+                fprintf(stderr, "Unknown --tile-format '%s' (use png or raw)\n", argv[i]);
+                g_free(new_argv);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--usb-stats") == 0) {
+            app.show_usb_stats = TRUE;
+        } else if (strcmp(argv[i], "--perf-stats") == 0) {
+            app.show_perf_stats = TRUE;
+        } else if (strcmp(argv[i], "--stats") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--stats", argv[i], 1, 3600, &app.perf_dump_seconds) != 0;
+        } else if (strcmp(argv[i], "--metrics-port") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--metrics-port", argv[i], 1, 65535,
+                                          &app.metrics_port) != 0;
+        } else if (strcmp(argv[i], "--spectrum-port") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--spectrum-port", argv[i], 1, 65535,
+                                          &app.spectrum_port) != 0;
+        } else if (strcmp(argv[i], "--shm") == 0) {
+            app.shm_enabled = TRUE;
+        } else if (strcmp(argv[i], "--latency-test") == 0) {
+            if (!perf_trace_enabled()) {
+                fprintf(stderr, "--latency-test needs a build with -Dperf_trace=true\n");
+                g_free(new_argv);
+                return 1;
+            }
+            app.latency_test = TRUE;
+        } else if (strcmp(argv[i], "--usb-cpu") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--usb-cpu", argv[i], 0, max_cpu, &app.usb_rt.cpu) != 0;
+        } else if (strcmp(argv[i], "--dsp-cpu") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--dsp-cpu", argv[i], 0, max_cpu, &app.dsp_rt.cpu) != 0;
+        } else if (strcmp(argv[i], "--rt-policy") == 0 && i + 1 < argc) {
+            i++;
+            if (rt_sched_parse_policy(argv[i], &app.usb_rt.policy) != 0) {
+                fprintf(stderr, "Unknown --rt-policy '%s' (use fifo, rr or none)\n", argv[i]);
+                g_free(new_argv);
+                return 1;
+            }
+            app.dsp_rt.policy = app.usb_rt.policy;
+        } else if (strcmp(argv[i], "--rt-prio") == 0 && i + 1 < argc) {
+            i++;
+            bad_option = parse_int_option("--rt-prio", argv[i], 1, 99, &rt_prio) != 0;
+            rt_prio_given = TRUE;
+        } else if (strcmp(argv[i], "--mlock") == 0) {
+            app.lock_memory = TRUE;
+        } else if (strcmp(argv[i], "--auto-range") == 0) {
+            app.auto_range = TRUE;
+        } else if (strcmp(argv[i], "--detect") == 0) {
+            app.detect_signals = TRUE;
+        } else if (strcmp(argv[i], "--window") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "bh") == 0) {
+                app.fft_window = FFT_WINDOW_BLACKMAN_HARRIS;
+            } else if (strcmp(argv[i], "wola") == 0) {
+                app.fft_window = FFT_WINDOW_WOLA;
+            } else {
+                fprintf(stderr, "Unknown --window '%s' (use bh or wola)\n", argv[i]);
+                g_free(new_argv);
+                return 1;
+            }
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
             g_free(new_argv);
@@ -940,6 +2375,31 @@ int main(int argc, char *argv[]) {
         }
     }
     new_argv[new_argc] = NULL;
+    if (bad_option) {
+        print_usage(argv[0]);
+        g_free(new_argv);
+        return 1;
+    }
+
+    // --rt-prio alone implies SCHED_FIFO; DSP runs below USB so the
+    // event loop can always refill its transfers first
+    if (rt_prio_given && app.usb_rt.policy == RT_POLICY_NONE) {
+        app.usb_rt.policy = RT_POLICY_FIFO;
+        app.dsp_rt.policy = RT_POLICY_FIFO;
+    }
+    app.usb_rt.priority = rt_prio;
+    app.dsp_rt.priority = rt_prio > 1 ? rt_prio - 1 : 1;
+
+    // CW decoding runs on the detector's carriers and channelizer output
+    if (app.cw_decode) {
+        app.detect_signals = TRUE;
+        if (app.channelizer_channels == 0) app.channelizer_channels = CW_DEFAULT_CHANNELS;
+    }
+
+    if (app.headless_dir) {
+        g_free(new_argv);
+        return run_headless(&app);
+    }
 
     // Create GTK application
     app.app = gtk_application_new("org.elad.spectrum", G_APPLICATION_DEFAULT_FLAGS);
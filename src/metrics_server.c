@@ -0,0 +1,371 @@
+#define _DEFAULT_SOURCE
+#include "metrics_server.h"
+#include "perf_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <errno.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// How long accept waits before re-checking for shutdown
+#define ACCEPT_POLL_MS 200
+
+// Timeout for reading a request and writing the response
+#define CLIENT_TIMEOUT_MS 1000
+
+// Stage histogram buckets exported: powers of two from 1 us to ~1 s
+#define STAGE_LE_MIN_NS (1ULL << 10)
+#define STAGE_LE_MAX_NS (1ULL << 30)
+
+typedef struct {
+    char label[USB_SERIAL_LEN];
+    radio_pipeline_t *pipe;
+    cat_control_t *cat;
+} metrics_radio_t;
+
+struct metrics_server {
+    int port;
+    int listen_fd;
+
+    metrics_radio_t radios[METRICS_MAX_RADIOS];
+    int num_radios;
+
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+
+    // Response body, reused between scrapes (server thread only)
+    char *body;
+    size_t body_len;
+    size_t body_size;
+};
+
+metrics_server_t *metrics_server_new(int port) {
+    if (port <= 0 || port > 65535) return NULL;
+
+    metrics_server_t *server = calloc(1, sizeof(metrics_server_t));
+    if (!server) return NULL;
+    server->port = port;
+    server->listen_fd = -1;
+    return server;
+}
+
+void metrics_server_free(metrics_server_t *server) {
+    if (!server) return;
+    metrics_server_stop(server);
+    free(server->body);
+    free(server);
+}
+
+int metrics_server_add_radio(metrics_server_t *server, const char *label,
+                             radio_pipeline_t *pipe, cat_control_t *cat) {
+    if (!server || !pipe || server->num_radios >= METRICS_MAX_RADIOS) return -1;
+
+    metrics_radio_t *radio = &server->radios[server->num_radios++];
+    snprintf(radio->label, sizeof(radio->label), "%s", label ? label : "");
+    radio->pipe = pipe;
+    radio->cat = cat;
+    return 0;
+}
+
+// Append formatted text to the response body, growing it as needed
+static void emit(metrics_server_t *server, const char *fmt, ...) {
+    for (;;) {
+        size_t room = server->body_size - server->body_len;
+        va_list args;
+        va_start(args, fmt);
+        int n = server->body ? vsnprintf(server->body + server->body_len, room, fmt, args) : -1;
+        va_end(args);
+
+        if (n >= 0 && (size_t)n < room) {
+            server->body_len += n;
+            return;
+        }
+
+        size_t size = server->body_size ? server->body_size * 2 : 16384;
+        char *body = realloc(server->body, size);
+        if (!body) return;  // Out of memory: drop this line
+        server->body = body;
+        server->body_size = size;
+    }
+}
+
+static void emit_header(metrics_server_t *server, const char *name, const char *type,
+                        const char *help) {
+    emit(server, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+// Histogram with log2 microsecond buckets (usb_stats_t / cat_stats_t layout)
+static void emit_us_histogram(metrics_server_t *server, const char *name, const char *label,
+                              const uint64_t *hist, int buckets, double sum_seconds) {
+    uint64_t count = 0;
+    for (int i = 0; i < buckets - 1; i++) {
+        count += hist[i];
+        emit(server, "%s_bucket{radio=\"%s\",le=\"%g\"} %llu\n",
+             name, label, (double)(1ULL << i) / 1e6, (unsigned long long)count);
+    }
+    count += hist[buckets - 1];
+    emit(server, "%s_bucket{radio=\"%s\",le=\"+Inf\"} %llu\n", name, label, (unsigned long long)count);
+    emit(server, "%s_sum{radio=\"%s\"} %g\n", name, label, sum_seconds);
+    emit(server, "%s_count{radio=\"%s\"} %llu\n", name, label, (unsigned long long)count);
+}
+
+static void build_radio_metrics(metrics_server_t *server) {
+    emit_header(server, "elad_connected", "gauge", "1 if the radio is streaming");
+    for (int r = 0; r < server->num_radios; r++) {
+        metrics_radio_t *radio = &server->radios[r];
+        emit(server, "elad_connected{radio=\"%s\"} %d\n", radio->label,
+             radio_pipeline_is_connected(radio->pipe) ? 1 : 0);
+    }
+
+    emit_header(server, "elad_reconnects_total", "counter", "Reconnections after the first connect");
+    for (int r = 0; r < server->num_radios; r++) {
+        metrics_radio_t *radio = &server->radios[r];
+        int connects = radio_pipeline_get_connect_count(radio->pipe);
+        emit(server, "elad_reconnects_total{radio=\"%s\"} %d\n", radio->label,
+             connects > 0 ? connects - 1 : 0);
+    }
+
+    emit_header(server, "elad_tuned_frequency_hz", "gauge", "Frequency shown for the radio");
+    for (int r = 0; r < server->num_radios; r++) {
+        metrics_radio_t *radio = &server->radios[r];
+        long freq = radio_pipeline_get_tuned_freq(radio->pipe);
+        if (freq < 0) continue;
+        emit(server, "elad_tuned_frequency_hz{radio=\"%s\",mode=\"%s\"} %ld\n", radio->label,
+             usb_device_mode_name(radio_pipeline_get_tuned_mode(radio->pipe)), freq);
+    }
+
+    emit_header(server, "elad_spectra_total", "counter", "Averaged FFT spectra computed");
+    for (int r = 0; r < server->num_radios; r++) {
+        metrics_radio_t *radio = &server->radios[r];
+        emit(server, "elad_spectra_total{radio=\"%s\"} %ld\n", radio->label,
+             radio_pipeline_get_spectrum_count(radio->pipe));
+    }
+
+    emit_header(server, "elad_ring_dropped_total", "counter",
+                "IQ chunks dropped because the DSP thread fell behind");
+    for (int r = 0; r < server->num_radios; r++) {
+        metrics_radio_t *radio = &server->radios[r];
+        emit(server, "elad_ring_dropped_total{radio=\"%s\"} %ld\n", radio->label,
+             radio_pipeline_get_dropped(radio->pipe));
+    }
+
+    // USB stream health (USB radios only)
+    static const struct {
+        const char *name;
+        const char *help;
+        size_t offset;
+    } usb_counters[] = {
+        { "elad_usb_bytes_total", "IQ payload bytes received", offsetof(usb_stats_t, bytes) },
+        { "elad_usb_transfers_total", "Completed bulk transfers", offsetof(usb_stats_t, transfers) },
+        { "elad_usb_short_transfers_total", "Transfers shorter than the buffer",
+          offsetof(usb_stats_t, short_transfers) },
+        { "elad_usb_timeouts_total", "Transfers that timed out", offsetof(usb_stats_t, timeouts) },
+        { "elad_usb_errors_total", "Fatal transfer errors", offsetof(usb_stats_t, errors) },
+    };
+    usb_stats_t usb_stats[METRICS_MAX_RADIOS];
+    bool have_usb[METRICS_MAX_RADIOS];
+    for (int r = 0; r < server->num_radios; r++) {
+        usb_device_t *usb = radio_pipeline_get_usb(server->radios[r].pipe);
+        have_usb[r] = usb != NULL;
+        if (usb) usb_device_get_stats(usb, &usb_stats[r]);
+    }
+    for (size_t c = 0; c < sizeof(usb_counters) / sizeof(usb_counters[0]); c++) {
+        emit_header(server, usb_counters[c].name, "counter", usb_counters[c].help);
+        for (int r = 0; r < server->num_radios; r++) {
+            if (!have_usb[r]) continue;
+            const uint64_t *value = (const uint64_t *)((const char *)&usb_stats[r] + usb_counters[c].offset);
+            emit(server, "%s{radio=\"%s\"} %llu\n", usb_counters[c].name, server->radios[r].label,
+                 (unsigned long long)*value);
+        }
+    }
+    emit_header(server, "elad_usb_samples_lost", "gauge", "Expected minus received samples (estimate)");
+    for (int r = 0; r < server->num_radios; r++) {
+        if (!have_usb[r]) continue;
+        emit(server, "elad_usb_samples_lost{radio=\"%s\"} %lld\n", server->radios[r].label,
+             (long long)usb_stats[r].samples_lost);
+    }
+    emit_header(server, "elad_usb_max_gap_seconds", "gauge", "Longest time between transfer completions");
+    for (int r = 0; r < server->num_radios; r++) {
+        if (!have_usb[r]) continue;
+        emit(server, "elad_usb_max_gap_seconds{radio=\"%s\"} %g\n", server->radios[r].label,
+             usb_stats[r].max_gap_us / 1e6);
+    }
+
+    // CAT round trips (radios with a CAT port)
+    emit_header(server, "elad_cat_failures_total", "counter", "CAT commands without a complete reply");
+    for (int r = 0; r < server->num_radios; r++) {
+        if (!server->radios[r].cat) continue;
+        cat_stats_t stats;
+        cat_control_get_stats(server->radios[r].cat, &stats);
+        emit(server, "elad_cat_failures_total{radio=\"%s\"} %llu\n", server->radios[r].label,
+             (unsigned long long)stats.failures);
+    }
+    emit_header(server, "elad_cat_rtt_seconds", "histogram", "CAT command round-trip time");
+    for (int r = 0; r < server->num_radios; r++) {
+        if (!server->radios[r].cat) continue;
+        cat_stats_t stats;
+        cat_control_get_stats(server->radios[r].cat, &stats);
+        emit_us_histogram(server, "elad_cat_rtt_seconds", server->radios[r].label,
+                          stats.rtt_hist, CAT_STATS_HIST_BUCKETS, stats.rtt_sum_us / 1e6);
+    }
+}
+
+// Stage latency histograms, process-wide (perf_trace has no per-radio split)
+static void build_stage_metrics(metrics_server_t *server) {
+    if (!perf_trace_enabled()) return;
+
+    static perf_snapshot_t snap;  // Server thread only
+    perf_trace_snapshot(&snap);
+
+    emit_header(server, "elad_stage_duration_seconds", "histogram",
+                "Processing time per hot-path stage (DSP, hand-off, draw) and sample-to-pixel latency");
+    for (int s = 0; s < PERF_STAGE_COUNT; s++) {
+        const char *stage = perf_stage_name((perf_stage_t)s);
+        uint64_t count = 0;
+        int b = 0;
+        for (uint64_t le = STAGE_LE_MIN_NS; le <= STAGE_LE_MAX_NS; le <<= 1) {
+            while (b < PERF_TRACE_BUCKETS && perf_trace_bucket_limit(b) <= le) {
+                count += snap.hist[s][b++];
+            }
+            emit(server, "elad_stage_duration_seconds_bucket{stage=\"%s\",le=\"%g\"} %llu\n",
+                 stage, le / 1e9, (unsigned long long)count);
+        }
+        while (b < PERF_TRACE_BUCKETS) count += snap.hist[s][b++];
+        emit(server, "elad_stage_duration_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %llu\n",
+             stage, (unsigned long long)count);
+        emit(server, "elad_stage_duration_seconds_sum{stage=\"%s\"} %g\n", stage, snap.sum_ns[s] / 1e9);
+        emit(server, "elad_stage_duration_seconds_count{stage=\"%s\"} %llu\n",
+             stage, (unsigned long long)count);
+    }
+}
+
+// Write all of buf, giving up after CLIENT_TIMEOUT_MS of no progress
+static void write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0 && (errno == EINTR)) continue;
+        if (n <= 0) return;
+        buf += n;
+        len -= n;
+    }
+}
+
+static void handle_client(metrics_server_t *server, int fd) {
+    struct timeval tv = { CLIENT_TIMEOUT_MS / 1000, (CLIENT_TIMEOUT_MS % 1000) * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+
+    // Only the request line matters; read until the end of the headers
+    char request[1024];
+    size_t len = 0;
+    while (len < sizeof(request) - 1) {
+        ssize_t n = recv(fd, request + len, sizeof(request) - 1 - len, 0);
+        if (n <= 0) break;
+        len += n;
+        request[len] = '\0';
+        if (strstr(request, "\r\n\r\n") || strstr(request, "\n\n")) break;
+    }
+    request[len] = '\0';
+
+    const char *status = "200 OK";
+    server->body_len = 0;
+    if (strncmp(request, "GET /metrics ", 13) == 0 || strncmp(request, "GET / ", 6) == 0) {
+        build_radio_metrics(server);
+        build_stage_metrics(server);
+    } else if (strncmp(request, "GET ", 4) == 0) {
+        status = "404 Not Found";
+        emit(server, "Not found (try /metrics)\n");
+    } else {
+        status = "405 Method Not Allowed";
+        emit(server, "Only GET is supported\n");
+    }
+
+    char header[256];
+    int header_len = snprintf(header, sizeof(header),
+                              "HTTP/1.0 %s\r\n"
+                              "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+                              "Content-Length: %zu\r\n"
+                              "Connection: close\r\n\r\n",
+                              status, server->body_len);
+    write_all(fd, header, header_len);
+    if (server->body) write_all(fd, server->body, server->body_len);
+}
+
+static void *metrics_thread_func(void *user_data) {
+    metrics_server_t *server = (metrics_server_t *)user_data;
+
+    while (atomic_load(&server->running)) {
+        struct pollfd pfd = { .fd = server->listen_fd, .events = POLLIN };
+        int ready = poll(&pfd, 1, ACCEPT_POLL_MS);
+        if (ready <= 0) continue;
+
+        int fd = accept(server->listen_fd, NULL, NULL);
+        if (fd < 0) continue;
+        handle_client(server, fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+int metrics_server_start(metrics_server_t *server) {
+    if (!server) return -1;
+    if (atomic_load(&server->running)) return 0;
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0) {
+        fprintf(stderr, "Metrics: socket failed: %s\n", strerror(errno));
+        return -1;
+    }
+    int one = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    // Localhost only: scrape through an SSH tunnel or a local agent
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)server->port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, 4) != 0) {
+        fprintf(stderr, "Metrics: cannot listen on 127.0.0.1:%d: %s\n", server->port, strerror(errno));
+        close(server->listen_fd);
+        server->listen_fd = -1;
+        return -1;
+    }
+
+    atomic_store(&server->running, 1);
+    if (pthread_create(&server->thread, NULL, metrics_thread_func, server) != 0) {
+        fprintf(stderr, "Metrics: failed to create thread\n");
+        atomic_store(&server->running, 0);
+        close(server->listen_fd);
+        server->listen_fd = -1;
+        return -1;
+    }
+    server->thread_started = 1;
+
+    fprintf(stderr, "Metrics: serving http://127.0.0.1:%d/metrics\n", server->port);
+    return 0;
+}
+
+void metrics_server_stop(metrics_server_t *server) {
+    if (!server) return;
+
+    atomic_store(&server->running, 0);
+    if (server->thread_started) {
+        pthread_join(server->thread, NULL);
+        server->thread_started = 0;
+    }
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        server->listen_fd = -1;
+    }
+}
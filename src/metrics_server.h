@@ -0,0 +1,36 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include "radio_pipeline.h"
+#include "cat_control.h"
+
+// Prometheus text-format endpoint (GET /metrics) on 127.0.0.1 for
+// unattended stations. Runs its own thread and only reads counters the
+// pipelines, CAT ports and perf_trace publish as atomics, so a scrape
+// never takes a pipeline lock.
+
+typedef struct metrics_server metrics_server_t;
+
+// Maximum number of radios exported
+#define METRICS_MAX_RADIOS 8
+
+// Create server for the given TCP port (not yet listening)
+metrics_server_t *metrics_server_new(int port);
+
+// Free server (stops the thread first)
+void metrics_server_free(metrics_server_t *server);
+
+// Export a radio under radio="<label>" (cat may be NULL)
+// Must be called before metrics_server_start
+// Returns 0 on success, -1 if full
+int metrics_server_add_radio(metrics_server_t *server, const char *label,
+                             radio_pipeline_t *pipe, cat_control_t *cat);
+
+// Bind to 127.0.0.1:port and start the server thread
+// Returns 0 on success, -1 on error
+int metrics_server_start(metrics_server_t *server);
+
+// Stop the server thread (blocks until it exits)
+void metrics_server_stop(metrics_server_t *server);
+
+#endif // METRICS_SERVER_H
@@ -0,0 +1,56 @@
+#ifndef MONO_CLOCK_H
+#define MONO_CLOCK_H
+
+// Clock reads in integer ns/us/ms for the modules that time themselves
+// (retune latency, loss reports, rate limits, CPU budgets)
+// Header-only: clock_gettime is a vDSO call, so these inline to a few
+// instructions on the hot paths that use them.
+
+#include <stdint.h>
+#include <time.h>
+
+static inline uint64_t clock_read_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// CLOCK_MONOTONIC, the clock of chunk and spectrum timestamps
+static inline uint64_t monotonic_ns(void) {
+    return clock_read_ns(CLOCK_MONOTONIC);
+}
+
+static inline uint64_t monotonic_us(void) {
+    return monotonic_ns() / 1000ULL;
+}
+
+static inline uint64_t monotonic_ms(void) {
+    return monotonic_ns() / 1000000ULL;
+}
+
+// CPU time used by the calling thread
+static inline uint64_t thread_cpu_ns(void) {
+    return clock_read_ns(CLOCK_THREAD_CPUTIME_ID);
+}
+
+// Wall-clock time of a CLOCK_MONOTONIC timestamp, for files and viewers
+// on other machines; 0 or a timestamp in the future means now
+static inline int64_t monotonic_to_realtime_ns(uint64_t timestamp_ns) {
+    uint64_t mono_now = monotonic_ns();
+    int64_t real_now = (int64_t)clock_read_ns(CLOCK_REALTIME);
+    if (timestamp_ns == 0 || timestamp_ns > mono_now) return real_now;
+    return real_now - (int64_t)(mono_now - timestamp_ns);
+}
+
+// Log2 histogram bucket for a duration (bucket i holds values below 2^i),
+// clamped to the last of buckets; the USB and CAT stats histograms use it
+static inline int duration_hist_bucket(uint64_t duration, int buckets) {
+    int bucket = 0;
+    while (duration > 0 && bucket < buckets - 1) {
+        duration >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+#endif // MONO_CLOCK_H
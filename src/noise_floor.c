@@ -0,0 +1,42 @@
+#include "noise_floor.h"
+#include <stdint.h>
+#include <string.h>
+
+// Quarter-dB buckets from -200 to +56 dB
+#define HIST_MIN_DB -200.0f
+#define HIST_STEP_DB 0.25f
+#define HIST_BUCKETS 1024
+
+// Level at the given percentile (bucket centre)
+static float histogram_percentile(const uint32_t *hist, int total, float pct) {
+    int rank = (int)(pct / 100.0f * (total - 1));
+    int below = 0;
+    for (int b = 0; b < HIST_BUCKETS; b++) {
+        below += hist[b];
+        if (below > rank) {
+            return HIST_MIN_DB + (b + 0.5f) * HIST_STEP_DB;
+        }
+    }
+    return HIST_MIN_DB + HIST_BUCKETS * HIST_STEP_DB;
+}
+
+void noise_floor_measure(const float *spectrum_db, int size, spectrum_levels_t *levels) {
+    if (!levels) return;
+    if (!spectrum_db || size <= 0) {
+        levels->noise_db = HIST_MIN_DB;
+        levels->peak_db = HIST_MIN_DB;
+        return;
+    }
+
+    uint32_t hist[HIST_BUCKETS];
+    memset(hist, 0, sizeof(hist));
+    for (int i = 0; i < size; i++) {
+        int b = (int)((spectrum_db[i] - HIST_MIN_DB) / HIST_STEP_DB);
+        if (b < 0) b = 0;
+        if (b >= HIST_BUCKETS) b = HIST_BUCKETS - 1;
+        hist[b]++;
+    }
+
+    levels->noise_db = histogram_percentile(hist, size, NOISE_FLOOR_PERCENTILE);
+    levels->peak_db = histogram_percentile(hist, size, NOISE_PEAK_PERCENTILE);
+}
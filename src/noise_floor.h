@@ -0,0 +1,21 @@
+#ifndef NOISE_FLOOR_H
+#define NOISE_FLOOR_H
+
+// Noise floor and peak level of a dB spectrum from a fixed-size dB
+// histogram: one pass over the bins plus one over the buckets, no sort.
+// Called by the DSP thread for every spectrum; drives the automatic
+// reference level/range in the display.
+
+// Percentiles of the spectrum bins
+#define NOISE_FLOOR_PERCENTILE 20.0f  // Most HF bins are noise
+#define NOISE_PEAK_PERCENTILE 100.0f  // Strongest bin (spectra are already averaged)
+
+typedef struct {
+    float noise_db;  // Noise floor (NOISE_FLOOR_PERCENTILE)
+    float peak_db;   // Peak level (NOISE_PEAK_PERCENTILE)
+} spectrum_levels_t;
+
+// Measure noise floor and peak of size bins
+void noise_floor_measure(const float *spectrum_db, int size, spectrum_levels_t *levels);
+
+#endif // NOISE_FLOOR_H
@@ -0,0 +1,489 @@
+#define _DEFAULT_SOURCE
+#include "occupancy.h"
+#include "mono_clock.h"
+#include "rt_sched.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Bucket table and cell rows start on cache lines
+#define OCC_ALIGN 64
+
+// Files mapped at once: the two tiles a spectrum can cover, and the ones
+// just left, so tuning back and forth does not remap
+#define OCC_SLOTS 4
+
+// Slot life cycle: the DSP thread asks for a tile (WANTED) and gives up
+// one it no longer needs (RETIRED); the worker maps (READY) and unmaps
+// (FREE) them. Each side only touches a slot in the states it owns.
+enum {
+    SLOT_FREE = 0,
+    SLOT_WANTED,
+    SLOT_READY,
+    SLOT_RETIRED,
+};
+
+typedef struct {
+    atomic_int state;
+    int64_t tile;              // Covers [tile * span_hz, (tile + 1) * span_hz)
+    uint32_t span_hz;
+
+    // Set by the worker before READY; header NULL if the file failed
+    uint8_t *map;
+    size_t map_size;
+    occupancy_header_t *header;
+
+    // Current bucket (DSP thread only)
+    occupancy_bucket_t *bucket;
+    occupancy_cell_t *cells;
+    uint64_t bucket_end_ns;    // CLOCK_MONOTONIC time the bucket's hour ends
+    uint64_t last_used;        // Frame counter of the last frame added
+} occ_slot_t;
+
+struct occupancy {
+    char dir[512];
+    int bins;
+    float threshold_db;        // For new files
+
+    occ_slot_t slots[OCC_SLOTS];
+    uint64_t frame_counter;    // DSP thread only
+
+    // File worker: sleeps until a slot is WANTED or RETIRED
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+
+    atomic_long frames;
+};
+
+static size_t align_up(size_t n) {
+    return (n + OCC_ALIGN - 1) & ~(size_t)(OCC_ALIGN - 1);
+}
+
+static void file_path(const occupancy_t *occ, int64_t tile, uint32_t span_hz,
+                      char *path, size_t size) {
+    snprintf(path, size, "%s/%lld-%u.occ", occ->dir, (long long)(tile * span_hz), span_hz);
+}
+
+// Grid bin of a spectrum's bin 0: bin bins/2 on the grid bin nearest
+// center_hz
+static int64_t grid_first_bin(int64_t center_hz, uint32_t span_hz, int bins) {
+    return llround((double)center_hz * bins / span_hz) - bins / 2;
+}
+
+static size_t cells_offset(uint32_t bucket_count) {
+    return align_up(align_up(sizeof(occupancy_header_t)) +
+                    sizeof(occupancy_bucket_t) * bucket_count);
+}
+
+static bool header_valid(const occupancy_header_t *header, size_t size) {
+    if (size < sizeof(occupancy_header_t) || header->magic != OCCUPANCY_MAGIC) return false;
+    atomic_thread_fence(memory_order_acquire);
+    return header->version == OCCUPANCY_VERSION && header->bins > 0 &&
+           header->bucket_count > 0 && header->bucket_seconds > 0 &&
+           header->header_size >= sizeof(occupancy_header_t) &&
+           header->cells_offset >= header->header_size +
+                                       sizeof(occupancy_bucket_t) * header->bucket_count &&
+           header->cells_offset + sizeof(occupancy_cell_t) * (size_t)header->bins *
+                                      header->bucket_count <= size;
+}
+
+static occupancy_bucket_t *bucket_table(const uint8_t *map, const occupancy_header_t *header) {
+    return (occupancy_bucket_t *)(map + header->header_size);
+}
+
+static occupancy_cell_t *bucket_cells(const uint8_t *map, const occupancy_header_t *header,
+                                      uint32_t index) {
+    return (occupancy_cell_t *)(map + header->cells_offset +
+                                sizeof(occupancy_cell_t) * (size_t)header->bins * index);
+}
+
+// Map (creating if new) the file of a slot's tile (worker thread); on
+// failure the tile is skipped until the slot is given up
+static void map_slot(occupancy_t *occ, occ_slot_t *slot) {
+    slot->map = NULL;
+    slot->header = NULL;
+
+    char path[600];
+    file_path(occ, slot->tile, slot->span_hz, path, sizeof(path));
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Occupancy: cannot open %s: %s\n", path, strerror(errno));
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return;
+    }
+    uint32_t count = OCCUPANCY_DAYS * 86400 / OCCUPANCY_BUCKET_SECONDS;
+    size_t size = cells_offset(count) + sizeof(occupancy_cell_t) * (size_t)occ->bins * count;
+    bool created = st.st_size == 0;
+    // Sparse: only the hours written take disk space
+    if (created && ftruncate(fd, (off_t)size) != 0) {
+        fprintf(stderr, "Occupancy: cannot size %s: %s\n", path, strerror(errno));
+        close(fd);
+        return;
+    }
+    if (!created) size = (size_t)st.st_size;
+
+    uint8_t *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Occupancy: cannot map %s: %s\n", path, strerror(errno));
+        return;
+    }
+
+    occupancy_header_t *header = (occupancy_header_t *)map;
+    if (created) {
+        header->version = OCCUPANCY_VERSION;
+        header->header_size = (uint32_t)align_up(sizeof(occupancy_header_t));
+        header->cells_offset = (uint32_t)cells_offset(count);
+        header->bins = (uint32_t)occ->bins;
+        header->bucket_seconds = OCCUPANCY_BUCKET_SECONDS;
+        header->bucket_count = count;
+        header->threshold_db = occ->threshold_db;
+        header->center_hz = slot->tile * slot->span_hz + slot->span_hz / 2;
+        header->span_hz = slot->span_hz;
+        // Readers check the magic last
+        atomic_thread_fence(memory_order_release);
+        header->magic = OCCUPANCY_MAGIC;
+    } else if (!header_valid(header, size) || header->bins != (uint32_t)occ->bins) {
+        fprintf(stderr, "Occupancy: %s has an unknown layout, not updated\n", path);
+        munmap(map, size);
+        return;
+    }
+
+    slot->map = map;
+    slot->map_size = size;
+    slot->header = header;
+}
+
+static void unmap_slot(occ_slot_t *slot) {
+    if (slot->map) {
+        msync(slot->map, slot->map_size, MS_ASYNC);
+        munmap(slot->map, slot->map_size);
+    }
+    slot->map = NULL;
+    slot->header = NULL;
+}
+
+static void *worker_thread_func(void *arg) {
+    occupancy_t *occ = (occupancy_t *)arg;
+    rt_sched_apply("occupancy", NULL);
+
+    pthread_mutex_lock(&occ->mutex);
+    while (atomic_load(&occ->running)) {
+        bool worked = false;
+        for (int i = 0; i < OCC_SLOTS; i++) {
+            occ_slot_t *slot = &occ->slots[i];
+            int state = atomic_load_explicit(&slot->state, memory_order_acquire);
+            if (state != SLOT_WANTED && state != SLOT_RETIRED) continue;
+
+            // File system calls outside the lock
+            pthread_mutex_unlock(&occ->mutex);
+            if (state == SLOT_WANTED) {
+                map_slot(occ, slot);
+                atomic_store_explicit(&slot->state, SLOT_READY, memory_order_release);
+            } else {
+                unmap_slot(slot);
+                atomic_store_explicit(&slot->state, SLOT_FREE, memory_order_release);
+            }
+            pthread_mutex_lock(&occ->mutex);
+            worked = true;
+        }
+        if (!worked) pthread_cond_wait(&occ->cond, &occ->mutex);
+    }
+    pthread_mutex_unlock(&occ->mutex);
+    return NULL;
+}
+
+// Wake the worker after a slot changed to WANTED or RETIRED (the state is
+// stored first, so the worker either sees it or is waiting)
+static void wake_worker(occupancy_t *occ) {
+    pthread_mutex_lock(&occ->mutex);
+    pthread_cond_signal(&occ->cond);
+    pthread_mutex_unlock(&occ->mutex);
+}
+
+occupancy_t *occupancy_new(const char *dir, int bins, float threshold_db) {
+    if (!dir || bins <= 0) return NULL;
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Occupancy: cannot create %s: %s\n", dir, strerror(errno));
+        return NULL;
+    }
+
+    occupancy_t *occ = calloc(1, sizeof(occupancy_t));
+    if (!occ) return NULL;
+    snprintf(occ->dir, sizeof(occ->dir), "%s", dir);
+    occ->bins = bins;
+    occ->threshold_db = threshold_db;
+    for (int i = 0; i < OCC_SLOTS; i++) atomic_init(&occ->slots[i].state, SLOT_FREE);
+    pthread_mutex_init(&occ->mutex, NULL);
+    pthread_cond_init(&occ->cond, NULL);
+    atomic_init(&occ->running, 1);
+    atomic_init(&occ->frames, 0);
+
+    if (pthread_create(&occ->thread, NULL, worker_thread_func, occ) != 0) {
+        fprintf(stderr, "Occupancy: failed to create worker thread\n");
+        occupancy_free(occ);
+        return NULL;
+    }
+    occ->thread_started = 1;
+
+    fprintf(stderr, "Occupancy: %s, busy above noise + %.1f dB, %d days kept\n", dir,
+            threshold_db, OCCUPANCY_DAYS);
+    return occ;
+}
+
+void occupancy_free(occupancy_t *occ) {
+    if (!occ) return;
+
+    if (occ->thread_started) {
+        pthread_mutex_lock(&occ->mutex);
+        atomic_store(&occ->running, 0);
+        pthread_cond_signal(&occ->cond);
+        pthread_mutex_unlock(&occ->mutex);
+        pthread_join(occ->thread, NULL);
+    }
+    for (int i = 0; i < OCC_SLOTS; i++) unmap_slot(&occ->slots[i]);
+    pthread_mutex_destroy(&occ->mutex);
+    pthread_cond_destroy(&occ->cond);
+    free(occ);
+}
+
+// The mapped slot of a tile, or NULL while it is not mapped yet (DSP
+// thread); a missing tile is requested from the worker, giving up the
+// least recently used file not needed by this frame if all slots are taken
+static occ_slot_t *find_slot(occupancy_t *occ, int64_t tile, uint32_t span_hz) {
+    occ_slot_t *free_slot = NULL;
+    occ_slot_t *oldest = NULL;
+    for (int i = 0; i < OCC_SLOTS; i++) {
+        occ_slot_t *slot = &occ->slots[i];
+        int state = atomic_load_explicit(&slot->state, memory_order_acquire);
+        if (state == SLOT_FREE) {
+            if (!free_slot) free_slot = slot;
+            continue;
+        }
+        if (state == SLOT_RETIRED) continue;
+        if (slot->tile == tile && slot->span_hz == span_hz) {
+            slot->last_used = occ->frame_counter;
+            return state == SLOT_READY && slot->header ? slot : NULL;
+        }
+        if (state == SLOT_READY && slot->last_used != occ->frame_counter &&
+            (!oldest || slot->last_used < oldest->last_used)) {
+            oldest = slot;
+        }
+    }
+
+    if (free_slot) {
+        free_slot->tile = tile;
+        free_slot->span_hz = span_hz;
+        free_slot->bucket = NULL;
+        free_slot->cells = NULL;
+        free_slot->bucket_end_ns = 0;
+        free_slot->last_used = occ->frame_counter;
+        atomic_store_explicit(&free_slot->state, SLOT_WANTED, memory_order_release);
+        wake_worker(occ);
+    } else if (oldest) {
+        // Requested once the worker has freed it
+        atomic_store_explicit(&oldest->state, SLOT_RETIRED, memory_order_release);
+        wake_worker(occ);
+    }
+    return NULL;
+}
+
+// Find a tile's bucket of the hour holding timestamp_ns, resetting it if
+// it last held an older hour (once per hour: the only clock reads)
+static void select_bucket(occ_slot_t *slot, uint64_t timestamp_ns) {
+    int64_t frame_ns = monotonic_to_realtime_ns(timestamp_ns);
+
+    occupancy_header_t *header = slot->header;
+    int64_t seconds = header->bucket_seconds;
+    int64_t start_s = frame_ns / 1000000000LL / seconds * seconds;
+    uint32_t index = (uint32_t)(start_s / seconds % header->bucket_count);
+
+    occupancy_bucket_t *bucket = &bucket_table(slot->map, header)[index];
+    occupancy_cell_t *cells = bucket_cells(slot->map, header, index);
+    if (bucket->start_s != start_s) {
+        // Readers skip the bucket while it is being reset
+        bucket->start_s = 0;
+        bucket->frames = 0;
+        atomic_thread_fence(memory_order_release);
+        memset(cells, 0, sizeof(occupancy_cell_t) * header->bins);
+        atomic_thread_fence(memory_order_release);
+        bucket->start_s = start_s;
+    }
+
+    slot->bucket = bucket;
+    slot->cells = cells;
+    slot->bucket_end_ns = timestamp_ns + (uint64_t)((start_s + seconds) * 1000000000LL - frame_ns);
+}
+
+// Add count bins of a spectrum to a tile's cells from offset on
+static void add_to_tile(occ_slot_t *slot, const float *spectrum_db, int offset, int count,
+                        float noise_db, uint64_t timestamp_ns) {
+    if (timestamp_ns >= slot->bucket_end_ns) {
+        select_bucket(slot, timestamp_ns);
+    }
+
+    occupancy_cell_t *cells = slot->cells + offset;
+    float threshold = noise_db + slot->header->threshold_db;
+    for (int i = 0; i < count; i++) {
+        float db = spectrum_db[i];
+        cells[i].max_db = cells[i].frames == 0 || db > cells[i].max_db ? db : cells[i].max_db;
+        cells[i].frames++;
+        cells[i].busy += db > threshold;
+        cells[i].sum_db += db;
+    }
+    slot->bucket->frames++;
+}
+
+void occupancy_add(occupancy_t *occ, const float *spectrum_db, float noise_db,
+                   int64_t center_hz, uint32_t span_hz, uint64_t timestamp_ns) {
+    if (!occ || !spectrum_db || center_hz <= 0 || span_hz == 0 || timestamp_ns == 0) return;
+
+    int64_t bins = occ->bins;
+    int64_t first = grid_first_bin(center_hz, span_hz, occ->bins);
+    int64_t last = first + bins;
+    if (last <= 0) return;
+
+    occ->frame_counter++;
+    bool added = false;
+    for (int64_t tile = (first > 0 ? first : 0) / bins; tile * bins < last; tile++) {
+        occ_slot_t *slot = find_slot(occ, tile, span_hz);
+        if (!slot) continue;
+        int64_t lo = tile * bins > first ? tile * bins : first;
+        int64_t hi = (tile + 1) * bins < last ? (tile + 1) * bins : last;
+        add_to_tile(slot, spectrum_db + (lo - first), (int)(lo - tile * bins), (int)(hi - lo),
+                    noise_db, timestamp_ns);
+        added = true;
+    }
+    if (added) atomic_fetch_add_explicit(&occ->frames, 1, memory_order_relaxed);
+}
+
+// Per hour of day and output column, what a heatmap sums over its bins
+typedef struct {
+    int columns;
+    int *column_of;      // Output column of each bin of the queried span
+    uint64_t *frames;    // Cell frames
+    double *sums;        // Busy frames or dB
+    float *maxima;
+} heatmap_acc_t;
+
+// Add the bins of one tile the span first..first + bins covers
+// Returns the frames of the tile's buckets counted, -1 if it has no file
+static long heatmap_tile(occupancy_t *occ, int64_t tile, uint32_t span_hz, int64_t first,
+                         int days, occupancy_metric_t metric, heatmap_acc_t *acc) {
+    char path[600];
+    file_path(occ, tile, span_hz, path, sizeof(path));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+    size_t size = (size_t)st.st_size;
+    const uint8_t *map = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    const occupancy_header_t *header = (const occupancy_header_t *)map;
+    if (!header_valid(header, size) || header->bins != (uint32_t)occ->bins) {
+        munmap((void *)map, size);
+        return -1;
+    }
+
+    // Tile bin j is bin j + shift of the queried span
+    int64_t bins = occ->bins;
+    int64_t lo = tile * bins > first ? tile * bins : first;
+    int64_t hi = (tile + 1) * bins < first + bins ? (tile + 1) * bins : first + bins;
+    int from = (int)(lo - tile * bins);
+    int to = (int)(hi - tile * bins);
+    int shift = (int)(tile * bins - first);
+
+    int64_t oldest_s = days > 0 ? (int64_t)time(NULL) - (int64_t)days * 86400 : 0;
+    const occupancy_bucket_t *table = bucket_table(map, header);
+    long total = 0;
+    for (uint32_t b = 0; b < header->bucket_count; b++) {
+        int64_t start_s = table[b].start_s;
+        uint32_t frames = table[b].frames;
+        atomic_thread_fence(memory_order_acquire);
+        if (start_s <= 0 || frames == 0 || start_s + header->bucket_seconds <= oldest_s) continue;
+        total += frames;
+
+        size_t row = (size_t)(start_s % 86400 / 3600) * acc->columns;
+        const occupancy_cell_t *cells = bucket_cells(map, header, b);
+        for (int j = from; j < to; j++) {
+            if (cells[j].frames == 0) continue;
+            size_t k = row + acc->column_of[j + shift];
+            acc->frames[k] += cells[j].frames;
+            acc->sums[k] += metric == OCCUPANCY_BUSY ? (double)cells[j].busy : cells[j].sum_db;
+            if (cells[j].max_db > acc->maxima[k]) acc->maxima[k] = cells[j].max_db;
+        }
+    }
+
+    munmap((void *)map, size);
+    return total;
+}
+
+long occupancy_heatmap(occupancy_t *occ, int64_t center_hz, uint32_t span_hz, int days,
+                       occupancy_metric_t metric, float *out, int columns) {
+    if (!occ || !out || columns <= 0 || span_hz == 0) return -1;
+
+    int64_t bins = occ->bins;
+    int64_t first = grid_first_bin(center_hz, span_hz, occ->bins);
+    if (first + bins <= 0) return -1;
+
+    heatmap_acc_t acc = {
+        .columns = columns,
+        .column_of = malloc(sizeof(int) * (size_t)bins),
+        .frames = calloc((size_t)24 * columns, sizeof(uint64_t)),
+        .sums = calloc((size_t)24 * columns, sizeof(double)),
+        .maxima = malloc(sizeof(float) * 24 * (size_t)columns),
+    };
+    long total = -1;
+    if (acc.column_of && acc.frames && acc.sums && acc.maxima) {
+        for (int64_t i = 0; i < bins; i++) acc.column_of[i] = (int)(i * columns / bins);
+        for (int i = 0; i < 24 * columns; i++) acc.maxima[i] = -INFINITY;
+
+        for (int64_t tile = (first > 0 ? first : 0) / bins; tile * bins < first + bins; tile++) {
+            long frames = heatmap_tile(occ, tile, span_hz, first, days, metric, &acc);
+            if (frames > total) total = frames;
+        }
+        for (int i = 0; i < 24 * columns; i++) {
+            if (acc.frames[i] == 0) {
+                out[i] = NAN;
+            } else if (metric == OCCUPANCY_MAX_DB) {
+                out[i] = acc.maxima[i];
+            } else {
+                out[i] = (float)(acc.sums[i] / (double)acc.frames[i]);
+            }
+        }
+    }
+
+    free(acc.column_of);
+    free(acc.frames);
+    free(acc.sums);
+    free(acc.maxima);
+    return total;
+}
+
+long occupancy_get_frames(occupancy_t *occ) {
+    return occ ? atomic_load_explicit(&occ->frames, memory_order_relaxed) : 0;
+}
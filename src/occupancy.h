@@ -0,0 +1,100 @@
+#ifndef OCCUPANCY_H
+#define OCCUPANCY_H
+
+#include <stdint.h>
+
+// Long-term spectrum occupancy: which bins are busy, and when.
+//
+// The DSP thread adds every full-span spectrum. Per bin and per hour of
+// wall-clock time, a cell counts the frames that covered it, the ones
+// more than threshold_db above that frame's noise floor, and sums and
+// maxes the level. Bins sit on a fixed absolute grid of span_hz / bins
+// from 0 Hz, cut into tiles of span_hz aligned to multiples of span_hz,
+// so a tuning lands on the same cells wherever it is centred (bins are
+// placed on the nearest grid bin) and a spectrum feeds at most two tiles.
+// Each tile is a memory-mapped file in a directory, updated in place:
+// adding a frame is a pass over the bins with no system call (the clock
+// is read once per hour). A worker thread opens, maps and unmaps the
+// files, so a retune never blocks the DSP thread; frames are skipped for
+// a tile until its file is mapped. Buckets form a ring of OCCUPANCY_DAYS
+// days, the oldest hour being reset when it comes round again.
+//
+// Queries map the files read-only on their own, so any thread can ask
+// for an hour-of-day x frequency heatmap while the DSP thread writes; a
+// query reads a few tens of MB per tile at most and takes milliseconds.
+// Cells being updated may be read half-way (one frame's worth of error).
+//
+// Layout (<dir>/<tile start Hz>-<span_hz>.occ): occupancy_header_t, the
+// bucket table (bucket_count occupancy_bucket_t) at header_size, then
+// bucket_count rows of bins occupancy_cell_t at cells_offset, bucket i
+// holding the hour starting at start_s with start_s / 3600 % count == i.
+
+#define OCCUPANCY_MAGIC 0x434F4C45u  // "ELOC" little-endian
+#define OCCUPANCY_VERSION 2
+#define OCCUPANCY_BUCKET_SECONDS 3600
+#define OCCUPANCY_DAYS 28
+#define OCCUPANCY_DEFAULT_THRESHOLD_DB 10.0f
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;     // Offset of the bucket table
+    uint32_t cells_offset;    // Offset of bucket 0's cells
+    uint32_t bins;
+    uint32_t bucket_seconds;
+    uint32_t bucket_count;
+    float threshold_db;       // Busy: level above noise floor + threshold_db
+    int64_t center_hz;        // Centre frequency of bin bins/2 (tile start + span / 2)
+    uint32_t span_hz;         // Width covered by all bins (the tile width)
+    uint32_t reserved;
+} occupancy_header_t;
+
+typedef struct {
+    int64_t start_s;          // Wall-clock start (UTC), 0 = never written
+    uint32_t frames;          // Spectra that covered any bin of the tile
+    uint32_t reserved;
+} occupancy_bucket_t;
+
+typedef struct {
+    uint32_t frames;          // Spectra that covered the bin
+    uint32_t busy;            // Of those, frames above the threshold
+    float sum_db;             // Sum of levels (mean = sum_db / frames)
+    float max_db;             // Highest level
+} occupancy_cell_t;
+
+typedef enum {
+    OCCUPANCY_BUSY = 0,       // Fraction of frames above the threshold (0..1)
+    OCCUPANCY_MEAN_DB = 1,    // Mean level (dB)
+    OCCUPANCY_MAX_DB = 2,     // Highest level (dB)
+} occupancy_metric_t;
+
+typedef struct occupancy occupancy_t;
+
+// Create an accumulator for spectra of bins bins, with files in dir
+// (created if missing), and start its file worker thread; threshold_db
+// applies to new files, existing ones keep theirs
+// Returns NULL on error
+occupancy_t *occupancy_new(const char *dir, int bins, float threshold_db);
+
+// Stop the worker, flush and unmap the open files and free the accumulator
+void occupancy_free(occupancy_t *occ);
+
+// Add one spectrum (single writer thread): noise_db is its noise floor,
+// timestamp_ns the capture time of its newest samples (CLOCK_MONOTONIC);
+// frames without a frequency or capture time are ignored, and bins below
+// 0 Hz are dropped
+void occupancy_add(occupancy_t *occ, const float *spectrum_db, float noise_db,
+                   int64_t center_hz, uint32_t span_hz, uint64_t timestamp_ns);
+
+// Heatmap of the span center_hz/span_hz (any thread), read from the tiles
+// it overlaps: out receives 24 rows (hour of day, UTC, 00 first) of
+// columns values, each over bins / columns adjacent bins and the buckets
+// of the last days days (0 = all kept); NAN where there is no data
+// Returns the most frames any of those tiles holds, -1 if there is no file
+long occupancy_heatmap(occupancy_t *occ, int64_t center_hz, uint32_t span_hz, int days,
+                       occupancy_metric_t metric, float *out, int columns);
+
+// Frames added since creation
+long occupancy_get_frames(occupancy_t *occ);
+
+#endif // OCCUPANCY_H
@@ -0,0 +1,175 @@
+#define _DEFAULT_SOURCE
+#include "perf_trace.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <stdatomic.h>
+
+// One thread's histograms; written only by the owning thread, read by
+// any thread with relaxed loads (a count may be one span behind)
+typedef struct {
+    atomic_uint_fast64_t hist[PERF_STAGE_COUNT][PERF_TRACE_BUCKETS];
+    atomic_uint_fast64_t sum_ns[PERF_STAGE_COUNT];
+} perf_thread_t;
+
+static perf_thread_t perf_threads[PERF_TRACE_MAX_THREADS];
+static atomic_int perf_thread_count;
+static _Thread_local perf_thread_t *perf_self;
+static _Thread_local bool perf_self_full;
+
+static const char *stage_names[PERF_STAGE_COUNT] = {
+    [PERF_STAGE_CONVERT] = "convert",
+    [PERF_STAGE_WINDOW] = "window",
+    [PERF_STAGE_FFT] = "fft",
+    [PERF_STAGE_DB] = "db",
+    [PERF_STAGE_AVERAGE] = "average",
+    [PERF_STAGE_PUBLISH] = "publish",
+    [PERF_STAGE_DEMOD] = "demod",
+    [PERF_STAGE_HANDOFF] = "handoff",
+    [PERF_STAGE_SPECTRUM_DRAW] = "spec_draw",
+    [PERF_STAGE_WATERFALL_DRAW] = "wf_draw",
+    [PERF_STAGE_LAT_FETCH] = "lat_fetch",
+    [PERF_STAGE_LAT_DRAW] = "lat_draw",
+    [PERF_STAGE_LAT_PRESENT] = "lat_present",
+    [PERF_STAGE_LAT_BURST] = "lat_burst",
+};
+
+uint64_t perf_trace_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int bucket_of(uint64_t ns) {
+    if (ns < 4) return (int)ns;
+    int msb = 63 - __builtin_clzll(ns);
+    int sub = (int)(ns >> (msb - 2)) & 3;
+    int bucket = (msb - 1) * 4 + sub;
+    return bucket < PERF_TRACE_BUCKETS ? bucket : PERF_TRACE_BUCKETS - 1;
+}
+
+uint64_t perf_trace_bucket_limit(int bucket) {
+    if (bucket < 4) return (uint64_t)bucket + 1;
+    int msb = bucket / 4 + 1;
+    int sub = bucket % 4;
+    return (uint64_t)(5 + sub) << (msb - 2);
+}
+
+void perf_trace_record(perf_stage_t stage, uint64_t ns) {
+    if ((unsigned)stage >= PERF_STAGE_COUNT) return;
+
+    if (!perf_self) {
+        if (perf_self_full) return;
+        int index = atomic_fetch_add(&perf_thread_count, 1);
+        if (index >= PERF_TRACE_MAX_THREADS) {
+            perf_self_full = true;
+            return;
+        }
+        perf_self = &perf_threads[index];
+    }
+
+    // Single writer: a plain load/store pair, no locked add needed
+    atomic_uint_fast64_t *counter = &perf_self->hist[stage][bucket_of(ns)];
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_uint_fast64_t *sum = &perf_self->sum_ns[stage];
+    atomic_store_explicit(sum, atomic_load_explicit(sum, memory_order_relaxed) + ns,
+                          memory_order_relaxed);
+}
+
+bool perf_trace_enabled(void) {
+#ifdef PERF_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char *perf_stage_name(perf_stage_t stage) {
+    if ((unsigned)stage >= PERF_STAGE_COUNT) return "?";
+    return stage_names[stage];
+}
+
+void perf_trace_snapshot(perf_snapshot_t *snap) {
+    if (!snap) return;
+    memset(snap, 0, sizeof(*snap));
+
+    int threads = atomic_load(&perf_thread_count);
+    if (threads > PERF_TRACE_MAX_THREADS) threads = PERF_TRACE_MAX_THREADS;
+    for (int t = 0; t < threads; t++) {
+        for (int s = 0; s < PERF_STAGE_COUNT; s++) {
+            snap->sum_ns[s] += atomic_load_explicit(&perf_threads[t].sum_ns[s], memory_order_relaxed);
+            for (int b = 0; b < PERF_TRACE_BUCKETS; b++) {
+                snap->hist[s][b] += atomic_load_explicit(&perf_threads[t].hist[s][b],
+                                                         memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void perf_trace_stats(const perf_snapshot_t *now, const perf_snapshot_t *prev,
+                      perf_stage_t stage, perf_stage_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!now || (unsigned)stage >= PERF_STAGE_COUNT) return;
+
+    uint64_t hist[PERF_TRACE_BUCKETS];
+    for (int b = 0; b < PERF_TRACE_BUCKETS; b++) {
+        hist[b] = now->hist[stage][b] - (prev ? prev->hist[stage][b] : 0);
+        stats->count += hist[b];
+        if (hist[b] > 0) stats->max_ns = perf_trace_bucket_limit(b);
+    }
+    if (stats->count == 0) return;
+
+    uint64_t p50 = stats->count / 2;
+    uint64_t p99 = stats->count * 99 / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < PERF_TRACE_BUCKETS; b++) {
+        if (seen <= p50 && seen + hist[b] > p50) stats->p50_ns = perf_trace_bucket_limit(b);
+        if (seen <= p99 && seen + hist[b] > p99) stats->p99_ns = perf_trace_bucket_limit(b);
+        seen += hist[b];
+    }
+}
+
+// Duration with a unit that keeps three significant digits
+static void format_ns(uint64_t ns, char *buf, size_t size) {
+    if (ns < 10000) {
+        snprintf(buf, size, "%lluns", (unsigned long long)ns);
+    } else if (ns < 10000000) {
+        snprintf(buf, size, "%.1fus", ns / 1e3);
+    } else {
+        snprintf(buf, size, "%.1fms", ns / 1e6);
+    }
+}
+
+int perf_trace_format(const perf_snapshot_t *now, const perf_snapshot_t *prev,
+                      double seconds, char *buf, size_t size) {
+    if (!buf || size == 0) return 0;
+    buf[0] = '\0';
+
+    if (!perf_trace_enabled()) {
+        return snprintf(buf, size, "Perf tracing not built in (-Dperf_trace=true)");
+    }
+
+    size_t len = 0;
+    int n = snprintf(buf, size, "%-10s %7s %9s %9s %9s", "Stage", "/s", "p50<", "p99<", "max<");
+    if (n > 0) len = (size_t)n;
+
+    for (int s = 0; s < PERF_STAGE_COUNT && len < size; s++) {
+        perf_stage_stats_t st;
+        perf_trace_stats(now, prev, (perf_stage_t)s, &st);
+
+        char p50[16] = "-", p99[16] = "-", max[16] = "-";
+        if (st.count > 0) {
+            format_ns(st.p50_ns, p50, sizeof(p50));
+            format_ns(st.p99_ns, p99, sizeof(p99));
+            format_ns(st.max_ns, max, sizeof(max));
+        }
+        char rate[16] = "-";
+        if (seconds > 0.0) snprintf(rate, sizeof(rate), "%.1f", st.count / seconds);
+        n = snprintf(buf + len, size - len, "\n%-10s %7s %9s %9s %9s",
+                     perf_stage_name((perf_stage_t)s), rate, p50, p99, max);
+        if (n > 0) len += (size_t)n;
+    }
+    return len < size ? (int)len : (int)size - 1;
+}
@@ -0,0 +1,98 @@
+#ifndef PERF_TRACE_H
+#define PERF_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Hot-path timing: spans around each processing stage are recorded into
+// per-thread latency histograms (each thread writes only its own, so
+// recording takes no locks and no atomic read-modify-write), and summed
+// when the overlay or the --stats dump reads them.
+//
+// The lat_* stages are end-to-end latencies from sample capture (USB
+// transfer completion, CLOCK_MONOTONIC) to a later point on the GTK
+// thread. They are measured against CLOCK_MONOTONIC, the clock of
+// g_get_monotonic_time and the frame clock, not perf_trace_now().
+//
+// Built with -Dperf_trace=false (meson) the span macros compile to
+// nothing; the query functions still link and report no data.
+
+typedef enum {
+    PERF_STAGE_CONVERT = 0,    // USB bytes -> float IQ (per block)
+    PERF_STAGE_WINDOW,         // Window or WOLA fold into the FFT input
+    PERF_STAGE_FFT,            // fftw_execute
+    PERF_STAGE_DB,             // Magnitude, dB and accumulation
+    PERF_STAGE_AVERAGE,        // Average of accumulated frames and RSSI
+    PERF_STAGE_PUBLISH,        // DSP thread: copy to shared buffers under the mutex
+    PERF_STAGE_DEMOD,          // Audio thread: demodulate one IQ chunk
+    PERF_STAGE_HANDOFF,        // Reader: lock, copy and unlock the published spectrum
+    PERF_STAGE_SPECTRUM_DRAW,  // SpectrumWidget draw
+    PERF_STAGE_WATERFALL_DRAW, // WaterfallWidget draw
+    PERF_STAGE_LAT_FETCH,      // Sample capture -> spectrum fetched by the GTK thread
+    PERF_STAGE_LAT_DRAW,       // Sample capture -> waterfall line drawn
+    PERF_STAGE_LAT_PRESENT,    // Sample capture -> frame presented (frame clock)
+    PERF_STAGE_LAT_BURST,      // Test burst onset -> first presented frame showing it
+    PERF_STAGE_COUNT
+} perf_stage_t;
+
+// Quarter-octave buckets: bucket i < 4 counts i ns, above that every
+// power of two is split in four (~19% resolution), up to ~8.6 s
+#define PERF_TRACE_BUCKETS 132
+
+// Threads that can record (USB, DSP per radio, GTK, encoders)
+#define PERF_TRACE_MAX_THREADS 16
+
+// Sum of all threads' histograms (cumulative since start)
+typedef struct {
+    uint64_t hist[PERF_STAGE_COUNT][PERF_TRACE_BUCKETS];
+    uint64_t sum_ns[PERF_STAGE_COUNT];  // Total time per stage
+} perf_snapshot_t;
+
+typedef struct {
+    uint64_t count;
+    uint64_t p50_ns;  // Upper bound of the bucket holding the percentile
+    uint64_t p99_ns;
+    uint64_t max_ns;
+} perf_stage_stats_t;
+
+// Monotonic clock in ns (CLOCK_MONOTONIC_RAW, vDSO on x86 and ARM)
+uint64_t perf_trace_now(void);
+
+// Add one span to the calling thread's histogram
+void perf_trace_record(perf_stage_t stage, uint64_t ns);
+
+#ifdef PERF_TRACE
+#define PERF_SPAN_BEGIN(name) uint64_t name = perf_trace_now()
+#define PERF_SPAN_END(name, stage) perf_trace_record((stage), perf_trace_now() - (name))
+#define PERF_RECORD(stage, ns) perf_trace_record((stage), (ns))
+#else
+#define PERF_SPAN_BEGIN(name) do {} while (0)
+#define PERF_SPAN_END(name, stage) do {} while (0)
+#define PERF_RECORD(stage, ns) do {} while (0)
+#endif
+
+// True if spans are compiled in
+bool perf_trace_enabled(void);
+
+// Stage name for overlays and logs
+const char *perf_stage_name(perf_stage_t stage);
+
+// Exclusive upper bound of a histogram bucket in ns
+uint64_t perf_trace_bucket_limit(int bucket);
+
+// Read all threads' histograms
+void perf_trace_snapshot(perf_snapshot_t *snap);
+
+// Statistics of one stage over the interval between two snapshots
+// (prev NULL = since start)
+void perf_trace_stats(const perf_snapshot_t *now, const perf_snapshot_t *prev,
+                      perf_stage_t stage, perf_stage_stats_t *stats);
+
+// Table with spans/s, p50, p99 and max per stage, one line per stage
+// (seconds 0 = no rate, e.g. for a cumulative snapshot)
+// Returns the length written (truncated to size)
+int perf_trace_format(const perf_snapshot_t *now, const perf_snapshot_t *prev,
+                      double seconds, char *buf, size_t size);
+
+#endif // PERF_TRACE_H
@@ -0,0 +1,674 @@
+#define _DEFAULT_SOURCE
+#include "radio_pipeline.h"
+#include "fft_processor.h"
+#include "iq_ring.h"
+#include "signal_detector.h"
+#include "noise_floor.h"
+#include "perf_trace.h"
+#include "mono_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// Chunks buffered between source and DSP thread (~250 ms at 192 kS/s)
+#define PIPELINE_RING_SLOTS 32
+
+// Frequency/mode poll of radios without CAT, on the USB thread
+#define PIPELINE_TUNING_POLL_NS (250 * 1000000ULL)
+
+// How long the DSP thread waits for data before re-checking for shutdown
+#define DSP_WAIT_MS 100
+
+struct radio_pipeline {
+    // Source: USB radio, file playback, synthetic test signal or UDP stream
+    usb_device_t *usb;
+    char serial[USB_SERIAL_LEN];
+    iq_playback_t *playback;
+    synthetic_source_t *synthetic;
+    udp_iq_receiver_t *udp;
+    int udp_sample_rate;
+
+    // Optional CAT port tied to this radio
+    cat_control_t *cat;
+    char cat_device[64];
+
+    // DSP
+    fft_processor_t *fft;
+    iq_ring_t *ring;
+    signal_detector_t *detector;  // NULL unless enabled
+    spectrum_shm_t *shm;          // NULL unless enabled (not owned)
+    audio_output_t *audio;        // NULL unless enabled (not owned)
+    occupancy_t *occupancy;       // NULL unless enabled (not owned)
+    channelizer_t *channelizer;   // NULL unless enabled
+    band_sweep_t *sweep;          // NULL unless enabled (not owned)
+    float work_db[FFT_SIZE];      // DSP thread only
+
+    // Threads
+    rt_thread_config_t usb_config;
+    rt_thread_config_t dsp_config;
+    pthread_t source_thread;
+    pthread_t dsp_thread;
+    int source_started;
+    int dsp_started;
+    atomic_int running;
+
+    // Connection state
+    atomic_int connected;
+    atomic_int connect_count;
+    atomic_long radio_freq_hz;
+
+    // Tuning: polled from the radio by the USB thread (no CAT), otherwise
+    // published by the GTK thread; read by the UI and monitoring
+    atomic_long tuned_freq_hz;
+    atomic_int tuned_mode;
+    uint64_t tuning_poll_ns;     // USB thread only: time of the last poll
+
+    // Zoom request from the GTK thread, applied on the DSP thread
+    atomic_int zoom_request;
+    atomic_int pan_request;
+    atomic_int zoom_generation;  // Bumped on every request
+    int applied_generation;      // DSP thread only
+
+    // Latest spectrum hand-off to the GTK thread
+    pthread_mutex_t spectrum_mutex;
+    float spectrum_db[FFT_SIZE];
+    uint64_t spectrum_timestamp_ns;  // Capture time of the newest samples
+    int spectrum_generation;  // Zoom generation the spectrum was computed with
+    atomic_int spectrum_ready;
+    atomic_long spectrum_count;  // Spectra computed since start
+    detected_signal_t signals[SIGNAL_DETECTOR_MAX_SIGNALS];
+    int signal_count;
+    spectrum_levels_t levels;
+    bool have_levels;
+};
+
+static radio_pipeline_t *pipeline_alloc(void) {
+    radio_pipeline_t *pipe = calloc(1, sizeof(radio_pipeline_t));
+    if (!pipe) return NULL;
+
+    pthread_mutex_init(&pipe->spectrum_mutex, NULL);
+    atomic_store(&pipe->radio_freq_hz, -1);
+    atomic_store(&pipe->tuned_freq_hz, -1);
+    atomic_store(&pipe->tuned_mode, ELAD_MODE_UNKNOWN);
+    atomic_store(&pipe->zoom_request, 1);
+
+    rt_thread_config_t default_config = RT_THREAD_CONFIG_DEFAULT;
+    pipe->usb_config = default_config;
+    pipe->dsp_config = default_config;
+
+    pipe->fft = fft_processor_new(FFT_SIZE);
+    pipe->ring = iq_ring_new(PIPELINE_RING_SLOTS, USB_BUFFER_SIZE);
+    if (!pipe->fft || !pipe->ring) {
+        fprintf(stderr, "Pipeline: Failed to initialize FFT or sample ring\n");
+        radio_pipeline_free(pipe);
+        return NULL;
+    }
+    return pipe;
+}
+
+radio_pipeline_t *radio_pipeline_new_usb(libusb_context *ctx, const char *serial) {
+    radio_pipeline_t *pipe = pipeline_alloc();
+    if (!pipe) return NULL;
+
+    pipe->usb = ctx ? usb_device_new_with_context(ctx) : usb_device_new();
+    if (!pipe->usb) {
+        fprintf(stderr, "Failed to initialize USB\n");
+        radio_pipeline_free(pipe);
+        return NULL;
+    }
+    if (serial) {
+        snprintf(pipe->serial, sizeof(pipe->serial), "%s", serial);
+    }
+    return pipe;
+}
+
+radio_pipeline_t *radio_pipeline_new_playback(iq_playback_t *playback) {
+    if (!playback) return NULL;
+
+    radio_pipeline_t *pipe = pipeline_alloc();
+    if (!pipe) {
+        iq_playback_free(playback);
+        return NULL;
+    }
+    pipe->playback = playback;
+    return pipe;
+}
+
+radio_pipeline_t *radio_pipeline_new_synthetic(synthetic_source_t *synthetic) {
+    if (!synthetic) return NULL;
+
+    radio_pipeline_t *pipe = pipeline_alloc();
+    if (!pipe) {
+        synthetic_source_free(synthetic);
+        return NULL;
+    }
+    pipe->synthetic = synthetic;
+    return pipe;
+}
+
+radio_pipeline_t *radio_pipeline_new_udp(udp_iq_receiver_t *udp, int sample_rate) {
+    if (!udp) return NULL;
+
+    radio_pipeline_t *pipe = pipeline_alloc();
+    if (!pipe) {
+        udp_iq_receiver_free(udp);
+        return NULL;
+    }
+    pipe->udp = udp;
+    pipe->udp_sample_rate = sample_rate > 0 ? sample_rate : DEFAULT_SAMPLE_RATE;
+    return pipe;
+}
+
+void radio_pipeline_free(radio_pipeline_t *pipe) {
+    if (!pipe) return;
+
+    radio_pipeline_stop(pipe);
+
+    usb_device_free(pipe->usb);
+    iq_playback_free(pipe->playback);
+    synthetic_source_free(pipe->synthetic);
+    udp_iq_receiver_free(pipe->udp);
+    fft_processor_free(pipe->fft);
+    signal_detector_free(pipe->detector);
+    channelizer_free(pipe->channelizer);
+    iq_ring_free(pipe->ring);
+    pthread_mutex_destroy(&pipe->spectrum_mutex);
+    free(pipe);
+}
+
+void radio_pipeline_set_cat(radio_pipeline_t *pipe, cat_control_t *cat, const char *device) {
+    if (!pipe) return;
+    pipe->cat = cat;
+    snprintf(pipe->cat_device, sizeof(pipe->cat_device), "%s", device ? device : "");
+}
+
+void radio_pipeline_set_thread_config(radio_pipeline_t *pipe,
+                                      const rt_thread_config_t *usb_config,
+                                      const rt_thread_config_t *dsp_config) {
+    if (!pipe) return;
+    if (usb_config) pipe->usb_config = *usb_config;
+    if (dsp_config) pipe->dsp_config = *dsp_config;
+}
+
+int radio_pipeline_enable_detector(radio_pipeline_t *pipe, const signal_detector_config_t *config) {
+    if (!pipe) return -1;
+    if (pipe->detector) return 0;
+    pipe->detector = signal_detector_new(FFT_SIZE, config);
+    return pipe->detector ? 0 : -1;
+}
+
+int radio_pipeline_enable_channelizer(radio_pipeline_t *pipe, int channels) {
+    if (!pipe) return -1;
+    if (pipe->channelizer) return 0;
+    pipe->channelizer = channelizer_new(radio_pipeline_get_sample_rate(pipe), channels);
+    return pipe->channelizer ? 0 : -1;
+}
+
+channelizer_t *radio_pipeline_get_channelizer(radio_pipeline_t *pipe) {
+    return pipe ? pipe->channelizer : NULL;
+}
+
+void radio_pipeline_set_shm(radio_pipeline_t *pipe, spectrum_shm_t *shm) {
+    if (!pipe) return;
+    pipe->shm = shm;
+}
+
+void radio_pipeline_set_sweep(radio_pipeline_t *pipe, band_sweep_t *sweep) {
+    if (!pipe) return;
+    pipe->sweep = sweep;
+}
+
+void radio_pipeline_set_audio(radio_pipeline_t *pipe, audio_output_t *audio) {
+    if (!pipe) return;
+    pipe->audio = audio;
+}
+
+void radio_pipeline_set_occupancy(radio_pipeline_t *pipe, occupancy_t *occupancy) {
+    if (!pipe) return;
+    pipe->occupancy = occupancy;
+}
+
+// Write the spectrum just published to the shared-memory ring (DSP thread)
+static void write_shm(radio_pipeline_t *pipe, uint64_t timestamp_ns) {
+    int sample_rate = radio_pipeline_get_sample_rate(pipe);
+    int zoom = atomic_load(&pipe->zoom_request);
+    int pan_offset = zoom > 1 ? atomic_load(&pipe->pan_request) : 0;
+    if (zoom < 1) zoom = 1;
+    long freq = atomic_load(&pipe->tuned_freq_hz);
+
+    spectrum_shm_frame_t meta = {
+        .timestamp_ns = timestamp_ns,
+        .center_hz = freq > 0 ? freq + (int64_t)pan_offset * sample_rate / FFT_SIZE : 0,
+        .span_hz = (uint32_t)(sample_rate / zoom),
+    };
+    if (pipe->sweep) {
+        band_sweep_get_span(pipe->sweep, &meta.center_hz, &meta.span_hz);
+    }
+    spectrum_shm_write(pipe->shm, pipe->work_db, &meta);
+}
+
+// Add the spectrum just published to the occupancy store (DSP thread);
+// zoomed spectra are left out, their bins would not line up
+static void write_occupancy(radio_pipeline_t *pipe, float noise_db, uint64_t timestamp_ns) {
+    if (atomic_load(&pipe->zoom_request) > 1) return;
+    long freq = atomic_load(&pipe->tuned_freq_hz);
+    occupancy_add(pipe->occupancy, pipe->work_db, noise_db, freq > 0 ? freq : 0,
+                  (uint32_t)radio_pipeline_get_sample_rate(pipe), timestamp_ns);
+}
+
+int radio_pipeline_set_window(radio_pipeline_t *pipe, fft_window_t type) {
+    if (!pipe) return -1;
+    return fft_processor_set_window(pipe->fft, type);
+}
+
+// Thread name like "usb-1234ABCD" (serial suffix identifies the radio)
+static void thread_name(radio_pipeline_t *pipe, const char *prefix, char *name, size_t size) {
+    size_t len = strlen(pipe->serial);
+    const char *suffix = len > 8 ? pipe->serial + len - 8 : pipe->serial;
+    snprintf(name, size, "%s%s%s", prefix, suffix[0] ? "-" : "", suffix);
+}
+
+// USB data callback - called from the libusb event thread (and the
+// synthetic source and UDP receive threads, which are paced like the radio)
+// Only copies the transfer into the ring; FFT work happens on the DSP thread
+static void usb_data_callback(const uint8_t *data, int length, uint64_t timestamp_ns,
+                              void *user_data) {
+    radio_pipeline_t *pipe = (radio_pipeline_t *)user_data;
+    iq_ring_push(pipe->ring, data, length, timestamp_ns, false, 0);
+}
+
+// Playback callback - waits for ring space instead of dropping, so
+// as-fast-as-possible playback is paced by the DSP thread
+static void playback_data_callback(const uint8_t *data, int length, uint64_t timestamp_ns,
+                                   void *user_data) {
+    radio_pipeline_t *pipe = (radio_pipeline_t *)user_data;
+    iq_ring_push(pipe->ring, data, length, timestamp_ns, true, DSP_WAIT_MS);
+}
+
+// Read frequency and mode from a radio without CAT every
+// PIPELINE_TUNING_POLL_NS (USB thread) and publish them for the UI
+static void poll_tuning(radio_pipeline_t *pipe) {
+    uint64_t now_ns = monotonic_ns();
+    if (pipe->tuning_poll_ns && now_ns - pipe->tuning_poll_ns < PIPELINE_TUNING_POLL_NS) return;
+    pipe->tuning_poll_ns = now_ns;
+
+    long freq;
+    elad_mode_t mode;
+    if (usb_device_get_freq_mode(pipe->usb, &freq, &mode) != 0 || freq <= 0) return;
+    atomic_store(&pipe->tuned_freq_hz, freq);
+    atomic_store(&pipe->tuned_mode, mode);
+}
+
+// USB thread function
+static void *usb_thread_func(void *user_data) {
+    radio_pipeline_t *pipe = (radio_pipeline_t *)user_data;
+    const char *serial = pipe->serial[0] ? pipe->serial : NULL;
+
+    fprintf(stderr, "USB thread started%s%s\n", serial ? " for " : "", serial ? serial : "");
+
+    char name[16];
+    thread_name(pipe, "usb", name, sizeof(name));
+    rt_sched_apply(name, &pipe->usb_config);
+
+    while (atomic_load(&pipe->running)) {
+        // Check for disconnection (detected via transfer errors)
+        if (usb_device_is_open(pipe->usb) && usb_device_check_disconnected(pipe->usb)) {
+            fprintf(stderr, "USB device disconnected, closing...\n");
+            usb_device_close(pipe->usb);
+            atomic_store(&pipe->connected, 0);
+            // Also close CAT - serial port will be invalid
+            cat_control_close(pipe->cat);
+            usleep(500000);  // Wait 500ms before attempting reconnect
+            continue;
+        }
+
+        if (!usb_device_is_open(pipe->usb)) {
+            // Try to open device
+            if (usb_device_open_serial(pipe->usb, serial) == 0) {
+                // Give device time to fully initialize after power-on
+                // The FPGA and USB controller need time to stabilize
+                fprintf(stderr, "Waiting for device to stabilize (3s)...\n");
+                usleep(3000000);  // 3 seconds
+
+                // Try to reopen CAT serial port (it may have been recreated)
+                if (pipe->cat && pipe->cat_device[0] && !cat_control_is_open(pipe->cat)) {
+                    cat_control_open(pipe->cat, pipe->cat_device);
+                }
+
+                // Read current frequency from radio (don't change it)
+                long freq = usb_device_get_frequency(pipe->usb);
+                if (freq > 0 && freq < 100000000) {  // Sanity check: < 100 MHz
+                    atomic_store(&pipe->radio_freq_hz, freq);
+                    fprintf(stderr, "Radio frequency: %ld Hz\n", freq);
+                } else {
+                    fprintf(stderr, "Radio frequency invalid: %ld Hz (using previous)\n", freq);
+                }
+
+                // Start streaming
+                if (usb_device_start_streaming(pipe->usb, usb_data_callback, pipe) != 0) {
+                    fprintf(stderr, "Failed to start streaming\n");
+                    usb_device_close(pipe->usb);
+                } else {
+                    atomic_store(&pipe->connected, 1);
+                    atomic_fetch_add(&pipe->connect_count, 1);
+                    pipe->tuning_poll_ns = 0;
+                    fprintf(stderr, "USB device connected\n");
+                    // The radio is back on its own frequency
+                    band_sweep_restart(pipe->sweep);
+                }
+            } else {
+                // Device not found, wait and retry
+                usleep(1000000);  // 1 second
+                continue;
+            }
+        }
+
+        // Sweep retunes and tuning polls between event rounds, on this
+        // thread so the device cannot be closed under them
+        long sweep_freq;
+        if (pipe->sweep && band_sweep_get_request(pipe->sweep, &sweep_freq)) {
+            band_sweep_tuned(pipe->sweep, usb_device_set_frequency(pipe->usb, sweep_freq) == 0);
+        } else if (!pipe->sweep && !cat_control_is_open(pipe->cat)) {
+            poll_tuning(pipe);
+        }
+
+        // Handle USB events (with timeout to allow disconnect check)
+        // With a shared context libusb lets one thread at a time run the
+        // event loop and completions for every radio are dispatched there;
+        // main.c gives each radio its own context so they stay apart
+        int res = usb_device_handle_events(pipe->usb);
+        if (res < 0) {
+            fprintf(stderr, "USB error: %d\n", res);
+            usb_device_close(pipe->usb);
+            atomic_store(&pipe->connected, 0);
+        }
+    }
+
+    // Cleanup
+    usb_device_stop_streaming(pipe->usb);
+    usb_device_close(pipe->usb);
+    atomic_store(&pipe->connected, 0);
+
+    fprintf(stderr, "USB thread stopped\n");
+    return NULL;
+}
+
+// Hand the spectrum in work_db to the GTK thread and the optional
+// consumers (DSP thread); timestamp_ns is the capture time of its newest
+// samples
+static void publish_spectrum(radio_pipeline_t *pipe, uint64_t timestamp_ns) {
+    // Detection outside the lock, then copy both to the shared buffers
+    if (pipe->detector) {
+        signal_detector_process(pipe->detector, pipe->work_db);
+    }
+    spectrum_levels_t levels;
+    noise_floor_measure(pipe->work_db, FFT_SIZE, &levels);
+
+    PERF_SPAN_BEGIN(publish_start);
+    pthread_mutex_lock(&pipe->spectrum_mutex);
+    memcpy(pipe->spectrum_db, pipe->work_db, sizeof(pipe->spectrum_db));
+    pipe->spectrum_timestamp_ns = timestamp_ns;
+    if (pipe->detector) {
+        pipe->signal_count = signal_detector_get_signals(pipe->detector, pipe->signals,
+                                                         SIGNAL_DETECTOR_MAX_SIGNALS);
+    }
+    pipe->levels = levels;
+    pipe->have_levels = true;
+    pipe->spectrum_generation = pipe->applied_generation;
+    atomic_store(&pipe->spectrum_ready, 1);
+    pthread_mutex_unlock(&pipe->spectrum_mutex);
+    atomic_fetch_add_explicit(&pipe->spectrum_count, 1, memory_order_relaxed);
+    PERF_SPAN_END(publish_start, PERF_STAGE_PUBLISH);
+
+    if (pipe->shm) {
+        write_shm(pipe, timestamp_ns);
+    }
+    if (pipe->occupancy && !pipe->sweep) {
+        write_occupancy(pipe, levels.noise_db, timestamp_ns);
+    }
+}
+
+// DSP thread function - FFT and spectrum hand-off
+static void *dsp_thread_func(void *user_data) {
+    radio_pipeline_t *pipe = (radio_pipeline_t *)user_data;
+
+    fprintf(stderr, "DSP thread started\n");
+
+    char name[16];
+    thread_name(pipe, "dsp", name, sizeof(name));
+    rt_sched_apply(name, &pipe->dsp_config);
+
+    while (atomic_load(&pipe->running)) {
+        // Pick up zoom/pan changes between chunks
+        int generation = atomic_load(&pipe->zoom_generation);
+        if (generation != pipe->applied_generation) {
+            pipe->applied_generation = generation;
+            fft_processor_set_zoom(pipe->fft, atomic_load(&pipe->zoom_request),
+                                   atomic_load(&pipe->pan_request));
+            signal_detector_reset(pipe->detector);
+        }
+
+        int length = 0;
+        uint64_t timestamp_ns = 0;
+        const uint8_t *data = iq_ring_read_begin(pipe->ring, &length, &timestamp_ns, DSP_WAIT_MS);
+        if (!data) continue;
+
+        // Sweeping: the IQ hops, only the stitched spectrum is of use
+        if (pipe->sweep) {
+            if (band_sweep_process(pipe->sweep, data, length, timestamp_ns)) {
+                band_sweep_get_spectrum(pipe->sweep, pipe->work_db);
+                publish_spectrum(pipe, timestamp_ns);
+            }
+            iq_ring_read_commit(pipe->ring);
+            continue;
+        }
+
+        // Copied into the audio thread's ring, never waits for it
+        if (pipe->audio) {
+            audio_output_push(pipe->audio, data, length);
+        }
+        if (pipe->channelizer) {
+            channelizer_process_s32(pipe->channelizer, data, length / 8);
+        }
+
+        if (fft_processor_process(pipe->fft, data, length)) {
+            // The chunk that completed the frame holds its newest samples
+            fft_processor_get_spectrum_db(pipe->fft, pipe->work_db);
+            publish_spectrum(pipe, timestamp_ns);
+        }
+
+        iq_ring_read_commit(pipe->ring);
+    }
+
+    fprintf(stderr, "DSP thread stopped\n");
+    return NULL;
+}
+
+int radio_pipeline_start(radio_pipeline_t *pipe) {
+    if (!pipe) return -1;
+    if (atomic_load(&pipe->running)) return 0;
+
+    atomic_store(&pipe->running, 1);
+    atomic_store(&pipe->spectrum_ready, 0);
+
+    if (pthread_create(&pipe->dsp_thread, NULL, dsp_thread_func, pipe) != 0) {
+        fprintf(stderr, "Failed to create DSP thread\n");
+        atomic_store(&pipe->running, 0);
+        return -1;
+    }
+    pipe->dsp_started = 1;
+
+    if (pipe->playback) {
+        if (iq_playback_start(pipe->playback, playback_data_callback, pipe) != 0) {
+            radio_pipeline_stop(pipe);
+            return -1;
+        }
+        atomic_store(&pipe->connected, 1);
+        atomic_fetch_add(&pipe->connect_count, 1);
+    } else if (pipe->synthetic) {
+        if (synthetic_source_start(pipe->synthetic, usb_data_callback, pipe) != 0) {
+            radio_pipeline_stop(pipe);
+            return -1;
+        }
+        atomic_store(&pipe->connected, 1);
+        atomic_fetch_add(&pipe->connect_count, 1);
+    } else if (pipe->udp) {
+        if (udp_iq_receiver_start(pipe->udp, usb_data_callback, pipe) != 0) {
+            radio_pipeline_stop(pipe);
+            return -1;
+        }
+        atomic_store(&pipe->connected, 1);
+        atomic_fetch_add(&pipe->connect_count, 1);
+    } else {
+        if (pthread_create(&pipe->source_thread, NULL, usb_thread_func, pipe) != 0) {
+            fprintf(stderr, "Failed to create USB thread\n");
+            radio_pipeline_stop(pipe);
+            return -1;
+        }
+        pipe->source_started = 1;
+    }
+
+    return 0;
+}
+
+void radio_pipeline_stop(radio_pipeline_t *pipe) {
+    if (!pipe) return;
+
+    atomic_store(&pipe->running, 0);
+
+    // Source first so nothing is left waiting on a full ring
+    if (pipe->playback) {
+        iq_playback_stop(pipe->playback);
+        atomic_store(&pipe->connected, 0);
+    }
+    if (pipe->synthetic) {
+        synthetic_source_stop(pipe->synthetic);
+        atomic_store(&pipe->connected, 0);
+    }
+    if (pipe->udp) {
+        udp_iq_receiver_stop(pipe->udp);
+        atomic_store(&pipe->connected, 0);
+    }
+    if (pipe->source_started) {
+        pthread_join(pipe->source_thread, NULL);
+        pipe->source_started = 0;
+    }
+    if (pipe->dsp_started) {
+        pthread_join(pipe->dsp_thread, NULL);
+        pipe->dsp_started = 0;
+    }
+    iq_ring_flush(pipe->ring);
+}
+
+void radio_pipeline_set_zoom(radio_pipeline_t *pipe, int zoom, int pan_offset) {
+    if (!pipe) return;
+    atomic_store(&pipe->zoom_request, zoom);
+    atomic_store(&pipe->pan_request, pan_offset);
+    atomic_fetch_add(&pipe->zoom_generation, 1);
+}
+
+bool radio_pipeline_get_spectrum(radio_pipeline_t *pipe, float *output, int size,
+                                 uint64_t *timestamp_ns) {
+    if (!pipe || !output) return false;
+    if (!atomic_exchange(&pipe->spectrum_ready, 0)) return false;
+
+    if (size > FFT_SIZE) size = FFT_SIZE;
+    PERF_SPAN_BEGIN(handoff_start);
+    pthread_mutex_lock(&pipe->spectrum_mutex);
+    bool current = pipe->spectrum_generation == atomic_load(&pipe->zoom_generation);
+    if (current) {
+        memcpy(output, pipe->spectrum_db, sizeof(float) * size);
+        if (timestamp_ns) *timestamp_ns = pipe->spectrum_timestamp_ns;
+    }
+    pthread_mutex_unlock(&pipe->spectrum_mutex);
+    PERF_SPAN_END(handoff_start, PERF_STAGE_HANDOFF);
+    return current;
+}
+
+int radio_pipeline_get_signals(radio_pipeline_t *pipe, detected_signal_t *out, int max) {
+    if (!pipe || !out || !pipe->detector) return 0;
+
+    pthread_mutex_lock(&pipe->spectrum_mutex);
+    int count = 0;
+    if (pipe->spectrum_generation == atomic_load(&pipe->zoom_generation)) {
+        count = pipe->signal_count < max ? pipe->signal_count : max;
+        memcpy(out, pipe->signals, sizeof(detected_signal_t) * count);
+    }
+    pthread_mutex_unlock(&pipe->spectrum_mutex);
+    return count;
+}
+
+bool radio_pipeline_get_levels(radio_pipeline_t *pipe, spectrum_levels_t *levels) {
+    if (!pipe || !levels) return false;
+
+    pthread_mutex_lock(&pipe->spectrum_mutex);
+    bool valid = pipe->have_levels;
+    if (valid) {
+        *levels = pipe->levels;
+    }
+    pthread_mutex_unlock(&pipe->spectrum_mutex);
+    return valid;
+}
+
+bool radio_pipeline_is_connected(radio_pipeline_t *pipe) {
+    if (pipe && pipe->udp && !udp_iq_receiver_is_receiving(pipe->udp)) return false;
+    return pipe && atomic_load(&pipe->connected) != 0;
+}
+
+int radio_pipeline_get_connect_count(radio_pipeline_t *pipe) {
+    return pipe ? atomic_load(&pipe->connect_count) : 0;
+}
+
+long radio_pipeline_get_radio_freq(radio_pipeline_t *pipe) {
+    return pipe ? atomic_load(&pipe->radio_freq_hz) : -1;
+}
+
+long radio_pipeline_get_dropped(radio_pipeline_t *pipe) {
+    return pipe ? iq_ring_get_dropped(pipe->ring) : 0;
+}
+
+usb_device_t *radio_pipeline_get_usb(radio_pipeline_t *pipe) {
+    return pipe ? pipe->usb : NULL;
+}
+
+synthetic_source_t *radio_pipeline_get_synthetic(radio_pipeline_t *pipe) {
+    return pipe ? pipe->synthetic : NULL;
+}
+
+const char *radio_pipeline_get_serial(radio_pipeline_t *pipe) {
+    if (!pipe) return "";
+    if (pipe->serial[0]) return pipe->serial;
+    if (pipe->usb && usb_device_is_open(pipe->usb)) {
+        const char *serial = usb_device_get_serial(pipe->usb);
+        if (serial) return serial;
+    }
+    return "";
+}
+
+int radio_pipeline_get_sample_rate(radio_pipeline_t *pipe) {
+    if (pipe && pipe->playback) return iq_playback_get_sample_rate(pipe->playback);
+    if (pipe && pipe->synthetic) return synthetic_source_get_sample_rate(pipe->synthetic);
+    if (pipe && pipe->udp) return pipe->udp_sample_rate;
+    return DEFAULT_SAMPLE_RATE;
+}
+
+void radio_pipeline_set_tuning(radio_pipeline_t *pipe, long freq_hz, elad_mode_t mode) {
+    if (!pipe) return;
+    atomic_store(&pipe->tuned_freq_hz, freq_hz);
+    atomic_store(&pipe->tuned_mode, mode);
+}
+
+long radio_pipeline_get_tuned_freq(radio_pipeline_t *pipe) {
+    return pipe ? atomic_load(&pipe->tuned_freq_hz) : -1;
+}
+
+elad_mode_t radio_pipeline_get_tuned_mode(radio_pipeline_t *pipe) {
+    return pipe ? (elad_mode_t)atomic_load(&pipe->tuned_mode) : ELAD_MODE_UNKNOWN;
+}
+
+long radio_pipeline_get_spectrum_count(radio_pipeline_t *pipe) {
+    return pipe ? atomic_load_explicit(&pipe->spectrum_count, memory_order_relaxed) : 0;
+}
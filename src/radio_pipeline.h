@@ -0,0 +1,166 @@
+#ifndef RADIO_PIPELINE_H
+#define RADIO_PIPELINE_H
+
+#include <stdbool.h>
+#include "app_state.h"
+#include "usb_device.h"
+#include "cat_control.h"
+#include "iq_playback.h"
+#include "synthetic_source.h"
+#include "udp_iq.h"
+#include "rt_sched.h"
+#include "fft_processor.h"
+#include "signal_detector.h"
+#include "noise_floor.h"
+#include "spectrum_shm.h"
+#include "occupancy.h"
+#include "audio_output.h"
+#include "channelizer.h"
+#include "band_sweep.h"
+
+// One receive pipeline per radio:
+//   source thread (USB events, file playback or UDP) -> iq_ring -> DSP thread
+//   (fft_processor) -> latest spectrum, picked up by the GTK thread.
+// Each pipeline owns its threads, so several radios run side by side.
+
+typedef struct radio_pipeline radio_pipeline_t;
+
+// Create a pipeline for an FDM-DUO on a shared libusb context, or on its
+// own context if ctx is NULL (then only this pipeline's USB thread runs its
+// events, so transfers complete on that thread and its CPU and priority)
+// serial selects the radio (NULL = first radio found)
+radio_pipeline_t *radio_pipeline_new_usb(libusb_context *ctx, const char *serial);
+
+// Create a pipeline fed from a recorded IQ file (takes ownership of playback)
+radio_pipeline_t *radio_pipeline_new_playback(iq_playback_t *playback);
+
+// Create a pipeline fed from a synthetic test source (takes ownership)
+radio_pipeline_t *radio_pipeline_new_synthetic(synthetic_source_t *synthetic);
+
+// Create a pipeline fed from a UDP IQ stream in the USB format at
+// sample_rate (takes ownership of the receiver)
+radio_pipeline_t *radio_pipeline_new_udp(udp_iq_receiver_t *udp, int sample_rate);
+
+// Free pipeline (stops threads first)
+void radio_pipeline_free(radio_pipeline_t *pipe);
+
+// Let the pipeline close/reopen a CAT port as the radio disconnects/reconnects
+void radio_pipeline_set_cat(radio_pipeline_t *pipe, cat_control_t *cat, const char *device);
+
+// Set CPU affinity and scheduling for the USB and DSP threads
+// (NULL keeps the default); must be called before radio_pipeline_start
+void radio_pipeline_set_thread_config(radio_pipeline_t *pipe,
+                                      const rt_thread_config_t *usb_config,
+                                      const rt_thread_config_t *dsp_config);
+
+// Run the carrier detector on every spectrum (NULL config = defaults)
+// Must be called before radio_pipeline_start
+// Returns 0 on success, -1 on error
+int radio_pipeline_enable_detector(radio_pipeline_t *pipe, const signal_detector_config_t *config);
+
+// Also write every spectrum into a shared-memory ring for local consumers
+// (not owned; must outlive the pipeline's threads)
+// Must be called before radio_pipeline_start
+void radio_pipeline_set_shm(radio_pipeline_t *pipe, spectrum_shm_t *shm);
+
+// Also add every full-span spectrum to a long-term occupancy store, with
+// its noise floor and the tuned frequency (not owned; must outlive the
+// pipeline's threads)
+// Must be called before radio_pipeline_start
+void radio_pipeline_set_occupancy(radio_pipeline_t *pipe, occupancy_t *occupancy);
+
+// Sweep the radio across a wide range instead of showing the tuned span:
+// the USB thread retunes on the sweep's requests and the DSP thread feeds
+// it the IQ and publishes the stitched spectrum after every step, in
+// place of its own (not owned; must outlive the pipeline's threads). The
+// demodulator, channelizer and occupancy store get nothing while sweeping
+// Must be called before radio_pipeline_start
+void radio_pipeline_set_sweep(radio_pipeline_t *pipe, band_sweep_t *sweep);
+
+// Also hand every IQ chunk to a demodulator (not owned; must outlive the
+// pipeline's threads)
+// Must be called before radio_pipeline_start
+void radio_pipeline_set_audio(radio_pipeline_t *pipe, audio_output_t *audio);
+
+// Split the IQ stream into channels uniform sub-channels on the DSP thread
+// (see channelizer.h); consumers subscribe through
+// radio_pipeline_get_channelizer()
+// Must be called before radio_pipeline_start
+// Returns 0 on success, -1 on error
+int radio_pipeline_enable_channelizer(radio_pipeline_t *pipe, int channels);
+
+// Channelizer of this pipeline, NULL unless enabled
+channelizer_t *radio_pipeline_get_channelizer(radio_pipeline_t *pipe);
+
+// Select the spectrum estimator (Blackman-Harris window or WOLA filterbank)
+// Must be called before radio_pipeline_start
+// Returns 0 on success, -1 on unknown type
+int radio_pipeline_set_window(radio_pipeline_t *pipe, fft_window_t type);
+
+// Start source and DSP threads
+// Returns 0 on success, -1 on error
+int radio_pipeline_start(radio_pipeline_t *pipe);
+
+// Stop threads (blocks until they exit)
+void radio_pipeline_stop(radio_pipeline_t *pipe);
+
+// Request zoom FFT around pan_offset (full-resolution bins from centre)
+// Applied by the DSP thread; spectra computed with the previous setting
+// are discarded
+void radio_pipeline_set_zoom(radio_pipeline_t *pipe, int zoom, int pan_offset);
+
+// Copy the latest spectrum if a new one is ready
+// timestamp_ns (may be NULL) receives the capture time of the newest
+// samples in it (CLOCK_MONOTONIC, from the USB transfer completion)
+// Returns true if output was updated
+bool radio_pipeline_get_spectrum(radio_pipeline_t *pipe, float *output, int size,
+                                 uint64_t *timestamp_ns);
+
+// Copy up to max signals found in the latest spectrum (ordered by
+// frequency, positions in spectrum bins as passed to the widgets)
+// Returns the number copied (0 if the detector is not enabled)
+int radio_pipeline_get_signals(radio_pipeline_t *pipe, detected_signal_t *out, int max);
+
+// Noise floor and peak level of the latest spectrum
+// Returns false until the first spectrum is ready
+bool radio_pipeline_get_levels(radio_pipeline_t *pipe, spectrum_levels_t *levels);
+
+// Check if the source is delivering data (UDP: a datagram in the last second)
+bool radio_pipeline_is_connected(radio_pipeline_t *pipe);
+
+// Number of successful (re)connections so far
+int radio_pipeline_get_connect_count(radio_pipeline_t *pipe);
+
+// Frequency read from the radio on the last connect (Hz, or -1 if unknown)
+long radio_pipeline_get_radio_freq(radio_pipeline_t *pipe);
+
+// Number of IQ chunks dropped because the DSP thread fell behind
+long radio_pipeline_get_dropped(radio_pipeline_t *pipe);
+
+// Number of spectra computed since start
+long radio_pipeline_get_spectrum_count(radio_pipeline_t *pipe);
+
+// Publish the frequency and mode shown for this radio (GTK thread), so
+// monitoring threads can read them without touching the display state
+// USB radios without CAT need not: their USB thread polls the radio every
+// 250 ms and publishes what it reads, so no other thread sends control
+// transfers to a device it may be closing
+void radio_pipeline_set_tuning(radio_pipeline_t *pipe, long freq_hz, elad_mode_t mode);
+
+// Last published frequency (Hz, -1 if unknown) and mode
+long radio_pipeline_get_tuned_freq(radio_pipeline_t *pipe);
+elad_mode_t radio_pipeline_get_tuned_mode(radio_pipeline_t *pipe);
+
+// Get the USB device (NULL for playback pipelines)
+usb_device_t *radio_pipeline_get_usb(radio_pipeline_t *pipe);
+
+// Get the synthetic source (NULL unless created with radio_pipeline_new_synthetic)
+synthetic_source_t *radio_pipeline_get_synthetic(radio_pipeline_t *pipe);
+
+// Get the requested serial number (or the connected radio's), "" if none
+const char *radio_pipeline_get_serial(radio_pipeline_t *pipe);
+
+// Get the input sample rate in Hz
+int radio_pipeline_get_sample_rate(radio_pipeline_t *pipe);
+
+#endif // RADIO_PIPELINE_H
@@ -0,0 +1,125 @@
+#define _GNU_SOURCE  // pthread_setaffinity_np, pthread_setname_np, CPU_SET, SCHED_IDLE
+#include "rt_sched.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+
+int rt_sched_parse_policy(const char *name, rt_policy_t *policy) {
+    if (!name || !policy) return -1;
+
+    if (strcasecmp(name, "fifo") == 0) {
+        *policy = RT_POLICY_FIFO;
+    } else if (strcasecmp(name, "rr") == 0) {
+        *policy = RT_POLICY_RR;
+    } else if (strcasecmp(name, "none") == 0 || strcasecmp(name, "other") == 0) {
+        *policy = RT_POLICY_NONE;
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static const char *policy_name(rt_policy_t policy) {
+    switch (policy) {
+        case RT_POLICY_FIFO: return "SCHED_FIFO";
+        case RT_POLICY_RR:   return "SCHED_RR";
+        case RT_POLICY_IDLE: return "SCHED_IDLE";
+        default:             return "SCHED_OTHER";
+    }
+}
+
+// Explain the usual reason a scheduling request was refused
+static const char *sched_error_hint(int err) {
+    if (err == EPERM) {
+        return " (needs CAP_SYS_NICE or an rtprio limit, see /etc/security/limits.conf)";
+    }
+    return "";
+}
+
+static int apply_affinity(const char *thread_name, int cpu) {
+    long cpu_count = sysconf(_SC_NPROCESSORS_CONF);
+    if (cpu < 0 || (cpu_count > 0 && cpu >= cpu_count)) {
+        fprintf(stderr, "RT: %s: CPU %d does not exist (have %ld), not pinning\n",
+                thread_name, cpu, cpu_count);
+        return -1;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    int res = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (res != 0) {
+        fprintf(stderr, "RT: %s: Cannot pin to CPU %d: %s\n", thread_name, cpu, strerror(res));
+        return -1;
+    }
+
+    fprintf(stderr, "RT: %s pinned to CPU %d\n", thread_name, cpu);
+    return 0;
+}
+
+static int apply_policy(const char *thread_name, rt_policy_t policy, int priority) {
+    int sched_policy = (policy == RT_POLICY_FIFO) ? SCHED_FIFO :
+                       (policy == RT_POLICY_RR) ? SCHED_RR : SCHED_IDLE;
+    int min_prio = sched_get_priority_min(sched_policy);
+    int max_prio = sched_get_priority_max(sched_policy);
+    if (priority < min_prio) priority = min_prio;
+    if (priority > max_prio) priority = max_prio;
+
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = priority;
+
+    int res = pthread_setschedparam(pthread_self(), sched_policy, &param);
+    if (res != 0) {
+        fprintf(stderr, "RT: %s: %s priority %d refused: %s%s, using default scheduling\n",
+                thread_name, policy_name(policy), priority, strerror(res), sched_error_hint(res));
+        return -1;
+    }
+
+    fprintf(stderr, "RT: %s running %s priority %d\n", thread_name, policy_name(policy), priority);
+    return 0;
+}
+
+int rt_sched_apply(const char *thread_name, const rt_thread_config_t *config) {
+    if (!thread_name) thread_name = "thread";
+
+    // Thread names show up in top -H / ps -L (limited to 15 characters)
+    char short_name[16];
+    snprintf(short_name, sizeof(short_name), "%s", thread_name);
+    pthread_setname_np(pthread_self(), short_name);
+
+    if (!config) return 0;
+
+    int result = 0;
+    if (config->cpu >= 0 && apply_affinity(thread_name, config->cpu) != 0) {
+        result = -1;
+    }
+    if (config->policy != RT_POLICY_NONE &&
+        apply_policy(thread_name, config->policy, config->priority) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+int rt_sched_lock_memory(void) {
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        int err = errno;
+        struct rlimit limit;
+        if ((err == ENOMEM || err == EPERM) && getrlimit(RLIMIT_MEMLOCK, &limit) == 0 &&
+            limit.rlim_cur != RLIM_INFINITY) {
+            fprintf(stderr, "RT: mlockall failed: %s (memlock limit %lu kB, raise with ulimit -l)\n",
+                    strerror(err), (unsigned long)(limit.rlim_cur / 1024));
+        } else {
+            fprintf(stderr, "RT: mlockall failed: %s\n", strerror(err));
+        }
+        return -1;
+    }
+
+    fprintf(stderr, "RT: Memory locked\n");
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef RT_SCHED_H
+#define RT_SCHED_H
+
+// Real-time scheduling, CPU affinity and memory locking for the
+// time-critical threads (USB event loop, DSP)
+
+typedef enum {
+    RT_POLICY_NONE = 0,  // Keep default (SCHED_OTHER) scheduling
+    RT_POLICY_FIFO,      // SCHED_FIFO
+    RT_POLICY_RR,        // SCHED_RR
+    RT_POLICY_IDLE       // SCHED_IDLE, for background work (priority ignored)
+} rt_policy_t;
+
+typedef struct {
+    int cpu;             // CPU core to pin to (-1 = any)
+    rt_policy_t policy;
+    int priority;        // 1-99, used with RT_POLICY_FIFO/RR
+} rt_thread_config_t;
+
+// Default config: no pinning, default scheduling
+#define RT_THREAD_CONFIG_DEFAULT { .cpu = -1, .policy = RT_POLICY_NONE, .priority = 0 }
+
+// Parse "fifo", "rr" or "none"
+// Returns 0 on success, -1 if name is not a known policy
+int rt_sched_parse_policy(const char *name, rt_policy_t *policy);
+
+// Name, pin and schedule the calling thread
+// Failures are logged with the reason and leave the thread running with
+// whatever settings could be applied
+// Returns 0 if everything requested was applied, -1 otherwise
+int rt_sched_apply(const char *thread_name, const rt_thread_config_t *config);
+
+// Lock current and future memory to avoid page faults in RT threads
+// Returns 0 on success, -1 on failure (logged)
+int rt_sched_lock_memory(void);
+
+#endif // RT_SCHED_H
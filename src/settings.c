@@ -15,6 +15,7 @@
 #define DEFAULT_WATERFALL_RANGE 120.0
 #define DEFAULT_ZOOM_LEVEL 1
 #define DEFAULT_PAN_OFFSET 0
+#define DEFAULT_AUTO_RANGE 0
 
 void settings_init_defaults(app_settings_t *settings) {
     settings->spectrum_ref = DEFAULT_SPECTRUM_REF;
@@ -23,6 +24,7 @@ void settings_init_defaults(app_settings_t *settings) {
     settings->waterfall_range = DEFAULT_WATERFALL_RANGE;
     settings->zoom_level = DEFAULT_ZOOM_LEVEL;
     settings->pan_offset = DEFAULT_PAN_OFFSET;
+    settings->auto_range = DEFAULT_AUTO_RANGE;
 }
 
 // Get full path to config file
@@ -129,6 +131,8 @@ void settings_load(app_settings_t *settings) {
             }
         } else if (sscanf(line, "pan_offset=%d", &ival) == 1) {
             settings->pan_offset = ival;
+        } else if (sscanf(line, "auto_range=%d", &ival) == 1) {
+            settings->auto_range = ival ? 1 : 0;
         }
     }
 
@@ -161,6 +165,7 @@ void settings_save(const app_settings_t *settings) {
     fprintf(f, "waterfall_range=%.1f\n", settings->waterfall_range);
     fprintf(f, "zoom_level=%d\n", settings->zoom_level);
     fprintf(f, "pan_offset=%d\n", settings->pan_offset);
+    fprintf(f, "auto_range=%d\n", settings->auto_range);
 
     fclose(f);
 }
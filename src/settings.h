@@ -9,6 +9,7 @@ typedef struct {
     double waterfall_range;
     int zoom_level;
     int pan_offset;
+    int auto_range;  // Ref/range follow the noise floor and peaks
 } app_settings_t;
 
 // Load settings from config file (~/.config/elad-spectrum/settings.conf)
@@ -0,0 +1,305 @@
+#define _DEFAULT_SOURCE
+#include "signal_detector.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+// dB histogram for the sliding order statistic
+#define HIST_MIN_DB -200.0f
+#define HIST_STEP_DB 0.5f
+#define HIST_BUCKETS 512  // -200 .. +56 dB
+
+typedef struct {
+    detected_signal_t sig;
+    int hits;    // Consecutive frames detected
+    int missed;  // Frames since last detected
+} track_t;
+
+// One cluster of active bins in the current frame
+typedef struct {
+    float center_bin;
+    float bandwidth_bins;
+    float peak_db;
+    float snr_db;
+} cluster_t;
+
+struct signal_detector {
+    int size;
+    signal_detector_config_t config;
+
+    // Per-bin state
+    uint16_t *bucket;  // Histogram bucket of each bin (this frame)
+    float *noise_db;   // CFAR noise estimate
+    uint8_t *active;   // Hysteresis state, kept across frames
+
+    // Sliding histogram of the reference cells
+    uint16_t hist[HIST_BUCKETS];
+
+    cluster_t clusters[SIGNAL_DETECTOR_MAX_SIGNALS];
+    int cluster_count;
+
+    // Tracks, double-buffered for the frame-to-frame merge
+    track_t tracks_a[SIGNAL_DETECTOR_MAX_SIGNALS];
+    track_t tracks_b[SIGNAL_DETECTOR_MAX_SIGNALS];
+    track_t *tracks;
+    track_t *next_tracks;
+    int track_count;
+    uint32_t next_id;
+};
+
+signal_detector_t *signal_detector_new(int size, const signal_detector_config_t *config) {
+    if (size <= 0) return NULL;
+
+    signal_detector_t *det = calloc(1, sizeof(signal_detector_t));
+    if (!det) return NULL;
+
+    signal_detector_config_t defaults = SIGNAL_DETECTOR_CONFIG_DEFAULT;
+    det->config = config ? *config : defaults;
+    if (det->config.window_bins < 1) det->config.window_bins = 1;
+    if (det->config.guard_bins < 0) det->config.guard_bins = 0;
+    if (det->config.rank < 0.0f) det->config.rank = 0.0f;
+    if (det->config.rank > 1.0f) det->config.rank = 1.0f;
+    if (det->config.off_db > det->config.on_db) det->config.off_db = det->config.on_db;
+
+    det->size = size;
+    det->bucket = malloc(sizeof(uint16_t) * size);
+    det->noise_db = malloc(sizeof(float) * size);
+    det->active = calloc(size, sizeof(uint8_t));
+    if (!det->bucket || !det->noise_db || !det->active) {
+        fprintf(stderr, "Detector: failed to allocate buffers\n");
+        signal_detector_free(det);
+        return NULL;
+    }
+
+    det->tracks = det->tracks_a;
+    det->next_tracks = det->tracks_b;
+    det->next_id = 1;
+    return det;
+}
+
+void signal_detector_free(signal_detector_t *det) {
+    if (!det) return;
+    free(det->bucket);
+    free(det->noise_db);
+    free(det->active);
+    free(det);
+}
+
+void signal_detector_reset(signal_detector_t *det) {
+    if (!det) return;
+    memset(det->active, 0, det->size);
+    det->track_count = 0;
+    det->cluster_count = 0;
+}
+
+static inline int db_to_bucket(float db) {
+    int b = (int)((db - HIST_MIN_DB) / HIST_STEP_DB);
+    if (b < 0) return 0;
+    if (b >= HIST_BUCKETS) return HIST_BUCKETS - 1;
+    return b;
+}
+
+// OS-CFAR noise estimate for every bin
+// The reference cells of bin i are [i-G-W, i-G-1] and [i+G+1, i+G+W];
+// moving to i+1 swaps two cells in and two out of the histogram, and the
+// rank pointer (bucket p, `below` cells in lower buckets) moves by the
+// few buckets the rank shifted, so the whole pass is linear in bins
+static void estimate_noise(signal_detector_t *det, const float *spectrum_db) {
+    int n = det->size;
+    int g = det->config.guard_bins;
+    int w = det->config.window_bins;
+    uint16_t *hist = det->hist;
+
+    for (int i = 0; i < n; i++) {
+        det->bucket[i] = (uint16_t)db_to_bucket(spectrum_db[i]);
+    }
+    memset(hist, 0, sizeof(det->hist));
+
+    // Reference cells of bin 0 (right side only)
+    int count = 0;
+    for (int j = g + 1; j <= g + w && j < n; j++) {
+        hist[det->bucket[j]]++;
+        count++;
+    }
+
+    int p = 0;
+    int below = 0;
+    for (int i = 0; i < n; i++) {
+        if (count > 0) {
+            int k = (int)(det->config.rank * (count - 1));
+            while (p > 0 && below > k) {
+                p--;
+                below -= hist[p];
+            }
+            while (p < HIST_BUCKETS - 1 && below + hist[p] <= k) {
+                below += hist[p];
+                p++;
+            }
+            det->noise_db[i] = HIST_MIN_DB + (p + 0.5f) * HIST_STEP_DB;
+        } else {
+            det->noise_db[i] = INFINITY;
+        }
+
+        // Slide to bin i + 1
+        int cells[4] = { i - g - w, i + g + 1, i - g, i + g + w + 1 };  // Out, out, in, in
+        for (int c = 0; c < 4; c++) {
+            int j = cells[c];
+            if (j < 0 || j >= n) continue;
+            int b = det->bucket[j];
+            int delta = c < 2 ? -1 : 1;
+            hist[b] += delta;
+            count += delta;
+            if (b < p) below += delta;
+        }
+    }
+}
+
+// Threshold with hysteresis and merge active bins into clusters
+static void find_clusters(signal_detector_t *det, const float *spectrum_db) {
+    int n = det->size;
+    float on_db = det->config.on_db;
+    float off_db = det->config.off_db;
+
+    for (int i = 0; i < n; i++) {
+        float margin = spectrum_db[i] - det->noise_db[i];
+        det->active[i] = det->active[i] ? (margin > off_db) : (margin > on_db);
+    }
+
+    det->cluster_count = 0;
+    int i = 0;
+    while (i < n && det->cluster_count < SIGNAL_DETECTOR_MAX_SIGNALS) {
+        if (!det->active[i]) {
+            i++;
+            continue;
+        }
+
+        // Extend over active bins, bridging gaps up to merge_gap
+        int start = i;
+        int end = i;
+        int peak = i;
+        double power_sum = 0.0;
+        double moment = 0.0;
+        while (i < n && i - end <= det->config.merge_gap) {
+            if (det->active[i]) {
+                double power = pow(10.0, spectrum_db[i] / 10.0);
+                power_sum += power;
+                moment += power * i;
+                if (spectrum_db[i] > spectrum_db[peak]) peak = i;
+                end = i;
+            }
+            i++;
+        }
+        i = end + 1;
+
+        cluster_t *cl = &det->clusters[det->cluster_count++];
+        cl->center_bin = (float)(moment / power_sum);
+        cl->bandwidth_bins = (float)(end - start + 1);
+        cl->peak_db = spectrum_db[peak];
+        cl->snr_db = spectrum_db[peak] - det->noise_db[peak];
+    }
+}
+
+static bool cluster_matches(const detected_signal_t *sig, const cluster_t *cl) {
+    float tolerance = 0.5f * fmaxf(sig->bandwidth_bins, cl->bandwidth_bins) + 1.0f;
+    return fabsf(sig->center_bin - cl->center_bin) <= tolerance;
+}
+
+// Match clusters to tracks; both lists are ordered by frequency, so one
+// merge pass updates, creates and ages tracks
+static void update_tracks(signal_detector_t *det) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    int64_t now_us = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+
+    track_t *out = det->next_tracks;
+    int out_count = 0;
+    int t = 0;
+    int c = 0;
+
+    while ((t < det->track_count || c < det->cluster_count) &&
+           out_count < SIGNAL_DETECTOR_MAX_SIGNALS) {
+        track_t *tr = t < det->track_count ? &det->tracks[t] : NULL;
+        const cluster_t *cl = c < det->cluster_count ? &det->clusters[c] : NULL;
+
+        if (tr && cl && cluster_matches(&tr->sig, cl)) {
+            // Seen again: take the new measurement
+            track_t *o = &out[out_count++];
+            *o = *tr;
+            o->sig.center_bin = cl->center_bin;
+            o->sig.bandwidth_bins = cl->bandwidth_bins;
+            o->sig.peak_db = cl->peak_db;
+            o->sig.snr_db = cl->snr_db;
+            o->sig.last_seen_us = now_us;
+            o->hits++;
+            o->missed = 0;
+            t++;
+            c++;
+        } else if (tr && (!cl || tr->sig.center_bin < cl->center_bin)) {
+            // Not seen: hold confirmed tracks for a while, drop the rest
+            t++;
+            if (tr->hits >= det->config.confirm_frames && tr->missed < det->config.hold_frames) {
+                track_t *o = &out[out_count++];
+                *o = *tr;
+                o->missed++;
+            }
+        } else {
+            // New signal
+            track_t *o = &out[out_count++];
+            o->sig.id = det->next_id++;
+            o->sig.center_bin = cl->center_bin;
+            o->sig.bandwidth_bins = cl->bandwidth_bins;
+            o->sig.peak_db = cl->peak_db;
+            o->sig.snr_db = cl->snr_db;
+            o->sig.first_seen_us = now_us;
+            o->sig.last_seen_us = now_us;
+            o->hits = 1;
+            o->missed = 0;
+            c++;
+        }
+    }
+
+    // Held tracks can end up slightly out of order next to moved ones;
+    // the list is nearly sorted, so insertion sort stays linear in practice
+    for (int i = 1; i < out_count; i++) {
+        track_t tmp = out[i];
+        int j = i - 1;
+        while (j >= 0 && out[j].sig.center_bin > tmp.sig.center_bin) {
+            out[j + 1] = out[j];
+            j--;
+        }
+        out[j + 1] = tmp;
+    }
+
+    det->next_tracks = det->tracks;
+    det->tracks = out;
+    det->track_count = out_count;
+}
+
+int signal_detector_process(signal_detector_t *det, const float *spectrum_db) {
+    if (!det || !spectrum_db) return 0;
+
+    estimate_noise(det, spectrum_db);
+    find_clusters(det, spectrum_db);
+    update_tracks(det);
+
+    int reported = 0;
+    for (int i = 0; i < det->track_count; i++) {
+        if (det->tracks[i].hits >= det->config.confirm_frames) reported++;
+    }
+    return reported;
+}
+
+int signal_detector_get_signals(signal_detector_t *det, detected_signal_t *out, int max) {
+    if (!det || !out) return 0;
+
+    int count = 0;
+    for (int i = 0; i < det->track_count && count < max; i++) {
+        if (det->tracks[i].hits >= det->config.confirm_frames) {
+            out[count++] = det->tracks[i].sig;
+        }
+    }
+    return count;
+}
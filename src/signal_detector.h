@@ -0,0 +1,62 @@
+#ifndef SIGNAL_DETECTOR_H
+#define SIGNAL_DETECTOR_H
+
+#include <stdint.h>
+
+// Carrier detector for the averaged dB spectrum:
+//   ordered-statistic CFAR (noise = k-th smallest of the reference cells
+//   around each bin) -> per-bin hysteresis -> clustering of adjacent bins
+//   -> tracked signal list matched frame to frame.
+// The reference window slides over a dB histogram with a moving rank
+// pointer, so a frame costs O(bins). Runs on the DSP thread.
+
+typedef struct signal_detector signal_detector_t;
+
+// Maximum number of tracked signals
+#define SIGNAL_DETECTOR_MAX_SIGNALS 128
+
+// One tracked signal; positions are fractional spectrum bin indices
+typedef struct {
+    uint32_t id;            // Unique per detector, stable while tracked
+    float center_bin;       // Power-weighted centre
+    float bandwidth_bins;   // Width of the detected cluster
+    float peak_db;          // Strongest bin
+    float snr_db;           // Peak over CFAR noise estimate
+    int64_t first_seen_us;  // Wall clock (CLOCK_REALTIME) of first detection
+    int64_t last_seen_us;   // Wall clock of the latest detection
+} detected_signal_t;
+
+typedef struct {
+    int guard_bins;      // Cells skipped on each side of the bin under test
+    int window_bins;     // Reference cells on each side
+    float rank;          // Order statistic as a fraction of the reference cells
+    float on_db;         // Threshold above noise to start a detection
+    float off_db;        // Threshold above noise to keep it (hysteresis)
+    int merge_gap;       // Inactive bins bridged when clustering
+    int confirm_frames;  // Consecutive detections before a signal is reported
+    int hold_frames;     // Frames a signal is kept after it was last seen
+} signal_detector_config_t;
+
+#define SIGNAL_DETECTOR_CONFIG_DEFAULT { \
+    .guard_bins = 4, .window_bins = 64, .rank = 0.6f, \
+    .on_db = 10.0f, .off_db = 6.0f, .merge_gap = 2, \
+    .confirm_frames = 2, .hold_frames = 8 }
+
+// Create detector for spectra of size bins (NULL config = defaults)
+signal_detector_t *signal_detector_new(int size, const signal_detector_config_t *config);
+
+// Free detector
+void signal_detector_free(signal_detector_t *det);
+
+// Run detection on one averaged spectrum and update the tracked list
+// Returns the number of reported (confirmed) signals
+int signal_detector_process(signal_detector_t *det, const float *spectrum_db);
+
+// Forget all tracks and hysteresis state (e.g. after a zoom change)
+void signal_detector_reset(signal_detector_t *det);
+
+// Copy up to max reported signals, ordered by frequency
+// Returns the number copied
+int signal_detector_get_signals(signal_detector_t *det, detected_signal_t *out, int max);
+
+#endif // SIGNAL_DETECTOR_H
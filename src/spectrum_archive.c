@@ -0,0 +1,655 @@
+#define _DEFAULT_SOURCE  // gmtime_r
+#include "spectrum_archive.h"
+#include "rt_sched.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+
+// Lines queued for the worker (about 8 s at the display rate)
+#define ARCHIVE_QUEUE_LINES 128
+
+// A partial batch is written after this long without new lines, so a
+// reader is never far behind a stream that stopped
+#define ARCHIVE_FLUSH_NS (1 * 1000000000LL)
+
+#define NS_PER_SEC 1000000000LL
+
+// "20261019-120000-016": chunk names sort in time order
+#define ARCHIVE_NAME_LEN 32
+
+typedef struct {
+    int64_t time_ns;
+    int64_t center_hz;
+    uint32_t span_hz;
+    float noise_db;
+} archive_queued_t;
+
+struct spectrum_archive {
+    char *dir;
+    int bins;
+    spectrum_archive_config_t config;
+
+    // Queue (under mutex); the worker encodes the line at the tail outside
+    // the lock and releases it afterwards
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    float *queue_db;  // ARCHIVE_QUEUE_LINES * bins
+    archive_queued_t queue[ARCHIVE_QUEUE_LINES];
+    int queue_head;
+    int queue_count;
+
+    atomic_long lines;
+    atomic_long dropped;
+    atomic_long bytes;
+
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+
+    // Worker only: current chunk and its pending batch
+    int fd;
+    int index_fd;
+    int64_t chunk_slot_ns;    // Start of the chunk's hour
+    uint64_t offset;          // Chunk size including the batch
+    uint8_t *q;               // Quantized current line
+    uint8_t *prev_q;          // Quantized previous line
+    int8_t *delta;
+    int since_key;            // Lines since the last key line
+    int64_t center_hz;        // Span of the last key line
+    uint32_t span_hz;
+    uint8_t *batch;
+    size_t batch_len;
+    size_t batch_capacity;
+    int batch_lines;
+    spectrum_archive_index_t index_batch[SPECTRUM_ARCHIVE_BATCH_LINES];
+    int index_count;
+};
+
+struct spectrum_archive_reader {
+    char *dir;
+    char (*names)[ARCHIVE_NAME_LEN];  // Chunks, sorted
+    int count;
+
+    // Decoding state
+    int bins;
+    uint8_t *q;
+    int8_t *delta;
+    uint8_t *packed;
+};
+
+// Worst-case PackBits size: one control byte per 128 literals
+static size_t packed_max(int bins) {
+    return (size_t)bins + (size_t)bins / 128 + 1;
+}
+
+static void format_name(int64_t time_ns, char *name, size_t size) {
+    time_t sec = (time_t)(time_ns / NS_PER_SEC);
+    struct tm tm;
+    gmtime_r(&sec, &tm);
+    size_t len = strftime(name, size, "%Y%m%d-%H%M%S", &tm);
+    snprintf(name + len, size - len, "-%03d", (int)(time_ns % NS_PER_SEC / 1000000));
+}
+
+// PackBits: control c < 128 is followed by c + 1 literal bytes, c >= 128
+// by one byte repeated c - 126 times
+static size_t packbits_encode(const int8_t *in, int n, uint8_t *out) {
+    size_t o = 0;
+    int i = 0;
+    while (i < n) {
+        int run = 1;
+        while (i + run < n && run < 129 && in[i + run] == in[i]) run++;
+        if (run >= 2) {
+            out[o++] = (uint8_t)(run + 126);
+            out[o++] = (uint8_t)in[i];
+            i += run;
+            continue;
+        }
+        // Literals up to the next pair of equal bytes
+        int lit = 1;
+        while (i + lit < n && lit < 128 &&
+               !(i + lit + 1 < n && in[i + lit] == in[i + lit + 1])) {
+            lit++;
+        }
+        out[o++] = (uint8_t)(lit - 1);
+        memcpy(out + o, in + i, (size_t)lit);
+        o += (size_t)lit;
+        i += lit;
+    }
+    return o;
+}
+
+// Returns 0 if exactly n bytes were decoded, -1 on a corrupt stream
+static int packbits_decode(const uint8_t *in, size_t size, int8_t *out, int n) {
+    size_t i = 0;
+    int o = 0;
+    while (i < size) {
+        int c = in[i++];
+        if (c < 128) {
+            int lit = c + 1;
+            if (i + (size_t)lit > size || o + lit > n) return -1;
+            memcpy(out + o, in + i, (size_t)lit);
+            i += (size_t)lit;
+            o += lit;
+        } else {
+            int run = c - 126;
+            if (i >= size || o + run > n) return -1;
+            memset(out + o, (int8_t)in[i++], (size_t)run);
+            o += run;
+        }
+    }
+    return o == n ? 0 : -1;
+}
+
+static int write_all(int fd, const void *data, size_t size) {
+    const uint8_t *p = data;
+    while (size > 0) {
+        ssize_t n = write(fd, p, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        size -= (size_t)n;
+    }
+    return 0;
+}
+
+// Write the batch: lines first, then the index entries pointing at them
+static void flush_batch(spectrum_archive_t *arc) {
+    if (arc->batch_len == 0 || arc->fd < 0) return;
+
+    size_t index_bytes = sizeof(spectrum_archive_index_t) * (size_t)arc->index_count;
+    if (write_all(arc->fd, arc->batch, arc->batch_len) != 0 ||
+        (index_bytes && write_all(arc->index_fd, arc->index_batch, index_bytes) != 0)) {
+        fprintf(stderr, "Archive: Write failed: %s\n", strerror(errno));
+    } else {
+        atomic_fetch_add(&arc->bytes, (long)(arc->batch_len + index_bytes));
+        atomic_fetch_add(&arc->lines, arc->batch_lines);
+    }
+    arc->batch_len = 0;
+    arc->batch_lines = 0;
+    arc->index_count = 0;
+}
+
+static void close_chunk(spectrum_archive_t *arc) {
+    flush_batch(arc);
+    if (arc->fd >= 0) close(arc->fd);
+    if (arc->index_fd >= 0) close(arc->index_fd);
+    arc->fd = -1;
+    arc->index_fd = -1;
+}
+
+// Start a chunk named after its first line; every run writes its own
+// chunks, so a crash can only leave a truncated tail
+static int open_chunk(spectrum_archive_t *arc, int64_t time_ns, int64_t slot_ns) {
+    close_chunk(arc);
+
+    char name[ARCHIVE_NAME_LEN];
+    format_name(time_ns, name, sizeof(name));
+    char path[PATH_MAX], index_path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s.esa", arc->dir, name);
+    snprintf(index_path, sizeof(index_path), "%s/%s.idx", arc->dir, name);
+
+    arc->fd = open(path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (arc->fd < 0) {
+        fprintf(stderr, "Archive: Cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    arc->index_fd = open(index_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (arc->index_fd < 0) {
+        fprintf(stderr, "Archive: Cannot create %s: %s\n", index_path, strerror(errno));
+        close(arc->fd);
+        arc->fd = -1;
+        return -1;
+    }
+
+    spectrum_archive_header_t header = {
+        .magic = SPECTRUM_ARCHIVE_MAGIC,
+        .version = SPECTRUM_ARCHIVE_VERSION,
+        .header_size = sizeof(spectrum_archive_header_t),
+        .bins = (uint32_t)arc->bins,
+        .step_db = arc->config.step_db,
+        .gate_db = arc->config.gate_db,
+        .start_ns = time_ns,
+    };
+    memcpy(arc->batch, &header, sizeof(header));
+    arc->batch_len = sizeof(header);
+    arc->offset = sizeof(header);
+    arc->chunk_slot_ns = slot_ns;
+    arc->since_key = SPECTRUM_ARCHIVE_KEY_LINES;  // First line is a key
+    return 0;
+}
+
+// Quantize, delta and pack one line into the batch (worker thread)
+static void encode_line(spectrum_archive_t *arc, const float *db, const archive_queued_t *line) {
+    int64_t chunk_ns = (int64_t)SPECTRUM_ARCHIVE_CHUNK_SECONDS * NS_PER_SEC;
+    int64_t slot_ns = line->time_ns - line->time_ns % chunk_ns;
+    if (arc->fd < 0 || slot_ns != arc->chunk_slot_ns) {
+        if (open_chunk(arc, line->time_ns, slot_ns) != 0) return;
+    }
+
+    float step = arc->config.step_db;
+    float noise_db = isfinite(line->noise_db) ? line->noise_db : -200.0f;
+    float floor_db = step * roundf(noise_db / step);
+    float gate = floor_db + arc->config.gate_db;
+    for (int i = 0; i < arc->bins; i++) {
+        // NaN and -inf bins are stored as the floor (lrintf of NaN is undefined)
+        float v = db[i] >= gate ? 1.0f + (db[i] - gate) / step : 0.0f;
+        arc->q[i] = v > 255.0f ? 255 : (uint8_t)lrintf(v);
+    }
+
+    bool key = arc->since_key >= SPECTRUM_ARCHIVE_KEY_LINES || line->center_hz != arc->center_hz ||
+               line->span_hz != arc->span_hz;
+    for (int i = 0; i < arc->bins; i++) {
+        arc->delta[i] = (int8_t)(key ? arc->q[i] : (uint8_t)(arc->q[i] - arc->prev_q[i]));
+    }
+    uint8_t *swap = arc->prev_q;
+    arc->prev_q = arc->q;
+    arc->q = swap;
+
+    if (key) {
+        if (arc->index_count == SPECTRUM_ARCHIVE_BATCH_LINES) flush_batch(arc);
+        arc->index_batch[arc->index_count++] =
+            (spectrum_archive_index_t){ line->time_ns, arc->offset };
+        arc->since_key = 0;
+        arc->center_hz = line->center_hz;
+        arc->span_hz = line->span_hz;
+    }
+    arc->since_key++;
+
+    spectrum_archive_record_t record = { .time_ns = line->time_ns, .floor_db = floor_db };
+    size_t start = arc->batch_len;
+    size_t header_bytes = sizeof(record) + (key ? sizeof(spectrum_archive_key_t) : 0);
+    size_t size = packbits_encode(arc->delta, arc->bins, arc->batch + start + header_bytes);
+    record.size = (uint32_t)size | (key ? SPECTRUM_ARCHIVE_KEY_FLAG : 0);
+    memcpy(arc->batch + start, &record, sizeof(record));
+    if (key) {
+        spectrum_archive_key_t span = { .center_hz = line->center_hz, .span_hz = line->span_hz };
+        memcpy(arc->batch + start + sizeof(record), &span, sizeof(span));
+    }
+    arc->batch_len += header_bytes + size;
+    arc->offset += header_bytes + size;
+
+    if (++arc->batch_lines >= SPECTRUM_ARCHIVE_BATCH_LINES) flush_batch(arc);
+}
+
+static void *worker_thread_func(void *arg) {
+    spectrum_archive_t *arc = (spectrum_archive_t *)arg;
+
+    // Only runs when nothing else wants the CPU
+    rt_thread_config_t config = { .cpu = -1, .policy = RT_POLICY_IDLE, .priority = 0 };
+    rt_sched_apply("archive", &config);
+
+    pthread_mutex_lock(&arc->mutex);
+    for (;;) {
+        while (arc->queue_count == 0 && atomic_load(&arc->running)) {
+            if (arc->batch_lines == 0) {
+                pthread_cond_wait(&arc->cond, &arc->mutex);
+                continue;
+            }
+            // Lines pending: write them if nothing comes for a while
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += ARCHIVE_FLUSH_NS / NS_PER_SEC;
+            if (pthread_cond_timedwait(&arc->cond, &arc->mutex, &deadline) == ETIMEDOUT &&
+                arc->queue_count == 0) {
+                pthread_mutex_unlock(&arc->mutex);
+                flush_batch(arc);
+                pthread_mutex_lock(&arc->mutex);
+            }
+        }
+        if (arc->queue_count == 0) break;
+
+        int tail = (arc->queue_head - arc->queue_count + ARCHIVE_QUEUE_LINES) % ARCHIVE_QUEUE_LINES;
+        archive_queued_t line = arc->queue[tail];
+        pthread_mutex_unlock(&arc->mutex);
+
+        encode_line(arc, arc->queue_db + (size_t)tail * arc->bins, &line);
+
+        pthread_mutex_lock(&arc->mutex);
+        arc->queue_count--;
+    }
+    pthread_mutex_unlock(&arc->mutex);
+
+    close_chunk(arc);
+    return NULL;
+}
+
+spectrum_archive_t *spectrum_archive_new(const char *dir, int bins,
+                                         const spectrum_archive_config_t *config) {
+    spectrum_archive_config_t defaults = SPECTRUM_ARCHIVE_CONFIG_DEFAULT;
+    if (!config) config = &defaults;
+    if (!dir || bins <= 0) return NULL;
+    if (config->step_db <= 0.0f || config->gate_db < 0.0f) {
+        fprintf(stderr, "Archive: Invalid step %.2f dB / gate %.1f dB\n", config->step_db,
+                config->gate_db);
+        return NULL;
+    }
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Archive: Cannot create %s: %s\n", dir, strerror(errno));
+        return NULL;
+    }
+
+    spectrum_archive_t *arc = calloc(1, sizeof(spectrum_archive_t));
+    if (!arc) return NULL;
+
+    arc->dir = strdup(dir);
+    arc->bins = bins;
+    arc->config = *config;
+    arc->fd = -1;
+    arc->index_fd = -1;
+    arc->queue_db = malloc(sizeof(float) * ARCHIVE_QUEUE_LINES * bins);
+    arc->q = malloc((size_t)bins);
+    arc->prev_q = malloc((size_t)bins);
+    arc->delta = malloc((size_t)bins);
+    // A whole batch of incompressible lines, each a key, plus the header
+    arc->batch_capacity = sizeof(spectrum_archive_header_t) +
+                          SPECTRUM_ARCHIVE_BATCH_LINES *
+                              (sizeof(spectrum_archive_record_t) +
+                               sizeof(spectrum_archive_key_t) + packed_max(bins));
+    arc->batch = malloc(arc->batch_capacity);
+    pthread_mutex_init(&arc->mutex, NULL);
+    pthread_cond_init(&arc->cond, NULL);
+    atomic_init(&arc->lines, 0);
+    atomic_init(&arc->dropped, 0);
+    atomic_init(&arc->bytes, 0);
+    atomic_init(&arc->running, 0);
+
+    if (!arc->dir || !arc->queue_db || !arc->q || !arc->prev_q || !arc->delta || !arc->batch) {
+        fprintf(stderr, "Archive: Failed to set up %s\n", dir);
+        spectrum_archive_free(arc);
+        return NULL;
+    }
+
+    fprintf(stderr, "Archive: Writing spectra to %s (%.2f dB steps, gate %.1f dB)\n", dir,
+            config->step_db, config->gate_db);
+    return arc;
+}
+
+void spectrum_archive_free(spectrum_archive_t *arc) {
+    if (!arc) return;
+
+    spectrum_archive_stop(arc);
+    close_chunk(arc);
+    pthread_mutex_destroy(&arc->mutex);
+    pthread_cond_destroy(&arc->cond);
+    free(arc->queue_db);
+    free(arc->q);
+    free(arc->prev_q);
+    free(arc->delta);
+    free(arc->batch);
+    free(arc->dir);
+    free(arc);
+}
+
+int spectrum_archive_start(spectrum_archive_t *arc) {
+    if (!arc) return -1;
+    if (atomic_load(&arc->running)) return 0;
+
+    atomic_store(&arc->running, 1);
+    if (pthread_create(&arc->thread, NULL, worker_thread_func, arc) != 0) {
+        fprintf(stderr, "Archive: Failed to create worker thread\n");
+        atomic_store(&arc->running, 0);
+        return -1;
+    }
+    arc->thread_started = 1;
+    return 0;
+}
+
+void spectrum_archive_stop(spectrum_archive_t *arc) {
+    if (!arc || !arc->thread_started) return;
+
+    pthread_mutex_lock(&arc->mutex);
+    atomic_store(&arc->running, 0);
+    pthread_cond_signal(&arc->cond);
+    pthread_mutex_unlock(&arc->mutex);
+
+    pthread_join(arc->thread, NULL);
+    arc->thread_started = 0;
+}
+
+int spectrum_archive_add_line(spectrum_archive_t *arc, const float *spectrum_db, float noise_db,
+                              int64_t time_ns, int64_t center_hz, uint32_t span_hz) {
+    if (!arc || !spectrum_db || time_ns < 0) return -1;
+
+    pthread_mutex_lock(&arc->mutex);
+    if (!atomic_load(&arc->running) || arc->queue_count == ARCHIVE_QUEUE_LINES) {
+        pthread_mutex_unlock(&arc->mutex);
+        atomic_fetch_add_explicit(&arc->dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    int head = arc->queue_head;
+    memcpy(arc->queue_db + (size_t)head * arc->bins, spectrum_db, sizeof(float) * arc->bins);
+    arc->queue[head] = (archive_queued_t){ time_ns, center_hz, span_hz, noise_db };
+    arc->queue_head = (head + 1) % ARCHIVE_QUEUE_LINES;
+    arc->queue_count++;
+    pthread_cond_signal(&arc->cond);
+    pthread_mutex_unlock(&arc->mutex);
+    return 0;
+}
+
+long spectrum_archive_get_lines(spectrum_archive_t *arc) {
+    return arc ? atomic_load(&arc->lines) : 0;
+}
+
+long spectrum_archive_get_dropped(spectrum_archive_t *arc) {
+    return arc ? atomic_load_explicit(&arc->dropped, memory_order_relaxed) : 0;
+}
+
+long spectrum_archive_get_bytes(spectrum_archive_t *arc) {
+    return arc ? atomic_load(&arc->bytes) : 0;
+}
+
+spectrum_archive_reader_t *spectrum_archive_reader_open(const char *dir) {
+    if (!dir) return NULL;
+    DIR *d = opendir(dir);
+    if (!d) return NULL;
+    closedir(d);
+
+    spectrum_archive_reader_t *reader = calloc(1, sizeof(spectrum_archive_reader_t));
+    if (!reader) return NULL;
+    reader->dir = strdup(dir);
+    if (!reader->dir) {
+        free(reader);
+        return NULL;
+    }
+    return reader;
+}
+
+void spectrum_archive_reader_close(spectrum_archive_reader_t *reader) {
+    if (!reader) return;
+    free(reader->names);
+    free(reader->q);
+    free(reader->delta);
+    free(reader->packed);
+    free(reader->dir);
+    free(reader);
+}
+
+static int compare_names(const void *a, const void *b) {
+    return strcmp((const char *)a, (const char *)b);
+}
+
+// List the chunks (the writer adds one an hour)
+static void scan_chunks(spectrum_archive_reader_t *reader) {
+    DIR *d = opendir(reader->dir);
+    if (!d) return;
+
+    int capacity = reader->count > 0 ? reader->count + 16 : 64;
+    char (*names)[ARCHIVE_NAME_LEN] = malloc(sizeof(*names) * (size_t)capacity);
+    int count = 0;
+    struct dirent *entry;
+    while (names && (entry = readdir(d)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len < 5 || len - 4 >= ARCHIVE_NAME_LEN || strcmp(entry->d_name + len - 4, ".esa") != 0) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            char (*grown)[ARCHIVE_NAME_LEN] = realloc(names, sizeof(*names) * (size_t)capacity);
+            if (!grown) break;
+            names = grown;
+        }
+        memcpy(names[count], entry->d_name, len - 4);
+        names[count][len - 4] = '\0';
+        count++;
+    }
+    closedir(d);
+    if (!names) return;
+
+    qsort(names, (size_t)count, sizeof(*names), compare_names);
+    free(reader->names);
+    reader->names = names;
+    reader->count = count;
+}
+
+// Offset of the last key line at or before start_ns (the first line if
+// none is), by binary search of the chunk's index
+static long find_key(const char *index_path, int64_t start_ns, long first) {
+    FILE *f = fopen(index_path, "rb");
+    if (!f) return first;
+
+    long offset = first;
+    long lo = 0, hi = -1;
+    if (fseek(f, 0, SEEK_END) == 0) hi = ftell(f) / (long)sizeof(spectrum_archive_index_t) - 1;
+    while (lo <= hi) {
+        long mid = lo + (hi - lo) / 2;
+        spectrum_archive_index_t entry;
+        if (fseek(f, mid * (long)sizeof(entry), SEEK_SET) != 0 || fread(&entry, sizeof(entry), 1, f) != 1) {
+            break;
+        }
+        if (entry.time_ns <= start_ns) {
+            offset = (long)entry.offset;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    fclose(f);
+    return offset;
+}
+
+// Decode lines at or after start_ns from one chunk
+static int read_chunk(spectrum_archive_reader_t *reader, const char *name, int64_t start_ns,
+                      int max_lines, float *lines, spectrum_archive_line_t *info) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s.esa", reader->dir, name);
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+
+    spectrum_archive_header_t header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != SPECTRUM_ARCHIVE_MAGIC ||
+        header.version != SPECTRUM_ARCHIVE_VERSION || header.bins != (uint32_t)reader->bins ||
+        header.header_size < sizeof(header) || header.step_db <= 0.0f) {
+        fclose(f);
+        return 0;
+    }
+
+    snprintf(path, sizeof(path), "%s/%s.idx", reader->dir, name);
+    long offset = find_key(path, start_ns, (long)header.header_size);
+    if (fseek(f, offset, SEEK_SET) != 0) {
+        fclose(f);
+        return 0;
+    }
+
+    int bins = reader->bins;
+    size_t max_size = packed_max(bins);
+    bool have_key = false;
+    int64_t center_hz = 0;
+    uint32_t span_hz = 0;
+    int count = 0;
+    spectrum_archive_record_t record;
+    while (count < max_lines && fread(&record, sizeof(record), 1, f) == 1) {
+        bool key = (record.size & SPECTRUM_ARCHIVE_KEY_FLAG) != 0;
+        size_t size = record.size & ~SPECTRUM_ARCHIVE_KEY_FLAG;
+        if (size > max_size) break;
+        if (key) {
+            spectrum_archive_key_t span;
+            if (fread(&span, sizeof(span), 1, f) != 1) break;
+            center_hz = span.center_hz;
+            span_hz = span.span_hz;
+        }
+        // Truncated tail (writer mid-batch or crashed) or damage: stop
+        if (fread(reader->packed, 1, size, f) != size ||
+            packbits_decode(reader->packed, size, reader->delta, bins) != 0) {
+            break;
+        }
+
+        if (key) {
+            memcpy(reader->q, reader->delta, (size_t)bins);
+            have_key = true;
+        } else if (have_key) {
+            for (int i = 0; i < bins; i++) reader->q[i] += (uint8_t)reader->delta[i];
+        } else {
+            continue;
+        }
+        if (record.time_ns < start_ns) continue;
+
+        float gate = record.floor_db + header.gate_db;
+        float *out = lines + (size_t)count * bins;
+        for (int i = 0; i < bins; i++) {
+            uint8_t q = reader->q[i];
+            out[i] = q == 0 ? record.floor_db : gate + (float)(q - 1) * header.step_db;
+        }
+        if (info) {
+            info[count] = (spectrum_archive_line_t){ record.time_ns, center_hz, span_hz };
+        }
+        count++;
+    }
+    fclose(f);
+    return count;
+}
+
+int spectrum_archive_read(spectrum_archive_reader_t *reader, int64_t start_ns, int max_lines,
+                          float *lines, int bins, spectrum_archive_line_t *info) {
+    if (!reader || !lines || bins <= 0 || max_lines <= 0) return 0;
+
+    if (bins != reader->bins) {
+        free(reader->q);
+        free(reader->delta);
+        free(reader->packed);
+        reader->q = malloc((size_t)bins);
+        reader->delta = malloc((size_t)bins);
+        reader->packed = malloc(packed_max(bins));
+        reader->bins = bins;
+        if (!reader->q || !reader->delta || !reader->packed) {
+            reader->bins = 0;
+            return 0;
+        }
+    }
+
+    scan_chunks(reader);
+    if (reader->count == 0) return 0;
+
+    // Last chunk starting at or before start_ns (names sort by time)
+    char key[ARCHIVE_NAME_LEN];
+    format_name(start_ns, key, sizeof(key));
+    int lo = 0, hi = reader->count - 1, first = 0;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (strcmp(reader->names[mid], key) <= 0) {
+            first = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+
+    int count = 0;
+    for (int c = first; c < reader->count && count < max_lines; c++) {
+        count += read_chunk(reader, reader->names[c], start_ns, max_lines - count,
+                            lines + (size_t)count * bins, info ? info + count : NULL);
+    }
+    return count;
+}
@@ -0,0 +1,126 @@
+#ifndef SPECTRUM_ARCHIVE_H
+#define SPECTRUM_ARCHIVE_H
+
+#include <stdint.h>
+
+// Every spectrum line on disk, compact enough to keep days of waterfall.
+//
+// Lines are queued by the caller (never blocking, dropped and counted
+// when the worker is behind) and encoded by a SCHED_IDLE worker:
+//   quantize  uint8 steps of step_db above the line's noise floor; bins
+//             less than gate_db above it are stored as the floor, so the
+//             noise (which neither deltas nor runs compress) costs nothing
+//   delta     each line minus the previous one (mod 256), except key
+//             lines every SPECTRUM_ARCHIVE_KEY_LINES and after a retune
+//   RLE       PackBits over the deltas: runs of equal bytes (mostly zero
+//             where the band is quiet or steady) and literal stretches
+// and written in batches of SPECTRUM_ARCHIVE_BATCH_LINES with one write
+// per file. A day of 4096-bin lines at 15.6/s of a busy band takes about
+// 150 MB (bench-storage "archive").
+//
+// Files (chunks) end at each wall-clock hour and are named after their
+// first line in UTC, so names sort by time and every run writes its own:
+// <dir>/20261019-120000-016.esa holds a spectrum_archive_header_t, then
+// per line a spectrum_archive_record_t, for key lines a
+// spectrum_archive_key_t, and size bytes of PackBits. Its sparse index
+// <dir>/20261019-120000-016.idx lists (time, offset) of every key line, so
+// a reader seeks with two binary searches (chunk name, then key) and
+// decodes at most SPECTRUM_ARCHIVE_KEY_LINES - 1 lines it does not need.
+// Both files only grow, key entries after their lines, so a reader can
+// follow the writer; a truncated tail ends the chunk.
+
+#define SPECTRUM_ARCHIVE_MAGIC 0x41534C45u  // "ELSA" little-endian
+#define SPECTRUM_ARCHIVE_VERSION 1
+#define SPECTRUM_ARCHIVE_CHUNK_SECONDS 3600
+#define SPECTRUM_ARCHIVE_KEY_LINES 64    // About 4 s at 15.6 lines/s
+#define SPECTRUM_ARCHIVE_BATCH_LINES 64
+#define SPECTRUM_ARCHIVE_KEY_FLAG 0x80000000u
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;  // Offset of the first record
+    uint32_t bins;
+    float step_db;         // dB per quantization step
+    float gate_db;         // Bins below floor + gate_db stored as the floor
+    int64_t start_ns;      // Time of the first line (CLOCK_REALTIME)
+} spectrum_archive_header_t;
+
+typedef struct {
+    int64_t time_ns;       // Capture time (CLOCK_REALTIME)
+    uint32_t size;         // PackBits bytes; SPECTRUM_ARCHIVE_KEY_FLAG on key lines
+    float floor_db;        // Noise floor (a multiple of step_db)
+} spectrum_archive_record_t;
+
+// After the record of a key line
+typedef struct {
+    int64_t center_hz;
+    uint32_t span_hz;
+    uint32_t reserved;
+} spectrum_archive_key_t;
+
+// Index entry
+typedef struct {
+    int64_t time_ns;
+    uint64_t offset;       // Of the key line's record in the chunk
+} spectrum_archive_index_t;
+
+// A line as read back
+typedef struct {
+    int64_t time_ns;
+    int64_t center_hz;
+    uint32_t span_hz;
+} spectrum_archive_line_t;
+
+typedef struct {
+    float step_db;
+    float gate_db;
+} spectrum_archive_config_t;
+
+#define SPECTRUM_ARCHIVE_CONFIG_DEFAULT { .step_db = 0.5f, .gate_db = 8.0f }
+
+typedef struct spectrum_archive spectrum_archive_t;
+typedef struct spectrum_archive_reader spectrum_archive_reader_t;
+
+// Writer for lines of bins bins into dir (created if missing); chunks
+// already there are kept
+// Returns NULL on error
+spectrum_archive_t *spectrum_archive_new(const char *dir, int bins,
+                                         const spectrum_archive_config_t *config);
+
+// Stop the worker (writing queued lines) and free the writer
+void spectrum_archive_free(spectrum_archive_t *arc);
+
+// Start the worker thread
+// Returns 0 on success, -1 on error
+int spectrum_archive_start(spectrum_archive_t *arc);
+
+// Write the queued lines and stop the worker
+void spectrum_archive_stop(spectrum_archive_t *arc);
+
+// Queue one line (never blocks)
+// noise_db: its noise floor; time_ns: capture time (CLOCK_REALTIME)
+// Returns 0 if queued, -1 if dropped
+int spectrum_archive_add_line(spectrum_archive_t *arc, const float *spectrum_db, float noise_db,
+                              int64_t time_ns, int64_t center_hz, uint32_t span_hz);
+
+// Lines written, lines dropped, and bytes written (chunks and indexes)
+long spectrum_archive_get_lines(spectrum_archive_t *arc);
+long spectrum_archive_get_dropped(spectrum_archive_t *arc);
+long spectrum_archive_get_bytes(spectrum_archive_t *arc);
+
+// Reader over the chunks in dir (any thread, independent of the writer)
+// Returns NULL if dir cannot be read
+spectrum_archive_reader_t *spectrum_archive_reader_open(const char *dir);
+
+void spectrum_archive_reader_close(spectrum_archive_reader_t *reader);
+
+// Decode up to max_lines lines (bins floats each, oldest first) starting
+// with the first line at or after start_ns, following on into later
+// chunks; chunks of another bin count are skipped; info (may be NULL)
+// receives each line's time and span
+// Returns the number of lines read (0 if none)
+int spectrum_archive_read(spectrum_archive_reader_t *reader, int64_t start_ns, int max_lines,
+                          float *lines, int bins, spectrum_archive_line_t *info);
+
+#endif // SPECTRUM_ARCHIVE_H
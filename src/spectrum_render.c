@@ -0,0 +1,377 @@
+#include "spectrum_render.h"
+#include "ddc.h"
+#include <glib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+// Margins for axis labels
+#define MARGIN_LEFT 55
+#define MARGIN_BOTTOM 20
+
+void spectrum_view_init(spectrum_view_t *view) {
+    memset(view, 0, sizeof(*view));
+    view->min_db = -120.0f;
+    view->max_db = 0.0f;
+    view->center_freq_hz = 14200000;
+    view->sample_rate = DEFAULT_SAMPLE_RATE;
+    view->zoom_level = 1;
+}
+
+void spectrum_render(cairo_t *cr, int width, int height, const spectrum_view_t *view,
+                     const float *spectrum_db, int size) {
+    // Black background
+    cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
+    cairo_paint(cr);
+
+    // Calculate plot area (inside margins)
+    int plot_x = MARGIN_LEFT;
+    int plot_y = 0;
+    int plot_width = width - MARGIN_LEFT;
+    int plot_height = height - MARGIN_BOTTOM;
+
+    if (plot_width <= 0 || plot_height <= 0) return;
+
+    // Draw band overlays on x-axis (frequency axis at bottom)
+    // Note: Use FFT_SIZE constant instead of spectrum_size so bands draw before data arrives
+    if (view->bandplan && view->bandplan->count > 0 && view->sample_rate > 0) {
+        // Calculate visible frequency range
+        double freq_span = view->sample_rate / view->zoom_level;
+        double hz_per_bin = (double)view->sample_rate / FFT_SIZE;
+        double pan_hz = view->pan_offset * hz_per_bin;
+        int64_t freq_start = (int64_t)(view->center_freq_hz - freq_span / 2 + pan_hz);
+        int64_t freq_end = (int64_t)(view->center_freq_hz + freq_span / 2 + pan_hz);
+
+        // Find visible bands
+        int visible_indices[32];
+        int num_visible = bandplan_find_visible(view->bandplan, freq_start, freq_end,
+                                                 visible_indices, 32);
+
+        // Draw each visible band as colored rectangle on x-axis
+        for (int i = 0; i < num_visible; i++) {
+            const band_entry_t *band = &view->bandplan->bands[visible_indices[i]];
+
+            // Set color based on band type
+            switch (band->tag) {
+                case BAND_TAG_HAMRADIO:
+                    cairo_set_source_rgba(cr, 0.0, 0.8, 0.0, 0.6);  // Green
+                    break;
+                case BAND_TAG_BROADCAST:
+                    cairo_set_source_rgba(cr, 1.0, 0.5, 0.0, 0.6);  // Orange
+                    break;
+                default:
+                    cairo_set_source_rgba(cr, 0.5, 0.5, 0.5, 0.4);  // Gray for other bands
+                    break;
+            }
+
+            // Convert band frequencies to pixel coordinates
+            double band_start_x = plot_x + ((double)(band->lower_bound - freq_start) / freq_span) * plot_width;
+            double band_end_x = plot_x + ((double)(band->upper_bound - freq_start) / freq_span) * plot_width;
+
+            // Clamp to plot area boundaries
+            if (band_start_x < plot_x) band_start_x = plot_x;
+            if (band_end_x > plot_x + plot_width) band_end_x = plot_x + plot_width;
+
+            // Draw rectangle on x-axis area (bottom margin)
+            if (band_end_x > band_start_x) {
+                cairo_rectangle(cr, band_start_x, plot_y + plot_height, band_end_x - band_start_x, MARGIN_BOTTOM);
+                cairo_fill(cr);
+            }
+        }
+    }
+
+    float range = view->max_db - view->min_db;
+    if (range < 1.0f) range = 1.0f;
+
+    // Set up font for labels
+    cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 12);
+
+    // Draw grid lines in plot area
+    cairo_set_source_rgba(cr, 0.3, 0.3, 0.3, 1.0);
+    cairo_set_line_width(cr, 1.0);
+
+    int num_h_lines = 10;
+    int num_v_lines = 10;
+
+    // Horizontal grid lines (dB levels)
+    for (int i = 0; i <= num_h_lines; i++) {
+        double y = plot_y + (double)i / num_h_lines * plot_height;
+        cairo_move_to(cr, plot_x, y);
+        cairo_line_to(cr, plot_x + plot_width, y);
+    }
+
+    // Vertical grid lines
+    for (int i = 0; i <= num_v_lines; i++) {
+        double x = plot_x + (double)i / num_v_lines * plot_width;
+        cairo_move_to(cr, x, plot_y);
+        cairo_line_to(cr, x, plot_y + plot_height);
+    }
+    cairo_stroke(cr);
+
+    // Draw dB labels in left margin (right-justified)
+    cairo_set_source_rgba(cr, 0.7, 0.7, 0.7, 1.0);
+    for (int i = 0; i <= num_h_lines; i++) {
+        double y = plot_y + (double)i / num_h_lines * plot_height;
+        float db = view->max_db - (float)i / num_h_lines * range;
+        char label[16];
+        snprintf(label, sizeof(label), "%+.0f", db);
+        cairo_text_extents_t extents;
+        cairo_text_extents(cr, label, &extents);
+        cairo_move_to(cr, MARGIN_LEFT - extents.width - 5, y + 4);
+        cairo_show_text(cr, label);
+    }
+
+    // Draw frequency labels in bottom margin (adjusted for zoom and pan)
+    if (view->sample_rate > 0) {
+        double freq_span = view->sample_rate / view->zoom_level;
+        // Calculate pan offset in Hz
+        double hz_per_bin = (double)view->sample_rate / size;
+        double pan_hz = view->pan_offset * hz_per_bin;
+        double freq_start = view->center_freq_hz - freq_span / 2 + pan_hz;
+
+        for (int i = 0; i <= num_v_lines; i++) {
+            double x = plot_x + (double)i / num_v_lines * plot_width;
+            double freq = freq_start + (double)i / num_v_lines * freq_span;
+
+            char label[32];
+            if (fabs(freq) >= 1e6) {
+                snprintf(label, sizeof(label), "%.3f", freq / 1e6);
+            } else if (fabs(freq) >= 1e3) {
+                snprintf(label, sizeof(label), "%.1fk", freq / 1e3);
+            } else {
+                snprintf(label, sizeof(label), "%.0f", freq);
+            }
+
+            // Center label under tick
+            cairo_text_extents_t extents;
+            cairo_text_extents(cr, label, &extents);
+            cairo_move_to(cr, x - extents.width / 2, height - 5);
+            cairo_show_text(cr, label);
+        }
+    }
+
+    // Draw spectrum in plot area (with zoom and pan support)
+    if (spectrum_db && size > 0) {
+        // Calculate visible bin range based on zoom level and pan offset
+        int visible_bins = size / view->zoom_level;
+        int max_pan = (size - visible_bins) / 2;
+        int clamped_pan = view->pan_offset;
+        if (clamped_pan < -max_pan) clamped_pan = -max_pan;
+        if (clamped_pan > max_pan) clamped_pan = max_pan;
+        int start_bin = (size - visible_bins) / 2 + clamped_pan;
+        int end_bin = start_bin + visible_bins;
+
+        // Data bins to draw: the visible slice, or everything in zoom FFT mode
+        int data_start = view->zoom_fft ? 0 : start_bin;
+        int data_end = view->zoom_fft ? size : end_bin;
+        int data_count = data_end - data_start;
+
+        // Draw spectrum line (cyan)
+        cairo_set_source_rgb(cr, 0.0, 1.0, 1.0);
+        cairo_set_line_width(cr, 1.0);
+
+        int first = 1;
+        for (int i = data_start; i < data_end; i++) {
+            double x = plot_x + (double)(i - data_start) / (data_count - 1) * plot_width;
+            float db = spectrum_db[i];
+
+            // Clamp to display range
+            if (db < view->min_db) db = view->min_db;
+            if (db > view->max_db) db = view->max_db;
+
+            // Convert dB to y coordinate
+            double y = plot_y + (1.0 - (db - view->min_db) / range) * plot_height;
+
+            if (first) {
+                cairo_move_to(cr, x, y);
+                first = 0;
+            } else {
+                cairo_line_to(cr, x, y);
+            }
+        }
+        cairo_stroke(cr);
+
+        // Fill under the spectrum with transparent cyan
+        cairo_set_source_rgba(cr, 0.0, 1.0, 1.0, 0.2);
+        first = 1;
+        for (int i = data_start; i < data_end; i++) {
+            double x = plot_x + (double)(i - data_start) / (data_count - 1) * plot_width;
+            float db = spectrum_db[i];
+
+            if (db < view->min_db) db = view->min_db;
+            if (db > view->max_db) db = view->max_db;
+
+            double y = plot_y + (1.0 - (db - view->min_db) / range) * plot_height;
+
+            if (first) {
+                cairo_move_to(cr, x, plot_y + plot_height);
+                cairo_line_to(cr, x, y);
+                first = 0;
+            } else {
+                cairo_line_to(cr, x, y);
+            }
+        }
+        cairo_line_to(cr, plot_x + plot_width, plot_y + plot_height);
+        cairo_close_path(cr);
+        cairo_fill(cr);
+
+        // Zoom FFT: grey out the DDC's attenuated, possibly aliased edges
+        if (view->zoom_fft && view->zoom_level > 1) {
+            double edge = plot_width * DDC_EDGE_FRACTION;
+            cairo_set_source_rgba(cr, 0.5, 0.5, 0.5, 0.35);
+            cairo_rectangle(cr, plot_x, plot_y, edge, plot_height);
+            cairo_rectangle(cr, plot_x + plot_width - edge, plot_y, edge, plot_height);
+            cairo_fill(cr);
+        }
+
+        // Draw detected-signal markers: shaded bandwidth, triangle, SNR
+        // and decoded text (staggered over rows so neighbours stay readable)
+        if (view->marker_count > 0) {
+            cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+            cairo_set_font_size(cr, 10);
+        }
+        for (int m = 0; m < view->marker_count; m++) {
+            const spectrum_marker_t *mk = &view->markers[m];
+            double scale = (double)plot_width / (data_count - 1);
+            double x = plot_x + (mk->center_bin - data_start) * scale;
+            if (x < plot_x || x > plot_x + plot_width) continue;
+
+            double half_width = mk->width_bins * scale / 2;
+            if (half_width < 1.0) half_width = 1.0;
+            cairo_set_source_rgba(cr, 1.0, 0.0, 1.0, 0.15);
+            cairo_rectangle(cr, x - half_width, plot_y, half_width * 2, plot_height);
+            cairo_fill(cr);
+
+            double tri = 5.0;
+            cairo_set_source_rgb(cr, 1.0, 0.0, 1.0);
+            cairo_move_to(cr, x - tri, plot_y + 14);
+            cairo_line_to(cr, x + tri, plot_y + 14);
+            cairo_line_to(cr, x, plot_y + 14 + tri * 1.5);
+            cairo_close_path(cr);
+            cairo_fill(cr);
+
+            char label[16];
+            snprintf(label, sizeof(label), "%.0f", mk->snr_db);
+            cairo_text_extents_t extents;
+            cairo_text_extents(cr, label, &extents);
+            cairo_move_to(cr, x - extents.width / 2, plot_y + 11);
+            cairo_show_text(cr, label);
+
+            if (mk->text[0]) {
+                double text_y = plot_y + 34 + (m % 4) * 13;
+                cairo_text_extents(cr, mk->text, &extents);
+                cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.6);
+                cairo_rectangle(cr, x - 1, text_y - 10, extents.x_advance + 2, 13);
+                cairo_fill(cr);
+                cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+                cairo_move_to(cr, x, text_y);
+                cairo_show_text(cr, mk->text);
+            }
+        }
+
+        // Draw red center frequency marker line or arrow
+        int center_bin = size / 2;
+        cairo_set_source_rgb(cr, 1.0, 0.0, 0.0);
+
+        if (center_bin >= start_bin && center_bin < end_bin) {
+            // Center is visible - draw vertical line
+            double marker_x = plot_x + (double)(center_bin - start_bin) / (visible_bins - 1) * plot_width;
+            cairo_set_line_width(cr, 2.0);
+            cairo_move_to(cr, marker_x, plot_y);
+            cairo_line_to(cr, marker_x, plot_y + plot_height);
+            cairo_stroke(cr);
+        } else {
+            // Center is off-screen - draw arrow pointing toward it
+            double arrow_size = 12.0;
+            double arrow_y = plot_y + plot_height / 2;
+
+            if (center_bin < start_bin) {
+                // Tuned frequency is to the left - draw left arrow
+                double arrow_x = plot_x + 5;
+                cairo_move_to(cr, arrow_x + arrow_size, arrow_y - arrow_size / 2);
+                cairo_line_to(cr, arrow_x, arrow_y);
+                cairo_line_to(cr, arrow_x + arrow_size, arrow_y + arrow_size / 2);
+                cairo_close_path(cr);
+                cairo_fill(cr);
+            } else {
+                // Tuned frequency is to the right - draw right arrow
+                double arrow_x = plot_x + plot_width - 5;
+                cairo_move_to(cr, arrow_x - arrow_size, arrow_y - arrow_size / 2);
+                cairo_line_to(cr, arrow_x, arrow_y);
+                cairo_line_to(cr, arrow_x - arrow_size, arrow_y + arrow_size / 2);
+                cairo_close_path(cr);
+                cairo_fill(cr);
+            }
+        }
+    }
+
+    // Draw overlay (frequency and mode) with transparent background - centered in plot area
+    if (view->overlay_freq[0] != '\0' || view->overlay_mode[0] != '\0') {
+        char overlay_text[64];
+        snprintf(overlay_text, sizeof(overlay_text), "%s  %s",
+                 view->overlay_freq[0] ? view->overlay_freq : "",
+                 view->overlay_mode[0] ? view->overlay_mode : "");
+
+        // Set up font
+        cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+        cairo_set_font_size(cr, 18);
+
+        // Measure text
+        cairo_text_extents_t extents;
+        cairo_text_extents(cr, overlay_text, &extents);
+
+        // Position centered in plot area, at top
+        double text_x = plot_x + (plot_width - extents.width) / 2;
+        double padding = 4;
+        double text_y = plot_y + extents.height + padding * 2;
+
+        // Draw semi-transparent background
+        cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.6);
+        cairo_rectangle(cr,
+                        text_x - padding,
+                        text_y - extents.height - padding,
+                        extents.width + padding * 2,
+                        extents.height + padding * 2);
+        cairo_fill(cr);
+
+        // Draw text in bright cyan
+        cairo_set_source_rgba(cr, 0.0, 1.0, 1.0, 1.0);
+        cairo_move_to(cr, text_x, text_y);
+        cairo_show_text(cr, overlay_text);
+    }
+
+    // Draw info overlay (one line per '\n') in the top-left corner of the plot
+    if (view->info_text[0] != '\0') {
+        cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+        cairo_set_font_size(cr, 11);
+
+        gchar **lines = g_strsplit(view->info_text, "\n", -1);
+
+        // Measure block size
+        double line_height = 13;
+        double block_width = 0;
+        int line_count = 0;
+        for (int i = 0; lines[i]; i++) {
+            cairo_text_extents_t extents;
+            cairo_text_extents(cr, lines[i], &extents);
+            if (extents.x_advance > block_width) block_width = extents.x_advance;
+            line_count++;
+        }
+
+        double padding = 4;
+        double box_x = plot_x + 5;
+        double box_y = plot_y + 5;
+        cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.7);
+        cairo_rectangle(cr, box_x, box_y, block_width + padding * 2, line_count * line_height + padding * 2);
+        cairo_fill(cr);
+
+        // Draw text in yellow
+        cairo_set_source_rgba(cr, 1.0, 1.0, 0.0, 1.0);
+        for (int i = 0; lines[i]; i++) {
+            cairo_move_to(cr, box_x + padding, box_y + padding + (i + 1) * line_height - 3);
+            cairo_show_text(cr, lines[i]);
+        }
+        g_strfreev(lines);
+    }
+}
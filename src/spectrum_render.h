@@ -0,0 +1,58 @@
+#ifndef SPECTRUM_RENDER_H
+#define SPECTRUM_RENDER_H
+
+#include <stdbool.h>
+#include <cairo.h>
+#include "app_state.h"
+#include "bandplan.h"
+
+// Cairo rendering of the spectrum display, independent of GTK so it can
+// run on any surface (SpectrumWidget draws through it, benchmarks use an
+// offscreen image surface)
+
+// Maximum number of signal markers
+#define SPECTRUM_MAX_MARKERS 128
+
+// Decoded text shown under a marker (most recent characters)
+#define SPECTRUM_MARKER_TEXT_LEN 16
+
+// Detected-signal marker (positions in spectrum data bins)
+typedef struct {
+    float center_bin;
+    float width_bins;
+    float snr_db;
+    char text[SPECTRUM_MARKER_TEXT_LEN];  // Decoded text, empty for none
+} spectrum_marker_t;
+
+// Everything the spectrum display shows apart from the data itself
+typedef struct {
+    float min_db;
+    float max_db;
+    int center_freq_hz;
+    int sample_rate;
+    int zoom_level;  // 1, 2, 4, 8, 16 = horizontal zoom factor
+    int pan_offset;  // Bin offset from center (only effective when zoom > 1)
+    bool zoom_fft;   // Data already covers the zoomed span
+
+    // Overlay text
+    char overlay_freq[32];
+    char overlay_mode[16];
+    char info_text[1536];  // Multi-line info overlay (diagnostics)
+
+    // Detected-signal markers
+    spectrum_marker_t markers[SPECTRUM_MAX_MARKERS];
+    int marker_count;
+
+    // Band overlay
+    const bandplan_t *bandplan;
+} spectrum_view_t;
+
+// Initialize view to defaults (-120..0 dB, no zoom, no overlays)
+void spectrum_view_init(spectrum_view_t *view);
+
+// Draw axes, bands, spectrum trace, markers and overlays into a
+// width x height area (spectrum_db may be NULL before data arrives)
+void spectrum_render(cairo_t *cr, int width, int height, const spectrum_view_t *view,
+                     const float *spectrum_db, int size);
+
+#endif // SPECTRUM_RENDER_H
@@ -0,0 +1,437 @@
+#define _GNU_SOURCE  // pipe2, accept4
+#include "spectrum_server.h"
+#include "mono_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <poll.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// How long poll waits before re-checking for shutdown
+#define SERVER_POLL_MS 200
+
+// Radios with their own sequence counter
+#define SERVER_MAX_RADIOS 8
+
+// One quantized spectrum, shared by every client queue that holds it
+typedef struct {
+    atomic_int refs;
+    size_t length;
+    uint8_t data[];
+} spectrum_frame_t;
+
+// Drop-oldest queue of one radio's frames for one client
+typedef struct {
+    spectrum_frame_t *frames[SPECTRUM_SERVER_QUEUE_FRAMES];
+    int head;
+    int count;
+    uint64_t last_queued_ns;
+} frame_queue_t;
+
+typedef struct {
+    bool active;
+    int fd;
+
+    // Shared with the publisher (under server->mutex); one queue and one
+    // rate limit per radio, so a busy pane neither evicts nor starves
+    // another pane's frames
+    frame_queue_t queues[SERVER_MAX_RADIOS];
+    int queued;                // Frames in all queues
+    int next_radio;            // Queue client_write() tries first
+    uint64_t min_interval_ns;  // From "rate <fps>", 0 = every frame
+
+    // Server thread only: frame being sent and how far
+    spectrum_frame_t *sending;
+    size_t sent;
+    char command[64];
+    size_t command_len;
+} spectrum_client_t;
+
+struct spectrum_server {
+    int port;
+    int listen_fd;
+    int wake_fd[2];  // Publisher -> server thread
+
+    pthread_mutex_t mutex;
+    spectrum_client_t clients[SPECTRUM_SERVER_MAX_CLIENTS];
+    uint32_t sequence[SERVER_MAX_RADIOS];  // Publisher only
+
+    atomic_int client_count;
+    atomic_long dropped;
+
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+};
+
+static void frame_unref(spectrum_frame_t *frame) {
+    if (frame && atomic_fetch_sub(&frame->refs, 1) == 1) free(frame);
+}
+
+static spectrum_frame_t *queue_pop(frame_queue_t *queue) {
+    spectrum_frame_t *frame = queue->frames[queue->head];
+    queue->head = (queue->head + 1) % SPECTRUM_SERVER_QUEUE_FRAMES;
+    queue->count--;
+    return frame;
+}
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_le64(uint8_t *p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static void put_float(uint8_t *p, float f) {
+    uint32_t v;
+    memcpy(&v, &f, sizeof(v));
+    put_le32(p, v);
+}
+
+spectrum_server_t *spectrum_server_new(int port) {
+    if (port <= 0 || port > 65535) return NULL;
+
+    spectrum_server_t *server = calloc(1, sizeof(spectrum_server_t));
+    if (!server) return NULL;
+    server->port = port;
+    server->listen_fd = -1;
+    server->wake_fd[0] = -1;
+    server->wake_fd[1] = -1;
+    pthread_mutex_init(&server->mutex, NULL);
+    return server;
+}
+
+void spectrum_server_free(spectrum_server_t *server) {
+    if (!server) return;
+    spectrum_server_stop(server);
+    pthread_mutex_destroy(&server->mutex);
+    free(server);
+}
+
+// Release a client's frames and socket (server thread, or after it stopped)
+static void client_close(spectrum_server_t *server, spectrum_client_t *client) {
+    pthread_mutex_lock(&server->mutex);
+    for (int r = 0; r < SERVER_MAX_RADIOS; r++) {
+        frame_queue_t *queue = &client->queues[r];
+        while (queue->count > 0) frame_unref(queue_pop(queue));
+    }
+    client->queued = 0;
+    client->active = false;
+    pthread_mutex_unlock(&server->mutex);
+
+    frame_unref(client->sending);
+    client->sending = NULL;
+    close(client->fd);
+    client->fd = -1;
+    atomic_fetch_sub(&server->client_count, 1);
+}
+
+static void client_accept(spectrum_server_t *server) {
+    struct sockaddr_in addr;
+    socklen_t addr_len = sizeof(addr);
+    int fd = accept4(server->listen_fd, (struct sockaddr *)&addr, &addr_len,
+                     SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) return;
+
+    spectrum_client_t *client = NULL;
+    for (int i = 0; i < SPECTRUM_SERVER_MAX_CLIENTS; i++) {
+        if (!server->clients[i].active) {
+            client = &server->clients[i];
+            break;
+        }
+    }
+    if (!client) {
+        fprintf(stderr, "Spectrum server: rejecting %s, %d clients connected\n",
+                inet_ntoa(addr.sin_addr), SPECTRUM_SERVER_MAX_CLIENTS);
+        close(fd);
+        return;
+    }
+
+    pthread_mutex_lock(&server->mutex);
+    memset(client, 0, sizeof(*client));
+    client->fd = fd;
+    client->active = true;
+    pthread_mutex_unlock(&server->mutex);
+    atomic_fetch_add(&server->client_count, 1);
+    fprintf(stderr, "Spectrum server: client %s connected\n", inet_ntoa(addr.sin_addr));
+}
+
+// Handle "rate <fps>" lines; anything else is ignored
+// Returns false if the client closed the connection
+static bool client_read(spectrum_server_t *server, spectrum_client_t *client) {
+    for (;;) {
+        char buf[64];
+        ssize_t n = recv(client->fd, buf, sizeof(buf), 0);
+        if (n == 0) return false;
+        if (n < 0) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+
+        for (ssize_t i = 0; i < n; i++) {
+            if (buf[i] != '\n') {
+                if (client->command_len < sizeof(client->command) - 1) {
+                    client->command[client->command_len++] = buf[i];
+                }
+                continue;
+            }
+            client->command[client->command_len] = '\0';
+            client->command_len = 0;
+
+            int fps;
+            if (sscanf(client->command, "rate %d", &fps) == 1) {
+                if (fps > SPECTRUM_SERVER_MAX_FPS) fps = SPECTRUM_SERVER_MAX_FPS;
+                pthread_mutex_lock(&server->mutex);
+                client->min_interval_ns = fps > 0 ? 1000000000ULL / fps : 0;
+                pthread_mutex_unlock(&server->mutex);
+            }
+        }
+    }
+}
+
+// Send queued frames until the socket would block, taking the radios'
+// queues in turn
+// Returns false on a send error
+static bool client_write(spectrum_server_t *server, spectrum_client_t *client) {
+    for (;;) {
+        if (!client->sending) {
+            pthread_mutex_lock(&server->mutex);
+            for (int i = 0; client->queued > 0 && i < SERVER_MAX_RADIOS; i++) {
+                int r = (client->next_radio + i) % SERVER_MAX_RADIOS;
+                if (client->queues[r].count == 0) continue;
+                client->sending = queue_pop(&client->queues[r]);
+                client->queued--;
+                client->next_radio = (r + 1) % SERVER_MAX_RADIOS;
+                break;
+            }
+            pthread_mutex_unlock(&server->mutex);
+            if (!client->sending) return true;
+            client->sent = 0;
+        }
+
+        spectrum_frame_t *frame = client->sending;
+        ssize_t n = send(client->fd, frame->data + client->sent, frame->length - client->sent,
+                         MSG_NOSIGNAL);
+        if (n < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        client->sent += (size_t)n;
+        if (client->sent == frame->length) {
+            frame_unref(frame);
+            client->sending = NULL;
+        }
+    }
+}
+
+static void *server_thread_func(void *user_data) {
+    spectrum_server_t *server = (spectrum_server_t *)user_data;
+    struct pollfd pfds[2 + SPECTRUM_SERVER_MAX_CLIENTS];
+    int slots[SPECTRUM_SERVER_MAX_CLIENTS];
+
+    while (atomic_load(&server->running)) {
+        pfds[0] = (struct pollfd){ .fd = server->listen_fd, .events = POLLIN };
+        pfds[1] = (struct pollfd){ .fd = server->wake_fd[0], .events = POLLIN };
+        int nfds = 2;
+
+        // Only ask for POLLOUT while a partial frame is stuck in the socket
+        for (int i = 0; i < SPECTRUM_SERVER_MAX_CLIENTS; i++) {
+            spectrum_client_t *client = &server->clients[i];
+            if (!client->active) continue;
+            short events = POLLIN;
+            if (client->sending) events |= POLLOUT;
+            slots[nfds - 2] = i;
+            pfds[nfds++] = (struct pollfd){ .fd = client->fd, .events = events };
+        }
+
+        if (poll(pfds, nfds, SERVER_POLL_MS) < 0 && errno != EINTR) break;
+
+        if (pfds[1].revents & POLLIN) {
+            char drain[64];
+            while (read(server->wake_fd[0], drain, sizeof(drain)) > 0) {}
+        }
+
+        for (int p = 2; p < nfds; p++) {
+            spectrum_client_t *client = &server->clients[slots[p - 2]];
+            bool ok = true;
+            if (pfds[p].revents & (POLLERR | POLLHUP | POLLNVAL)) ok = false;
+            if (ok && (pfds[p].revents & POLLIN)) ok = client_read(server, client);
+            if (ok) ok = client_write(server, client);
+            if (!ok) {
+                fprintf(stderr, "Spectrum server: client disconnected\n");
+                client_close(server, client);
+            }
+        }
+
+        if (pfds[0].revents & POLLIN) client_accept(server);
+    }
+    return NULL;
+}
+
+int spectrum_server_start(spectrum_server_t *server) {
+    if (!server) return -1;
+    if (atomic_load(&server->running)) return 0;
+
+    if (pipe2(server->wake_fd, O_NONBLOCK | O_CLOEXEC) != 0) {
+        fprintf(stderr, "Spectrum server: pipe failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    server->listen_fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0) {
+        fprintf(stderr, "Spectrum server: socket failed: %s\n", strerror(errno));
+        spectrum_server_stop(server);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(server->listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    // All interfaces: the viewers are on other machines
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)server->port);
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (bind(server->listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(server->listen_fd, 16) != 0) {
+        fprintf(stderr, "Spectrum server: cannot listen on port %d: %s\n", server->port,
+                strerror(errno));
+        spectrum_server_stop(server);
+        return -1;
+    }
+
+    atomic_store(&server->running, 1);
+    if (pthread_create(&server->thread, NULL, server_thread_func, server) != 0) {
+        fprintf(stderr, "Spectrum server: failed to create thread\n");
+        spectrum_server_stop(server);
+        return -1;
+    }
+    server->thread_started = 1;
+
+    fprintf(stderr, "Spectrum server: streaming on port %d\n", server->port);
+    return 0;
+}
+
+void spectrum_server_stop(spectrum_server_t *server) {
+    if (!server) return;
+
+    atomic_store(&server->running, 0);
+    if (server->thread_started) {
+        pthread_join(server->thread, NULL);
+        server->thread_started = 0;
+    }
+    for (int i = 0; i < SPECTRUM_SERVER_MAX_CLIENTS; i++) {
+        if (server->clients[i].active) client_close(server, &server->clients[i]);
+    }
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        server->listen_fd = -1;
+    }
+    for (int i = 0; i < 2; i++) {
+        if (server->wake_fd[i] >= 0) {
+            close(server->wake_fd[i]);
+            server->wake_fd[i] = -1;
+        }
+    }
+}
+
+// Build the shared frame: header plus one quantized byte per bin
+static spectrum_frame_t *frame_build(spectrum_server_t *server, int radio,
+                                     const spectrum_frame_meta_t *meta, const float *spectrum_db,
+                                     int bins) {
+    size_t length = SPECTRUM_SERVER_HEADER_SIZE + (size_t)bins;
+    spectrum_frame_t *frame = malloc(sizeof(spectrum_frame_t) + length);
+    if (!frame) return NULL;
+    atomic_init(&frame->refs, 1);  // Publisher's reference
+    frame->length = length;
+
+    // Capture time on the wall clock, for viewers on other machines
+    uint64_t wall_ns = (uint64_t)monotonic_to_realtime_ns(meta->timestamp_ns);
+
+    float step = (SPECTRUM_SERVER_DB_MAX - SPECTRUM_SERVER_DB_MIN) / 255.0f;
+
+    uint8_t *h = frame->data;
+    memcpy(h, SPECTRUM_SERVER_MAGIC, 4);
+    h[4] = SPECTRUM_SERVER_VERSION;
+    h[5] = (uint8_t)radio;
+    put_le16(h + 6, SPECTRUM_SERVER_HEADER_SIZE);
+    put_le32(h + 8, server->sequence[radio]++);
+    put_le32(h + 12, (uint32_t)bins);
+    put_le64(h + 16, (uint64_t)meta->center_hz);
+    put_le64(h + 24, wall_ns);
+    put_le32(h + 32, (uint32_t)meta->span_hz);
+    put_le32(h + 36, 0);
+    put_float(h + 40, SPECTRUM_SERVER_DB_MIN);
+    put_float(h + 44, step);
+
+    uint8_t *out = h + SPECTRUM_SERVER_HEADER_SIZE;
+    float scale = 1.0f / step;
+    for (int i = 0; i < bins; i++) {
+        float v = (spectrum_db[i] - SPECTRUM_SERVER_DB_MIN) * scale + 0.5f;
+        out[i] = v <= 0.0f ? 0 : v >= 255.0f ? 255 : (uint8_t)v;
+    }
+    return frame;
+}
+
+void spectrum_server_publish(spectrum_server_t *server, const spectrum_frame_meta_t *meta,
+                             const float *spectrum_db, int bins) {
+    if (!server || !meta || !spectrum_db || bins <= 0) return;
+    if (!atomic_load(&server->running) || atomic_load(&server->client_count) == 0) return;
+
+    int radio = meta->radio >= 0 && meta->radio < SERVER_MAX_RADIOS ? meta->radio : 0;
+    spectrum_frame_t *frame = frame_build(server, radio, meta, spectrum_db, bins);
+    if (!frame) return;
+
+    uint64_t now_ns = monotonic_ns();
+    int queued = 0;
+    pthread_mutex_lock(&server->mutex);
+    for (int i = 0; i < SPECTRUM_SERVER_MAX_CLIENTS; i++) {
+        spectrum_client_t *client = &server->clients[i];
+        if (!client->active) continue;
+        frame_queue_t *queue = &client->queues[radio];
+        if (client->min_interval_ns && now_ns - queue->last_queued_ns < client->min_interval_ns) {
+            continue;
+        }
+        queue->last_queued_ns = now_ns;
+
+        // Drop this radio's oldest frame for a client that fell behind
+        if (queue->count == SPECTRUM_SERVER_QUEUE_FRAMES) {
+            frame_unref(queue_pop(queue));
+            client->queued--;
+            atomic_fetch_add_explicit(&server->dropped, 1, memory_order_relaxed);
+        }
+        int tail = (queue->head + queue->count) % SPECTRUM_SERVER_QUEUE_FRAMES;
+        atomic_fetch_add_explicit(&frame->refs, 1, memory_order_relaxed);
+        queue->frames[tail] = frame;
+        queue->count++;
+        client->queued++;
+        queued++;
+    }
+    pthread_mutex_unlock(&server->mutex);
+    frame_unref(frame);
+
+    if (queued > 0) {
+        char one = 1;
+        ssize_t ignored = write(server->wake_fd[1], &one, 1);  // Full pipe: already awake
+        (void)ignored;
+    }
+}
+
+int spectrum_server_get_client_count(spectrum_server_t *server) {
+    return server ? atomic_load(&server->client_count) : 0;
+}
+
+long spectrum_server_get_dropped(spectrum_server_t *server) {
+    return server ? atomic_load_explicit(&server->dropped, memory_order_relaxed) : 0;
+}
@@ -0,0 +1,75 @@
+#ifndef SPECTRUM_SERVER_H
+#define SPECTRUM_SERVER_H
+
+#include <stdint.h>
+
+// Streams the spectra the display already computed to remote viewers
+// over TCP. Every spectrum is quantized once into a shared,
+// reference-counted frame; each client gets a pointer to it in a short
+// drop-oldest queue per radio, so extra clients cost a queue slot and a
+// send(). A client can lower its frame rate by sending "rate <fps>\n"
+// (applied to each radio separately).
+//
+// Frame layout (little-endian, 48-byte header, then one byte per bin):
+//   0  char[4]  magic "ELSP"
+//   4  uint8    version (1)
+//   5  uint8    radio index (pane)
+//   6  uint16   header length (48)
+//   8  uint32   sequence number (per radio)
+//   12 uint32   bins
+//   16 int64    centre frequency (Hz)
+//   24 uint64   capture time of the newest samples (ns since the Unix epoch)
+//   32 uint32   span (Hz)
+//   36 uint32   reserved (0)
+//   40 float32  dB of value 0
+//   44 float32  dB per step (dB = min + value * step)
+
+typedef struct spectrum_server spectrum_server_t;
+
+#define SPECTRUM_SERVER_MAGIC "ELSP"
+#define SPECTRUM_SERVER_VERSION 1
+#define SPECTRUM_SERVER_HEADER_SIZE 48
+
+// Quantization range: 0..255 covers -160..0 dB (~0.63 dB steps)
+#define SPECTRUM_SERVER_DB_MIN -160.0f
+#define SPECTRUM_SERVER_DB_MAX 0.0f
+
+// Connected viewers, queued frames per viewer and radio, highest
+// requestable rate
+#define SPECTRUM_SERVER_MAX_CLIENTS 64
+#define SPECTRUM_SERVER_QUEUE_FRAMES 4
+#define SPECTRUM_SERVER_MAX_FPS 60
+
+// Where a spectrum sits in frequency and time
+typedef struct {
+    int radio;              // Pane index
+    int64_t center_hz;      // Centre of the spectrum (after zoom/pan)
+    int span_hz;            // Width covered by all bins
+    uint64_t timestamp_ns;  // Capture time (CLOCK_MONOTONIC, 0 = now)
+} spectrum_frame_meta_t;
+
+// Create server for the given TCP port (not yet listening)
+spectrum_server_t *spectrum_server_new(int port);
+
+// Free server (stops the thread and releases queued frames)
+void spectrum_server_free(spectrum_server_t *server);
+
+// Listen on all interfaces and start the server thread
+// Returns 0 on success, -1 on error
+int spectrum_server_start(spectrum_server_t *server);
+
+// Stop the server thread and disconnect all clients
+void spectrum_server_stop(spectrum_server_t *server);
+
+// Queue a spectrum (dB per bin) for every client (GTK thread)
+// Does nothing if no client is connected
+void spectrum_server_publish(spectrum_server_t *server, const spectrum_frame_meta_t *meta,
+                             const float *spectrum_db, int bins);
+
+// Number of connected clients
+int spectrum_server_get_client_count(spectrum_server_t *server);
+
+// Frames dropped from client queues (slow clients) since start
+long spectrum_server_get_dropped(spectrum_server_t *server);
+
+#endif // SPECTRUM_SERVER_H
@@ -0,0 +1,251 @@
+#define _DEFAULT_SOURCE
+#include "spectrum_shm.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Slots start on cache lines so neighbouring slots never share one
+#define SHM_ALIGN 64
+
+struct spectrum_shm {
+    char name[64];
+    int fd;  // Held open with an exclusive flock while the writer lives
+    uint8_t *map;
+    size_t map_size;
+    spectrum_shm_header_t *header;
+};
+
+struct spectrum_shm_reader {
+    const uint8_t *map;
+    size_t map_size;
+    const spectrum_shm_header_t *header;
+    uint32_t next_frame;
+};
+
+static size_t align_up(size_t n) {
+    return (n + SHM_ALIGN - 1) & ~(size_t)(SHM_ALIGN - 1);
+}
+
+static spectrum_shm_slot_t *slot_at(const uint8_t *map, const spectrum_shm_header_t *header,
+                                    uint32_t frame) {
+    size_t index = (size_t)(frame % header->slot_count);
+    return (spectrum_shm_slot_t *)(map + header->header_size + index * header->slot_size);
+}
+
+// name exists: remove it if no writer holds its lock (the writer crashed)
+// Returns 0 if it was removed, -1 if a writer is alive or on error
+static int remove_stale(const char *name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return errno == ENOENT ? 0 : -1;
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Unlink only the object we locked, not one a writer created since
+    struct stat locked, current;
+    int same = 0;
+    int check = shm_open(name, O_RDONLY, 0);
+    if (check >= 0) {
+        same = fstat(fd, &locked) == 0 && fstat(check, &current) == 0 &&
+               locked.st_dev == current.st_dev && locked.st_ino == current.st_ino;
+        close(check);
+    }
+    if (same) shm_unlink(name);
+    close(fd);
+    return 0;
+}
+
+spectrum_shm_t *spectrum_shm_create(const char *name, int bins, int slots, int sample_rate) {
+    if (!name || name[0] != '/' || bins <= 0 || slots <= 0) return NULL;
+
+    spectrum_shm_t *shm = calloc(1, sizeof(spectrum_shm_t));
+    if (!shm) return NULL;
+    snprintf(shm->name, sizeof(shm->name), "%s", name);
+
+    size_t header_size = align_up(sizeof(spectrum_shm_header_t));
+    size_t slot_size = align_up(sizeof(spectrum_shm_slot_t) + sizeof(float) * (size_t)bins);
+    shm->map_size = header_size + slot_size * (size_t)slots;
+
+    // Never take over an object another instance is still writing: the
+    // writer holds an exclusive flock on it until it exits, so an object
+    // nobody has locked was left by a crash and is replaced
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0 && errno == EEXIST) {
+        if (remove_stale(name) != 0) {
+            fprintf(stderr, "Spectrum shm: %s is in use by another instance\n", name);
+            free(shm);
+            return NULL;
+        }
+        fprintf(stderr, "Spectrum shm: replacing stale %s\n", name);
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "Spectrum shm: cannot create %s: %s\n", name, strerror(errno));
+        free(shm);
+        return NULL;
+    }
+    if (flock(fd, LOCK_EX | LOCK_NB) != 0 || ftruncate(fd, (off_t)shm->map_size) != 0) {
+        fprintf(stderr, "Spectrum shm: cannot lock and size %s: %s\n", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        free(shm);
+        return NULL;
+    }
+    shm->map = mmap(NULL, shm->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (shm->map == MAP_FAILED) {
+        fprintf(stderr, "Spectrum shm: cannot map %s: %s\n", name, strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        free(shm);
+        return NULL;
+    }
+    shm->fd = fd;
+
+    // ftruncate zero-fills: every slot starts at seq 0, frame 0
+    spectrum_shm_header_t *header = (spectrum_shm_header_t *)shm->map;
+    header->version = SPECTRUM_SHM_VERSION;
+    header->header_size = (uint32_t)header_size;
+    header->slot_size = (uint32_t)slot_size;
+    header->slot_count = (uint32_t)slots;
+    header->bins = (uint32_t)bins;
+    header->sample_rate = (uint32_t)sample_rate;
+    atomic_store_explicit(&header->frames_written, 0, memory_order_relaxed);
+    // Readers check the magic last
+    atomic_thread_fence(memory_order_release);
+    header->magic = SPECTRUM_SHM_MAGIC;
+    shm->header = header;
+
+    fprintf(stderr, "Spectrum shm: %s, %d slots of %d bins\n", name, slots, bins);
+    return shm;
+}
+
+void spectrum_shm_free(spectrum_shm_t *shm) {
+    if (!shm) return;
+    munmap(shm->map, shm->map_size);
+    shm_unlink(shm->name);
+    close(shm->fd);
+    free(shm);
+}
+
+void spectrum_shm_write(spectrum_shm_t *shm, const float *spectrum_db,
+                        const spectrum_shm_frame_t *meta) {
+    if (!shm || !spectrum_db) return;
+
+    spectrum_shm_header_t *header = shm->header;
+    uint32_t frame = atomic_load_explicit(&header->frames_written, memory_order_relaxed);
+    spectrum_shm_slot_t *slot = slot_at(shm->map, header, frame);
+
+    // Seqlock write: odd sequence, payload, even sequence
+    uint32_t seq = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+    atomic_store_explicit(&slot->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->frame = frame;
+    slot->timestamp_ns = meta ? meta->timestamp_ns : 0;
+    slot->center_hz = meta ? meta->center_hz : 0;
+    slot->span_hz = meta ? meta->span_hz : 0;
+    slot->flags = 0;
+    memcpy(slot + 1, spectrum_db, sizeof(float) * header->bins);
+
+    atomic_store_explicit(&slot->seq, seq + 2, memory_order_release);
+    atomic_store_explicit(&header->frames_written, frame + 1, memory_order_release);
+}
+
+spectrum_shm_reader_t *spectrum_shm_reader_open(const char *name) {
+    if (!name) return NULL;
+
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) return NULL;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(spectrum_shm_header_t)) {
+        close(fd);
+        return NULL;
+    }
+    const uint8_t *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    const spectrum_shm_header_t *header = (const spectrum_shm_header_t *)map;
+    bool valid = header->magic == SPECTRUM_SHM_MAGIC;
+    atomic_thread_fence(memory_order_acquire);
+    valid = valid && header->version == SPECTRUM_SHM_VERSION && header->slot_count > 0 &&
+            header->slot_size >= sizeof(spectrum_shm_slot_t) + sizeof(float) * header->bins &&
+            header->header_size + (size_t)header->slot_size * header->slot_count <=
+                (size_t)st.st_size;
+    if (!valid) {
+        munmap((void *)map, (size_t)st.st_size);
+        return NULL;
+    }
+
+    spectrum_shm_reader_t *reader = calloc(1, sizeof(spectrum_shm_reader_t));
+    if (!reader) {
+        munmap((void *)map, (size_t)st.st_size);
+        return NULL;
+    }
+    reader->map = map;
+    reader->map_size = (size_t)st.st_size;
+    reader->header = header;
+    reader->next_frame = atomic_load_explicit(
+        &((spectrum_shm_header_t *)header)->frames_written, memory_order_acquire);
+    return reader;
+}
+
+void spectrum_shm_reader_close(spectrum_shm_reader_t *reader) {
+    if (!reader) return;
+    munmap((void *)reader->map, reader->map_size);
+    free(reader);
+}
+
+int spectrum_shm_reader_get_bins(spectrum_shm_reader_t *reader) {
+    return reader ? (int)reader->header->bins : 0;
+}
+
+int spectrum_shm_reader_get_sample_rate(spectrum_shm_reader_t *reader) {
+    return reader ? (int)reader->header->sample_rate : 0;
+}
+
+int spectrum_shm_reader_next(spectrum_shm_reader_t *reader, float *out,
+                             spectrum_shm_frame_t *meta, uint64_t *lost) {
+    if (!reader || !out) return 0;
+
+    spectrum_shm_header_t *header = (spectrum_shm_header_t *)reader->header;
+    uint32_t slots = header->slot_count;
+
+    for (;;) {
+        uint32_t written = atomic_load_explicit(&header->frames_written, memory_order_acquire);
+        uint32_t behind = written - reader->next_frame;
+        if (behind == 0 || behind > INT32_MAX) return 0;
+
+        // Lapped: the oldest frame still in the ring is written - slots
+        // (and the writer may be overwriting it right now)
+        if (behind >= slots) {
+            uint32_t oldest = written - slots + 1;
+            if (lost) *lost += oldest - reader->next_frame;
+            reader->next_frame = oldest;
+        }
+
+        spectrum_shm_slot_t *slot = slot_at(reader->map, header, reader->next_frame);
+        uint32_t seq1 = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        if (seq1 & 1) continue;  // Writer inside: the frame is being replaced
+
+        uint32_t frame = slot->frame;
+        spectrum_shm_frame_t copy = { frame, slot->timestamp_ns, slot->center_hz, slot->span_hz };
+        memcpy(out, slot + 1, sizeof(float) * header->bins);
+
+        atomic_thread_fence(memory_order_acquire);
+        uint32_t seq2 = atomic_load_explicit(&slot->seq, memory_order_relaxed);
+        if (seq1 != seq2 || frame != reader->next_frame) continue;  // Torn or overwritten
+
+        reader->next_frame++;
+        if (meta) *meta = copy;
+        return 1;
+    }
+}
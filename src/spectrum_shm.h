@@ -0,0 +1,87 @@
+#ifndef SPECTRUM_SHM_H
+#define SPECTRUM_SHM_H
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Shared-memory spectrum ring for local consumers (plugins, decoders).
+// The DSP thread writes every spectrum into the next of N slots of a
+// POSIX shm object; each slot is guarded by its own sequence counter
+// (seqlock), so readers never block the writer, never see a torn frame
+// and need no system call per frame. A reader that falls more than N
+// frames behind skips ahead and is told how many it lost.
+//
+// Layout: spectrum_shm_header_t, then slot_count slots of slot_size
+// bytes at header_size + i * slot_size, each a spectrum_shm_slot_t
+// followed by bins floats (dB). Shared counters are 32-bit (readers map
+// the object read-only, and 64-bit atomics are not plain loads on 32-bit
+// ARM); frame numbers wrap and are compared by difference.
+
+#define SPECTRUM_SHM_MAGIC 0x50534C45u  // "ELSP" little-endian
+#define SPECTRUM_SHM_VERSION 1
+#define SPECTRUM_SHM_DEFAULT_SLOTS 64
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;   // Offset of slot 0
+    uint32_t slot_size;     // Bytes per slot, including its header
+    uint32_t slot_count;
+    uint32_t bins;          // Floats per spectrum
+    uint32_t sample_rate;   // Input sample rate (Hz)
+    _Atomic uint32_t frames_written;  // Frame number of the next write
+} spectrum_shm_header_t;
+
+typedef struct {
+    _Atomic uint32_t seq;   // Odd while the writer is inside the slot
+    uint32_t frame;         // Frame number held by the slot
+    uint64_t timestamp_ns;  // Capture time of the newest samples (CLOCK_MONOTONIC)
+    int64_t center_hz;      // Centre frequency of bin bins/2
+    uint32_t span_hz;       // Width covered by all bins
+    uint32_t flags;         // Reserved (0)
+} spectrum_shm_slot_t;
+
+// Metadata of one frame as seen by a reader
+typedef struct {
+    uint32_t frame;
+    uint64_t timestamp_ns;
+    int64_t center_hz;
+    uint32_t span_hz;
+} spectrum_shm_frame_t;
+
+typedef struct spectrum_shm spectrum_shm_t;
+typedef struct spectrum_shm_reader spectrum_shm_reader_t;
+
+// Writer: create the shm object name ("/elad-spectrum-0")
+// The writer holds an exclusive flock on the object while it lives; an
+// existing object without one (left by a crash) is unlinked and replaced
+// Returns NULL on error, including when another writer holds name
+spectrum_shm_t *spectrum_shm_create(const char *name, int bins, int slots, int sample_rate);
+
+// Writer: unmap and unlink the object
+void spectrum_shm_free(spectrum_shm_t *shm);
+
+// Writer: publish one spectrum (single writer thread)
+void spectrum_shm_write(spectrum_shm_t *shm, const float *spectrum_db,
+                        const spectrum_shm_frame_t *meta);
+
+// Reader: map an existing object read-only, starting at the newest frame
+// Returns NULL if it does not exist or has an unknown layout
+spectrum_shm_reader_t *spectrum_shm_reader_open(const char *name);
+
+// Reader: unmap
+void spectrum_shm_reader_close(spectrum_shm_reader_t *reader);
+
+// Reader: geometry
+int spectrum_shm_reader_get_bins(spectrum_shm_reader_t *reader);
+int spectrum_shm_reader_get_sample_rate(spectrum_shm_reader_t *reader);
+
+// Reader: copy the next unread frame into out (bins floats)
+// Returns 1 if a frame was copied, 0 if there is none yet
+// If the writer lapped the reader, *lost (may be NULL) is increased by
+// the number of frames skipped
+int spectrum_shm_reader_next(spectrum_shm_reader_t *reader, float *out,
+                             spectrum_shm_frame_t *meta, uint64_t *lost);
+
+#endif // SPECTRUM_SHM_H
@@ -1,7 +1,7 @@
 #include "spectrum_widget.h"
+#include "perf_trace.h"
 #include <string.h>
 #include <stdio.h>
-#include <math.h>
 
 struct _SpectrumWidget {
     GtkDrawingArea parent_instance;
@@ -11,298 +11,21 @@ struct _SpectrumWidget {
     float *spectrum_db;
     int spectrum_size;
 
-    // Display parameters
-    float min_db;
-    float max_db;
-    int center_freq_hz;
-    int sample_rate;
-    int zoom_level;  // 1, 2, 4, 8 = horizontal zoom factor
-    int pan_offset;  // Bin offset from center (only effective when zoom > 1)
-
-    // Overlay text
-    char overlay_freq[32];
-    char overlay_mode[16];
-
-    // Band overlay
-    const bandplan_t *bandplan;
+    // Display parameters, overlays and markers (also protected by mutex)
+    spectrum_view_t view;
 };
 
 G_DEFINE_TYPE(SpectrumWidget, spectrum_widget, GTK_TYPE_DRAWING_AREA)
 
-// Margins for axis labels
-#define MARGIN_LEFT 55
-#define MARGIN_BOTTOM 20
-
 static void spectrum_widget_draw(GtkDrawingArea *area, cairo_t *cr,
                                   int width, int height, gpointer user_data G_GNUC_UNUSED) {
     SpectrumWidget *self = SPECTRUM_WIDGET(area);
 
-    // Black background
-    cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
-    cairo_paint(cr);
-
-    // Calculate plot area (inside margins)
-    int plot_x = MARGIN_LEFT;
-    int plot_y = 0;
-    int plot_width = width - MARGIN_LEFT;
-    int plot_height = height - MARGIN_BOTTOM;
-
-    if (plot_width <= 0 || plot_height <= 0) return;
-
-    // Lock data for reading
+    PERF_SPAN_BEGIN(draw_start);
     g_mutex_lock(&self->data_mutex);
-
-    // Draw band overlays on x-axis (frequency axis at bottom)
-    // Note: Use FFT_SIZE constant instead of spectrum_size so bands draw before data arrives
-    if (self->bandplan && self->bandplan->count > 0 && self->sample_rate > 0) {
-        // Calculate visible frequency range
-        double freq_span = self->sample_rate / self->zoom_level;
-        double hz_per_bin = (double)self->sample_rate / FFT_SIZE;
-        double pan_hz = self->pan_offset * hz_per_bin;
-        int64_t freq_start = (int64_t)(self->center_freq_hz - freq_span / 2 + pan_hz);
-        int64_t freq_end = (int64_t)(self->center_freq_hz + freq_span / 2 + pan_hz);
-
-        // Find visible bands
-        int visible_indices[32];
-        int num_visible = bandplan_find_visible(self->bandplan, freq_start, freq_end,
-                                                 visible_indices, 32);
-
-        // Draw each visible band as colored rectangle on x-axis
-        for (int i = 0; i < num_visible; i++) {
-            const band_entry_t *band = &self->bandplan->bands[visible_indices[i]];
-
-            // Set color based on band type
-            switch (band->tag) {
-                case BAND_TAG_HAMRADIO:
-                    cairo_set_source_rgba(cr, 0.0, 0.8, 0.0, 0.6);  // Green
-                    break;
-                case BAND_TAG_BROADCAST:
-                    cairo_set_source_rgba(cr, 1.0, 0.5, 0.0, 0.6);  // Orange
-                    break;
-                default:
-                    cairo_set_source_rgba(cr, 0.5, 0.5, 0.5, 0.4);  // Gray for other bands
-                    break;
-            }
-
-            // Convert band frequencies to pixel coordinates
-            double band_start_x = plot_x + ((double)(band->lower_bound - freq_start) / freq_span) * plot_width;
-            double band_end_x = plot_x + ((double)(band->upper_bound - freq_start) / freq_span) * plot_width;
-
-            // Clamp to plot area boundaries
-            if (band_start_x < plot_x) band_start_x = plot_x;
-            if (band_end_x > plot_x + plot_width) band_end_x = plot_x + plot_width;
-
-            // Draw rectangle on x-axis area (bottom margin)
-            if (band_end_x > band_start_x) {
-                cairo_rectangle(cr, band_start_x, plot_y + plot_height, band_end_x - band_start_x, MARGIN_BOTTOM);
-                cairo_fill(cr);
-            }
-        }
-    }
-
-    float range = self->max_db - self->min_db;
-    if (range < 1.0f) range = 1.0f;
-
-    // Set up font for labels
-    cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-    cairo_set_font_size(cr, 12);
-
-    // Draw grid lines in plot area
-    cairo_set_source_rgba(cr, 0.3, 0.3, 0.3, 1.0);
-    cairo_set_line_width(cr, 1.0);
-
-    int num_h_lines = 10;
-    int num_v_lines = 10;
-
-    // Horizontal grid lines (dB levels)
-    for (int i = 0; i <= num_h_lines; i++) {
-        double y = plot_y + (double)i / num_h_lines * plot_height;
-        cairo_move_to(cr, plot_x, y);
-        cairo_line_to(cr, plot_x + plot_width, y);
-    }
-
-    // Vertical grid lines
-    for (int i = 0; i <= num_v_lines; i++) {
-        double x = plot_x + (double)i / num_v_lines * plot_width;
-        cairo_move_to(cr, x, plot_y);
-        cairo_line_to(cr, x, plot_y + plot_height);
-    }
-    cairo_stroke(cr);
-
-    // Draw dB labels in left margin (right-justified)
-    cairo_set_source_rgba(cr, 0.7, 0.7, 0.7, 1.0);
-    for (int i = 0; i <= num_h_lines; i++) {
-        double y = plot_y + (double)i / num_h_lines * plot_height;
-        float db = self->max_db - (float)i / num_h_lines * range;
-        char label[16];
-        snprintf(label, sizeof(label), "%+.0f", db);
-        cairo_text_extents_t extents;
-        cairo_text_extents(cr, label, &extents);
-        cairo_move_to(cr, MARGIN_LEFT - extents.width - 5, y + 4);
-        cairo_show_text(cr, label);
-    }
-
-    // Draw frequency labels in bottom margin (adjusted for zoom and pan)
-    if (self->sample_rate > 0) {
-        double freq_span = self->sample_rate / self->zoom_level;
-        // Calculate pan offset in Hz
-        double hz_per_bin = (double)self->sample_rate / self->spectrum_size;
-        double pan_hz = self->pan_offset * hz_per_bin;
-        double freq_start = self->center_freq_hz - freq_span / 2 + pan_hz;
-
-        for (int i = 0; i <= num_v_lines; i++) {
-            double x = plot_x + (double)i / num_v_lines * plot_width;
-            double freq = freq_start + (double)i / num_v_lines * freq_span;
-
-            char label[32];
-            if (fabs(freq) >= 1e6) {
-                snprintf(label, sizeof(label), "%.3f", freq / 1e6);
-            } else if (fabs(freq) >= 1e3) {
-                snprintf(label, sizeof(label), "%.1fk", freq / 1e3);
-            } else {
-                snprintf(label, sizeof(label), "%.0f", freq);
-            }
-
-            // Center label under tick
-            cairo_text_extents_t extents;
-            cairo_text_extents(cr, label, &extents);
-            cairo_move_to(cr, x - extents.width / 2, height - 5);
-            cairo_show_text(cr, label);
-        }
-    }
-
-    // Draw spectrum in plot area (with zoom and pan support)
-    if (self->spectrum_db && self->spectrum_size > 0) {
-        // Calculate visible bin range based on zoom level and pan offset
-        int visible_bins = self->spectrum_size / self->zoom_level;
-        int max_pan = (self->spectrum_size - visible_bins) / 2;
-        int clamped_pan = self->pan_offset;
-        if (clamped_pan < -max_pan) clamped_pan = -max_pan;
-        if (clamped_pan > max_pan) clamped_pan = max_pan;
-        int start_bin = (self->spectrum_size - visible_bins) / 2 + clamped_pan;
-        int end_bin = start_bin + visible_bins;
-
-        // Draw spectrum line (cyan)
-        cairo_set_source_rgb(cr, 0.0, 1.0, 1.0);
-        cairo_set_line_width(cr, 1.0);
-
-        int first = 1;
-        for (int i = start_bin; i < end_bin; i++) {
-            double x = plot_x + (double)(i - start_bin) / (visible_bins - 1) * plot_width;
-            float db = self->spectrum_db[i];
-
-            // Clamp to display range
-            if (db < self->min_db) db = self->min_db;
-            if (db > self->max_db) db = self->max_db;
-
-            // Convert dB to y coordinate
-            double y = plot_y + (1.0 - (db - self->min_db) / range) * plot_height;
-
-            if (first) {
-                cairo_move_to(cr, x, y);
-                first = 0;
-            } else {
-                cairo_line_to(cr, x, y);
-            }
-        }
-        cairo_stroke(cr);
-
-        // Fill under the spectrum with transparent cyan
-        cairo_set_source_rgba(cr, 0.0, 1.0, 1.0, 0.2);
-        first = 1;
-        for (int i = start_bin; i < end_bin; i++) {
-            double x = plot_x + (double)(i - start_bin) / (visible_bins - 1) * plot_width;
-            float db = self->spectrum_db[i];
-
-            if (db < self->min_db) db = self->min_db;
-            if (db > self->max_db) db = self->max_db;
-
-            double y = plot_y + (1.0 - (db - self->min_db) / range) * plot_height;
-
-            if (first) {
-                cairo_move_to(cr, x, plot_y + plot_height);
-                cairo_line_to(cr, x, y);
-                first = 0;
-            } else {
-                cairo_line_to(cr, x, y);
-            }
-        }
-        cairo_line_to(cr, plot_x + plot_width, plot_y + plot_height);
-        cairo_close_path(cr);
-        cairo_fill(cr);
-
-        // Draw red center frequency marker line or arrow
-        int center_bin = self->spectrum_size / 2;
-        cairo_set_source_rgb(cr, 1.0, 0.0, 0.0);
-
-        if (center_bin >= start_bin && center_bin < end_bin) {
-            // Center is visible - draw vertical line
-            double marker_x = plot_x + (double)(center_bin - start_bin) / (visible_bins - 1) * plot_width;
-            cairo_set_line_width(cr, 2.0);
-            cairo_move_to(cr, marker_x, plot_y);
-            cairo_line_to(cr, marker_x, plot_y + plot_height);
-            cairo_stroke(cr);
-        } else {
-            // Center is off-screen - draw arrow pointing toward it
-            double arrow_size = 12.0;
-            double arrow_y = plot_y + plot_height / 2;
-
-            if (center_bin < start_bin) {
-                // Tuned frequency is to the left - draw left arrow
-                double arrow_x = plot_x + 5;
-                cairo_move_to(cr, arrow_x + arrow_size, arrow_y - arrow_size / 2);
-                cairo_line_to(cr, arrow_x, arrow_y);
-                cairo_line_to(cr, arrow_x + arrow_size, arrow_y + arrow_size / 2);
-                cairo_close_path(cr);
-                cairo_fill(cr);
-            } else {
-                // Tuned frequency is to the right - draw right arrow
-                double arrow_x = plot_x + plot_width - 5;
-                cairo_move_to(cr, arrow_x - arrow_size, arrow_y - arrow_size / 2);
-                cairo_line_to(cr, arrow_x, arrow_y);
-                cairo_line_to(cr, arrow_x - arrow_size, arrow_y + arrow_size / 2);
-                cairo_close_path(cr);
-                cairo_fill(cr);
-            }
-        }
-    }
-
-    // Draw overlay (frequency and mode) with transparent background - centered in plot area
-    if (self->overlay_freq[0] != '\0' || self->overlay_mode[0] != '\0') {
-        char overlay_text[64];
-        snprintf(overlay_text, sizeof(overlay_text), "%s  %s",
-                 self->overlay_freq[0] ? self->overlay_freq : "",
-                 self->overlay_mode[0] ? self->overlay_mode : "");
-
-        // Set up font
-        cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-        cairo_set_font_size(cr, 18);
-
-        // Measure text
-        cairo_text_extents_t extents;
-        cairo_text_extents(cr, overlay_text, &extents);
-
-        // Position centered in plot area, at top
-        double text_x = plot_x + (plot_width - extents.width) / 2;
-        double padding = 4;
-        double text_y = plot_y + extents.height + padding * 2;
-
-        // Draw semi-transparent background
-        cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 0.6);
-        cairo_rectangle(cr,
-                        text_x - padding,
-                        text_y - extents.height - padding,
-                        extents.width + padding * 2,
-                        extents.height + padding * 2);
-        cairo_fill(cr);
-
-        // Draw text in bright cyan
-        cairo_set_source_rgba(cr, 0.0, 1.0, 1.0, 1.0);
-        cairo_move_to(cr, text_x, text_y);
-        cairo_show_text(cr, overlay_text);
-    }
-
+    spectrum_render(cr, width, height, &self->view, self->spectrum_db, self->spectrum_size);
     g_mutex_unlock(&self->data_mutex);
+    PERF_SPAN_END(draw_start, PERF_STAGE_SPECTRUM_DRAW);
 }
 
 static void spectrum_widget_finalize(GObject *object) {
@@ -323,15 +46,7 @@ static void spectrum_widget_init(SpectrumWidget *self) {
     g_mutex_init(&self->data_mutex);
     self->spectrum_db = NULL;
     self->spectrum_size = 0;
-    self->min_db = -120.0f;
-    self->max_db = 0.0f;
-    self->center_freq_hz = 14200000;
-    self->sample_rate = DEFAULT_SAMPLE_RATE;
-    self->zoom_level = 1;
-    self->pan_offset = 0;
-    self->overlay_freq[0] = '\0';
-    self->overlay_mode[0] = '\0';
-    self->bandplan = NULL;
+    spectrum_view_init(&self->view);
 
     gtk_drawing_area_set_draw_func(GTK_DRAWING_AREA(self), spectrum_widget_draw, NULL, NULL);
 }
@@ -362,20 +77,20 @@ void spectrum_widget_update(SpectrumWidget *widget, const float *spectrum_db, in
 
 void spectrum_widget_set_range(SpectrumWidget *widget, float min_db, float max_db) {
     if (!widget) return;
-    widget->min_db = min_db;
-    widget->max_db = max_db;
+    widget->view.min_db = min_db;
+    widget->view.max_db = max_db;
     gtk_widget_queue_draw(GTK_WIDGET(widget));
 }
 
 void spectrum_widget_set_center_freq(SpectrumWidget *widget, int freq_hz) {
     if (!widget) return;
-    widget->center_freq_hz = freq_hz;
+    widget->view.center_freq_hz = freq_hz;
     gtk_widget_queue_draw(GTK_WIDGET(widget));
 }
 
 void spectrum_widget_set_sample_rate(SpectrumWidget *widget, int sample_rate) {
     if (!widget) return;
-    widget->sample_rate = sample_rate;
+    widget->view.sample_rate = sample_rate;
     gtk_widget_queue_draw(GTK_WIDGET(widget));
 }
 
@@ -385,15 +100,15 @@ void spectrum_widget_set_overlay(SpectrumWidget *widget, const char *freq_str, c
     g_mutex_lock(&widget->data_mutex);
 
     if (freq_str) {
-        snprintf(widget->overlay_freq, sizeof(widget->overlay_freq), "%s", freq_str);
+        snprintf(widget->view.overlay_freq, sizeof(widget->view.overlay_freq), "%s", freq_str);
     } else {
-        widget->overlay_freq[0] = '\0';
+        widget->view.overlay_freq[0] = '\0';
     }
 
     if (mode_str) {
-        snprintf(widget->overlay_mode, sizeof(widget->overlay_mode), "%s", mode_str);
+        snprintf(widget->view.overlay_mode, sizeof(widget->view.overlay_mode), "%s", mode_str);
     } else {
-        widget->overlay_mode[0] = '\0';
+        widget->view.overlay_mode[0] = '\0';
     }
 
     g_mutex_unlock(&widget->data_mutex);
@@ -401,33 +116,64 @@ void spectrum_widget_set_overlay(SpectrumWidget *widget, const char *freq_str, c
     gtk_widget_queue_draw(GTK_WIDGET(widget));
 }
 
+void spectrum_widget_set_info_overlay(SpectrumWidget *widget, const char *text) {
+    if (!widget) return;
+
+    g_mutex_lock(&widget->data_mutex);
+    snprintf(widget->view.info_text, sizeof(widget->view.info_text), "%s", text ? text : "");
+    g_mutex_unlock(&widget->data_mutex);
+
+    gtk_widget_queue_draw(GTK_WIDGET(widget));
+}
+
 void spectrum_widget_set_zoom(SpectrumWidget *widget, int zoom_level) {
     if (!widget) return;
     // Clamp to valid zoom levels
     if (zoom_level < 1) zoom_level = 1;
-    if (zoom_level > 8) zoom_level = 8;
-    widget->zoom_level = zoom_level;
+    if (zoom_level > 16) zoom_level = 16;
+    widget->view.zoom_level = zoom_level;
+    gtk_widget_queue_draw(GTK_WIDGET(widget));
+}
+
+void spectrum_widget_set_markers(SpectrumWidget *widget, const spectrum_marker_t *markers, int count) {
+    if (!widget) return;
+    if (!markers || count < 0) count = 0;
+    if (count > SPECTRUM_MAX_MARKERS) count = SPECTRUM_MAX_MARKERS;
+
+    g_mutex_lock(&widget->data_mutex);
+    if (count > 0) {
+        memcpy(widget->view.markers, markers, sizeof(spectrum_marker_t) * count);
+    }
+    widget->view.marker_count = count;
+    g_mutex_unlock(&widget->data_mutex);
+
+    gtk_widget_queue_draw(GTK_WIDGET(widget));
+}
+
+void spectrum_widget_set_zoom_fft(SpectrumWidget *widget, gboolean enabled) {
+    if (!widget) return;
+    widget->view.zoom_fft = enabled;
     gtk_widget_queue_draw(GTK_WIDGET(widget));
 }
 
 int spectrum_widget_get_zoom(SpectrumWidget *widget) {
     if (!widget) return 1;
-    return widget->zoom_level;
+    return widget->view.zoom_level;
 }
 
 void spectrum_widget_set_pan(SpectrumWidget *widget, int pan_offset) {
     if (!widget) return;
-    widget->pan_offset = pan_offset;
+    widget->view.pan_offset = pan_offset;
     gtk_widget_queue_draw(GTK_WIDGET(widget));
 }
 
 int spectrum_widget_get_pan(SpectrumWidget *widget) {
     if (!widget) return 0;
-    return widget->pan_offset;
+    return widget->view.pan_offset;
 }
 
 void spectrum_widget_set_bandplan(SpectrumWidget *widget, const bandplan_t *plan) {
     if (!widget) return;
-    widget->bandplan = plan;
+    widget->view.bandplan = plan;
     gtk_widget_queue_draw(GTK_WIDGET(widget));
 }
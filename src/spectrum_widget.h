@@ -4,6 +4,7 @@
 #include <gtk/gtk.h>
 #include "app_state.h"
 #include "bandplan.h"
+#include "spectrum_render.h"
 
 G_BEGIN_DECLS
 
@@ -28,9 +29,19 @@ void spectrum_widget_set_sample_rate(SpectrumWidget *widget, int sample_rate);
 // Set overlay text (frequency and mode) displayed on top of spectrum
 void spectrum_widget_set_overlay(SpectrumWidget *widget, const char *freq_str, const char *mode_str);
 
-// Set horizontal zoom level (1, 2, 4, 8 = divisor of displayed frequency span)
+// Set multi-line info text drawn in the top-left corner (NULL or "" hides it)
+void spectrum_widget_set_info_overlay(SpectrumWidget *widget, const char *text);
+
+// Set detected-signal markers (copied; count 0 clears them)
+void spectrum_widget_set_markers(SpectrumWidget *widget, const spectrum_marker_t *markers, int count);
+
+// Set horizontal zoom level (1, 2, 4, 8, 16 = divisor of displayed frequency span)
 void spectrum_widget_set_zoom(SpectrumWidget *widget, int zoom_level);
 
+// Zoom FFT mode: spectrum data already covers the zoomed span (DDC in the
+// DSP path) and is drawn in full instead of slicing the visible bins
+void spectrum_widget_set_zoom_fft(SpectrumWidget *widget, gboolean enabled);
+
 // Get current zoom level
 int spectrum_widget_get_zoom(SpectrumWidget *widget);
 
@@ -0,0 +1,186 @@
+#define _DEFAULT_SOURCE
+#include "synthetic_source.h"
+#include "app_state.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+// FDM-DUO stream layout: 32-bit I + 32-bit Q
+#define BYTES_PER_SAMPLE 8
+#define CHUNK_SAMPLES (USB_BUFFER_SIZE / BYTES_PER_SAMPLE)
+
+// Levels relative to full scale: noise around -80 dBFS per sample,
+// tone at -12 dBFS, so the burst stands far above the noise in one frame
+#define NOISE_AMPLITUDE 2.0e-4
+#define TONE_AMPLITUDE 0.25
+
+struct synthetic_source {
+    int sample_rate;
+    double tone_hz;
+    int64_t period_samples;
+    int64_t burst_samples;
+
+    uint8_t chunk[USB_BUFFER_SIZE];
+    uint32_t rng;
+
+    synthetic_source_callback_t callback;
+    void *callback_user_data;
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+
+    atomic_ullong burst_start_ns;
+    atomic_int burst_count;
+};
+
+static uint64_t timespec_ns(const struct timespec *ts) {
+    return (uint64_t)ts->tv_sec * 1000000000ULL + (uint64_t)ts->tv_nsec;
+}
+
+static struct timespec ns_timespec(uint64_t ns) {
+    struct timespec ts = { (time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL) };
+    return ts;
+}
+
+// Uniform noise in [-1, 1) (xorshift32)
+static inline double noise_sample(synthetic_source_t *src) {
+    uint32_t x = src->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    src->rng = x;
+    return (double)x / 2147483648.0 - 1.0;
+}
+
+static inline void write_le32(uint8_t *p, double value) {
+    int32_t v = (int32_t)lrint(value * 2147483647.0);
+    uint32_t u = (uint32_t)v;
+    p[0] = (uint8_t)u;
+    p[1] = (uint8_t)(u >> 8);
+    p[2] = (uint8_t)(u >> 16);
+    p[3] = (uint8_t)(u >> 24);
+}
+
+synthetic_source_t *synthetic_source_new(int sample_rate, double tone_hz,
+                                         int period_ms, int burst_ms) {
+    if (sample_rate <= 0 || period_ms <= 0 || burst_ms <= 0 || burst_ms >= period_ms) {
+        fprintf(stderr, "Synthetic: invalid parameters\n");
+        return NULL;
+    }
+    if (fabs(tone_hz) >= sample_rate / 2.0) {
+        fprintf(stderr, "Synthetic: tone %.0f Hz outside +/-%d Hz\n", tone_hz, sample_rate / 2);
+        return NULL;
+    }
+
+    synthetic_source_t *src = calloc(1, sizeof(synthetic_source_t));
+    if (!src) return NULL;
+
+    src->sample_rate = sample_rate;
+    src->tone_hz = tone_hz;
+    src->period_samples = (int64_t)sample_rate * period_ms / 1000;
+    src->burst_samples = (int64_t)sample_rate * burst_ms / 1000;
+    src->rng = 0x2545F491u;
+    return src;
+}
+
+void synthetic_source_free(synthetic_source_t *src) {
+    if (!src) return;
+    synthetic_source_stop(src);
+    free(src);
+}
+
+static void *synthetic_thread_func(void *user_data) {
+    synthetic_source_t *src = (synthetic_source_t *)user_data;
+
+    fprintf(stderr, "Synthetic source started (tone %+.0f Hz)\n", src->tone_hz);
+
+    // Sample n is "captured" at start_ns + n / sample_rate. The first burst
+    // starts half a period in, after the averaging has settled on noise
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    uint64_t start_ns = timespec_ns(&now);
+    int64_t n = 0;
+    int64_t phase_offset = src->period_samples / 2;
+    double omega = 2.0 * M_PI * src->tone_hz / src->sample_rate;
+
+    while (atomic_load(&src->running)) {
+        int64_t onset = -1;
+        for (int i = 0; i < CHUNK_SAMPLES; i++, n++) {
+            int64_t in_period = (n + phase_offset) % src->period_samples;
+            double re = NOISE_AMPLITUDE * noise_sample(src);
+            double im = NOISE_AMPLITUDE * noise_sample(src);
+            if (in_period < src->burst_samples) {
+                if (in_period == 0) onset = n;
+                // Phase from the absolute sample index keeps the tone continuous
+                double phase = omega * (double)(n % src->sample_rate);
+                re += TONE_AMPLITUDE * cos(phase);
+                im += TONE_AMPLITUDE * sin(phase);
+            }
+            write_le32(src->chunk + i * BYTES_PER_SAMPLE, re);
+            write_le32(src->chunk + i * BYTES_PER_SAMPLE + 4, im);
+        }
+
+        // A chunk is complete once its last sample has been captured
+        uint64_t due_ns = start_ns + (uint64_t)((double)n * 1e9 / src->sample_rate);
+        struct timespec due = ns_timespec(due_ns);
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &due, NULL);
+
+        if (onset >= 0) {
+            uint64_t onset_ns = start_ns + (uint64_t)((double)onset * 1e9 / src->sample_rate);
+            atomic_store(&src->burst_start_ns, onset_ns);
+            atomic_fetch_add(&src->burst_count, 1);
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        src->callback(src->chunk, USB_BUFFER_SIZE, timespec_ns(&now), src->callback_user_data);
+    }
+
+    fprintf(stderr, "Synthetic source stopped\n");
+    return NULL;
+}
+
+int synthetic_source_start(synthetic_source_t *src, synthetic_source_callback_t callback,
+                           void *user_data) {
+    if (!src || !callback) return -1;
+    if (src->thread_started) return 0;
+
+    src->callback = callback;
+    src->callback_user_data = user_data;
+    atomic_store(&src->running, 1);
+
+    if (pthread_create(&src->thread, NULL, synthetic_thread_func, src) != 0) {
+        fprintf(stderr, "Synthetic: Failed to create thread\n");
+        atomic_store(&src->running, 0);
+        return -1;
+    }
+    src->thread_started = 1;
+    return 0;
+}
+
+void synthetic_source_stop(synthetic_source_t *src) {
+    if (!src || !src->thread_started) return;
+
+    atomic_store(&src->running, 0);
+    pthread_join(src->thread, NULL);
+    src->thread_started = 0;
+}
+
+uint64_t synthetic_source_get_burst_start(synthetic_source_t *src) {
+    return src ? atomic_load(&src->burst_start_ns) : 0;
+}
+
+int synthetic_source_get_burst_count(synthetic_source_t *src) {
+    return src ? atomic_load(&src->burst_count) : 0;
+}
+
+double synthetic_source_get_tone_hz(synthetic_source_t *src) {
+    return src ? src->tone_hz : 0.0;
+}
+
+int synthetic_source_get_sample_rate(synthetic_source_t *src) {
+    return src ? src->sample_rate : 0;
+}
@@ -0,0 +1,49 @@
+#ifndef SYNTHETIC_SOURCE_H
+#define SYNTHETIC_SOURCE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Synthetic IQ source for latency self-tests: a real-time paced thread
+// producing noise with a periodic tone burst, in the FDM-DUO stream
+// format and USB transfer size. Chunks are timestamped like USB
+// completions (CLOCK_MONOTONIC when the last sample of the chunk is
+// "captured"), and the onset of every burst is published so the display
+// side can measure when it first shows up on screen.
+
+typedef struct synthetic_source synthetic_source_t;
+
+// Same layout and timestamp meaning as usb_sample_callback_t
+typedef void (*synthetic_source_callback_t)(const uint8_t *data, int length,
+                                            uint64_t timestamp_ns, void *user_data);
+
+// Create a source at sample_rate with a tone burst at tone_hz from the
+// centre, burst_ms long, repeating every period_ms
+// Returns NULL on error
+synthetic_source_t *synthetic_source_new(int sample_rate, double tone_hz,
+                                         int period_ms, int burst_ms);
+
+// Stop the thread and free the source
+void synthetic_source_free(synthetic_source_t *src);
+
+// Start the generator thread, delivering data to callback
+// Returns 0 on success, -1 on error
+int synthetic_source_start(synthetic_source_t *src, synthetic_source_callback_t callback,
+                           void *user_data);
+
+// Stop the generator thread (blocks until it exits)
+void synthetic_source_stop(synthetic_source_t *src);
+
+// Onset time of the latest delivered burst (CLOCK_MONOTONIC ns, 0 if none yet)
+uint64_t synthetic_source_get_burst_start(synthetic_source_t *src);
+
+// Number of bursts delivered so far
+int synthetic_source_get_burst_count(synthetic_source_t *src);
+
+// Tone offset from the centre in Hz
+double synthetic_source_get_tone_hz(synthetic_source_t *src);
+
+// Sample rate in Hz
+int synthetic_source_get_sample_rate(synthetic_source_t *src);
+
+#endif // SYNTHETIC_SOURCE_H
@@ -0,0 +1,361 @@
+#define _DEFAULT_SOURCE  // gmtime_r
+#include "tile_writer.h"
+#include "waterfall_render.h"
+#include "rt_sched.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/stat.h>
+#include <cairo.h>
+
+// Lines queued for the worker (about 4 s at the display rate, enough to
+// cover a PNG encode on a Pi Zero 2)
+#define TILE_QUEUE_LINES 128
+
+// A pause longer than this (radio unplugged, stream stopped) closes the tile
+#define TILE_GAP_NS (2 * 1000000000LL)
+
+#define NS_PER_SEC 1000000000LL
+
+typedef struct {
+    int64_t time_ns;
+    int64_t center_hz;
+    int span_hz;
+} tile_line_t;
+
+struct tile_writer {
+    char *dir;
+    int bins;
+    tile_writer_config_t config;
+
+    // Queue (under mutex); the worker renders the line at queue_tail
+    // outside the lock and releases it afterwards
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    float *queue_db;  // TILE_QUEUE_LINES * bins
+    tile_line_t queue[TILE_QUEUE_LINES];
+    int queue_head;
+    int queue_count;
+
+    atomic_long dropped;
+    atomic_long tiles;
+
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+
+    // Worker only: tile being rendered
+    cairo_surface_t *surface;  // width x capacity rows
+    int capacity;
+    int lines;
+    int64_t slot_ns;    // Start of the tile interval
+    int64_t first_ns;   // First and last line
+    int64_t last_ns;
+    int64_t center_hz;
+    int span_hz;
+    long dropped_at_open;
+
+    FILE *index;
+    bool index_empty;
+};
+
+// "2026-10-19T12:00:00.016Z"
+static void format_iso(int64_t time_ns, char *text, size_t size) {
+    time_t sec = (time_t)(time_ns / NS_PER_SEC);
+    struct tm tm;
+    gmtime_r(&sec, &tm);
+    size_t len = strftime(text, size, "%Y-%m-%dT%H:%M:%S", &tm);
+    snprintf(text + len, size - len, ".%03dZ", (int)(time_ns % NS_PER_SEC / 1000000));
+}
+
+// Open index.json for appending, creating it (or replacing an unreadable
+// one, kept as index.json.bad) as an empty array
+static int open_index(tile_writer_t *tw) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/index.json", tw->dir);
+
+    FILE *f = fopen(path, "r+");
+    if (f) {
+        char tail[2] = { 0, 0 };
+        long size = -1;
+        if (fseek(f, 0, SEEK_END) == 0) size = ftell(f);
+        if (size >= 4 && fseek(f, -2, SEEK_END) == 0 && fread(tail, 1, 2, f) == 2 &&
+            tail[0] == ']' && tail[1] == '\n') {
+            tw->index = f;
+            tw->index_empty = (size == 4);
+            return 0;
+        }
+        fclose(f);
+
+        char bad[PATH_MAX + 8];
+        snprintf(bad, sizeof(bad), "%s.bad", path);
+        fprintf(stderr, "Tiles: %s is not a tile index, moving it to %s\n", path, bad);
+        if (rename(path, bad) != 0) {
+            fprintf(stderr, "Tiles: Cannot rename %s: %s\n", path, strerror(errno));
+            return -1;
+        }
+    }
+
+    f = fopen(path, "w+");
+    if (!f) {
+        fprintf(stderr, "Tiles: Cannot create %s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    fputs("[\n]\n", f);
+    fflush(f);
+    tw->index = f;
+    tw->index_empty = true;
+    return 0;
+}
+
+// Append one entry, keeping the file a valid JSON array
+static void append_index(tile_writer_t *tw, const char *file, long dropped) {
+    char start[32], end[32];
+    format_iso(tw->first_ns, start, sizeof(start));
+    format_iso(tw->last_ns, end, sizeof(end));
+
+    // Overwrite the closing "]\n" (and the newline before it)
+    fseek(tw->index, tw->index_empty ? -2 : -3, SEEK_END);
+    fprintf(tw->index,
+            "%s{\"file\":\"%s\",\"format\":\"%s\",\"start\":\"%s\",\"end\":\"%s\","
+            "\"start_ns\":%lld,\"end_ns\":%lld,\"lines\":%d,\"width\":%d,\"height\":%d,"
+            "\"center_hz\":%lld,\"span_hz\":%d,\"start_hz\":%lld,\"stop_hz\":%lld,"
+            "\"min_db\":%.1f,\"max_db\":%.1f,\"dropped\":%ld}\n]\n",
+            tw->index_empty ? "" : ",\n", file,
+            tw->config.format == TILE_FORMAT_PNG ? "png" : "raw", start, end,
+            (long long)tw->first_ns, (long long)tw->last_ns, tw->lines, tw->config.width,
+            tw->lines, (long long)tw->center_hz, tw->span_hz,
+            (long long)(tw->center_hz - tw->span_hz / 2),
+            (long long)(tw->center_hz + tw->span_hz / 2),
+            tw->config.min_db, tw->config.max_db, dropped);
+    fflush(tw->index);
+    tw->index_empty = false;
+}
+
+static int write_raw(cairo_surface_t *surface, int lines, const char *path) {
+    FILE *f = fopen(path, "wb");
+    if (!f) return -1;
+
+    const unsigned char *data = cairo_image_surface_get_data(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+    size_t row_bytes = (size_t)cairo_image_surface_get_width(surface) * 4;
+    int result = 0;
+    for (int y = 0; y < lines && result == 0; y++) {
+        if (fwrite(data + (size_t)y * stride, 1, row_bytes, f) != row_bytes) result = -1;
+    }
+    if (fclose(f) != 0) result = -1;
+    return result;
+}
+
+// Write the rendered rows as a tile and index it; starts a new tile
+static void close_tile(tile_writer_t *tw) {
+    if (tw->lines == 0) return;
+
+    // Named after the first line, so early-closed tiles never collide
+    char name[64];
+    time_t sec = (time_t)(tw->first_ns / NS_PER_SEC);
+    struct tm tm;
+    gmtime_r(&sec, &tm);
+    size_t len = strftime(name, sizeof(name), "%Y%m%d-%H%M%S", &tm);
+    snprintf(name + len, sizeof(name) - len, "-%03d.%s",
+             (int)(tw->first_ns % NS_PER_SEC / 1000000),
+             tw->config.format == TILE_FORMAT_PNG ? "png" : "raw");
+
+    // Written under a temporary name, so readers never see partial tiles
+    char path[PATH_MAX], tmp[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", tw->dir, name);
+    snprintf(tmp, sizeof(tmp), "%s/.%s.tmp", tw->dir, name);
+
+    cairo_surface_flush(tw->surface);
+    int result;
+    if (tw->config.format == TILE_FORMAT_PNG) {
+        // View of the rows rendered so far
+        cairo_surface_t *tile = cairo_image_surface_create_for_data(
+            cairo_image_surface_get_data(tw->surface), CAIRO_FORMAT_RGB24, tw->config.width,
+            tw->lines, cairo_image_surface_get_stride(tw->surface));
+        result = cairo_surface_write_to_png(tile, tmp) == CAIRO_STATUS_SUCCESS ? 0 : -1;
+        cairo_surface_destroy(tile);
+    } else {
+        result = write_raw(tw->surface, tw->lines, tmp);
+    }
+
+    long dropped = atomic_load_explicit(&tw->dropped, memory_order_relaxed);
+    if (result == 0 && rename(tmp, path) == 0) {
+        append_index(tw, name, dropped - tw->dropped_at_open);
+        atomic_fetch_add(&tw->tiles, 1);
+    } else {
+        fprintf(stderr, "Tiles: Cannot write %s: %s\n", path, strerror(errno));
+        remove(tmp);
+    }
+    tw->lines = 0;
+}
+
+// Render one queued line into the current tile (worker thread)
+static void add_to_tile(tile_writer_t *tw, const float *db, const tile_line_t *line) {
+    int64_t tile_ns = (int64_t)tw->config.seconds * NS_PER_SEC;
+    int64_t slot_ns = line->time_ns - line->time_ns % tile_ns;
+
+    if (tw->lines > 0 &&
+        (slot_ns != tw->slot_ns || line->center_hz != tw->center_hz ||
+         line->span_hz != tw->span_hz || line->time_ns - tw->last_ns > TILE_GAP_NS ||
+         line->time_ns < tw->last_ns || tw->lines == tw->capacity)) {
+        close_tile(tw);
+    }
+
+    if (tw->lines == 0) {
+        tw->slot_ns = slot_ns;
+        tw->first_ns = line->time_ns;
+        tw->center_hz = line->center_hz;
+        tw->span_hz = line->span_hz;
+        tw->dropped_at_open = atomic_load_explicit(&tw->dropped, memory_order_relaxed);
+    }
+
+    waterfall_render_row(tw->surface, tw->lines, db, 0, tw->bins,
+                         tw->config.min_db, tw->config.max_db);
+    tw->lines++;
+    tw->last_ns = line->time_ns;
+}
+
+static void *worker_thread_func(void *arg) {
+    tile_writer_t *tw = (tile_writer_t *)arg;
+
+    // Only runs when nothing else wants the CPU
+    rt_thread_config_t config = { .cpu = -1, .policy = RT_POLICY_IDLE, .priority = 0 };
+    rt_sched_apply("tile-writer", &config);
+
+    pthread_mutex_lock(&tw->mutex);
+    for (;;) {
+        while (tw->queue_count == 0 && atomic_load(&tw->running)) {
+            pthread_cond_wait(&tw->cond, &tw->mutex);
+        }
+        if (tw->queue_count == 0) break;
+
+        int tail = (tw->queue_head - tw->queue_count + TILE_QUEUE_LINES) % TILE_QUEUE_LINES;
+        tile_line_t line = tw->queue[tail];
+        pthread_mutex_unlock(&tw->mutex);
+
+        add_to_tile(tw, tw->queue_db + (size_t)tail * tw->bins, &line);
+
+        pthread_mutex_lock(&tw->mutex);
+        tw->queue_count--;
+    }
+    pthread_mutex_unlock(&tw->mutex);
+
+    close_tile(tw);
+    return NULL;
+}
+
+tile_writer_t *tile_writer_new(const char *dir, int bins, const tile_writer_config_t *config) {
+    tile_writer_config_t defaults = TILE_WRITER_CONFIG_DEFAULT;
+    if (!config) config = &defaults;
+    if (!dir || bins <= 0) return NULL;
+    if (config->width <= 0 || config->seconds <= 0) {
+        fprintf(stderr, "Tiles: Invalid tile size %d px x %d s\n", config->width, config->seconds);
+        return NULL;
+    }
+
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "Tiles: Cannot create %s: %s\n", dir, strerror(errno));
+        return NULL;
+    }
+
+    tile_writer_t *tw = calloc(1, sizeof(tile_writer_t));
+    if (!tw) return NULL;
+
+    tw->dir = strdup(dir);
+    tw->bins = bins;
+    tw->config = *config;
+    tw->capacity = config->seconds * TILE_WRITER_MAX_LINE_RATE;
+    tw->queue_db = malloc(sizeof(float) * TILE_QUEUE_LINES * bins);
+    tw->surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, config->width, tw->capacity);
+    pthread_mutex_init(&tw->mutex, NULL);
+    pthread_cond_init(&tw->cond, NULL);
+    atomic_init(&tw->dropped, 0);
+    atomic_init(&tw->tiles, 0);
+    atomic_init(&tw->running, 0);
+
+    if (!tw->dir || !tw->queue_db ||
+        cairo_surface_status(tw->surface) != CAIRO_STATUS_SUCCESS || open_index(tw) != 0) {
+        fprintf(stderr, "Tiles: Failed to set up %s\n", dir);
+        tile_writer_free(tw);
+        return NULL;
+    }
+
+    fprintf(stderr, "Tiles: Writing %d s %s tiles (%d px wide) to %s\n", config->seconds,
+            config->format == TILE_FORMAT_PNG ? "PNG" : "raw", config->width, dir);
+    return tw;
+}
+
+void tile_writer_free(tile_writer_t *tw) {
+    if (!tw) return;
+
+    tile_writer_stop(tw);
+    if (tw->index) fclose(tw->index);
+    if (tw->surface) cairo_surface_destroy(tw->surface);
+    pthread_mutex_destroy(&tw->mutex);
+    pthread_cond_destroy(&tw->cond);
+    free(tw->queue_db);
+    free(tw->dir);
+    free(tw);
+}
+
+int tile_writer_start(tile_writer_t *tw) {
+    if (!tw) return -1;
+    if (atomic_load(&tw->running)) return 0;
+
+    atomic_store(&tw->running, 1);
+    if (pthread_create(&tw->thread, NULL, worker_thread_func, tw) != 0) {
+        fprintf(stderr, "Tiles: Failed to create worker thread\n");
+        atomic_store(&tw->running, 0);
+        return -1;
+    }
+    tw->thread_started = 1;
+    return 0;
+}
+
+void tile_writer_stop(tile_writer_t *tw) {
+    if (!tw || !tw->thread_started) return;
+
+    pthread_mutex_lock(&tw->mutex);
+    atomic_store(&tw->running, 0);
+    pthread_cond_signal(&tw->cond);
+    pthread_mutex_unlock(&tw->mutex);
+
+    pthread_join(tw->thread, NULL);
+    tw->thread_started = 0;
+}
+
+int tile_writer_add_line(tile_writer_t *tw, const float *spectrum_db, int64_t time_ns,
+                         int64_t center_hz, int span_hz) {
+    if (!tw || !spectrum_db || time_ns < 0) return -1;
+
+    pthread_mutex_lock(&tw->mutex);
+    if (!atomic_load(&tw->running) || tw->queue_count == TILE_QUEUE_LINES) {
+        pthread_mutex_unlock(&tw->mutex);
+        atomic_fetch_add_explicit(&tw->dropped, 1, memory_order_relaxed);
+        return -1;
+    }
+
+    int head = tw->queue_head;
+    memcpy(tw->queue_db + (size_t)head * tw->bins, spectrum_db, sizeof(float) * tw->bins);
+    tw->queue[head] = (tile_line_t){ time_ns, center_hz, span_hz };
+    tw->queue_head = (head + 1) % TILE_QUEUE_LINES;
+    tw->queue_count++;
+    pthread_cond_signal(&tw->cond);
+    pthread_mutex_unlock(&tw->mutex);
+    return 0;
+}
+
+long tile_writer_get_dropped(tile_writer_t *tw) {
+    return tw ? atomic_load_explicit(&tw->dropped, memory_order_relaxed) : 0;
+}
+
+long tile_writer_get_tiles(tile_writer_t *tw) {
+    return tw ? atomic_load(&tw->tiles) : 0;
+}
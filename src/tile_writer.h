@@ -0,0 +1,75 @@
+#ifndef TILE_WRITER_H
+#define TILE_WRITER_H
+
+#include <stdint.h>
+
+// Waterfall tiles on disk for headless monitoring.
+//
+// Spectrum lines are queued by the caller and rendered by a SCHED_IDLE
+// worker thread with the waterfall palette (waterfall_render.h) into an
+// offscreen image, one row per line, oldest line at the top. Tiles cover
+// a fixed wall-clock interval (aligned to multiples of its duration) and
+// are closed early when the frequency or span changes, the stream pauses
+// or the image is full. Each finished tile is written as PNG or raw
+// pixels and appended to index.json in the tile directory:
+//   [
+//   {"file":"20261019-120000-016.png","format":"png","start":"...Z","end":"...Z",
+//    "start_ns":...,"end_ns":...,"lines":1843,"width":1024,"height":1843,
+//    "center_hz":...,"span_hz":...,"start_hz":...,"stop_hz":...,
+//    "min_db":...,"max_db":...,"dropped":0}
+//   ]
+// Raw tiles are the Cairo RGB24 pixels: height rows of width 32-bit
+// little-endian 0x00RRGGBB values.
+
+typedef enum {
+    TILE_FORMAT_PNG = 0,
+    TILE_FORMAT_RAW = 1,
+} tile_format_t;
+
+typedef struct {
+    int width;             // Tile width in pixels (bins decimated like the waterfall widget)
+    int seconds;           // Tile duration
+    tile_format_t format;
+    float min_db;          // Palette range (black to red)
+    float max_db;
+} tile_writer_config_t;
+
+#define TILE_WRITER_CONFIG_DEFAULT { .width = 1024, .seconds = 60, .format = TILE_FORMAT_PNG, \
+                                     .min_db = -130.0f, .max_db = -50.0f }
+
+// Highest line rate a tile holds (lines beyond it start a new tile);
+// the headless loop fetches spectra at the display rate, about 30/s
+#define TILE_WRITER_MAX_LINE_RATE 32
+
+typedef struct tile_writer tile_writer_t;
+
+// Create a writer for spectra of bins bins, writing into dir (created if
+// missing); an existing index.json there is appended to
+// Returns NULL on error
+tile_writer_t *tile_writer_new(const char *dir, int bins, const tile_writer_config_t *config);
+
+// Stop the worker (writing the unfinished tile) and free the writer
+void tile_writer_free(tile_writer_t *tw);
+
+// Start the worker thread
+// Returns 0 on success, -1 on error
+int tile_writer_start(tile_writer_t *tw);
+
+// Render the queued lines, write the unfinished tile and stop the worker
+void tile_writer_stop(tile_writer_t *tw);
+
+// Queue one spectrum line (never blocks: the line is dropped and counted
+// when the worker is behind)
+// time_ns: capture time (CLOCK_REALTIME)
+// center_hz/span_hz: frequency span covered by the bins
+// Returns 0 if queued, -1 if dropped
+int tile_writer_add_line(tile_writer_t *tw, const float *spectrum_db, int64_t time_ns,
+                         int64_t center_hz, int span_hz);
+
+// Lines dropped because the worker was behind
+long tile_writer_get_dropped(tile_writer_t *tw);
+
+// Tiles written so far
+long tile_writer_get_tiles(tile_writer_t *tw);
+
+#endif // TILE_WRITER_H
@@ -0,0 +1,584 @@
+#define _GNU_SOURCE  // recvmmsg, sendmmsg
+#include "udp_iq.h"
+#include "iq_bfp.h"
+#include "mono_clock.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+
+// Datagrams per recvmmsg/sendmmsg call
+#define UDP_IQ_BATCH 32
+
+// Receive buffer per datagram (9000-byte jumbo frame)
+#define UDP_IQ_MAX_DATAGRAM 9000
+
+// Socket receive buffer requested (capped by net.core.rmem_max)
+#define UDP_IQ_RCVBUF (4 * 1024 * 1024)
+
+// Gaps up to this many samples are zero-filled; a larger jump (or a
+// sequence that goes back this far, i.e. a restarted sender) resyncs
+#define UDP_IQ_MAX_FILL_SAMPLES (1 << 18)
+
+// How long recvmmsg blocks before re-checking for shutdown
+#define UDP_IQ_POLL_MS 100
+
+// Legacy elad-server stream: BE 32-bit counter + 128 float samples
+#define LEGACY_DATAGRAM 1028
+#define LEGACY_SAMPLES 128
+
+static inline uint32_t read_le16(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8;
+}
+
+static inline uint32_t read_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static inline uint64_t read_le64(const uint8_t *p) {
+    return (uint64_t)read_le32(p) | (uint64_t)read_le32(p + 4) << 32;
+}
+
+static inline void write_le16(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void write_le32(uint8_t *p, uint32_t v) {
+    write_le16(p, v);
+    write_le16(p + 2, v >> 16);
+}
+
+static inline void write_le64(uint8_t *p, uint64_t v) {
+    write_le32(p, (uint32_t)v);
+    write_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+// ---- Receiver ----
+
+struct udp_iq_receiver {
+    int fd;
+    udp_iq_format_t format;
+
+    // Output chunk being assembled (receive thread only)
+    uint8_t *block;
+    int block_bytes;
+    int fill;
+    uint64_t next_seq;  // Stream index expected next
+    bool synced;
+
+    // recvmmsg batch, and one datagram decoded from BFP
+    uint8_t *rx_buf;
+    uint8_t *decoded;
+    struct iovec iov[UDP_IQ_BATCH];
+    struct mmsghdr msgs[UDP_IQ_BATCH];
+
+    udp_iq_callback_t callback;
+    void *callback_user_data;
+    pthread_t thread;
+    int thread_started;
+    atomic_int running;
+
+    atomic_ullong last_rx_ns;
+    atomic_int sample_rate;
+    atomic_long packets;
+    atomic_long samples;
+    atomic_long lost_samples;
+    atomic_long gaps;
+    atomic_long late;
+    atomic_long bad;
+
+    // Loss report (receive thread only)
+    long reported_lost;
+    long reported_late;
+    uint64_t report_ns;
+};
+
+// Mantissa bits of a BFP wire format, 0 for uncompressed formats
+static int format_bfp_bits(uint32_t format) {
+    switch (format) {
+    case UDP_IQ_FORMAT_BFP8: return 8;
+    case UDP_IQ_FORMAT_BFP12: return 12;
+    case UDP_IQ_FORMAT_BFP16: return 16;
+    default: return 0;
+    }
+}
+
+// Largest datagram decoded from BFP (8-bit mantissas expand the most)
+static size_t decoded_max_bytes(void) {
+    return (size_t)(UDP_IQ_MAX_DATAGRAM / iq_bfp_block_bytes(8) + 1) *
+           IQ_BFP_BLOCK_SAMPLES * UDP_IQ_BYTES_PER_SAMPLE;
+}
+
+udp_iq_receiver_t *udp_iq_receiver_new(int port, udp_iq_format_t format, int block_bytes) {
+    if (port <= 0 || port > 65535 || block_bytes <= 0 || block_bytes % UDP_IQ_BYTES_PER_SAMPLE) {
+        fprintf(stderr, "UDP IQ: invalid port or block size\n");
+        return NULL;
+    }
+
+    udp_iq_receiver_t *rx = calloc(1, sizeof(udp_iq_receiver_t));
+    if (!rx) return NULL;
+    rx->fd = -1;
+    rx->format = format;
+    rx->block_bytes = block_bytes;
+    rx->block = malloc(block_bytes);
+    rx->rx_buf = malloc((size_t)UDP_IQ_BATCH * UDP_IQ_MAX_DATAGRAM);
+    rx->decoded = malloc(decoded_max_bytes());
+    if (!rx->block || !rx->rx_buf || !rx->decoded) {
+        fprintf(stderr, "UDP IQ: failed to allocate buffers\n");
+        udp_iq_receiver_free(rx);
+        return NULL;
+    }
+    for (int i = 0; i < UDP_IQ_BATCH; i++) {
+        rx->iov[i].iov_base = rx->rx_buf + (size_t)i * UDP_IQ_MAX_DATAGRAM;
+        rx->iov[i].iov_len = UDP_IQ_MAX_DATAGRAM;
+        rx->msgs[i].msg_hdr.msg_iov = &rx->iov[i];
+        rx->msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    rx->fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (rx->fd < 0) {
+        fprintf(stderr, "UDP IQ: socket failed: %s\n", strerror(errno));
+        udp_iq_receiver_free(rx);
+        return NULL;
+    }
+    int opt = 1;
+    setsockopt(rx->fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    opt = UDP_IQ_RCVBUF;
+    setsockopt(rx->fd, SOL_SOCKET, SO_RCVBUF, &opt, sizeof(opt));
+    struct timeval tv = { 0, UDP_IQ_POLL_MS * 1000 };
+    setsockopt(rx->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(rx->fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "UDP IQ: cannot bind port %d: %s\n", port, strerror(errno));
+        udp_iq_receiver_free(rx);
+        return NULL;
+    }
+    return rx;
+}
+
+void udp_iq_receiver_free(udp_iq_receiver_t *rx) {
+    if (!rx) return;
+    udp_iq_receiver_stop(rx);
+    if (rx->fd >= 0) close(rx->fd);
+    free(rx->block);
+    free(rx->rx_buf);
+    free(rx->decoded);
+    free(rx);
+}
+
+// Append samples to the output chunk (data NULL = zeros), delivering
+// every chunk that fills up
+static void append(udp_iq_receiver_t *rx, const uint8_t *data, uint64_t bytes, uint64_t now_ns) {
+    atomic_fetch_add(&rx->samples, (long)(bytes / UDP_IQ_BYTES_PER_SAMPLE));
+    while (bytes > 0) {
+        int n = rx->block_bytes - rx->fill;
+        if ((uint64_t)n > bytes) n = (int)bytes;
+        if (data) {
+            memcpy(rx->block + rx->fill, data, n);
+            data += n;
+        } else {
+            memset(rx->block + rx->fill, 0, n);
+        }
+        rx->fill += n;
+        bytes -= n;
+        if (rx->fill == rx->block_bytes) {
+            rx->callback(rx->block, rx->block_bytes, now_ns, rx->callback_user_data);
+            rx->fill = 0;
+        }
+    }
+}
+
+static void handle_datagram(udp_iq_receiver_t *rx, const uint8_t *buf, int len, uint64_t now_ns) {
+    uint64_t seq;
+    const uint8_t *payload;
+    int payload_len;
+
+    if (len >= UDP_IQ_HEADER_SIZE && read_le32(buf) == UDP_IQ_MAGIC) {
+        int header_len = (int)read_le16(buf + 4);
+        uint32_t format = read_le16(buf + 6);
+        int bits = format_bfp_bits(format);
+        bool s32_to_f32 = format == UDP_IQ_FORMAT_S32 && rx->format == UDP_IQ_FORMAT_F32;
+        if (header_len < UDP_IQ_HEADER_SIZE || header_len > len ||
+            (format != (uint32_t)rx->format && !bits && !s32_to_f32)) {
+            atomic_fetch_add(&rx->bad, 1);
+            return;
+        }
+        payload = buf + header_len;
+        payload_len = len - header_len;
+        if (bits) {
+            // Decode straight to the delivered format
+            int samples = rx->format == UDP_IQ_FORMAT_F32
+                ? iq_bfp_decode_f32(payload, payload_len, bits, (float *)rx->decoded)
+                : iq_bfp_decode_s32(payload, payload_len, bits, rx->decoded);
+            if (samples < 0) {
+                atomic_fetch_add(&rx->bad, 1);
+                return;
+            }
+            payload = rx->decoded;
+            payload_len = samples * UDP_IQ_BYTES_PER_SAMPLE;
+        } else if (payload_len % UDP_IQ_BYTES_PER_SAMPLE != 0) {
+            atomic_fetch_add(&rx->bad, 1);
+            return;
+        } else if (s32_to_f32) {
+            // FDM-DUO integers (e.g. from elad-server) to full scale 1.0
+            float *out = (float *)rx->decoded;
+            for (int i = 0; i < payload_len / 4; i++) {
+                out[i] = (float)(int32_t)read_le32(payload + 4 * i) * (1.0f / 2147483648.0f);
+            }
+            payload = rx->decoded;
+        }
+        uint32_t rate = read_le32(buf + 8);
+        if (rate) atomic_store(&rx->sample_rate, (int)rate);
+        seq = read_le64(buf + 16);
+    } else if (rx->format == UDP_IQ_FORMAT_F32 && len == LEGACY_DATAGRAM) {
+        seq = (uint64_t)ntohl(*(const uint32_t *)buf) * LEGACY_SAMPLES;
+        payload = buf + 4;
+        payload_len = len - 4;
+    } else {
+        atomic_fetch_add(&rx->bad, 1);
+        return;
+    }
+
+    uint64_t count = (uint64_t)payload_len / UDP_IQ_BYTES_PER_SAMPLE;
+    if (!rx->synced) {
+        rx->next_seq = seq;
+        rx->synced = true;
+    }
+
+    if (seq > rx->next_seq) {
+        // Lost datagrams: keep the stream aligned with zeros
+        uint64_t gap = seq - rx->next_seq;
+        atomic_fetch_add(&rx->gaps, 1);
+        atomic_fetch_add(&rx->lost_samples, (long)gap);
+        if (gap <= UDP_IQ_MAX_FILL_SAMPLES) {
+            append(rx, NULL, gap * UDP_IQ_BYTES_PER_SAMPLE, now_ns);
+        }
+    } else if (seq < rx->next_seq) {
+        uint64_t behind = rx->next_seq - seq;
+        if (behind > UDP_IQ_MAX_FILL_SAMPLES) {
+            // Far behind: the sender restarted, follow it
+            atomic_fetch_add(&rx->gaps, 1);
+        } else if (behind >= count) {
+            atomic_fetch_add(&rx->late, 1);
+            return;
+        } else {
+            // Overlaps what was already delivered: keep only the new part
+            payload += behind * UDP_IQ_BYTES_PER_SAMPLE;
+            count -= behind;
+            seq = rx->next_seq;
+        }
+    }
+
+    append(rx, payload, count * UDP_IQ_BYTES_PER_SAMPLE, now_ns);
+    rx->next_seq = seq + count;
+    atomic_fetch_add(&rx->packets, 1);
+}
+
+// Loss summary at most once per second
+static void report_loss(udp_iq_receiver_t *rx, uint64_t now_ns) {
+    long lost = atomic_load(&rx->lost_samples);
+    long late = atomic_load(&rx->late);
+    if ((lost == rx->reported_lost && late == rx->reported_late) ||
+        now_ns - rx->report_ns < 1000000000ULL) {
+        return;
+    }
+    fprintf(stderr, "UDP IQ: %ld samples lost in %ld gaps, %ld late datagrams\n",
+            lost, atomic_load(&rx->gaps), late);
+    rx->reported_lost = lost;
+    rx->reported_late = late;
+    rx->report_ns = now_ns;
+}
+
+static void *receiver_thread_func(void *user_data) {
+    udp_iq_receiver_t *rx = (udp_iq_receiver_t *)user_data;
+
+    fprintf(stderr, "UDP IQ receiver started\n");
+
+    while (atomic_load(&rx->running)) {
+        // Blocks for the first datagram only, then takes what is queued
+        int n = recvmmsg(rx->fd, rx->msgs, UDP_IQ_BATCH, MSG_WAITFORONE, NULL);
+        if (n < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) continue;
+            fprintf(stderr, "UDP IQ: recvmmsg failed: %s\n", strerror(errno));
+            break;
+        }
+
+        uint64_t now_ns = monotonic_ns();
+        atomic_store(&rx->last_rx_ns, now_ns);
+        for (int i = 0; i < n; i++) {
+            if (rx->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                atomic_fetch_add(&rx->bad, 1);
+                continue;
+            }
+            handle_datagram(rx, rx->iov[i].iov_base, (int)rx->msgs[i].msg_len, now_ns);
+        }
+        report_loss(rx, now_ns);
+    }
+
+    fprintf(stderr, "UDP IQ receiver stopped\n");
+    return NULL;
+}
+
+int udp_iq_receiver_start(udp_iq_receiver_t *rx, udp_iq_callback_t callback, void *user_data) {
+    if (!rx || !callback) return -1;
+    if (rx->thread_started) return 0;
+
+    rx->callback = callback;
+    rx->callback_user_data = user_data;
+    rx->fill = 0;
+    rx->synced = false;
+    atomic_store(&rx->running, 1);
+
+    if (pthread_create(&rx->thread, NULL, receiver_thread_func, rx) != 0) {
+        fprintf(stderr, "UDP IQ: Failed to create thread\n");
+        atomic_store(&rx->running, 0);
+        return -1;
+    }
+    rx->thread_started = 1;
+    return 0;
+}
+
+void udp_iq_receiver_stop(udp_iq_receiver_t *rx) {
+    if (!rx || !rx->thread_started) return;
+
+    atomic_store(&rx->running, 0);
+    pthread_join(rx->thread, NULL);
+    rx->thread_started = 0;
+}
+
+bool udp_iq_receiver_is_receiving(udp_iq_receiver_t *rx) {
+    if (!rx) return false;
+    uint64_t last = atomic_load(&rx->last_rx_ns);
+    return last != 0 && monotonic_ns() - last < 1000000000ULL;
+}
+
+int udp_iq_receiver_get_sample_rate(udp_iq_receiver_t *rx) {
+    return rx ? atomic_load(&rx->sample_rate) : 0;
+}
+
+void udp_iq_receiver_get_stats(udp_iq_receiver_t *rx, udp_iq_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!rx) return;
+    stats->packets = atomic_load(&rx->packets);
+    stats->samples = atomic_load(&rx->samples);
+    stats->lost_samples = atomic_load(&rx->lost_samples);
+    stats->gaps = atomic_load(&rx->gaps);
+    stats->late = atomic_load(&rx->late);
+    stats->bad = atomic_load(&rx->bad);
+}
+
+// ---- Sender ----
+
+struct udp_iq_sender {
+    int fd;
+    udp_iq_format_t format;
+    int sample_rate;
+    int wire_bytes;       // Payload bytes the path MTU allows
+    int bfp_bits;         // 0 = uncompressed
+    int dgram_samples;    // Samples per datagram
+    uint64_t seq;         // Stream index of the next sample
+
+    // Compressed copy of the chunk being sent
+    uint8_t *encoded;
+    int encoded_size;
+
+    // sendmmsg batch: header + payload (pointing into the caller's data)
+    uint8_t headers[UDP_IQ_BATCH][UDP_IQ_HEADER_SIZE];
+    struct iovec iov[UDP_IQ_BATCH][2];
+    struct mmsghdr msgs[UDP_IQ_BATCH];
+};
+
+// Payload bytes that fit the path MTU (1500-byte Ethernet if unknown)
+static int path_payload_bytes(int fd, int family) {
+    int mtu = 1500;
+#ifdef IP_MTU
+    int value;
+    socklen_t len = sizeof(value);
+    int ok = family == AF_INET6
+        ? getsockopt(fd, IPPROTO_IPV6, IPV6_MTU, &value, &len)
+        : getsockopt(fd, IPPROTO_IP, IP_MTU, &value, &len);
+    if (ok == 0 && value > 0) mtu = value;
+#endif
+    int overhead = (family == AF_INET6 ? 40 : 20) + 8 + UDP_IQ_HEADER_SIZE;
+    int payload = mtu - overhead;
+    return payload > UDP_IQ_MAX_PAYLOAD ? UDP_IQ_MAX_PAYLOAD : payload;
+}
+
+// Samples per datagram for the payload limit and compression
+static void update_dgram_samples(udp_iq_sender_t *tx) {
+    if (tx->bfp_bits) {
+        int blocks = tx->wire_bytes / iq_bfp_block_bytes(tx->bfp_bits);
+        tx->dgram_samples = (blocks > 0 ? blocks : 1) * IQ_BFP_BLOCK_SAMPLES;
+    } else {
+        int samples = tx->wire_bytes / UDP_IQ_BYTES_PER_SAMPLE;
+        tx->dgram_samples = samples > 0 ? samples : 1;
+    }
+}
+
+udp_iq_sender_t *udp_iq_sender_new(const char *host, int port, udp_iq_format_t format,
+                                   int sample_rate) {
+    if (!host || port <= 0 || port > 65535) return NULL;
+
+    struct addrinfo hints;
+    struct addrinfo *list = NULL;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    char service[8];
+    snprintf(service, sizeof(service), "%d", port);
+    int rc = getaddrinfo(host, service, &hints, &list);
+    if (rc != 0) {
+        fprintf(stderr, "UDP IQ: cannot resolve %s: %s\n", host, gai_strerror(rc));
+        return NULL;
+    }
+
+    udp_iq_sender_t *tx = calloc(1, sizeof(udp_iq_sender_t));
+    if (!tx) {
+        freeaddrinfo(list);
+        return NULL;
+    }
+    tx->fd = -1;
+    tx->format = format;
+    tx->sample_rate = sample_rate;
+
+    // Connected socket: the kernel tracks the path MTU for this peer
+    int family = AF_INET;
+    for (struct addrinfo *ai = list; ai; ai = ai->ai_next) {
+        tx->fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (tx->fd < 0) continue;
+        if (connect(tx->fd, ai->ai_addr, ai->ai_addrlen) == 0) {
+            family = ai->ai_family;
+            break;
+        }
+        close(tx->fd);
+        tx->fd = -1;
+    }
+    freeaddrinfo(list);
+    if (tx->fd < 0) {
+        fprintf(stderr, "UDP IQ: cannot connect to %s:%d\n", host, port);
+        free(tx);
+        return NULL;
+    }
+
+    tx->wire_bytes = path_payload_bytes(tx->fd, family);
+    update_dgram_samples(tx);
+    for (int i = 0; i < UDP_IQ_BATCH; i++) {
+        tx->iov[i][0].iov_base = tx->headers[i];
+        tx->iov[i][0].iov_len = UDP_IQ_HEADER_SIZE;
+        tx->msgs[i].msg_hdr.msg_iov = tx->iov[i];
+        tx->msgs[i].msg_hdr.msg_iovlen = 2;
+    }
+    return tx;
+}
+
+void udp_iq_sender_free(udp_iq_sender_t *tx) {
+    if (!tx) return;
+    if (tx->fd >= 0) close(tx->fd);
+    free(tx->encoded);
+    free(tx);
+}
+
+int udp_iq_sender_set_compression(udp_iq_sender_t *tx, int bits) {
+    if (!tx) return -1;
+    if (bits != 0 && (!iq_bfp_valid_bits(bits) || tx->format != UDP_IQ_FORMAT_S32)) {
+        fprintf(stderr, "UDP IQ: BFP%d not supported for this stream\n", bits);
+        return -1;
+    }
+    tx->bfp_bits = bits;
+    update_dgram_samples(tx);
+    return 0;
+}
+
+int udp_iq_sender_send(udp_iq_sender_t *tx, const uint8_t *data, int length) {
+    if (!tx || !data || length % UDP_IQ_BYTES_PER_SAMPLE) return -1;
+
+    int samples = length / UDP_IQ_BYTES_PER_SAMPLE;
+    const uint8_t *payload = data;
+    int block_bytes = 0;
+    uint32_t format = (uint32_t)tx->format;
+    if (tx->bfp_bits) {
+        if (samples % IQ_BFP_BLOCK_SAMPLES) return -1;
+        block_bytes = iq_bfp_block_bytes(tx->bfp_bits);
+        int needed = samples / IQ_BFP_BLOCK_SAMPLES * block_bytes;
+        if (needed > tx->encoded_size) {
+            uint8_t *buf = realloc(tx->encoded, needed);
+            if (!buf) return -1;
+            tx->encoded = buf;
+            tx->encoded_size = needed;
+        }
+        iq_bfp_encode(data, samples, tx->bfp_bits, tx->encoded);
+        payload = tx->encoded;
+        format = UDP_IQ_FORMAT_BFP8 + (tx->bfp_bits - 8) / 4;
+    }
+
+    int offset = 0;  // Samples
+    while (offset < samples) {
+        // Fill a batch
+        int count = 0;
+        while (count < UDP_IQ_BATCH && offset < samples) {
+            int n = samples - offset;
+            if (n > tx->dgram_samples) n = tx->dgram_samples;
+            uint8_t *h = tx->headers[count];
+            write_le32(h, UDP_IQ_MAGIC);
+            write_le16(h + 4, UDP_IQ_HEADER_SIZE);
+            write_le16(h + 6, format);
+            write_le32(h + 8, (uint32_t)tx->sample_rate);
+            write_le32(h + 12, 0);
+            write_le64(h + 16, tx->seq + (uint64_t)offset);
+            if (tx->bfp_bits) {
+                tx->iov[count][1].iov_base = (void *)(payload + (size_t)offset / IQ_BFP_BLOCK_SAMPLES * block_bytes);
+                tx->iov[count][1].iov_len = (size_t)n / IQ_BFP_BLOCK_SAMPLES * block_bytes;
+            } else {
+                tx->iov[count][1].iov_base = (void *)(payload + (size_t)offset * UDP_IQ_BYTES_PER_SAMPLE);
+                tx->iov[count][1].iov_len = (size_t)n * UDP_IQ_BYTES_PER_SAMPLE;
+            }
+            offset += n;
+            count++;
+        }
+
+        // Send it; a partial send continues with the remaining datagrams
+        int sent = 0;
+        while (sent < count) {
+            int n = sendmmsg(tx->fd, tx->msgs + sent, count - sent, 0);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                if (errno == ECONNREFUSED) {
+                    // Nobody listening yet: the datagram is lost, keep streaming
+                    sent++;
+                    continue;
+                }
+                // Skip the whole chunk; the receiver zero-fills it
+                fprintf(stderr, "UDP IQ: sendmmsg failed: %s\n", strerror(errno));
+                tx->seq += (uint64_t)samples;
+                return -1;
+            }
+            sent += n;
+        }
+    }
+
+    tx->seq += (uint64_t)samples;
+    return 0;
+}
+
+int udp_iq_sender_get_payload_bytes(udp_iq_sender_t *tx) {
+    if (!tx) return 0;
+    if (tx->bfp_bits) {
+        return tx->dgram_samples / IQ_BFP_BLOCK_SAMPLES * iq_bfp_block_bytes(tx->bfp_bits);
+    }
+    return tx->dgram_samples * UDP_IQ_BYTES_PER_SAMPLE;
+}
@@ -0,0 +1,110 @@
+#ifndef UDP_IQ_H
+#define UDP_IQ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// IQ over UDP, batched with recvmmsg/sendmmsg.
+//
+// Datagram: 24-byte little-endian header, then interleaved I/Q samples
+// (8 bytes per complex sample) or block floating point blocks (iq_bfp.h):
+//   0  magic "EIQ1"
+//   4  u16 header length, u16 format (udp_iq_format_t)
+//   8  u32 sample rate (Hz, 0 = unknown)
+//   12 u32 reserved
+//   16 u64 sequence = stream index of the first sample in the datagram
+// Senders size datagrams from the path MTU (jumbo frames on links that
+// carry them). The receiver re-blocks the stream into fixed-size chunks;
+// missing samples are filled with zeros and counted, late or duplicate
+// datagrams are dropped, so a lost datagram never shifts the stream.
+
+#define UDP_IQ_MAGIC 0x31514945u  // "EIQ1"
+#define UDP_IQ_HEADER_SIZE 24
+#define UDP_IQ_BYTES_PER_SAMPLE 8
+
+// Largest payload a sender uses (1024 samples, fits a 9000-byte jumbo frame)
+#define UDP_IQ_MAX_PAYLOAD 8192
+
+typedef enum {
+    UDP_IQ_FORMAT_S32 = 0,    // 32-bit signed LE I/Q, the FDM-DUO USB format
+    UDP_IQ_FORMAT_F32 = 1,    // 32-bit float I/Q (full scale 1.0)
+    UDP_IQ_FORMAT_BFP8 = 2,   // Block floating point, 8-bit mantissas (wire only)
+    UDP_IQ_FORMAT_BFP12 = 3,  // 12-bit mantissas
+    UDP_IQ_FORMAT_BFP16 = 4,  // 16-bit mantissas
+} udp_iq_format_t;
+
+typedef struct {
+    long packets;       // Datagrams accepted
+    long samples;       // Samples delivered, including zero fill
+    long lost_samples;  // Samples filled with zeros (or skipped on resync)
+    long gaps;          // Sequence gaps seen
+    long late;          // Late or duplicate datagrams dropped
+    long bad;           // Datagrams with a wrong magic, format or length
+} udp_iq_stats_t;
+
+// ---- Receiver ----
+
+typedef struct udp_iq_receiver udp_iq_receiver_t;
+
+// Same layout and timestamp meaning as usb_sample_callback_t
+// (timestamp = CLOCK_MONOTONIC when the newest datagram was received)
+typedef void (*udp_iq_callback_t)(const uint8_t *data, int length,
+                                  uint64_t timestamp_ns, void *user_data);
+
+// Bind a receiver to UDP port on all interfaces, delivering chunks of
+// block_bytes (a multiple of 8) in format (S32 or F32). Streams in that
+// format or compressed with BFP are accepted (BFP is decoded to format),
+// and F32 receivers convert S32 streams; anything else is counted as
+// bad. F32 receivers also accept the legacy
+// elad-server stream (1028-byte datagrams: big-endian 32-bit counter +
+// 128 samples)
+// Returns NULL on error
+udp_iq_receiver_t *udp_iq_receiver_new(int port, udp_iq_format_t format, int block_bytes);
+
+// Stop the thread, close the socket and free the receiver
+void udp_iq_receiver_free(udp_iq_receiver_t *rx);
+
+// Start the receive thread
+// Returns 0 on success, -1 on error
+int udp_iq_receiver_start(udp_iq_receiver_t *rx, udp_iq_callback_t callback, void *user_data);
+
+// Stop the receive thread (blocks until it exits)
+void udp_iq_receiver_stop(udp_iq_receiver_t *rx);
+
+// True if a datagram arrived in the last second
+bool udp_iq_receiver_is_receiving(udp_iq_receiver_t *rx);
+
+// Sample rate announced by the sender (0 until known or if not sent)
+int udp_iq_receiver_get_sample_rate(udp_iq_receiver_t *rx);
+
+// Copy the counters
+void udp_iq_receiver_get_stats(udp_iq_receiver_t *rx, udp_iq_stats_t *stats);
+
+// ---- Sender ----
+
+typedef struct udp_iq_sender udp_iq_sender_t;
+
+// Send format (S32 or F32) samples to host:port; the payload size follows
+// the path MTU (Linux IP_MTU), up to UDP_IQ_MAX_PAYLOAD
+// Returns NULL on error
+udp_iq_sender_t *udp_iq_sender_new(const char *host, int port, udp_iq_format_t format,
+                                   int sample_rate);
+
+// Close the socket and free the sender
+void udp_iq_sender_free(udp_iq_sender_t *tx);
+
+// Compress an S32 stream with bits-per-mantissa block floating point
+// (8, 12 or 16; 0 = uncompressed)
+// Returns 0 on success, -1 on unsupported bits or an F32 stream
+int udp_iq_sender_set_compression(udp_iq_sender_t *tx, int bits);
+
+// Send length bytes of samples (a multiple of 8; with compression a
+// multiple of IQ_BFP_BLOCK_SAMPLES samples) as one sendmmsg batch per up
+// to 32 datagrams; uncompressed payloads are not copied
+// Returns 0 on success, -1 on error
+int udp_iq_sender_send(udp_iq_sender_t *tx, const uint8_t *data, int length);
+
+// Payload bytes per datagram (after compression)
+int udp_iq_sender_get_payload_bytes(udp_iq_sender_t *tx);
+
+#endif // UDP_IQ_H
@@ -1,22 +1,44 @@
 #define _DEFAULT_SOURCE
 #include "usb_device.h"
+#include "mono_clock.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 #include <unistd.h>
 #include <stdatomic.h>
+#include <pthread.h>
 #include <sys/time.h>
+#include <time.h>
 
 #define S_RATE 122880000
 #define NUM_TRANSFERS 2
+#define BYTES_PER_SAMPLE 8  // 32-bit I + 32-bit Q
+#define KNOWN_RADIOS_MAX 16
+
+// FDM-DUOs seen by this process, by bus and address (each radio has its own
+// libusb context, so libusb_device pointers differ between pipelines):
+// the serial read from EEPROM once per device, and whether a usb_device
+// has it open, so other pipelines neither take it nor send it requests
+typedef struct {
+    uint8_t bus;
+    uint8_t address;
+    bool present;            // Seen in the latest device list
+    bool claimed;
+    char serial[USB_SERIAL_LEN];
+} known_radio_t;
+
+static known_radio_t known_radios[KNOWN_RADIOS_MAX];
+static pthread_mutex_t known_lock = PTHREAD_MUTEX_INITIALIZER;
 
 struct usb_device {
     libusb_context *ctx;
+    int owns_ctx;  // Context created by usb_device_new (not shared)
     libusb_device_handle *handle;
+    known_radio_t *known;  // Registry entry claimed while open
 
     // Device info
-    char serial[33];
+    char serial[USB_SERIAL_LEN];
     int hw_version_major;
     int hw_version_minor;
     int sample_rate_correction;
@@ -31,6 +53,26 @@ struct usb_device {
     // Disconnection detection
     atomic_int disconnected;
     atomic_int transfers_pending;  // Count of transfers still in flight
+
+    // Stream health counters
+    // Written only from the libusb event thread; read with relaxed loads
+    uint64_t submit_ns[NUM_TRANSFERS];  // Submit time per transfer
+    atomic_uint_fast64_t stat_bytes;
+    atomic_uint_fast64_t stat_transfers;
+    atomic_uint_fast64_t stat_short;
+    atomic_uint_fast64_t stat_timeouts;
+    atomic_uint_fast64_t stat_errors;
+    atomic_uint_fast64_t stat_resubmit_failures;
+    atomic_int stat_streams;
+    atomic_uint_fast64_t stat_max_gap_us;
+    atomic_uint_fast64_t gap_hist[USB_STATS_HIST_BUCKETS];
+    atomic_uint_fast64_t latency_hist[USB_STATS_HIST_BUCKETS];
+
+    // Sample loss estimate for the current stream
+    atomic_uint_fast64_t stream_first_ns;  // First completion (0 = none yet)
+    atomic_uint_fast64_t stream_last_ns;   // Latest completion
+    atomic_uint_fast64_t stream_bytes;     // Bytes after the first completion
+    atomic_int_fast64_t samples_lost_prev; // Loss from earlier streams
 };
 
 static void transfer_callback(struct libusb_transfer *transfer);
@@ -45,23 +87,200 @@ usb_device_t *usb_device_new(void) {
         free(dev);
         return NULL;
     }
+    dev->owns_ctx = 1;
 
     return dev;
 }
 
+usb_device_t *usb_device_new_with_context(libusb_context *ctx) {
+    if (!ctx) return NULL;
+
+    usb_device_t *dev = calloc(1, sizeof(usb_device_t));
+    if (!dev) return NULL;
+
+    dev->ctx = ctx;
+    dev->owns_ctx = 0;
+    return dev;
+}
+
 void usb_device_free(usb_device_t *dev) {
     if (!dev) return;
 
     usb_device_close(dev);
 
-    if (dev->ctx) {
+    if (dev->ctx && dev->owns_ctx) {
         libusb_exit(dev->ctx);
     }
 
     free(dev);
 }
 
+// Read the 32-character serial number from radio EEPROM
+// Trailing padding (spaces/NUL) is stripped
+// Returns 0 on success, -1 on error
+static int read_serial(libusb_device_handle *handle, char *serial) {
+    unsigned char buffer[64];
+
+    memset(buffer, 0, sizeof(buffer));
+    int res = libusb_control_transfer(handle, 0xc0, 0xA2, 0x4000, 0x0151, buffer, 32, 1000);
+    if (res != 32) {
+        serial[0] = '\0';
+        return -1;
+    }
+
+    memcpy(serial, buffer, 32);
+    serial[32] = '\0';
+    for (int i = 31; i >= 0 && (serial[i] == ' ' || serial[i] == '\0'); i--) {
+        serial[i] = '\0';
+    }
+    return 0;
+}
+
+// Registry entry for a device in the list (known_lock held), added with
+// its serial read from EEPROM the first time; NULL if it cannot be
+// identified. Only called for devices no usb_device has open, so radios
+// streaming in other pipelines never see the vendor request
+static known_radio_t *known_radio_lookup(libusb_device *device) {
+    uint8_t bus = libusb_get_bus_number(device);
+    uint8_t address = libusb_get_device_address(device);
+    known_radio_t *free_slot = NULL;
+    for (int i = 0; i < KNOWN_RADIOS_MAX; i++) {
+        known_radio_t *k = &known_radios[i];
+        if (k->serial[0] && k->bus == bus && k->address == address) return k;
+        if (!k->serial[0] && !free_slot) free_slot = k;
+    }
+    if (!free_slot) return NULL;
+
+    libusb_device_handle *handle;
+    if (libusb_open(device, &handle) != 0) return NULL;
+    char serial[USB_SERIAL_LEN];
+    int res = read_serial(handle, serial);
+    libusb_close(handle);
+    if (res != 0 || serial[0] == '\0') return NULL;
+
+    free_slot->bus = bus;
+    free_slot->address = address;
+    free_slot->claimed = false;
+    memcpy(free_slot->serial, serial, sizeof(serial));
+    return free_slot;
+}
+
+// Walk the FDM-DUOs in list (known_lock held): entries of devices that
+// are gone and not open are forgotten (their address may be reused), the
+// rest identified; visit returns true to stop at a device
+static void known_radios_scan(libusb_device **list, ssize_t count,
+                              bool (*visit)(libusb_device *device, known_radio_t *k,
+                                            void *user_data),
+                              void *user_data) {
+    for (int i = 0; i < KNOWN_RADIOS_MAX; i++) known_radios[i].present = false;
+    for (ssize_t i = 0; i < count; i++) {
+        struct libusb_device_descriptor desc;
+        if (libusb_get_device_descriptor(list[i], &desc) != 0) continue;
+        if (desc.idVendor != ELAD_VENDOR_ID || desc.idProduct != ELAD_PRODUCT_ID) continue;
+        uint8_t bus = libusb_get_bus_number(list[i]);
+        uint8_t address = libusb_get_device_address(list[i]);
+        for (int j = 0; j < KNOWN_RADIOS_MAX; j++) {
+            known_radio_t *k = &known_radios[j];
+            if (k->serial[0] && k->bus == bus && k->address == address) k->present = true;
+        }
+    }
+    for (int i = 0; i < KNOWN_RADIOS_MAX; i++) {
+        known_radio_t *k = &known_radios[i];
+        if (k->serial[0] && !k->present && !k->claimed) k->serial[0] = '\0';
+    }
+
+    for (ssize_t i = 0; i < count; i++) {
+        struct libusb_device_descriptor desc;
+        if (libusb_get_device_descriptor(list[i], &desc) != 0) continue;
+        if (desc.idVendor != ELAD_VENDOR_ID || desc.idProduct != ELAD_PRODUCT_ID) continue;
+        known_radio_t *k = known_radio_lookup(list[i]);
+        if (k && visit(list[i], k, user_data)) break;
+    }
+}
+
+typedef struct {
+    const char *serial;           // NULL = any
+    libusb_device_handle *handle; // Result
+    known_radio_t *known;
+} open_match_t;
+
+static bool visit_open(libusb_device *device, known_radio_t *k, void *user_data) {
+    open_match_t *match = (open_match_t *)user_data;
+    if (k->claimed) return false;
+    if (match->serial && strcmp(k->serial, match->serial) != 0) return false;
+    if (libusb_open(device, &match->handle) != 0) return false;
+    k->claimed = true;
+    match->known = k;
+    return true;
+}
+
+// Open the first FDM-DUO whose serial matches (any if serial is NULL)
+// that no other usb_device in this process has open, and claim its
+// registry entry
+// Returns open handle, or NULL if no match
+static libusb_device_handle *open_matching_device(usb_device_t *dev, const char *serial) {
+    libusb_device **list;
+    ssize_t count = libusb_get_device_list(dev->ctx, &list);
+    if (count < 0) return NULL;
+
+    open_match_t match = { .serial = serial };
+    pthread_mutex_lock(&known_lock);
+    known_radios_scan(list, count, visit_open, &match);
+    if (match.known) {
+        dev->known = match.known;
+        memcpy(dev->serial, match.known->serial, sizeof(dev->serial));
+    }
+    pthread_mutex_unlock(&known_lock);
+
+    libusb_free_device_list(list, 1);
+    return match.handle;
+}
+
+// Give the registry entry back (device closed or open failed)
+static void release_known(usb_device_t *dev) {
+    if (!dev->known) return;
+    pthread_mutex_lock(&known_lock);
+    dev->known->claimed = false;
+    pthread_mutex_unlock(&known_lock);
+    dev->known = NULL;
+}
+
+typedef struct {
+    char (*serials)[USB_SERIAL_LEN];
+    int max_devices;
+    int found;
+} enumerate_t;
+
+static bool visit_enumerate(libusb_device *device, known_radio_t *k, void *user_data) {
+    enumerate_t *e = (enumerate_t *)user_data;
+    memcpy(e->serials[e->found], k->serial, USB_SERIAL_LEN);
+    fprintf(stderr, "Found FDM-DUO serial %s (bus %d, address %d)%s\n", k->serial,
+            libusb_get_bus_number(device), libusb_get_device_address(device),
+            k->claimed ? " (open)" : "");
+    return ++e->found >= e->max_devices;
+}
+
+int usb_device_enumerate(libusb_context *ctx, char serials[][USB_SERIAL_LEN], int max_devices) {
+    if (!ctx || !serials || max_devices <= 0) return 0;
+
+    libusb_device **list;
+    ssize_t count = libusb_get_device_list(ctx, &list);
+    if (count < 0) return 0;
+
+    enumerate_t e = { .serials = serials, .max_devices = max_devices };
+    pthread_mutex_lock(&known_lock);
+    known_radios_scan(list, count, visit_enumerate, &e);
+    pthread_mutex_unlock(&known_lock);
+
+    libusb_free_device_list(list, 1);
+    return e.found;
+}
+
 int usb_device_open(usb_device_t *dev) {
+    return usb_device_open_serial(dev, NULL);
+}
+
+int usb_device_open_serial(usb_device_t *dev, const char *serial) {
     if (!dev || !dev->ctx) return -1;
     if (dev->handle) return 0;  // Already open
 
@@ -72,10 +291,10 @@ int usb_device_open(usb_device_t *dev) {
     int res;
 
     // Open device
-    dev->handle = libusb_open_device_with_vid_pid(dev->ctx, ELAD_VENDOR_ID, ELAD_PRODUCT_ID);
+    dev->handle = open_matching_device(dev, serial);
     if (!dev->handle) {
-        fprintf(stderr, "Cannot open FDM-DUO device (VID=0x%04X, PID=0x%04X)\n",
-                ELAD_VENDOR_ID, ELAD_PRODUCT_ID);
+        fprintf(stderr, "Cannot open FDM-DUO device (VID=0x%04X, PID=0x%04X%s%s)\n",
+                ELAD_VENDOR_ID, ELAD_PRODUCT_ID, serial ? ", serial " : "", serial ? serial : "");
         return -1;
     }
     fprintf(stderr, "FDM-DUO device opened\n");
@@ -94,6 +313,7 @@ int usb_device_open(usb_device_t *dev) {
         fprintf(stderr, "Cannot claim interface: %s\n", libusb_strerror(res));
         libusb_close(dev->handle);
         dev->handle = NULL;
+        release_known(dev);
         return -1;
     }
     fprintf(stderr, "Interface claimed\n");
@@ -114,14 +334,8 @@ int usb_device_open(usb_device_t *dev) {
         fprintf(stderr, "HW version: %d.%d\n", dev->hw_version_major, dev->hw_version_minor);
     }
 
-    // Read serial number
-    memset(buffer, 0, sizeof(buffer));
-    res = libusb_control_transfer(dev->handle, 0xc0, 0xA2, 0x4000, 0x0151, buffer, 32, 1000);
-    if (res == 32) {
-        memcpy(dev->serial, buffer, 32);
-        dev->serial[32] = '\0';
-        fprintf(stderr, "Serial: %s\n", dev->serial);
-    }
+    // Serial number (read when the registry first saw the device)
+    fprintf(stderr, "Serial: %s\n", dev->serial);
 
     // Stop FIFO
     res = libusb_control_transfer(dev->handle, 0xc0, 0xE1, 0x0000, 0xE9 << 8, buffer, 1, 1000);
@@ -183,10 +397,12 @@ void usb_device_close(usb_device_t *dev) {
         libusb_close(dev->handle);
         dev->handle = NULL;
     }
+    release_known(dev);
 
     // If device was disconnected, reinitialize libusb context
     // This ensures clean state for reconnection
-    if (was_disconnected && dev->ctx) {
+    // (a shared context stays up - other radios are still using it)
+    if (was_disconnected && dev->ctx && dev->owns_ctx) {
         fprintf(stderr, "Reinitializing libusb context...\n");
         libusb_exit(dev->ctx);
         dev->ctx = NULL;
@@ -253,17 +469,78 @@ int usb_device_set_frequency(usb_device_t *dev, long freq_hz) {
     snprintf((char *)buffer, sizeof(buffer), "CF%11ld;", freq_hz);
     res = libusb_control_transfer(dev->handle, 0x40, 0xE1, 16, 0xF1 << 8, buffer, 16, 1000);
 
-    fprintf(stderr, "Frequency set to %ld Hz\n", freq_hz);
     return 0;
 }
 
+static void stat_add(atomic_uint_fast64_t *counter, uint64_t value) {
+    atomic_fetch_add_explicit(counter, value, memory_order_relaxed);
+}
+
+static int transfer_index(usb_device_t *dev, struct libusb_transfer *transfer) {
+    for (int i = 0; i < NUM_TRANSFERS; i++) {
+        if (dev->transfers[i] == transfer) return i;
+    }
+    return -1;
+}
+
+// Expected minus received samples for the current stream
+static int64_t stream_samples_lost(usb_device_t *dev) {
+    uint64_t first_ns = atomic_load_explicit(&dev->stream_first_ns, memory_order_relaxed);
+    uint64_t last_ns = atomic_load_explicit(&dev->stream_last_ns, memory_order_relaxed);
+    if (first_ns == 0 || last_ns <= first_ns) return 0;
+
+    double expected = (last_ns - first_ns) * 1e-9 * DEFAULT_SAMPLE_RATE;
+    double received = (double)atomic_load_explicit(&dev->stream_bytes, memory_order_relaxed)
+                      / BYTES_PER_SAMPLE;
+    int64_t lost = (int64_t)(expected - received);
+    return lost > 0 ? lost : 0;
+}
+
+// Update counters for a finished transfer (libusb event thread)
+// Returns the completion timestamp
+static uint64_t record_completion(usb_device_t *dev, struct libusb_transfer *transfer) {
+    uint64_t now_ns = monotonic_ns();
+
+    int index = transfer_index(dev, transfer);
+    if (index >= 0 && dev->submit_ns[index] > 0) {
+        uint64_t latency_us = (now_ns - dev->submit_ns[index]) / 1000;
+        stat_add(&dev->latency_hist[duration_hist_bucket(latency_us, USB_STATS_HIST_BUCKETS)], 1);
+    }
+
+    if (transfer->status != LIBUSB_TRANSFER_COMPLETED) return now_ns;
+
+    stat_add(&dev->stat_transfers, 1);
+    stat_add(&dev->stat_bytes, transfer->actual_length);
+    if (transfer->actual_length < USB_BUFFER_SIZE) {
+        stat_add(&dev->stat_short, 1);
+    }
+
+    uint64_t last_ns = atomic_load_explicit(&dev->stream_last_ns, memory_order_relaxed);
+    if (atomic_load_explicit(&dev->stream_first_ns, memory_order_relaxed) == 0) {
+        // First completion starts the expected-rate clock
+        atomic_store_explicit(&dev->stream_first_ns, now_ns, memory_order_relaxed);
+    } else {
+        uint64_t gap_us = (now_ns - last_ns) / 1000;
+        stat_add(&dev->gap_hist[duration_hist_bucket(gap_us, USB_STATS_HIST_BUCKETS)], 1);
+        if (gap_us > atomic_load_explicit(&dev->stat_max_gap_us, memory_order_relaxed)) {
+            atomic_store_explicit(&dev->stat_max_gap_us, gap_us, memory_order_relaxed);
+        }
+        stat_add(&dev->stream_bytes, transfer->actual_length);
+    }
+    atomic_store_explicit(&dev->stream_last_ns, now_ns, memory_order_relaxed);
+    return now_ns;
+}
+
 static void transfer_callback(struct libusb_transfer *transfer) {
     usb_device_t *dev = (usb_device_t *)transfer->user_data;
     int should_resubmit = 0;
 
+    uint64_t completed_ns = record_completion(dev, transfer);
+
     if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
         if (dev->callback && dev->streaming) {
-            dev->callback(transfer->buffer, transfer->actual_length, dev->callback_user_data);
+            dev->callback(transfer->buffer, transfer->actual_length, completed_ns,
+                          dev->callback_user_data);
         }
         should_resubmit = dev->streaming;
     } else if (transfer->status == LIBUSB_TRANSFER_NO_DEVICE ||
@@ -271,6 +548,7 @@ static void transfer_callback(struct libusb_transfer *transfer) {
                transfer->status == LIBUSB_TRANSFER_ERROR) {
         // Device disconnected or fatal error
         fprintf(stderr, "USB device disconnected (transfer status: %d)\n", transfer->status);
+        stat_add(&dev->stat_errors, 1);
         atomic_store(&dev->disconnected, 1);
         should_resubmit = 0;
     } else if (transfer->status == LIBUSB_TRANSFER_CANCELLED) {
@@ -278,17 +556,22 @@ static void transfer_callback(struct libusb_transfer *transfer) {
         should_resubmit = 0;
     } else if (transfer->status == LIBUSB_TRANSFER_TIMED_OUT) {
         // Timeout - resubmit if still streaming
+        stat_add(&dev->stat_timeouts, 1);
         should_resubmit = dev->streaming;
     } else {
         fprintf(stderr, "Transfer error: %d\n", transfer->status);
+        stat_add(&dev->stat_errors, 1);
         should_resubmit = 0;
     }
 
     // Resubmit or decrement pending count
     if (should_resubmit && !atomic_load(&dev->disconnected)) {
+        int index = transfer_index(dev, transfer);
+        if (index >= 0) dev->submit_ns[index] = monotonic_ns();
         int res = libusb_submit_transfer(transfer);
         if (res != 0) {
             fprintf(stderr, "Failed to resubmit transfer: %s\n", libusb_strerror(res));
+            stat_add(&dev->stat_resubmit_failures, 1);
             atomic_fetch_sub(&dev->transfers_pending, 1);
             if (res == LIBUSB_ERROR_NO_DEVICE || res == LIBUSB_ERROR_IO) {
                 atomic_store(&dev->disconnected, 1);
@@ -343,6 +626,13 @@ int usb_device_start_streaming(usb_device_t *dev, usb_sample_callback_t callback
     dev->streaming = 1;
     atomic_store(&dev->transfers_pending, 0);
 
+    // Close out the loss estimate of the previous stream and start a new one
+    atomic_fetch_add_explicit(&dev->samples_lost_prev, stream_samples_lost(dev), memory_order_relaxed);
+    atomic_store_explicit(&dev->stream_first_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&dev->stream_last_ns, 0, memory_order_relaxed);
+    atomic_store_explicit(&dev->stream_bytes, 0, memory_order_relaxed);
+    atomic_fetch_add_explicit(&dev->stat_streams, 1, memory_order_relaxed);
+
     // Allocate and submit transfers
     for (int i = 0; i < NUM_TRANSFERS; i++) {
         dev->transfers[i] = libusb_alloc_transfer(0);
@@ -363,6 +653,7 @@ int usb_device_start_streaming(usb_device_t *dev, usb_sample_callback_t callback
             2000
         );
 
+        dev->submit_ns[i] = monotonic_ns();
         res = libusb_submit_transfer(dev->transfers[i]);
         if (res != 0) {
             fprintf(stderr, "Failed to submit transfer: %s\n", libusb_strerror(res));
@@ -420,6 +711,52 @@ void usb_device_stop_streaming(usb_device_t *dev) {
     }
 }
 
+void usb_device_get_stats(usb_device_t *dev, usb_stats_t *stats) {
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!dev) return;
+
+    stats->bytes = atomic_load_explicit(&dev->stat_bytes, memory_order_relaxed);
+    stats->transfers = atomic_load_explicit(&dev->stat_transfers, memory_order_relaxed);
+    stats->short_transfers = atomic_load_explicit(&dev->stat_short, memory_order_relaxed);
+    stats->timeouts = atomic_load_explicit(&dev->stat_timeouts, memory_order_relaxed);
+    stats->errors = atomic_load_explicit(&dev->stat_errors, memory_order_relaxed);
+    stats->resubmit_failures = atomic_load_explicit(&dev->stat_resubmit_failures, memory_order_relaxed);
+    stats->streams = atomic_load_explicit(&dev->stat_streams, memory_order_relaxed);
+    stats->max_gap_us = atomic_load_explicit(&dev->stat_max_gap_us, memory_order_relaxed);
+
+    uint64_t first_ns = atomic_load_explicit(&dev->stream_first_ns, memory_order_relaxed);
+    uint64_t last_ns = atomic_load_explicit(&dev->stream_last_ns, memory_order_relaxed);
+    if (first_ns > 0 && last_ns > first_ns) {
+        stats->stream_seconds = (last_ns - first_ns) * 1e-9;
+    }
+    stats->samples_lost = atomic_load_explicit(&dev->samples_lost_prev, memory_order_relaxed)
+                          + stream_samples_lost(dev);
+
+    for (int i = 0; i < USB_STATS_HIST_BUCKETS; i++) {
+        stats->gap_hist[i] = atomic_load_explicit(&dev->gap_hist[i], memory_order_relaxed);
+        stats->latency_hist[i] = atomic_load_explicit(&dev->latency_hist[i], memory_order_relaxed);
+    }
+}
+
+uint64_t usb_stats_percentile_us(const uint64_t *hist, double percentile) {
+    if (!hist) return 0;
+
+    uint64_t total = 0;
+    for (int i = 0; i < USB_STATS_HIST_BUCKETS; i++) total += hist[i];
+    if (total == 0) return 0;
+
+    uint64_t target = (uint64_t)(total * percentile / 100.0);
+    if (target >= total) target = total - 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < USB_STATS_HIST_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen > target) return 1ULL << i;
+    }
+    return 1ULL << (USB_STATS_HIST_BUCKETS - 1);
+}
+
 int usb_device_handle_events(usb_device_t *dev) {
     if (!dev || !dev->ctx) return -1;
     // Use timeout to allow periodic disconnect checks
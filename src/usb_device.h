@@ -2,6 +2,7 @@
 #define USB_DEVICE_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <libusb-1.0/libusb.h>
 #include "app_state.h"
 
@@ -9,14 +10,49 @@
 #define ELAD_PRODUCT_ID 0x061a
 #define ELAD_RF_ENDPOINT 0x86
 
+// Serial number buffer size (32 characters + terminator)
+#define USB_SERIAL_LEN 33
+
 typedef struct usb_device usb_device_t;
 
+// Histogram buckets: bucket 0 counts values < 1 us, bucket i counts
+// values in [2^(i-1), 2^i) us, the last bucket everything above
+#define USB_STATS_HIST_BUCKETS 24
+
+// Stream health snapshot (see usb_device_get_stats)
+typedef struct {
+    uint64_t bytes;              // Payload bytes received
+    uint64_t transfers;          // Completed transfers
+    uint64_t short_transfers;    // Completed with less than USB_BUFFER_SIZE
+    uint64_t timeouts;           // Transfers that timed out
+    uint64_t errors;             // Fatal transfer errors
+    uint64_t resubmit_failures;  // libusb_submit_transfer failures on resubmit
+    int streams;                 // Number of streaming starts (reconnects + 1)
+    double stream_seconds;       // Time since first completion of current stream
+    int64_t samples_lost;        // Expected minus received samples (estimate)
+    uint64_t max_gap_us;         // Longest time between completions
+    uint64_t gap_hist[USB_STATS_HIST_BUCKETS];      // Time between completions
+    uint64_t latency_hist[USB_STATS_HIST_BUCKETS];  // Submit to completion
+} usb_stats_t;
+
 // Callback for received IQ samples
-typedef void (*usb_sample_callback_t)(const uint8_t *data, int length, void *user_data);
+// timestamp_ns: transfer completion time (CLOCK_MONOTONIC, the clock of
+// g_get_monotonic_time), i.e. when the last sample of the chunk arrived
+typedef void (*usb_sample_callback_t)(const uint8_t *data, int length, uint64_t timestamp_ns,
+                                      void *user_data);
 
 // Create USB device handler
 usb_device_t *usb_device_new(void);
 
+// Create USB device handler on a libusb context shared with other devices
+// The context is not owned and must outlive the handler
+usb_device_t *usb_device_new_with_context(libusb_context *ctx);
+
+// List connected FDM-DUO radios by serial number, including those open in
+// this process (serials are read once per device and remembered)
+// Returns number of radios found (at most max_devices)
+int usb_device_enumerate(libusb_context *ctx, char serials[][USB_SERIAL_LEN], int max_devices);
+
 // Free USB device handler
 void usb_device_free(usb_device_t *dev);
 
@@ -24,6 +60,12 @@ void usb_device_free(usb_device_t *dev);
 // Returns 0 on success, negative on error
 int usb_device_open(usb_device_t *dev);
 
+// Open and initialize the FDM-DUO with the given serial number
+// (NULL opens the first radio found, like usb_device_open); radios another
+// usb_device in this process has open are skipped and not queried
+// Returns 0 on success, negative on error
+int usb_device_open_serial(usb_device_t *dev, const char *serial);
+
 // Close the device
 void usb_device_close(usb_device_t *dev);
 
@@ -50,6 +92,13 @@ const char *usb_device_get_serial(usb_device_t *dev);
 int usb_device_get_hw_version_major(usb_device_t *dev);
 int usb_device_get_hw_version_minor(usb_device_t *dev);
 
+// Copy stream health counters (lock-free, callable from any thread)
+void usb_device_get_stats(usb_device_t *dev, usb_stats_t *stats);
+
+// Upper bound in microseconds of the histogram bucket holding the given
+// percentile (0-100), or 0 if the histogram is empty
+uint64_t usb_stats_percentile_us(const uint64_t *hist, double percentile);
+
 // Read current frequency from radio (returns frequency in Hz, or -1 on error)
 long usb_device_get_frequency(usb_device_t *dev);
 
@@ -0,0 +1,111 @@
+#include "waterfall_render.h"
+#include <stdint.h>
+#include <string.h>
+
+// Color map: converts dB value (0.0 to 1.0 normalized) to RGB
+static void db_to_color(float normalized, uint8_t *r, uint8_t *g, uint8_t *b) {
+    // Color gradient: black -> blue -> cyan -> green -> yellow -> red -> white
+    if (normalized < 0.0f) normalized = 0.0f;
+    if (normalized > 1.0f) normalized = 1.0f;
+
+    if (normalized < 0.2f) {
+        // Black to blue
+        float t = normalized / 0.2f;
+        *r = 0;
+        *g = 0;
+        *b = (uint8_t)(t * 255);
+    } else if (normalized < 0.4f) {
+        // Blue to cyan
+        float t = (normalized - 0.2f) / 0.2f;
+        *r = 0;
+        *g = (uint8_t)(t * 255);
+        *b = 255;
+    } else if (normalized < 0.6f) {
+        // Cyan to green
+        float t = (normalized - 0.4f) / 0.2f;
+        *r = 0;
+        *g = 255;
+        *b = (uint8_t)((1.0f - t) * 255);
+    } else if (normalized < 0.8f) {
+        // Green to yellow
+        float t = (normalized - 0.6f) / 0.2f;
+        *r = (uint8_t)(t * 255);
+        *g = 255;
+        *b = 0;
+    } else {
+        // Yellow to red
+        float t = (normalized - 0.8f) / 0.2f;
+        *r = 255;
+        *g = (uint8_t)((1.0f - t) * 255);
+        *b = 0;
+    }
+}
+
+// Colourise spectrum bins [start_bin, start_bin + visible_bins) into one
+// row of width pixels
+static void draw_row(uint32_t *row, int width, const float *spectrum_db,
+                     int start_bin, int visible_bins, float min_db, float max_db) {
+    // RGB24 format is 0xXXRRGGBB (little-endian: BB GG RR XX)
+    float range = max_db - min_db;
+    if (range < 1.0f) range = 1.0f;
+
+    for (int x = 0; x < width; x++) {
+        // Map x to spectrum bin (within zoomed range)
+        int bin = start_bin + x * visible_bins / width;
+        if (bin >= start_bin + visible_bins) bin = start_bin + visible_bins - 1;
+
+        float db = spectrum_db[bin];
+        if (db < min_db) db = min_db;
+        if (db > max_db) db = max_db;
+
+        float normalized = (db - min_db) / range;
+
+        uint8_t r, g, b;
+        db_to_color(normalized, &r, &g, &b);
+
+        // RGB24 format: 0x00RRGGBB
+        row[x] = ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+    }
+}
+
+void waterfall_render_line(cairo_surface_t *surface, const float *spectrum_db,
+                           int start_bin, int visible_bins, float min_db, float max_db) {
+    if (!surface || !spectrum_db || visible_bins <= 0) return;
+
+    int width = cairo_image_surface_get_width(surface);
+    int height = cairo_image_surface_get_height(surface);
+
+    // Flush any pending Cairo operations
+    cairo_surface_flush(surface);
+
+    // Get direct access to pixel data
+    unsigned char *data = cairo_image_surface_get_data(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+
+    // Scroll down: move all rows down by 1 (from bottom to top to avoid overlap)
+    // memmove handles overlapping regions correctly
+    if (height > 1) {
+        memmove(data + stride, data, stride * (height - 1));
+    }
+
+    // Draw new line at top (row 0)
+    draw_row((uint32_t *)data, width, spectrum_db, start_bin, visible_bins, min_db, max_db);
+
+    // Mark surface as modified
+    cairo_surface_mark_dirty(surface);
+}
+
+void waterfall_render_row(cairo_surface_t *surface, int y, const float *spectrum_db,
+                          int start_bin, int visible_bins, float min_db, float max_db) {
+    if (!surface || !spectrum_db || visible_bins <= 0) return;
+    if (y < 0 || y >= cairo_image_surface_get_height(surface)) return;
+
+    cairo_surface_flush(surface);
+    unsigned char *data = cairo_image_surface_get_data(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+
+    draw_row((uint32_t *)(data + (size_t)y * stride), cairo_image_surface_get_width(surface),
+             spectrum_db, start_bin, visible_bins, min_db, max_db);
+
+    cairo_surface_mark_dirty_rectangle(surface, 0, y, cairo_image_surface_get_width(surface), 1);
+}
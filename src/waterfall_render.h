@@ -0,0 +1,19 @@
+#ifndef WATERFALL_RENDER_H
+#define WATERFALL_RENDER_H
+
+#include <cairo.h>
+
+// Waterfall line rendering on a Cairo RGB24 image surface, independent of
+// GTK (WaterfallWidget uses it for every new spectrum line, the headless
+// tile writer and benchmarks on offscreen surfaces)
+
+// Scroll the surface down one row and draw spectrum bins
+// [start_bin, start_bin + visible_bins) colourised across the top row
+void waterfall_render_line(cairo_surface_t *surface, const float *spectrum_db,
+                           int start_bin, int visible_bins, float min_db, float max_db);
+
+// Draw spectrum bins colourised across row y without scrolling
+void waterfall_render_row(cairo_surface_t *surface, int y, const float *spectrum_db,
+                          int start_bin, int visible_bins, float min_db, float max_db);
+
+#endif // WATERFALL_RENDER_H
@@ -1,11 +1,27 @@
 #include "waterfall_widget.h"
+#include "waterfall_render.h"
+#include "perf_trace.h"
+#include "ddc.h"
 #include "usb_device.h"  // For elad_mode_t
 #include <string.h>
+#include <math.h>
 #include <time.h>
 
-// Must match spectrum_widget.c margins
+// Must match spectrum_render.c margins
 #define MARGIN_LEFT 55
 
+// Lines added but not yet drawn, and drawn frames waiting for their
+// presentation time (the frame clock keeps a short history of timings)
+#define LATENCY_PENDING_LINES 8
+#define LATENCY_PENDING_FRAMES 32
+
+// Drawn line waiting for the presentation time of its frame
+typedef struct {
+    gint64 frame_counter;
+    uint64_t timestamp_ns;  // Sample capture time (0 = none)
+    uint64_t probe_ns;      // Probe origin (0 = none)
+} latency_frame_t;
+
 struct _WaterfallWidget {
     GtkDrawingArea parent_instance;
 
@@ -24,8 +40,10 @@ struct _WaterfallWidget {
     // Display parameters
     float min_db;
     float max_db;
-    int zoom_level;  // 1, 2, 4, 8 = horizontal zoom factor
+    int zoom_level;  // 1, 2, 4, 8, 16 = horizontal zoom factor
     int pan_offset;  // Bin offset from center (only effective when zoom > 1)
+    gboolean zoom_fft;  // Lines already cover the zoomed span
+    int64_t line_ns;    // Time between lines, for the time axis and scrollback
 
     // Bandwidth display
     int bandwidth_hz;       // Filter bandwidth in Hz
@@ -33,56 +51,246 @@ struct _WaterfallWidget {
     int sample_rate;        // Sample rate for Hz to bin conversion
     int center_offset_hz;   // Offset from tuned freq (e.g., +1500 for data modes)
     int is_resonator;       // CW resonator mode (100&1, etc.) - draws orange
+
+    // Occupancy heatmap (NULL = waterfall lines shown)
+    float *occupancy;       // 24 rows of occupancy_columns, square-rooted
+    int occupancy_columns;
+
+    // Archive scrollback (history_end_ns 0 = live lines shown); the source
+    // is set on the GTK thread and read by the workers under history_lock
+    GMutex history_lock;
+    waterfall_history_func_t history_func;
+    gpointer history_data;
+    GDestroyNotify history_destroy;
+    int64_t history_end_ns;      // Time of the top row (CLOCK_REALTIME)
+    int64_t drag_start_ns;       // history_end_ns (or now) when the drag began
+    cairo_surface_t *history_surface;  // Last screenful read from the archive
+    gboolean history_dirty;      // Read history_surface again from the archive
+    gboolean history_loading;    // A worker is reading it (one at a time)
+
+    // Sample-to-pixel latency tracking (under data_mutex)
+    uint64_t pending_ts[LATENCY_PENDING_LINES];  // Undrawn lines, oldest first
+    int pending_count;
+    uint64_t probe_request_ns;  // Origin for the next added line
+    uint64_t pending_probe_ns;  // Origin of an added, undrawn line
+    latency_frame_t frames[LATENCY_PENDING_FRAMES];
+    int frame_count;
 };
 
 G_DEFINE_TYPE(WaterfallWidget, waterfall_widget, GTK_TYPE_DRAWING_AREA)
 
-// Color map: converts dB value (0.0 to 1.0 normalized) to RGB
-static void db_to_color(float normalized, uint8_t *r, uint8_t *g, uint8_t *b) {
-    // Color gradient: black -> blue -> cyan -> green -> yellow -> red -> white
-    if (normalized < 0.0f) normalized = 0.0f;
-    if (normalized > 1.0f) normalized = 1.0f;
-
-    if (normalized < 0.2f) {
-        // Black to blue
-        float t = normalized / 0.2f;
-        *r = 0;
-        *g = 0;
-        *b = (uint8_t)(t * 255);
-    } else if (normalized < 0.4f) {
-        // Blue to cyan
-        float t = (normalized - 0.2f) / 0.2f;
-        *r = 0;
-        *g = (uint8_t)(t * 255);
-        *b = 255;
-    } else if (normalized < 0.6f) {
-        // Cyan to green
-        float t = (normalized - 0.4f) / 0.2f;
-        *r = 0;
-        *g = 255;
-        *b = (uint8_t)((1.0f - t) * 255);
-    } else if (normalized < 0.8f) {
-        // Green to yellow
-        float t = (normalized - 0.6f) / 0.2f;
-        *r = (uint8_t)(t * 255);
-        *g = 255;
-        *b = 0;
-    } else {
-        // Yellow to red
-        float t = (normalized - 0.8f) / 0.2f;
-        *r = 255;
-        *g = (uint8_t)((1.0f - t) * 255);
-        *b = 0;
+// Default lines per second: 192000 / 4096 / 3 = 15.625
+#define LINES_PER_SECOND 15.625
+#define LINE_NS ((int64_t)(1e9 / LINES_PER_SECOND))
+
+// Scrollback per wheel step (plain, with Shift)
+#define HISTORY_SCROLL_NS (60 * 1000000000LL)
+#define HISTORY_SCROLL_FAST_NS (15 * 60 * 1000000000LL)
+
+#ifdef PERF_TRACE
+// Record presentation latency for drawn frames whose timings are complete
+// Frames that fell out of the clock's history or report no presentation
+// time (backend without feedback) are dropped
+static void latency_poll_frames(WaterfallWidget *self, GdkFrameClock *clock) {
+    int kept = 0;
+    for (int i = 0; i < self->frame_count; i++) {
+        latency_frame_t *f = &self->frames[i];
+        GdkFrameTimings *timings = gdk_frame_clock_get_timings(clock, f->frame_counter);
+        if (!timings) continue;
+        if (!gdk_frame_timings_get_complete(timings)) {
+            self->frames[kept++] = *f;
+            continue;
+        }
+
+        gint64 presented_us = gdk_frame_timings_get_presentation_time(timings);
+        if (presented_us == 0) {
+            presented_us = gdk_frame_timings_get_predicted_presentation_time(timings);
+        }
+        if (presented_us == 0) continue;
+
+        uint64_t presented_ns = (uint64_t)presented_us * 1000;
+        if (f->timestamp_ns && presented_ns > f->timestamp_ns) {
+            PERF_RECORD(PERF_STAGE_LAT_PRESENT, presented_ns - f->timestamp_ns);
+        }
+        if (f->probe_ns && presented_ns > f->probe_ns) {
+            PERF_RECORD(PERF_STAGE_LAT_BURST, presented_ns - f->probe_ns);
+        }
     }
+    self->frame_count = kept;
 }
 
-// Lines per second: 192000 / 4096 / 3 = 15.625
-#define LINES_PER_SECOND 15.625f
+// Account for the lines drawn in this frame (called from draw)
+static void latency_frame_drawn(WaterfallWidget *self) {
+    GdkFrameClock *clock = gtk_widget_get_frame_clock(GTK_WIDGET(self));
+    uint64_t now_ns = (uint64_t)g_get_monotonic_time() * 1000;
+
+    for (int i = 0; i < self->pending_count; i++) {
+        uint64_t ts = self->pending_ts[i];
+        if (ts && now_ns > ts) PERF_RECORD(PERF_STAGE_LAT_DRAW, now_ns - ts);
+    }
+
+    if (clock) {
+        latency_poll_frames(self, clock);
+        // The newest line is the one whose latency the frame shows
+        uint64_t newest = self->pending_count > 0 ? self->pending_ts[self->pending_count - 1] : 0;
+        if ((newest || self->pending_probe_ns) && self->frame_count < LATENCY_PENDING_FRAMES) {
+            latency_frame_t *f = &self->frames[self->frame_count++];
+            f->frame_counter = gdk_frame_clock_get_frame_counter(clock);
+            f->timestamp_ns = newest;
+            f->probe_ns = self->pending_probe_ns;
+        }
+    }
+
+    self->pending_count = 0;
+    self->pending_probe_ns = 0;
+}
+#endif
+
+// Occupancy heatmap over the plot area: one row per hour, the visible
+// part of the span across, in the waterfall palette (full scale = busy
+// all the time), hour labels every 3 hours in the margin
+// The heatmap always covers the full span; start_bin and visible_bins
+// are the zoom/pan window in full-span bins, which is also the span the
+// zoom FFT lines cover, so the columns line up with the axis either way
+static void draw_occupancy(WaterfallWidget *self, cairo_t *cr, int plot_width, int height,
+                           int start_bin, int visible_bins) {
+    int columns = self->occupancy_columns;
+    int size = self->spectrum_size > 0 ? self->spectrum_size : columns;
+    int start = (int)((int64_t)start_bin * columns / size);
+    int visible = (int)((int64_t)visible_bins * columns / size);
+    if (visible < 1) visible = 1;
+    if (start + visible > columns) start = columns - visible;
+
+    cairo_surface_t *map = cairo_image_surface_create(CAIRO_FORMAT_RGB24, plot_width, 24);
+    for (int hour = 0; hour < 24; hour++) {
+        waterfall_render_row(map, hour, self->occupancy + hour * columns, start, visible,
+                             0.0f, 1.0f);
+    }
+
+    cairo_save(cr);
+    cairo_translate(cr, MARGIN_LEFT, 0);
+    cairo_scale(cr, 1.0, height / 24.0);
+    cairo_set_source_surface(cr, map, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
+    cairo_paint(cr);
+    cairo_restore(cr);
+    cairo_surface_destroy(map);
+
+    cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 12);
+    cairo_set_source_rgba(cr, 0.7, 0.7, 0.7, 1.0);
+    for (int hour = 0; hour < 24; hour += 3) {
+        char label[8];
+        snprintf(label, sizeof(label), "%02dZ", hour);
+        cairo_text_extents_t extents;
+        cairo_text_extents(cr, label, &extents);
+        double y = (hour + 0.5) * height / 24.0;
+        cairo_move_to(cr, MARGIN_LEFT - extents.width - 5, y + 4);
+        cairo_show_text(cr, label);
+    }
+}
+
+// One screenful of scrollback, read and rendered on a worker thread so
+// archive I/O never blocks the GTK thread
+typedef struct {
+    int64_t end_ns;
+    int64_t line_ns;
+    int width;
+    int height;
+    int bins;
+    int start_bin;
+    int visible_bins;
+    float min_db;
+    float max_db;
+} history_job_t;
+
+// Row y shows the last line at or before end_ns - y line periods, black
+// where the archive has no line within two periods (gaps, other line
+// rates)
+static void history_job_run(GTask *task, gpointer source, gpointer task_data,
+                            GCancellable *cancellable G_GNUC_UNUSED) {
+    WaterfallWidget *self = WATERFALL_WIDGET(source);
+    history_job_t *job = (history_job_t *)task_data;
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, job->width,
+                                                          job->height);
+    cairo_t *surface_cr = cairo_create(surface);
+    cairo_set_source_rgb(surface_cr, 0, 0, 0);
+    cairo_paint(surface_cr);
+    cairo_destroy(surface_cr);
+
+    int max_lines = job->height + 32;
+    float *lines = g_new(float, (gsize)max_lines * job->bins);
+    int64_t *times = g_new(int64_t, max_lines);
+    int64_t start_ns = job->end_ns - (int64_t)(job->height + 1) * job->line_ns;
+    // The source may have been replaced since the job was queued
+    g_mutex_lock(&self->history_lock);
+    int count = self->history_func
+        ? self->history_func(self->history_data, start_ns, max_lines, lines, times, job->bins)
+        : 0;
+    g_mutex_unlock(&self->history_lock);
+
+    int j = count - 1;
+    for (int y = 0; y < job->height; y++) {
+        int64_t t = job->end_ns - (int64_t)y * job->line_ns;
+        while (j >= 0 && times[j] > t) j--;
+        if (j < 0) break;
+        if (t - times[j] < 2 * job->line_ns) {
+            waterfall_render_row(surface, y, lines + (size_t)j * job->bins, job->start_bin,
+                                 job->visible_bins, job->min_db, job->max_db);
+        }
+    }
+    cairo_surface_flush(surface);
+    g_free(lines);
+    g_free(times);
+    g_task_return_pointer(task, surface, (GDestroyNotify)cairo_surface_destroy);
+}
+
+// Back on the GTK thread: show the new screenful; the redraw starts the
+// next read if the view moved meanwhile
+static void history_job_done(GObject *source, GAsyncResult *result,
+                             gpointer user_data G_GNUC_UNUSED) {
+    WaterfallWidget *self = WATERFALL_WIDGET(source);
+    cairo_surface_t *surface = g_task_propagate_pointer(G_TASK(result), NULL);
+    self->history_loading = FALSE;
+    if (surface) {
+        if (self->history_surface) cairo_surface_destroy(self->history_surface);
+        self->history_surface = surface;
+    }
+    gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+static void history_load(WaterfallWidget *self, int plot_width, int height, int start_bin,
+                         int visible_bins) {
+    if (self->spectrum_size <= 0) return;
+
+    history_job_t *job = g_new(history_job_t, 1);
+    *job = (history_job_t){
+        .end_ns = self->history_end_ns,
+        .line_ns = self->line_ns,
+        .width = plot_width,
+        .height = height,
+        .bins = self->spectrum_size,
+        .start_bin = start_bin,
+        .visible_bins = visible_bins,
+        .min_db = self->min_db,
+        .max_db = self->max_db,
+    };
+    self->history_dirty = FALSE;
+    self->history_loading = TRUE;
+
+    // The task holds a reference to the widget until history_job_done
+    GTask *task = g_task_new(self, NULL, history_job_done, NULL);
+    g_task_set_task_data(task, job, g_free);
+    g_task_run_in_thread(task, history_job_run);
+    g_object_unref(task);
+}
 
 static void waterfall_widget_draw(GtkDrawingArea *area, cairo_t *cr,
                                    int width, int height, gpointer user_data G_GNUC_UNUSED) {
     WaterfallWidget *self = WATERFALL_WIDGET(area);
 
+    PERF_SPAN_BEGIN(draw_start);
+
     // Black background
     cairo_set_source_rgb(cr, 0.0, 0.0, 0.0);
     cairo_paint(cr);
@@ -112,11 +320,15 @@ static void waterfall_widget_draw(GtkDrawingArea *area, cairo_t *cr,
     }
 
     // Draw the surface at margin offset
-    if (self->surface) {
+    if (self->surface && !self->occupancy && !self->history_end_ns) {
         cairo_set_source_surface(cr, self->surface, MARGIN_LEFT, 0);
         cairo_paint(cr);
     }
 
+#ifdef PERF_TRACE
+    latency_frame_drawn(self);
+#endif
+
     // Calculate visible bin range (same as add_line) for bandwidth lines
     int visible_bins = self->spectrum_size / self->zoom_level;
     int max_pan = (self->spectrum_size - visible_bins) / 2;
@@ -127,13 +339,44 @@ static void waterfall_widget_draw(GtkDrawingArea *area, cairo_t *cr,
 
     g_mutex_unlock(&self->data_mutex);
 
+    if (self->occupancy) {
+        draw_occupancy(self, cr, plot_width, height, start_bin, visible_bins);
+    } else if (self->history_end_ns) {
+        // Until the worker is done, the previous screenful stays up
+        if (!self->history_loading && self->history_func &&
+            (self->history_dirty || !self->history_surface ||
+             cairo_image_surface_get_width(self->history_surface) != plot_width ||
+             cairo_image_surface_get_height(self->history_surface) != height)) {
+            if (self->zoom_fft) {
+                history_load(self, plot_width, height, 0, self->spectrum_size);
+            } else {
+                history_load(self, plot_width, height, start_bin, visible_bins);
+            }
+        }
+        if (self->history_surface) {
+            cairo_set_source_surface(cr, self->history_surface, MARGIN_LEFT, 0);
+            cairo_paint(cr);
+        }
+    }
+
+    // Zoom FFT: grey out the DDC's attenuated, possibly aliased edges
+    if (self->zoom_fft && self->zoom_level > 1 && !self->occupancy) {
+        double edge = plot_width * DDC_EDGE_FRACTION;
+        cairo_set_source_rgba(cr, 0.5, 0.5, 0.5, 0.35);
+        cairo_rectangle(cr, MARGIN_LEFT, 0, edge, height);
+        cairo_rectangle(cr, MARGIN_LEFT + plot_width - edge, 0, edge, height);
+        cairo_fill(cr);
+    }
+
     // Draw bandwidth lines (red dashed) if bandwidth is set
     if (self->bandwidth_hz > 0 && self->sample_rate > 0 && self->spectrum_size > 0) {
-        int center_bin = self->spectrum_size / 2;
+        // Positions in fractional full-resolution bins, so narrow filters
+        // stay accurate at high zoom
+        double center_bin = self->spectrum_size / 2;
         // Apply center offset (e.g., +1500 Hz for data modes)
-        int offset_bins = (self->center_offset_hz * self->spectrum_size) / self->sample_rate;
+        double offset_bins = (double)self->center_offset_hz * self->spectrum_size / self->sample_rate;
         center_bin += offset_bins;
-        int bw_bins = (self->bandwidth_hz * self->spectrum_size) / self->sample_rate;
+        double bw_bins = (double)self->bandwidth_hz * self->spectrum_size / self->sample_rate;
 
         // Set up dashed line style (orange for resonator, red otherwise)
         if (self->is_resonator) {
@@ -146,7 +389,7 @@ static void waterfall_widget_draw(GtkDrawingArea *area, cairo_t *cr,
         cairo_set_dash(cr, dashes, 2, 0);
 
         // Calculate line positions based on mode
-        int line_bins[2] = {-1, -1};  // Up to 2 lines
+        double line_bins[2] = {-1, -1};  // Up to 2 lines
         int num_lines = 0;
 
         // Data modes (with offset) are always symmetric around the offset center
@@ -182,7 +425,7 @@ static void waterfall_widget_draw(GtkDrawingArea *area, cairo_t *cr,
 
         // Draw each bandwidth line
         for (int i = 0; i < num_lines; i++) {
-            int bin = line_bins[i];
+            double bin = line_bins[i];
             if (bin < 0) continue;
 
             // Check if bin is visible
@@ -199,45 +442,59 @@ static void waterfall_widget_draw(GtkDrawingArea *area, cairo_t *cr,
         cairo_set_dash(cr, NULL, 0, 0);
     }
 
-    // Draw time labels in left margin
+    // Draw time labels in left margin (hours drawn with the heatmap)
     cairo_select_font_face(cr, "monospace", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
     cairo_set_font_size(cr, 12);
     cairo_set_source_rgba(cr, 0.7, 0.7, 0.7, 1.0);
 
     // Calculate total time span visible
-    float total_seconds = height / LINES_PER_SECOND;
-
-    // Draw time labels at regular intervals (right-justified)
-    int num_labels = 5;
-    for (int i = 0; i <= num_labels; i++) {
-        double y = (double)i / num_labels * height;
-        float seconds = (float)i / num_labels * total_seconds;
-
-        char label[16];
-        if (seconds < 60) {
-            snprintf(label, sizeof(label), "%.0fs", seconds);
-        } else {
-            int mins = (int)(seconds / 60);
-            int secs = (int)seconds % 60;
-            snprintf(label, sizeof(label), "%d:%02d", mins, secs);
+    float total_seconds = (float)(height * (self->line_ns / 1e9));
+
+    // Draw time labels at regular intervals (right-justified); scrolled
+    // back, the UTC time of the row
+    if (!self->occupancy) {
+        int num_labels = 5;
+        for (int i = 0; i <= num_labels; i++) {
+            double y = (double)i / num_labels * height;
+            float seconds = (float)i / num_labels * total_seconds;
+
+            char label[16];
+            if (self->history_end_ns) {
+                time_t row = (time_t)((self->history_end_ns - (int64_t)(y * self->line_ns)) / 1000000000LL);
+                struct tm row_tm;
+                gmtime_r(&row, &row_tm);
+                strftime(label, sizeof(label), "%H:%M", &row_tm);
+            } else if (seconds < 60) {
+                snprintf(label, sizeof(label), "%.0fs", seconds);
+            } else {
+                int mins = (int)(seconds / 60);
+                int secs = (int)seconds % 60;
+                snprintf(label, sizeof(label), "%d:%02d", mins, secs);
+            }
+            cairo_text_extents_t extents;
+            cairo_text_extents(cr, label, &extents);
+            cairo_move_to(cr, MARGIN_LEFT - extents.width - 5, y + 4);
+            cairo_show_text(cr, label);
         }
-        cairo_text_extents_t extents;
-        cairo_text_extents(cr, label, &extents);
-        cairo_move_to(cr, MARGIN_LEFT - extents.width - 5, y + 4);
-        cairo_show_text(cr, label);
     }
 
-    // Draw local and UTC time at top of waterfall
-    time_t now = time(NULL);
+    // Draw local and UTC time at top of waterfall (of the top row, in
+    // yellow, when scrolled back)
+    time_t now = self->history_end_ns ? (time_t)(self->history_end_ns / 1000000000LL) : time(NULL);
     struct tm local_tm, utc_tm;
-    char local_time[16], utc_time[16];
+    char local_time[32], utc_time[32];
 
     localtime_r(&now, &local_tm);
     gmtime_r(&now, &utc_tm);
-    strftime(local_time, sizeof(local_time), "LOCAL %H:%M:%S", &local_tm);
-    strftime(utc_time, sizeof(utc_time), "UTC %H:%M:%S", &utc_tm);
-
-    cairo_set_source_rgba(cr, 0.0, 1.0, 1.0, 1.0);  // Cyan
+    if (self->history_end_ns) {
+        strftime(local_time, sizeof(local_time), "LOCAL %Y-%m-%d %H:%M:%S", &local_tm);
+        strftime(utc_time, sizeof(utc_time), "UTC %Y-%m-%d %H:%M:%S", &utc_tm);
+        cairo_set_source_rgba(cr, 1.0, 1.0, 0.0, 1.0);  // Yellow
+    } else {
+        strftime(local_time, sizeof(local_time), "LOCAL %H:%M:%S", &local_tm);
+        strftime(utc_time, sizeof(utc_time), "UTC %H:%M:%S", &utc_tm);
+        cairo_set_source_rgba(cr, 0.0, 1.0, 1.0, 1.0);  // Cyan
+    }
     cairo_set_font_size(cr, 16);
 
     // Local time - top left
@@ -249,16 +506,25 @@ static void waterfall_widget_draw(GtkDrawingArea *area, cairo_t *cr,
     cairo_text_extents(cr, utc_time, &time_extents);
     cairo_move_to(cr, width - time_extents.width - 5, 18);
     cairo_show_text(cr, utc_time);
+
+    PERF_SPAN_END(draw_start, PERF_STAGE_WATERFALL_DRAW);
 }
 
 static void waterfall_widget_finalize(GObject *object) {
     WaterfallWidget *self = WATERFALL_WIDGET(object);
 
+    // No worker is left: each task holds a reference to the widget
+    if (self->history_destroy) self->history_destroy(self->history_data);
+    g_mutex_clear(&self->history_lock);
     g_mutex_clear(&self->data_mutex);
     g_free(self->waterfall_data);
+    g_free(self->occupancy);
     if (self->surface) {
         cairo_surface_destroy(self->surface);
     }
+    if (self->history_surface) {
+        cairo_surface_destroy(self->history_surface);
+    }
 
     G_OBJECT_CLASS(waterfall_widget_parent_class)->finalize(object);
 }
@@ -268,8 +534,49 @@ static void waterfall_widget_class_init(WaterfallWidgetClass *klass) {
     object_class->finalize = waterfall_widget_finalize;
 }
 
+// Show the archive with its top row at end_ns, the live lines from now on
+static void history_seek(WaterfallWidget *self, int64_t end_ns) {
+    self->history_end_ns = end_ns >= g_get_real_time() * 1000 ? 0 : end_ns;
+    self->history_dirty = TRUE;
+    gtk_widget_queue_draw(GTK_WIDGET(self));
+}
+
+static void on_drag_begin(GtkGestureDrag *gesture G_GNUC_UNUSED, double x G_GNUC_UNUSED,
+                          double y G_GNUC_UNUSED, gpointer user_data) {
+    WaterfallWidget *self = WATERFALL_WIDGET(user_data);
+    self->drag_start_ns = self->history_end_ns ? self->history_end_ns : g_get_real_time() * 1000;
+}
+
+// Dragging up pulls older lines into view, one line per pixel
+static void on_drag_update(GtkGestureDrag *gesture G_GNUC_UNUSED, double dx G_GNUC_UNUSED,
+                           double dy, gpointer user_data) {
+    WaterfallWidget *self = WATERFALL_WIDGET(user_data);
+    if (!self->history_func) return;
+    history_seek(self, self->drag_start_ns + (int64_t)(dy * self->line_ns));
+}
+
+static gboolean on_scroll(GtkEventControllerScroll *controller, double dx G_GNUC_UNUSED,
+                          double dy, gpointer user_data) {
+    WaterfallWidget *self = WATERFALL_WIDGET(user_data);
+    if (!self->history_func) return FALSE;
+
+    GdkModifierType state =
+        gtk_event_controller_get_current_event_state(GTK_EVENT_CONTROLLER(controller));
+    int64_t step = (state & GDK_SHIFT_MASK) ? HISTORY_SCROLL_FAST_NS : HISTORY_SCROLL_NS;
+    int64_t end = self->history_end_ns ? self->history_end_ns : g_get_real_time() * 1000;
+    history_seek(self, end - (int64_t)(dy * step));
+    return TRUE;
+}
+
+static void on_pressed(GtkGestureClick *gesture G_GNUC_UNUSED, int n_press,
+                       double x G_GNUC_UNUSED, double y G_GNUC_UNUSED, gpointer user_data) {
+    WaterfallWidget *self = WATERFALL_WIDGET(user_data);
+    if (n_press == 2 && self->history_end_ns) history_seek(self, 0);
+}
+
 static void waterfall_widget_init(WaterfallWidget *self) {
     g_mutex_init(&self->data_mutex);
+    g_mutex_init(&self->history_lock);
     self->waterfall_data = NULL;
     self->spectrum_size = 0;
     self->num_lines = WATERFALL_LINES;
@@ -281,48 +588,63 @@ static void waterfall_widget_init(WaterfallWidget *self) {
     self->max_db = 0.0f;
     self->zoom_level = 1;
     self->pan_offset = 0;
+    self->zoom_fft = FALSE;
+    self->line_ns = LINE_NS;
     self->bandwidth_hz = 0;
     self->current_mode = ELAD_MODE_UNKNOWN;
     self->sample_rate = DEFAULT_SAMPLE_RATE;
     self->center_offset_hz = 0;
     self->is_resonator = 0;
+    self->occupancy = NULL;
+    self->occupancy_columns = 0;
+    self->history_func = NULL;
+    self->history_data = NULL;
+    self->history_destroy = NULL;
+    self->history_end_ns = 0;
 
     gtk_drawing_area_set_draw_func(GTK_DRAWING_AREA(self), waterfall_widget_draw, NULL, NULL);
+
+    // Scrollback (inactive until an archive is set)
+    GtkGesture *drag = gtk_gesture_drag_new();
+    g_signal_connect(drag, "drag-begin", G_CALLBACK(on_drag_begin), self);
+    g_signal_connect(drag, "drag-update", G_CALLBACK(on_drag_update), self);
+    gtk_widget_add_controller(GTK_WIDGET(self), GTK_EVENT_CONTROLLER(drag));
+
+    GtkEventController *scroll = gtk_event_controller_scroll_new(GTK_EVENT_CONTROLLER_SCROLL_VERTICAL);
+    g_signal_connect(scroll, "scroll", G_CALLBACK(on_scroll), self);
+    gtk_widget_add_controller(GTK_WIDGET(self), scroll);
+
+    GtkGesture *click = gtk_gesture_click_new();
+    g_signal_connect(click, "pressed", G_CALLBACK(on_pressed), self);
+    gtk_widget_add_controller(GTK_WIDGET(self), GTK_EVENT_CONTROLLER(click));
 }
 
 GtkWidget *waterfall_widget_new(void) {
     return g_object_new(WATERFALL_TYPE_WIDGET, NULL);
 }
 
-void waterfall_widget_add_line(WaterfallWidget *widget, const float *spectrum_db, int size) {
+void waterfall_widget_add_line(WaterfallWidget *widget, const float *spectrum_db, int size,
+                               uint64_t timestamp_ns) {
     if (!widget || !spectrum_db || size <= 0) return;
 
     g_mutex_lock(&widget->data_mutex);
 
     widget->spectrum_size = size;
 
-    // If we have a surface, scroll it down and draw new line at top using direct pixel access
-    if (widget->surface) {
-        int width = widget->surface_width;
-        int height = widget->surface_height;
-
-        // Flush any pending Cairo operations
-        cairo_surface_flush(widget->surface);
-
-        // Get direct access to pixel data
-        unsigned char *data = cairo_image_surface_get_data(widget->surface);
-        int stride = cairo_image_surface_get_stride(widget->surface);
-
-        // Scroll down: move all rows down by 1 (from bottom to top to avoid overlap)
-        // memmove handles overlapping regions correctly
-        if (height > 1) {
-            memmove(data + stride, data, stride * (height - 1));
-        }
-
-        // Draw new line at top (row 0) - RGB24 format is 0xXXRRGGBB (little-endian: BB GG RR XX)
-        float range = widget->max_db - widget->min_db;
-        if (range < 1.0f) range = 1.0f;
+    // Remember when the line's samples were captured until it is drawn
+    if (widget->pending_count == LATENCY_PENDING_LINES) {
+        memmove(widget->pending_ts, widget->pending_ts + 1,
+                sizeof(uint64_t) * (LATENCY_PENDING_LINES - 1));
+        widget->pending_count--;
+    }
+    widget->pending_ts[widget->pending_count++] = timestamp_ns;
+    if (widget->probe_request_ns) {
+        widget->pending_probe_ns = widget->probe_request_ns;
+        widget->probe_request_ns = 0;
+    }
 
+    // If we have a surface, scroll it down and draw the new line at the top
+    if (widget->surface) {
         // Calculate visible bin range based on zoom level and pan offset
         int visible_bins = size / widget->zoom_level;
         int max_pan = (size - visible_bins) / 2;
@@ -331,27 +653,14 @@ void waterfall_widget_add_line(WaterfallWidget *widget, const float *spectrum_db
         if (clamped_pan > max_pan) clamped_pan = max_pan;
         int start_bin = (size - visible_bins) / 2 + clamped_pan;
 
-        uint32_t *row = (uint32_t *)data;
-        for (int x = 0; x < width; x++) {
-            // Map x to spectrum bin (within zoomed range)
-            int bin = start_bin + x * visible_bins / width;
-            if (bin >= start_bin + visible_bins) bin = start_bin + visible_bins - 1;
-
-            float db = spectrum_db[bin];
-            if (db < widget->min_db) db = widget->min_db;
-            if (db > widget->max_db) db = widget->max_db;
-
-            float normalized = (db - widget->min_db) / range;
-
-            uint8_t r, g, b;
-            db_to_color(normalized, &r, &g, &b);
-
-            // RGB24 format: 0x00RRGGBB
-            row[x] = ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+        // Zoom FFT lines already cover the visible span
+        if (widget->zoom_fft) {
+            visible_bins = size;
+            start_bin = 0;
         }
 
-        // Mark surface as modified
-        cairo_surface_mark_dirty(widget->surface);
+        waterfall_render_line(widget->surface, spectrum_db, start_bin, visible_bins,
+                              widget->min_db, widget->max_db);
     }
 
     g_mutex_unlock(&widget->data_mutex);
@@ -360,10 +669,18 @@ void waterfall_widget_add_line(WaterfallWidget *widget, const float *spectrum_db
     gtk_widget_queue_draw(GTK_WIDGET(widget));
 }
 
+void waterfall_widget_set_latency_probe(WaterfallWidget *widget, uint64_t origin_ns) {
+    if (!widget) return;
+    g_mutex_lock(&widget->data_mutex);
+    widget->probe_request_ns = origin_ns;
+    g_mutex_unlock(&widget->data_mutex);
+}
+
 void waterfall_widget_set_range(WaterfallWidget *widget, float min_db, float max_db) {
     if (!widget) return;
     widget->min_db = min_db;
     widget->max_db = max_db;
+    widget->history_dirty = TRUE;
 }
 
 void waterfall_widget_clear(WaterfallWidget *widget) {
@@ -380,6 +697,7 @@ void waterfall_widget_clear(WaterfallWidget *widget) {
         cairo_destroy(cr);
     }
     widget->current_line = 0;
+    widget->history_dirty = TRUE;
     g_mutex_unlock(&widget->data_mutex);
 
     gtk_widget_queue_draw(GTK_WIDGET(widget));
@@ -389,7 +707,7 @@ void waterfall_widget_set_zoom(WaterfallWidget *widget, int zoom_level) {
     if (!widget) return;
     // Clamp to valid zoom levels
     if (zoom_level < 1) zoom_level = 1;
-    if (zoom_level > 8) zoom_level = 8;
+    if (zoom_level > 16) zoom_level = 16;
 
     if (widget->zoom_level != zoom_level) {
         widget->zoom_level = zoom_level;
@@ -398,6 +716,14 @@ void waterfall_widget_set_zoom(WaterfallWidget *widget, int zoom_level) {
     }
 }
 
+void waterfall_widget_set_zoom_fft(WaterfallWidget *widget, gboolean enabled) {
+    if (!widget) return;
+    if (widget->zoom_fft != enabled) {
+        widget->zoom_fft = enabled;
+        waterfall_widget_clear(widget);
+    }
+}
+
 int waterfall_widget_get_zoom(WaterfallWidget *widget) {
     if (!widget) return 1;
     return widget->zoom_level;
@@ -425,6 +751,50 @@ void waterfall_widget_set_bandwidth(WaterfallWidget *widget, int bandwidth_hz, i
     widget->is_resonator = is_resonator;
 }
 
+void waterfall_widget_set_occupancy(WaterfallWidget *widget, const float *busy, int columns) {
+    if (!widget) return;
+
+    g_clear_pointer(&widget->occupancy, g_free);
+    widget->occupancy_columns = 0;
+    if (busy && columns > 0) {
+        // Square root, so a channel busy a few percent of the time shows
+        widget->occupancy = g_new(float, 24 * columns);
+        for (int i = 0; i < 24 * columns; i++) {
+            widget->occupancy[i] = isnan(busy[i]) ? 0.0f : sqrtf(busy[i]);
+        }
+        widget->occupancy_columns = columns;
+    }
+    gtk_widget_queue_draw(GTK_WIDGET(widget));
+}
+
+void waterfall_widget_set_history(WaterfallWidget *widget, waterfall_history_func_t func,
+                                  gpointer user_data, GDestroyNotify destroy) {
+    if (!widget) return;
+
+    // Once swapped under the lock, no worker reads the old source
+    g_mutex_lock(&widget->history_lock);
+    gpointer old_data = widget->history_data;
+    GDestroyNotify old_destroy = widget->history_destroy;
+    widget->history_func = func;
+    widget->history_data = user_data;
+    widget->history_destroy = destroy;
+    g_mutex_unlock(&widget->history_lock);
+
+    if (old_destroy) old_destroy(old_data);
+    if (!func) history_seek(widget, 0);
+}
+
+void waterfall_widget_set_line_rate(WaterfallWidget *widget, double lines_per_second) {
+    if (!widget || !(lines_per_second > 0.0)) return;
+    int64_t line_ns = (int64_t)(1e9 / lines_per_second);
+    if (line_ns < 1) line_ns = 1;
+    if (widget->line_ns != line_ns) {
+        widget->line_ns = line_ns;
+        widget->history_dirty = TRUE;
+        gtk_widget_queue_draw(GTK_WIDGET(widget));
+    }
+}
+
 void waterfall_widget_set_sample_rate(WaterfallWidget *widget, int sample_rate) {
     if (!widget) return;
     widget->sample_rate = sample_rate;
@@ -13,7 +13,15 @@ G_DECLARE_FINAL_TYPE(WaterfallWidget, waterfall_widget, WATERFALL, WIDGET, GtkDr
 GtkWidget *waterfall_widget_new(void);
 
 // Add a new spectrum line (thread-safe, copies data)
-void waterfall_widget_add_line(WaterfallWidget *widget, const float *spectrum_db, int size);
+// timestamp_ns: capture time of its newest samples (CLOCK_MONOTONIC, 0 if
+// unknown), used for the sample-to-pixel latency stages
+void waterfall_widget_add_line(WaterfallWidget *widget, const float *spectrum_db, int size,
+                               uint64_t timestamp_ns);
+
+// Tag the next added line as a latency probe: when the frame showing it
+// is presented, the time since origin_ns (CLOCK_MONOTONIC) is recorded
+// as the lat_burst stage
+void waterfall_widget_set_latency_probe(WaterfallWidget *widget, uint64_t origin_ns);
 
 // Set display range
 void waterfall_widget_set_range(WaterfallWidget *widget, float min_db, float max_db);
@@ -21,9 +29,13 @@ void waterfall_widget_set_range(WaterfallWidget *widget, float min_db, float max
 // Clear waterfall history
 void waterfall_widget_clear(WaterfallWidget *widget);
 
-// Set horizontal zoom level (1, 2, 4, 8 = divisor of displayed frequency span)
+// Set horizontal zoom level (1, 2, 4, 8, 16 = divisor of displayed frequency span)
 void waterfall_widget_set_zoom(WaterfallWidget *widget, int zoom_level);
 
+// Zoom FFT mode: lines already cover the zoomed span (DDC in the DSP
+// path) and are drawn in full instead of slicing the visible bins
+void waterfall_widget_set_zoom_fft(WaterfallWidget *widget, gboolean enabled);
+
 // Get current zoom level
 int waterfall_widget_get_zoom(WaterfallWidget *widget);
 
@@ -40,6 +52,33 @@ int waterfall_widget_get_pan(WaterfallWidget *widget);
 // is_resonator: true for CW resonator modes (draws orange instead of red)
 void waterfall_widget_set_bandwidth(WaterfallWidget *widget, int bandwidth_hz, int mode, int center_offset_hz, int is_resonator);
 
+// Show an occupancy heatmap instead of the waterfall lines: 24 rows (hour
+// of day UTC, 00 at the top) of columns busy fractions (0..1, NAN = no
+// data) across the full span; NULL hides it (copies data)
+void waterfall_widget_set_occupancy(WaterfallWidget *widget, const float *busy, int columns);
+
+// Archived lines for scrollback: fill lines (bins floats each, oldest
+// first) and times_ns (CLOCK_REALTIME) with up to max_lines lines from
+// start_ns on, returning how many
+// Called on a worker thread (GTask), never two at once for one widget
+typedef int (*waterfall_history_func_t)(gpointer user_data, int64_t start_ns, int max_lines,
+                                        float *lines, int64_t *times_ns, int bins);
+
+// Enable scrollback through an archive: dragging up or scrolling moves
+// back in time (wheel: 1 minute a step, 15 with Shift), dragging back
+// past the present or a double-click returns to the live lines; NULL
+// disables it
+// The widget owns user_data: destroy (may be NULL) is called once no
+// worker can read it any more, when the source is replaced or the
+// widget is finalized
+void waterfall_widget_set_history(WaterfallWidget *widget, waterfall_history_func_t func,
+                                  gpointer user_data, GDestroyNotify destroy);
+
+// Set the rate lines arrive at (default 15.625, one per averaged FFT),
+// which scales the time axis, dragging and scrollback, e.g. one line per
+// step while sweeping
+void waterfall_widget_set_line_rate(WaterfallWidget *widget, double lines_per_second);
+
 // Set sample rate (needed for Hz to bin conversion)
 void waterfall_widget_set_sample_rate(WaterfallWidget *widget, int sample_rate);
 